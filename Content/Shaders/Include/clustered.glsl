@@ -0,0 +1,50 @@
+// Clustered light lists, filled by ClusteredLighting. Light positions are in view space
+struct PointLight {
+    vec4 positionRadius;
+    vec4 colorIntensity;
+};
+
+struct LightCluster {
+    uint offset;
+    uint count;
+};
+
+layout (std430, binding = 2) readonly buffer ClusterLights
+{
+    PointLight clusterLights[];
+};
+
+layout (std430, binding = 3) readonly buffer Clusters
+{
+    LightCluster clusters[];
+};
+
+layout (std430, binding = 4) readonly buffer ClusterLightIndices
+{
+    uint clusterLightIndices[];
+};
+
+uniform vec3 clusterGrid;     // Cluster count in x, y and z
+uniform vec3 clusterSlicing;  // Depth slice scale and bias
+uniform vec3 clusterViewport; // Viewport size in pixels
+
+LightCluster GetLightCluster(vec2 fragCoord, float viewDepth)
+{
+    uvec3 grid = uvec3(clusterGrid);
+
+    uvec2 tile = uvec2(fragCoord / clusterViewport.xy * clusterGrid.xy);
+    uint slice = uint(max(log(viewDepth) * clusterSlicing.x + clusterSlicing.y, 0.0));
+
+    tile = min(tile, grid.xy - 1u);
+    slice = min(slice, grid.z - 1u);
+
+    return clusters[tile.x + tile.y * grid.x + slice * grid.x * grid.y];
+}
+
+// Smooth falloff that reaches exactly zero at the light radius
+float GetLightAttenuation(float distance, float radius)
+{
+    float ratio = clamp(distance / radius, 0.0, 1.0);
+    float falloff = 1.0 - ratio * ratio;
+    return falloff * falloff / (1.0 + distance * distance);
+}
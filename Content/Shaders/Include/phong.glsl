@@ -0,0 +1,36 @@
+struct Light {
+    vec3 position;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct Material {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    float shininess;
+};
+
+// Positions and normal in view space
+vec3 ComputePhong(Light light, Material material, vec3 position, vec3 normal)
+{
+    vec3 lightDir = normalize(light.position - position);
+
+    vec3 ambient = light.ambient * material.ambient;
+
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 diffuse = light.diffuse * (diff * material.diffuse);
+
+    vec3 result = ambient + diffuse;
+
+#ifdef SPECULAR
+    vec3 viewDir = normalize(-position);
+    vec3 reflectDir = reflect(-lightDir, normal);
+
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    result += light.specular * (spec * material.specular);
+#endif
+
+    return result;
+}
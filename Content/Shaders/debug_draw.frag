@@ -1,7 +1,10 @@
 #version 450 core
+
+in vec4 vColor;
+
 out vec4 FragColor;
 
 void main()
 {
-    FragColor = vec4(1.0);
+    FragColor = vColor;
 }
\ No newline at end of file
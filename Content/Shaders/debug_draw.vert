@@ -0,0 +1,14 @@
+#version 450 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aColor; // RGBA8, not normalized by the vertex layout
+
+uniform mat4 viewProjection;
+
+out vec4 vColor;
+
+void main()
+{
+    vColor = aColor / 255.0;
+    gl_Position = viewProjection * vec4(aPos, 1.0);
+}
\ No newline at end of file
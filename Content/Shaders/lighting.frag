@@ -1,46 +1,44 @@
 #version 450 core
+#pragma keywords SPECULAR
 
 out vec4 FragColor;
 
-struct Light {
-    vec3 position;
+#include "Include/phong.glsl"
+#include "Include/clustered.glsl"
+
+// Filled by the Material, see Material::UNIFORM_BLOCK_BINDING
+layout (std140, binding = 1) uniform MaterialBlock
+{
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
-};
-  
- struct Material {
-     vec3 ambient;
-     vec3 diffuse;
-     vec3 specular;
-     float shininess;
- };
-  
-uniform Material material;
-uniform Light light;
-uniform vec3 viewPosition;
+    float shininess;
+} uMaterial;
+
+uniform vec3 ambientLight;
 
 in vec3 FragPos;
 in vec3 Normal;
 
 void main()
 {
-    vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(light.position - FragPos);
-    vec3 viewDir = normalize(-FragPos);
-    vec3 reflectDir = reflect(-lightDir, norm);
-    
-    float ambientStrength = 0.1;
-    vec3 ambient = light.ambient * material.ambient;
-    
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = light.diffuse * (diff * material.diffuse);
-    
-    float specularStrength = 0.5;
-    
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = light.specular * (spec * material.specular);  
-   
-    vec3 result = ambient + diffuse + specular;
+    Material material = Material(uMaterial.ambient, uMaterial.diffuse, uMaterial.specular, uMaterial.shininess);
+    vec3 normal = normalize(Normal);
+
+    vec3 result = ambientLight * material.ambient;
+
+    // Only the lights binned into this fragment's cluster can reach it
+    LightCluster cluster = GetLightCluster(gl_FragCoord.xy, -FragPos.z);
+    for (uint i = 0u; i < cluster.count; ++i)
+    {
+        PointLight pointLight = clusterLights[clusterLightIndices[cluster.offset + i]];
+
+        float attenuation = GetLightAttenuation(length(pointLight.positionRadius.xyz - FragPos), pointLight.positionRadius.w);
+        vec3 radiance = pointLight.colorIntensity.rgb * pointLight.colorIntensity.a * attenuation;
+
+        Light light = Light(pointLight.positionRadius.xyz, vec3(0.0), radiance, radiance);
+        result += ComputePhong(light, material, FragPos, normal);
+    }
+
     FragColor = vec4(result, 1.0);
-}
\ No newline at end of file
+}
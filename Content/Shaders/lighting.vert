@@ -1,9 +1,21 @@
 #version 450 core
+#pragma keywords INSTANCED
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 
+#ifdef INSTANCED
+// Filled by the InstanceBuffer, see InstanceBuffer::BINDING
+layout (std430, binding = 5) readonly buffer InstanceTransforms
+{
+    mat4 instanceModels[];
+};
+
+uniform int instanceOffset;
+#else
 uniform mat4 model;
+#endif
+
 uniform mat4 view;
 uniform mat4 projection;
 
@@ -12,9 +24,13 @@ out vec3 Normal;
 
 void main()
 {
+#ifdef INSTANCED
+    mat4 model = instanceModels[instanceOffset + gl_InstanceID];
+#endif
+
     mat4 modelView = view * model;
     FragPos = vec3(modelView * vec4(aPos, 1.0));
     Normal = normalize(mat3(modelView) * aNormal);
     
     gl_Position = projection * vec4(FragPos, 1.0);
-}
\ No newline at end of file
+}
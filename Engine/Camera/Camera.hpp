@@ -43,6 +43,8 @@ namespace zn
         math::m4 GetViewMatrix() const;
         math::m4 GetProjection() const;
         math::m4 GetViewProjectionMatrix() const;
+        f32 GetNearClip() const { return m_nearClip; }
+        f32 GetFarClip() const { return m_farClip; }
         
     private:
         void UpdateProjection();
@@ -1,7 +1,13 @@
 #include "Application.hpp"
 
+#include "CpuFeatures.hpp"
+#include "JobSystem.hpp"
 #include "Log.hpp"
 #include "Math/Math.hpp"
+#include "Memory/FrameAllocator.hpp"
+#include "Memory/MemoryTracker.hpp"
+#include "Profiler.hpp"
+#include "StatsRegistry.hpp"
 #include "Timer.hpp"
 
 #include "Utils/Lifetime.hpp"
@@ -11,8 +17,31 @@
 #include "Assert.hpp"
 #include "Resource/ResourceRegistry.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <thread>
+
 namespace zn
 {
+	namespace
+	{
+		// Application the signal handler asks to stop while a headless run is active
+		std::atomic<Application*> s_signalTarget{nullptr};
+
+		void OnTerminationSignal(int signal)
+		{
+			// A second Ctrl+C falls through to the default handler and kills the process
+			std::signal(signal, SIG_DFL);
+
+			if (Application* application = s_signalTarget.load())
+			{
+				application->RequestExit();
+			}
+		}
+	}
+
 	Application::~Application()
 	{
 		
@@ -20,9 +49,42 @@ namespace zn
 
 	b8 Application::Init(const String& appName, u32 windowWidth, u32 windowHeight)
 	{
+		ApplicationConfig config;
+		config.Name = appName;
+		config.WindowWidth = windowWidth;
+		config.WindowHeight = windowHeight;
+
+		return Init(config);
+	}
+
+	b8 Application::Init(const ApplicationConfig& config)
+	{
+		// Subsystems charge their own allocations, whatever is left is engine core
+		MemoryTagScope memoryTag(MemoryTag::Core);
+
 		Log::Init();
-		
-		if (!m_window.Init(windowWidth, windowHeight, appName))
+		CpuFeatures::Init();
+		Profiler::Init();
+		JobSystem::Init();
+		FrameAllocator::Init();
+
+		m_headless = config.Headless;
+		m_throttleToFixedRate = config.ThrottleToFixedRate;
+		m_maxTicks = config.MaxTicks;
+		m_statsCsvPath = config.StatsCsvPath;
+
+		if (m_headless)
+		{
+			ZN_CORE_INFO("[Application::Init] {} running headless", config.Name);
+
+			m_initialized = true;
+			return true;
+		}
+
+		const u32 windowWidth = config.WindowWidth;
+		const u32 windowHeight = config.WindowHeight;
+
+		if (!m_window.Init(windowWidth, windowHeight, config.Name))
 		{
 			ZN_CORE_CRITICAL("[Application::Init] Failed to initialize Window. Closing Application");
 			return false;
@@ -47,6 +109,8 @@ namespace zn
 		m_windowClosedConnection = EventSystem::Instance().Subscribe<WindowClosedEvent>(shared_from_this(), &Application::OnWindowClosed);
 		m_windowResizedConnection = EventSystem::Instance().Subscribe<WindowResizedEvent>(shared_from_this(), &Application::OnWindowResized);
 
+		BuildFrameGraph();
+
 		m_initialized = true;
 
 		return true;
@@ -58,60 +122,175 @@ namespace zn
 		
 		if (!m_initialized)
 			return;
+
+		if (m_headless)
+		{
+			RunHeadless();
+		}
+		else
+		{
+			RunWindowed();
+		}
+
+		Shutdown();
+	}
+
+	void Application::RunWindowed()
+	{
+		m_previousFrameTime = Time::GetCurrentTime();
+		m_previousCameraPosition = m_camera.GetPosition();
 		
-		//const Time::Duration fixedDelta(1 / 60.f);
-		//f64 accumulator = 0.0;
-		//constexpr int maxUpdatesPerFrame = 5;
-		//constexpr f64 maxFrameTime = 0.25; // capped at 4 FPS equivalent
-		
-		Time::TimePoint previousTime = Time::GetCurrentTime();
-		
-		while (!m_window.ShouldClose())
+		while (!m_window.ShouldClose() && !m_exitRequested.load(std::memory_order_relaxed))
 		{
-			Time::TimePoint currentTime = Time::GetCurrentTime();
-			Time::Duration frameDuration = currentTime - previousTime;
-			f64 deltaTime = frameDuration.count();
-			
-			previousTime = currentTime;
-
-			// Clamp frameTime to prevent big accumulator jumps on stalls
-			//frameTime = std::min(frameTime, maxFrameTime);
-			//accumulator += frameTime;
-			//
-			//int frameUpdates = 0;
-			//while (accumulator >= fixedDelta.count())
-			//{
-			//	if (frameUpdates >= maxUpdatesPerFrame)
-			//	{
-			//		accumulator = 0.0;
-			//		break;
-			//	}
-			//
-			//	//Update Simulation(dt)
-			//	accumulator -= fixedDelta.count();
-			//	frameUpdates++;
-			//}
-			
-			m_window.PollEvents();
-			m_inputSystem.Update();
-			
-			ProcessInput(deltaTime);
-			
-			//f64 interpolationAlpha = accumulator / fixedDelta.count();
-			
-			m_renderer.Render(m_camera);
+			AdvanceClock();
+
+			Profiler::BeginFrame();
+			FrameAllocator::BeginFrame(m_frameIndex);
+			m_frameGraph.Execute();
+			m_frameIndex++;
 			
-			m_window.RenderImGUI();
-			m_window.SwapBuffers();
+			JobSystem::UpdateStats();
+			MemoryTracker::Update();
+			StatsRegistry::EndFrame();
 		}
+	}
 
-		Shutdown();
+	void Application::RunHeadless()
+	{
+		const StatId tickTimeStat = StatsRegistry::Register("Tick/Tick ms", StatKind::Gauge);
+
+		// Without a window there's nothing to close; Ctrl+C and SIGTERM stop the run cleanly instead,
+		// so the CSV stream and the log queue are still flushed
+		s_signalTarget.store(this);
+		const auto previousInterruptHandler = std::signal(SIGINT, &OnTerminationSignal);
+		const auto previousTerminateHandler = std::signal(SIGTERM, &OnTerminationSignal);
+
+		const auto tickDuration = std::chrono::duration_cast<Time::Clock::duration>(Time::Duration(m_fixedDelta));
+		Time::TimePoint nextTick = Time::GetCurrentTime();
+		Time::TimePoint reportStart = nextTick;
+		u64 reportTicks = 0;
+
+		while (!m_exitRequested.load(std::memory_order_relaxed) && (m_maxTicks == 0 || m_frameIndex < m_maxTicks))
+		{
+			if (m_throttleToFixedRate)
+			{
+				std::this_thread::sleep_until(nextTick);
+				// A tick that ran long isn't caught up with a burst of back to back ticks
+				nextTick = std::max(nextTick, Time::GetCurrentTime()) + tickDuration;
+			}
+
+			const Time::TimePoint tickStart = Time::GetCurrentTime();
+
+			Profiler::BeginFrame();
+			FrameAllocator::BeginFrame(m_frameIndex);
+			FixedUpdate();
+			m_frameIndex++;
+
+			const Time::TimePoint tickEnd = Time::GetCurrentTime();
+			StatsRegistry::Set(tickTimeStat, Time::Duration(tickEnd - tickStart).count() * 1000.0);
+
+			JobSystem::UpdateStats();
+			MemoryTracker::Update();
+			StatsRegistry::EndFrame();
+
+			// The CSV columns are fixed when the stream opens. Most stats register on first use, so the
+			// stream starts after the first tick has registered them
+			if (m_frameIndex == 1 && !m_statsCsvPath.empty())
+			{
+				StatsRegistry::BeginCsvStream(m_statsCsvPath);
+			}
+
+			// Nothing is drawn, so the stats are reported to the log once a second
+			reportTicks++;
+			const f64 reportSeconds = Time::Duration(tickEnd - reportStart).count();
+			if (reportSeconds >= 1.0)
+			{
+				ZN_CORE_INFO("[Application::RunHeadless] {:.0f} ticks/s, tick p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms",
+					static_cast<f64>(reportTicks) / reportSeconds, StatsRegistry::GetPercentile(tickTimeStat, 50.0),
+					StatsRegistry::GetPercentile(tickTimeStat, 99.0), StatsRegistry::GetPercentile(tickTimeStat, 100.0));
+
+				reportStart = tickEnd;
+				reportTicks = 0;
+			}
+		}
+
+		std::signal(SIGINT, previousInterruptHandler);
+		std::signal(SIGTERM, previousTerminateHandler);
+		s_signalTarget.store(nullptr);
+
+		StatsRegistry::EndCsvStream();
+
+		ZN_CORE_INFO("[Application::RunHeadless] Stopped after {} ticks ({:.2f} s simulated)", m_frameIndex, static_cast<f64>(m_frameIndex) * m_fixedDelta);
+	}
+
+	void Application::SetFixedUpdateRate(f64 updatesPerSecond)
+	{
+		ZN_ASSERT(updatesPerSecond > 0.0, "Fixed update rate must be positive");
+
+		if (updatesPerSecond > 0.0)
+		{
+			m_fixedDelta = 1.0 / updatesPerSecond;
+		}
+	}
+
+	void Application::SetMaxUpdatesPerFrame(u32 maxUpdates)
+	{
+		m_maxUpdatesPerFrame = std::max(maxUpdates, 1u);
+	}
+
+	void Application::AdvanceClock()
+	{
+		const Time::TimePoint currentTime = Time::GetCurrentTime();
+		const Time::Duration frameDuration = currentTime - m_previousFrameTime;
+		m_previousFrameTime = currentTime;
+
+		m_accumulator += std::min(frameDuration.count(), MAX_FRAME_TIME);
+
+		u32 updates = static_cast<u32>(m_accumulator / m_fixedDelta);
+		if (updates > m_maxUpdatesPerFrame)
+		{
+			// Can't keep up: run what fits and let the simulation fall behind wall clock time
+			ZN_STAT_ADD("Frame/Fixed updates dropped", updates - m_maxUpdatesPerFrame);
+			updates = m_maxUpdatesPerFrame;
+			m_accumulator = std::fmod(m_accumulator, m_fixedDelta);
+		}
+		else
+		{
+			m_accumulator -= updates * m_fixedDelta;
+		}
+
+		m_pendingFixedUpdates = updates;
+		m_interpolationAlpha = std::clamp(m_accumulator / m_fixedDelta, 0.0, 1.0);
+	}
+
+	void Application::FixedUpdate()
+	{
+		if (!m_headless)
+		{
+			m_previousCameraPosition = m_camera.GetPosition();
+			ProcessInput(m_fixedDelta);
+
+			m_renderer.Simulate(m_fixedDelta);
+		}
+
+		if (m_fixedUpdateCallback)
+		{
+			m_fixedUpdateCallback(m_fixedDelta);
+		}
 	}
 
 	void Application::Shutdown()
 	{
 		//ResourceManager::Shutdown();
-		//m_renderer.Shutdown();
+		if (!m_headless)
+		{
+			m_renderer.Shutdown();
+		}
+		JobSystem::Shutdown();
+		Profiler::Shutdown();
+		FrameAllocator::Shutdown();
+		// Last, so everything above can still log
+		Log::Shutdown();
 	}
 
 	b8 Application::OnKeyPressed(const KeyPressedEvent& e)
@@ -142,10 +321,79 @@ namespace zn
 	b8 Application::OnWindowResized(const WindowResizedEvent& e)
 	{
 		ZN_CORE_TRACE("Window ResizedEvent");
+
+		// Render targets are recreated at the new size
+		ZN_ALLOW_ALLOC_SCOPE();
 		m_camera.SetViewportSize(e.Width, e.Height);
+		m_renderer.SetViewportSize(e.Width, e.Height);
 		return true;
 	}
 
+	void Application::BuildFrameGraph()
+	{
+		// Frame N is simulated, culled and packed on the workers while the main thread submits
+		// frame N - 1, whose render packet is already complete. GLFW and GL stay on the main thread
+		const TaskId input = m_frameGraph.AddTask("Input", TaskAffinity::MainThread, [this]()
+		{
+			m_window.PollEvents();
+			m_inputSystem.Update();
+		});
+
+		// The fixed steps Run decided on for this frame. Camera movement is one of them, so it
+		// needs this frame's input
+		const TaskId simulation = m_frameGraph.AddTask("Simulation", TaskAffinity::Any, [this]()
+		{
+			const Time::TimePoint start = Time::GetCurrentTime();
+
+			for (u32 step = 0; step < m_pendingFixedUpdates; ++step)
+			{
+				FixedUpdate();
+			}
+
+			ZN_STAT_SET("Frame/Fixed updates", m_pendingFixedUpdates);
+			ZN_STAT_SET("Frame/Fixed update ms", Time::Duration(Time::GetCurrentTime() - start).count() * 1000.0);
+		}, { input });
+
+		const TaskId culling = m_frameGraph.AddTask("Culling", TaskAffinity::Any, [this]()
+		{
+			m_renderCamera = m_camera;
+			m_renderCamera.SetPosition(glm::mix(m_previousCameraPosition, m_camera.GetPosition(), static_cast<f32>(m_interpolationAlpha)));
+
+			m_renderer.BeginCulling(m_renderCamera);
+		}, { simulation });
+
+		m_frameGraph.AddTask("RenderPacket", TaskAffinity::Any, [this]()
+		{
+			m_renderer.BuildRenderPacket(m_renderCamera, m_frameIndex, static_cast<f32>(m_interpolationAlpha));
+		}, { culling });
+
+		// No dependencies: it only reads the previous frame's packet
+		m_frameGraph.AddTask("Submit", TaskAffinity::MainThread, [this]()
+		{
+			if (m_frameIndex == 0)
+				return;
+
+			const Time::TimePoint start = Time::GetCurrentTime();
+
+			m_renderer.Render(m_frameIndex - 1);
+
+			m_window.RenderImGUI([this]()
+			{
+				m_renderer.OnImGui();
+				m_frameGraph.OnImGui();
+				Profiler::OnImGui();
+				StatsRegistry::OnImGui();
+				MemoryTracker::OnImGui();
+				Log::OnImGui();
+			});
+
+			// Present is measured by the frame pacer
+			ZN_STAT_SET("Frame/Render ms", Time::Duration(Time::GetCurrentTime() - start).count() * 1000.0);
+
+			m_window.SwapBuffers();
+		});
+	}
+
 	void Application::ProcessInput(f64 deltaTime)
 	{
 		if (m_inputSystem.GetKeyState(KeyCode::W))
@@ -9,12 +9,43 @@
 #include "Input/InputSystem.hpp"
 #include "Platform/Window.hpp"
 #include "Renderer/Renderer.hpp"
+#include "TaskGraph.hpp"
+#include "Timer.hpp"
+
+#include <atomic>
 
 namespace zn
 {
+	struct ApplicationConfig
+	{
+		String Name = "Zenon";
+		u32 WindowWidth = 1280;
+		u32 WindowHeight = 720;
+
+		// No window, GL context, ImGui or renderer: just the engine core ticking the fixed update.
+		// For simulation servers, replay processing and batch jobs on machines without a display
+		b8 Headless = false;
+
+		// Headless only. Paces ticks to the fixed update rate instead of running them back to back
+		b8 ThrottleToFixedRate = false;
+		// Headless only. Run returns after this many ticks, 0 to run until RequestExit
+		u64 MaxTicks = 0;
+		// Headless only. Streams the per tick stats to this CSV file when set
+		String StatsCsvPath;
+	};
+
 	class Application : public EnableSharedFromThis<Application>
 	{
 	public:
+		// Runs once per fixed step, after the engine's own simulation step. Windowed, it's called from
+		// the frame graph's Simulation task on a worker thread; headless, on the main thread
+		using FixedUpdateFn = Func<void(f64 fixedDelta)>;
+
+		static constexpr f64 DEFAULT_FIXED_UPDATE_RATE = 60.0;
+		static constexpr u32 DEFAULT_MAX_UPDATES_PER_FRAME = 5;
+		// Longest frame fed into the accumulator, so a stall (breakpoint, window drag) isn't simulated
+		static constexpr f64 MAX_FRAME_TIME = 0.25;
+
 		Application() = default;
 		~Application();
 		
@@ -25,9 +56,24 @@ namespace zn
 		Application& operator=(Application&& other) noexcept = delete;
 		
 		b8 Init(const String& appName, u32 windowWidth, u32 windowHeight);
+		b8 Init(const ApplicationConfig& config);
 		void Run();
 		void Shutdown();
 
+		// Makes Run return after the current frame or tick. Safe from any thread
+		void RequestExit() { m_exitRequested.store(true, std::memory_order_relaxed); }
+		[[nodiscard]] b8 IsHeadless() const { return m_headless; }
+
+		// Simulation steps per second
+		void SetFixedUpdateRate(f64 updatesPerSecond);
+		// Steps beyond this are dropped instead of piling up when a frame runs long (spiral of death)
+		void SetMaxUpdatesPerFrame(u32 maxUpdates);
+		void SetFixedUpdateCallback(FixedUpdateFn callback) { m_fixedUpdateCallback = std::move(callback); }
+
+		[[nodiscard]] f64 GetFixedDelta() const { return m_fixedDelta; }
+		// How far the rendered frame is between the last two simulation steps, in [0, 1)
+		[[nodiscard]] f64 GetInterpolationAlpha() const { return m_interpolationAlpha; }
+
 		b8 OnKeyPressed(const KeyPressedEvent& e);
 		b8 OnCursosMoved(const CursorMovedEvent& e);
 		b8 OnScrollChanged(const ScrollChangedEvent& e);
@@ -36,6 +82,11 @@ namespace zn
 
 	private:
 		void ProcessInput(f64 deltaTime);
+		void BuildFrameGraph();
+		void RunWindowed();
+		void RunHeadless();
+		void AdvanceClock();
+		void FixedUpdate();
 
 	private:
 		Window m_window{};
@@ -43,6 +94,21 @@ namespace zn
 		Renderer m_renderer{};
 		
 		Camera m_camera;
+		// m_camera with its position interpolated between the last two steps; what gets culled and drawn
+		Camera m_renderCamera;
+		math::v3 m_previousCameraPosition{0.0f};
+
+		// One Execute per frame. Submitting frame N to GL overlaps with simulating frame N + 1
+		TaskGraph m_frameGraph;
+		u64 m_frameIndex = 0;
+		Time::TimePoint m_previousFrameTime{};
+
+		f64 m_fixedDelta = 1.0 / DEFAULT_FIXED_UPDATE_RATE;
+		u32 m_maxUpdatesPerFrame = DEFAULT_MAX_UPDATES_PER_FRAME;
+		f64 m_accumulator = 0.0;
+		f64 m_interpolationAlpha = 0.0;
+		u32 m_pendingFixedUpdates = 0;
+		FixedUpdateFn m_fixedUpdateCallback;
 
 		EventConnection<KeyPressedEvent> m_keyPressedConnection;
 		EventConnection<CursorMovedEvent> m_cursorMovedConnection;
@@ -50,6 +116,12 @@ namespace zn
 		EventConnection<WindowClosedEvent> m_windowClosedConnection;
 		EventConnection<WindowResizedEvent> m_windowResizedConnection;
 
+		b8 m_headless = false;
+		b8 m_throttleToFixedRate = false;
+		u64 m_maxTicks = 0;
+		String m_statsCsvPath;
+		std::atomic<b8> m_exitRequested{false};
+
 		b8 m_initialized = false;
 	};
 }
\ No newline at end of file
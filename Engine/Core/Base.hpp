@@ -28,6 +28,9 @@
 
 #define ZN_STRINGIFY_MACRO(x) #x
 
+#define ZN_CONCAT_MACRO_IMPL(a, b) a##b
+#define ZN_CONCAT_MACRO(a, b) ZN_CONCAT_MACRO_IMPL(a, b)
+
 namespace zn
 {
 	//-----------------------------------------------------------------------------
@@ -0,0 +1,163 @@
+#include "BinaryLogSink.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+
+#pragma warning(push, 0)
+#include "spdlog/details/os.h"
+#pragma warning(pop)
+
+namespace zn
+{
+	namespace
+	{
+		constexpr Array<c8, 8> FILE_MAGIC = { 'Z', 'N', 'L', 'O', 'G', 'B', 'I', 'N' };
+		constexpr u32 FILE_VERSION = 1;
+
+		struct RecordHeader
+		{
+			i64 TimeNs;
+			u64 Thread;
+			u32 MessageSize;
+			u8 Level;
+			u8 Padding[3];
+		};
+
+		static_assert(sizeof(RecordHeader) == 24);
+
+		String GetRotatedPath(const String& path, u32 index)
+		{
+			return index == 0 ? path : path + "." + std::to_string(index);
+		}
+	}
+
+	BinaryLogSink::BinaryLogSink(String path, uSize maxFileBytes, u32 fileCount)
+		: m_path(std::move(path))
+		, m_maxFileBytes(maxFileBytes)
+		, m_fileCount(std::max(fileCount, 1u))
+	{
+		Rotate();
+	}
+
+	BinaryLogSink::~BinaryLogSink()
+	{
+		if (m_file)
+		{
+			std::fclose(m_file);
+		}
+	}
+
+	void BinaryLogSink::sink_it_(const spdlog::details::log_msg& message)
+	{
+		if (!m_file)
+			return;
+
+		RecordHeader header{};
+		header.TimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(message.time.time_since_epoch()).count();
+		header.Thread = message.thread_id;
+		header.MessageSize = static_cast<u32>(message.payload.size());
+		header.Level = static_cast<u8>(message.level);
+
+		const uSize recordSize = sizeof(RecordHeader) + header.MessageSize;
+		if (m_fileBytes + recordSize > m_maxFileBytes && m_fileBytes > sizeof(FILE_MAGIC) + sizeof(FILE_VERSION))
+		{
+			Rotate();
+			if (!m_file)
+				return;
+		}
+
+		std::fwrite(&header, sizeof(RecordHeader), 1, m_file);
+		std::fwrite(message.payload.data(), 1, header.MessageSize, m_file);
+		m_fileBytes += recordSize;
+	}
+
+	void BinaryLogSink::flush_()
+	{
+		if (m_file)
+		{
+			std::fflush(m_file);
+		}
+	}
+
+	void BinaryLogSink::Open()
+	{
+		m_file = std::fopen(m_path.c_str(), "wb");
+		m_fileBytes = 0;
+
+		if (!m_file)
+			return;
+
+		std::fwrite(FILE_MAGIC.data(), 1, FILE_MAGIC.size(), m_file);
+		std::fwrite(&FILE_VERSION, sizeof(FILE_VERSION), 1, m_file);
+		m_fileBytes = FILE_MAGIC.size() + sizeof(FILE_VERSION);
+	}
+
+	void BinaryLogSink::Rotate()
+	{
+		if (m_file)
+		{
+			std::fclose(m_file);
+			m_file = nullptr;
+		}
+
+		// Oldest file falls off the end
+		std::error_code error;
+		std::filesystem::remove(GetRotatedPath(m_path, m_fileCount - 1), error);
+		for (u32 index = m_fileCount - 1; index > 0; --index)
+		{
+			std::filesystem::rename(GetRotatedPath(m_path, index - 1), GetRotatedPath(m_path, index), error);
+		}
+
+		Open();
+	}
+
+	b8 BinaryLogSink::ConvertToText(const String& binaryPath, const String& textPath)
+	{
+		std::FILE* input = std::fopen(binaryPath.c_str(), "rb");
+		if (!input)
+			return false;
+
+		Array<c8, 8> magic{};
+		u32 version = 0;
+		if (std::fread(magic.data(), 1, magic.size(), input) != magic.size() || magic != FILE_MAGIC ||
+			std::fread(&version, sizeof(version), 1, input) != 1 || version != FILE_VERSION)
+		{
+			std::fclose(input);
+			return false;
+		}
+
+		std::FILE* output = std::fopen(textPath.c_str(), "w");
+		if (!output)
+		{
+			std::fclose(input);
+			return false;
+		}
+
+		String message;
+		RecordHeader header{};
+		while (std::fread(&header, sizeof(RecordHeader), 1, input) == 1)
+		{
+			message.resize(header.MessageSize);
+			if (std::fread(message.data(), 1, header.MessageSize, input) != header.MessageSize)
+				break; // Truncated by a crash, keep what was read
+
+			const auto time = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(header.TimeNs)));
+			const std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+			const i64 micros = (header.TimeNs / 1000) % 1000000;
+
+			std::tm local = spdlog::details::os::localtime(seconds);
+			c8 stamp[32];
+			std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+
+			const spdlog::string_view_t level = spdlog::level::to_string_view(static_cast<spdlog::level::level_enum>(header.Level));
+			std::fprintf(output, "[%s.%06lld] [%.*s] [%llu] %s\n", stamp, static_cast<long long>(micros),
+				static_cast<int>(level.size()), level.data(), static_cast<unsigned long long>(header.Thread), message.c_str());
+		}
+
+		std::fclose(input);
+		std::fclose(output);
+		return true;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+#include <cstdio>
+#include <mutex>
+
+#pragma warning(push, 0)
+#include "spdlog/sinks/base_sink.h"
+#pragma warning(pop)
+
+namespace zn
+{
+	// Writes log messages as length prefixed binary records instead of text: no pattern formatting,
+	// no timestamp printing, just a memcpy into the file buffer. Files are rotated by size, keeping
+	// path, path.1 ... path.(count - 1), newest first. ConvertToText turns a file back into text.
+	class BinaryLogSink final : public spdlog::sinks::base_sink<std::mutex>
+	{
+	public:
+		BinaryLogSink(String path, uSize maxFileBytes, u32 fileCount);
+		~BinaryLogSink() override;
+
+		BinaryLogSink(const BinaryLogSink& other) = delete;
+		BinaryLogSink(BinaryLogSink&& other) noexcept = delete;
+
+		BinaryLogSink& operator=(const BinaryLogSink& other) = delete;
+		BinaryLogSink& operator=(BinaryLogSink&& other) noexcept = delete;
+
+		[[nodiscard]] b8 IsOpen() const { return m_file != nullptr; }
+
+		static b8 ConvertToText(const String& binaryPath, const String& textPath);
+
+	protected:
+		void sink_it_(const spdlog::details::log_msg& message) override;
+		void flush_() override;
+
+	private:
+		void Open();
+		void Rotate();
+
+		String m_path;
+		uSize m_maxFileBytes;
+		u32 m_fileCount;
+
+		std::FILE* m_file = nullptr;
+		uSize m_fileBytes = 0;
+	};
+}
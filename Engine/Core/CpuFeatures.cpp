@@ -0,0 +1,200 @@
+#include "CpuFeatures.hpp"
+
+#include "Core/Log.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+#if defined(ZN_CPU_X86) && defined(_MSC_VER) && !defined(__clang__)
+	#include <intrin.h>
+	#include <immintrin.h>
+#endif
+
+namespace zn
+{
+	namespace
+	{
+		CpuFeatureSet DetectFeatures()
+		{
+			CpuFeatureSet features;
+
+#if defined(ZN_CPU_X86)
+	#if defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+			__cpuid(info, 0);
+			const int maxLeaf = info[0];
+
+			__cpuid(info, 1);
+			features.SSE2 = (info[3] & (1 << 26)) != 0;
+			features.SSE41 = (info[2] & (1 << 19)) != 0;
+			features.SSE42 = (info[2] & (1 << 20)) != 0;
+			features.POPCNT = (info[2] & (1 << 23)) != 0;
+
+			// AVX state has to be enabled by the OS too, not just reported by the CPU
+			const b8 osxsave = (info[2] & (1 << 27)) != 0;
+			const u64 xcr0 = osxsave ? _xgetbv(0) : 0;
+			const b8 osAVX = (xcr0 & 0x6) == 0x6;
+			const b8 osAVX512 = (xcr0 & 0xE6) == 0xE6;
+
+			features.AVX = osAVX && (info[2] & (1 << 28)) != 0;
+			features.FMA = osAVX && (info[2] & (1 << 12)) != 0;
+
+			if (maxLeaf >= 7)
+			{
+				__cpuidex(info, 7, 0);
+				features.AVX2 = osAVX && (info[1] & (1 << 5)) != 0;
+				features.AVX512F = osAVX512 && (info[1] & (1 << 16)) != 0;
+				features.AVX512BW = osAVX512 && (info[1] & (1 << 30)) != 0;
+				features.AVX512VL = osAVX512 && (info[1] & (1u << 31)) != 0;
+			}
+	#else
+			// Also checks the OS saves the extended register state
+			__builtin_cpu_init();
+			features.SSE2 = __builtin_cpu_supports("sse2");
+			features.SSE41 = __builtin_cpu_supports("sse4.1");
+			features.SSE42 = __builtin_cpu_supports("sse4.2");
+			features.POPCNT = __builtin_cpu_supports("popcnt");
+			features.AVX = __builtin_cpu_supports("avx");
+			features.AVX2 = __builtin_cpu_supports("avx2");
+			features.FMA = __builtin_cpu_supports("fma");
+			features.AVX512F = __builtin_cpu_supports("avx512f");
+			features.AVX512BW = __builtin_cpu_supports("avx512bw");
+			features.AVX512VL = __builtin_cpu_supports("avx512vl");
+	#endif
+#endif
+
+			return features;
+		}
+
+		CpuIsa SelectIsa(const CpuFeatureSet& features)
+		{
+			if (features.AVX512F && features.AVX512BW && features.AVX512VL && features.AVX2 && features.FMA)
+				return CpuIsa::AVX512;
+
+			if (features.AVX2 && features.FMA)
+				return CpuIsa::AVX2;
+
+			if (features.SSE42)
+				return CpuIsa::SSE42;
+
+			return CpuIsa::Scalar;
+		}
+
+		String DescribeFeatures(const CpuFeatureSet& features)
+		{
+			String description;
+			auto append = [&description](b8 supported, const c8* name)
+			{
+				if (!supported)
+					return;
+
+				if (!description.empty())
+					description += ' ';
+
+				description += name;
+			};
+
+			append(features.SSE2, "SSE2");
+			append(features.SSE41, "SSE4.1");
+			append(features.SSE42, "SSE4.2");
+			append(features.POPCNT, "POPCNT");
+			append(features.AVX, "AVX");
+			append(features.AVX2, "AVX2");
+			append(features.FMA, "FMA");
+			append(features.AVX512F, "AVX512F");
+			append(features.AVX512BW, "AVX512BW");
+			append(features.AVX512VL, "AVX512VL");
+
+			return description.empty() ? String("none") : description;
+		}
+	}
+
+	void CpuFeatures::Init()
+	{
+		if (const c8* forced = std::getenv("ZN_FORCE_ISA"))
+		{
+			if (auto isa = ParseIsa(forced))
+			{
+				ForceIsa(isa.value());
+			}
+			else
+			{
+				ZN_CORE_WARN("[CpuFeatures::Init] Unknown ZN_FORCE_ISA value '{}'. Expected scalar, sse4.2, avx2 or avx512", forced);
+			}
+		}
+
+		ZN_CORE_INFO("[CpuFeatures::Init] CPU features: {}", DescribeFeatures(GetFeatures()));
+		ZN_CORE_INFO("[CpuFeatures::Init] Kernels dispatch to {} (detected {})", GetIsaName(GetIsa()), GetIsaName(GetDetectedIsa()));
+	}
+
+	const CpuFeatureSet& CpuFeatures::GetFeatures()
+	{
+		// Function local so kernels used during static initialization still see the right features
+		static const CpuFeatureSet features = DetectFeatures();
+		return features;
+	}
+
+	CpuIsa CpuFeatures::GetDetectedIsa()
+	{
+		static const CpuIsa detectedIsa = SelectIsa(GetFeatures());
+		return detectedIsa;
+	}
+
+	CpuIsa CpuFeatures::GetIsa()
+	{
+		return GetActiveIsa().load(std::memory_order_relaxed);
+	}
+
+	void CpuFeatures::ForceIsa(CpuIsa isa)
+	{
+		if (isa > GetDetectedIsa())
+		{
+			ZN_CORE_WARN("[CpuFeatures::ForceIsa] {} is not supported by this CPU, using {}", GetIsaName(isa), GetIsaName(GetDetectedIsa()));
+			isa = GetDetectedIsa();
+		}
+
+		GetActiveIsa().store(isa, std::memory_order_relaxed);
+	}
+
+	void CpuFeatures::ResetIsa()
+	{
+		GetActiveIsa().store(GetDetectedIsa(), std::memory_order_relaxed);
+	}
+
+	const c8* CpuFeatures::GetIsaName(CpuIsa isa)
+	{
+		switch (isa)
+		{
+			case CpuIsa::Scalar: return "Scalar";
+			case CpuIsa::SSE42:  return "SSE4.2";
+			case CpuIsa::AVX2:   return "AVX2";
+			case CpuIsa::AVX512: return "AVX-512";
+		}
+
+		return "Unknown";
+	}
+
+	Opt<CpuIsa> CpuFeatures::ParseIsa(StringView name)
+	{
+		String lower(name);
+		std::transform(lower.begin(), lower.end(), lower.begin(), [](c8 c) { return static_cast<c8>(std::tolower(static_cast<unsigned char>(c))); });
+
+		if (lower == "scalar")
+			return CpuIsa::Scalar;
+		if (lower == "sse4.2" || lower == "sse42")
+			return CpuIsa::SSE42;
+		if (lower == "avx2")
+			return CpuIsa::AVX2;
+		if (lower == "avx512" || lower == "avx-512")
+			return CpuIsa::AVX512;
+
+		return std::nullopt;
+	}
+
+	std::atomic<CpuIsa>& CpuFeatures::GetActiveIsa()
+	{
+		static std::atomic<CpuIsa> activeIsa{ GetDetectedIsa() };
+		return activeIsa;
+	}
+}
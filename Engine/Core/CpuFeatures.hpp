@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+#include <atomic>
+
+// Kernels that ship ISA specific variants include <immintrin.h> when ZN_CPU_X86 is defined, and tag
+// each variant with the matching ZN_TARGET_* so the rest of the binary keeps the baseline ISA
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define ZN_CPU_X86
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#define ZN_TARGET_SSE42
+		#define ZN_TARGET_AVX2
+		#define ZN_TARGET_AVX512
+	#else
+		#define ZN_TARGET_SSE42  __attribute__((target("sse4.2")))
+		#define ZN_TARGET_AVX2   __attribute__((target("avx2,fma")))
+		#define ZN_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx2,fma")))
+	#endif
+	#define ZN_ISA_VARIANT(function) function
+#else
+	#define ZN_ISA_VARIANT(function) nullptr
+#endif
+
+namespace zn
+{
+	// Instruction set tiers kernels are written against. Each tier implies the ones below it
+	enum class CpuIsa : u8
+	{
+		Scalar,
+		SSE42,
+		AVX2,   // AVX2 + FMA
+		AVX512, // AVX-512 F/BW/VL
+	};
+
+	struct CpuFeatureSet
+	{
+		b8 SSE2 = false;
+		b8 SSE41 = false;
+		b8 SSE42 = false;
+		b8 POPCNT = false;
+		b8 AVX = false;
+		b8 AVX2 = false;
+		b8 FMA = false;
+		b8 AVX512F = false;
+		b8 AVX512BW = false;
+		b8 AVX512VL = false;
+	};
+
+	// Detects the CPU features once and decides which ISA tier the vectorized kernels use.
+	// The tier can be lowered for testing and benchmarking, either with ForceIsa or by setting the
+	// ZN_FORCE_ISA environment variable (scalar, sse4.2, avx2, avx512) before Init runs.
+	class CpuFeatures
+	{
+	public:
+		CpuFeatures() = delete;
+
+		// Applies the ZN_FORCE_ISA override and logs the features and the selected tier
+		static void Init();
+
+		[[nodiscard]] static const CpuFeatureSet& GetFeatures();
+		// Best tier the CPU and OS support
+		[[nodiscard]] static CpuIsa GetDetectedIsa();
+		// Tier kernels dispatch to. Never above the detected one
+		[[nodiscard]] static CpuIsa GetIsa();
+		[[nodiscard]] static b8 Supports(CpuIsa isa) { return isa <= GetIsa(); }
+
+		// Tiers above the detected one are clamped. ResetIsa goes back to the detected tier
+		static void ForceIsa(CpuIsa isa);
+		static void ResetIsa();
+
+		[[nodiscard]] static const c8* GetIsaName(CpuIsa isa);
+		[[nodiscard]] static Opt<CpuIsa> ParseIsa(StringView name);
+
+	private:
+		// Changed from the main thread (ImGui, ForceIsa) while jobs dispatch kernels on the workers
+		static std::atomic<CpuIsa>& GetActiveIsa();
+	};
+
+	// ISA variants of one kernel, selected at call time from CpuFeatures::GetIsa(). Only Scalar is
+	// required; missing variants fall through to the next lower tier. Wrap x86 only variants in
+	// ZN_ISA_VARIANT so the table still compiles on other architectures.
+	template<typename Fn>
+	struct IsaDispatch
+	{
+		Fn Scalar = nullptr;
+		Fn SSE42 = nullptr;
+		Fn AVX2 = nullptr;
+		Fn AVX512 = nullptr;
+
+		[[nodiscard]] Fn Get(CpuIsa isa) const
+		{
+			switch (isa)
+			{
+				case CpuIsa::Scalar: return Scalar;
+				case CpuIsa::SSE42:  return SSE42;
+				case CpuIsa::AVX2:   return AVX2;
+				case CpuIsa::AVX512: return AVX512;
+			}
+
+			return nullptr;
+		}
+
+		// Tier of the variant Select would return
+		[[nodiscard]] CpuIsa SelectIsa() const
+		{
+			CpuIsa isa = CpuFeatures::GetIsa();
+			while (isa != CpuIsa::Scalar && !Get(isa))
+			{
+				isa = static_cast<CpuIsa>(static_cast<u8>(isa) - 1);
+			}
+
+			return isa;
+		}
+
+		[[nodiscard]] Fn Select() const { return Get(SelectIsa()); }
+	};
+}
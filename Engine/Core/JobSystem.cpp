@@ -0,0 +1,574 @@
+#include "JobSystem.hpp"
+
+#include "Core/Assert.hpp"
+#include "Core/Log.hpp"
+#include "Core/Profiler.hpp"
+#include "Core/StatsRegistry.hpp"
+#include "Core/WorkStealingDeque.hpp"
+#include "Memory/MemoryTracker.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace zn
+{
+	struct Job
+	{
+		JobSystem::JobFn Function;
+		JobCounter* Counter = nullptr;
+		// Allocations made by the job are charged to the tag of whoever started it
+		MemoryTag Tag = MemoryTag::Untagged;
+
+		// Pool jobs are handed back by whichever thread ran them; heap jobs are deleted
+		b8 Pooled = false;
+		std::atomic<b8> InUse{false};
+	};
+
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		constexpr u32 INVALID_WORKER = JobSystem::INVALID_WORKER;
+		constexpr u32 SPINS_BEFORE_SLEEP = 64;
+		// Slots tried before giving up on the pool. Jobs mostly finish in the order they were started,
+		// so the slot at the cursor is almost always free
+		constexpr u32 MAX_POOL_PROBES = 8;
+
+		static_assert(std::has_single_bit(JobSystem::JOB_POOL_SIZE));
+
+		// Only the owning thread acquires, any thread releases
+		class JobPool
+		{
+		public:
+			JobPool()
+				: m_jobs(new Job[JobSystem::JOB_POOL_SIZE])
+			{
+				for (u32 i = 0; i < JobSystem::JOB_POOL_SIZE; ++i)
+				{
+					m_jobs[i].Pooled = true;
+				}
+			}
+
+			Job* Acquire()
+			{
+				for (u32 probe = 0; probe < MAX_POOL_PROBES; ++probe)
+				{
+					Job& job = m_jobs[m_cursor++ & (JobSystem::JOB_POOL_SIZE - 1)];
+					if (!job.InUse.load(std::memory_order_acquire))
+					{
+						job.InUse.store(true, std::memory_order_relaxed);
+						return &job;
+					}
+				}
+
+				return nullptr;
+			}
+
+		private:
+			UniquePtr<Job[]> m_jobs;
+			u32 m_cursor = 0;
+		};
+
+		struct Worker
+		{
+			WorkStealingDeque<Job> Queue{ JobSystem::QUEUE_CAPACITY };
+			JobPool Jobs;
+			std::thread Thread;
+
+			std::atomic<u64> BusyNs{0};
+			std::atomic<u32> JobsExecuted{0};
+			std::atomic<u32> JobsStolen{0};
+
+			// Totals at the previous UpdateStats
+			u64 SampledBusyNs = 0;
+			u32 SampledJobs = 0;
+			u32 SampledSteals = 0;
+		};
+
+		struct DeferredJob
+		{
+			const JobCounter* Dependency;
+			Job* Pending;
+		};
+
+		Vector<UniquePtr<Worker>> s_workers;
+		std::atomic<b8> s_running{false};
+
+		// Jobs started from threads that aren't workers
+		std::mutex s_sharedQueueMutex;
+		Vector<Job*> s_sharedQueue;
+		std::atomic<u32> s_sharedQueueSize{0};
+
+		// Created on first use, most runs only start jobs from workers
+		std::mutex s_sharedPoolMutex;
+		UniquePtr<JobPool> s_sharedPool;
+
+		// Jobs waiting for a dependency. The counter is only used as a key, so it may go away right
+		// after reaching zero
+		std::mutex s_deferredMutex;
+		Vector<DeferredJob> s_deferredJobs;
+		std::atomic<u32> s_deferredCount{0};
+
+		std::mutex s_sleepMutex;
+		std::condition_variable s_wakeCondition;
+		std::atomic<u32> s_sleepingWorkers{0};
+
+		Vector<JobSystem::WorkerStats> s_stats;
+		Clock::time_point s_lastStatsSample;
+
+		thread_local u32 t_workerIndex = INVALID_WORKER;
+		thread_local u32 t_stealSeed = 0;
+
+		Job* AllocateJob(JobSystem::JobFn&& function, JobCounter& counter)
+		{
+			const u32 worker = t_workerIndex;
+
+			Job* job = nullptr;
+			if (worker != INVALID_WORKER)
+			{
+				job = s_workers[worker]->Jobs.Acquire();
+			}
+			else
+			{
+				std::lock_guard lock(s_sharedPoolMutex);
+				if (!s_sharedPool)
+				{
+					s_sharedPool = CreateUnique<JobPool>();
+				}
+
+				job = s_sharedPool->Acquire();
+			}
+
+			if (job == nullptr)
+			{
+				ZN_STAT_ADD("Jobs/Heap allocated", 1);
+				job = new Job();
+			}
+
+			job->Function = std::move(function);
+			job->Counter = &counter;
+			job->Tag = MemoryTracker::GetCurrentTag();
+
+			return job;
+		}
+
+		void FreeJob(Job* job)
+		{
+			// Captures are released now rather than when the slot is reused
+			job->Function.Reset();
+
+			if (job->Pooled)
+			{
+				job->InUse.store(false, std::memory_order_release);
+			}
+			else
+			{
+				delete job;
+			}
+		}
+
+		b8 HasQueuedJobs()
+		{
+			if (s_sharedQueueSize.load(std::memory_order_relaxed) > 0)
+				return true;
+
+			return std::any_of(s_workers.begin(), s_workers.end(), [](const UniquePtr<Worker>& worker) { return !worker->Queue.IsEmpty(); });
+		}
+
+		void WakeWorker()
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (s_sleepingWorkers.load(std::memory_order_relaxed) == 0)
+				return;
+
+			// A worker holds the lock from its last look at the queues until it waits, so once we get
+			// the lock it is either waiting or will see the new job
+			{
+				std::lock_guard lock(s_sleepMutex);
+			}
+			s_wakeCondition.notify_one();
+		}
+
+		Job* FindJob(u32 worker)
+		{
+			if (worker != INVALID_WORKER)
+			{
+				if (Job* job = s_workers[worker]->Queue.Pop())
+					return job;
+			}
+
+			if (s_sharedQueueSize.load(std::memory_order_relaxed) > 0)
+			{
+				std::lock_guard lock(s_sharedQueueMutex);
+				if (!s_sharedQueue.empty())
+				{
+					Job* job = s_sharedQueue.back();
+					s_sharedQueue.pop_back();
+					s_sharedQueueSize.fetch_sub(1, std::memory_order_relaxed);
+					return job;
+				}
+			}
+
+			// Start at a random victim so thieves don't all line up on the same worker
+			const u32 workerCount = static_cast<u32>(s_workers.size());
+			t_stealSeed = t_stealSeed * 1664525u + 1013904223u;
+			const u32 first = (t_stealSeed >> 16) % workerCount;
+
+			for (u32 i = 0; i < workerCount; ++i)
+			{
+				const u32 victim = (first + i) % workerCount;
+				if (victim == worker)
+					continue;
+
+				if (Job* job = s_workers[victim]->Queue.Steal())
+				{
+					if (worker != INVALID_WORKER)
+					{
+						s_workers[worker]->JobsStolen.fetch_add(1, std::memory_order_relaxed);
+					}
+
+					return job;
+				}
+			}
+
+			return nullptr;
+		}
+	}
+
+	void JobSystem::Init(u32 workerCount)
+	{
+		ZN_ASSERT(!IsInitialized(), "JobSystem::Init called twice");
+
+		const u32 threadCount = workerCount > 0 ? workerCount : std::max(1u, std::thread::hardware_concurrency());
+
+		s_workers.clear();
+		for (u32 i = 0; i < threadCount; ++i)
+		{
+			s_workers.push_back(CreateUnique<Worker>());
+		}
+
+		s_stats.assign(threadCount, WorkerStats{});
+		s_lastStatsSample = Clock::now();
+
+		s_running.store(true, std::memory_order_release);
+
+		// The calling thread is worker 0, it runs jobs from Wait and ParallelFor
+		t_workerIndex = 0;
+		for (u32 i = 1; i < threadCount; ++i)
+		{
+			s_workers[i]->Thread = std::thread(&JobSystem::WorkerMain, i);
+		}
+
+		ZN_LOG_INFO(Jobs, "[JobSystem::Init] Started {} worker threads plus the main thread", threadCount - 1);
+	}
+
+	void JobSystem::Shutdown()
+	{
+		if (!IsInitialized())
+			return;
+
+		// Whatever is still queued runs before the workers go away
+		while (Job* job = FindJob(t_workerIndex))
+		{
+			Execute(job, t_workerIndex);
+		}
+
+		{
+			std::lock_guard lock(s_sleepMutex);
+			s_running.store(false, std::memory_order_release);
+		}
+		s_wakeCondition.notify_all();
+
+		for (const UniquePtr<Worker>& worker : s_workers)
+		{
+			if (worker->Thread.joinable())
+			{
+				worker->Thread.join();
+			}
+		}
+
+		ZN_ASSERT(s_deferredJobs.empty(), "JobSystem shut down with jobs still waiting for a dependency");
+
+		s_workers.clear();
+		s_sharedPool.reset();
+		s_stats.clear();
+		t_workerIndex = INVALID_WORKER;
+	}
+
+	b8 JobSystem::IsInitialized()
+	{
+		return s_running.load(std::memory_order_acquire);
+	}
+
+	u32 JobSystem::GetThreadCount()
+	{
+		return IsInitialized() ? static_cast<u32>(s_workers.size()) : 1;
+	}
+
+	void JobSystem::Run(JobFn job, JobCounter& counter)
+	{
+		if (!IsInitialized())
+		{
+			job();
+			return;
+		}
+
+		counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+		Submit(AllocateJob(std::move(job), counter));
+	}
+
+	void JobSystem::Run(JobFn job, JobCounter& counter, const JobCounter& dependency)
+	{
+		if (!IsInitialized())
+		{
+			job();
+			return;
+		}
+
+		counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+		Job* pending = AllocateJob(std::move(job), counter);
+
+		{
+			std::lock_guard lock(s_deferredMutex);
+
+			// Announced before checking the dependency; the job finishing it checks the count after
+			// reaching zero, so one of the two always sees the other
+			s_deferredCount.fetch_add(1, std::memory_order_seq_cst);
+			if (!dependency.IsDone())
+			{
+				s_deferredJobs.push_back({ &dependency, pending });
+				return;
+			}
+
+			s_deferredCount.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		Submit(pending);
+	}
+
+	void JobSystem::Wait(const JobCounter& counter)
+	{
+		while (!counter.IsDone())
+		{
+			if (!RunPendingJob())
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	b8 JobSystem::RunPendingJob()
+	{
+		if (!IsInitialized())
+			return false;
+
+		const u32 worker = t_workerIndex;
+		if (Job* job = FindJob(worker))
+		{
+			Execute(job, worker);
+			return true;
+		}
+
+		return false;
+	}
+
+	u32 JobSystem::GetWorkerIndex()
+	{
+		return t_workerIndex;
+	}
+
+	void JobSystem::ParallelFor(u32 count, u32 minChunk, const Func<void(u32 begin, u32 end)>& body)
+	{
+		if (count == 0)
+			return;
+
+		minChunk = std::max(minChunk, 1u);
+
+		const u32 threadCount = GetThreadCount();
+		const u32 taskCount = std::min(threadCount, (count + minChunk - 1) / minChunk);
+
+		if (taskCount <= 1)
+		{
+			body(0, count);
+			return;
+		}
+
+		std::atomic<u32> next{0};
+		auto claimChunks = [&]()
+		{
+			u32 begin = next.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				if (begin >= count)
+					return;
+
+				// Guided scheduling: large chunks while plenty is left, smaller ones near the end
+				const u32 remaining = count - begin;
+				const u32 chunk = std::min(remaining, std::max(minChunk, remaining / (2 * threadCount)));
+
+				if (next.compare_exchange_weak(begin, begin + chunk, std::memory_order_relaxed))
+				{
+					body(begin, begin + chunk);
+					begin = next.load(std::memory_order_relaxed);
+				}
+			}
+		};
+
+		JobCounter counter;
+		for (u32 task = 1; task < taskCount; ++task)
+		{
+			Run(claimChunks, counter);
+		}
+
+		claimChunks();
+		Wait(counter);
+	}
+
+	void JobSystem::UpdateStats()
+	{
+		const Clock::time_point now = Clock::now();
+		const f64 wallNs = static_cast<f64>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - s_lastStatsSample).count());
+		s_lastStatsSample = now;
+
+		for (uSize i = 0; i < s_workers.size(); ++i)
+		{
+			Worker& worker = *s_workers[i];
+
+			const u64 busyNs = worker.BusyNs.load(std::memory_order_relaxed);
+			const u32 jobs = worker.JobsExecuted.load(std::memory_order_relaxed);
+			const u32 steals = worker.JobsStolen.load(std::memory_order_relaxed);
+
+			WorkerStats& stats = s_stats[i];
+			stats.JobsExecuted = jobs - worker.SampledJobs;
+			stats.JobsStolen = steals - worker.SampledSteals;
+			stats.BusyMs = static_cast<f64>(busyNs - worker.SampledBusyNs) / 1e6;
+			stats.Utilization = wallNs > 0.0 ? static_cast<f32>(static_cast<f64>(busyNs - worker.SampledBusyNs) / wallNs) : 0.0f;
+
+			worker.SampledBusyNs = busyNs;
+			worker.SampledJobs = jobs;
+			worker.SampledSteals = steals;
+		}
+	}
+
+	const Vector<JobSystem::WorkerStats>& JobSystem::GetWorkerStats()
+	{
+		return s_stats;
+	}
+
+	void JobSystem::Submit(Job* job)
+	{
+		const u32 worker = t_workerIndex;
+
+		if (worker != INVALID_WORKER)
+		{
+			if (!s_workers[worker]->Queue.Push(job))
+			{
+				// Queue full, running the job right away still makes progress
+				Execute(job, worker);
+				return;
+			}
+		}
+		else
+		{
+			std::lock_guard lock(s_sharedQueueMutex);
+			s_sharedQueue.push_back(job);
+			s_sharedQueueSize.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		WakeWorker();
+	}
+
+	void JobSystem::Execute(Job* job, u32 worker)
+	{
+		const Clock::time_point start = Clock::now();
+
+		{
+			ZN_PROFILE_SCOPE("Job");
+			ZN_STAT_ADD("Jobs/Executed", 1);
+			MemoryTagScope tag(job->Tag);
+			job->Function();
+		}
+
+		if (worker != INVALID_WORKER)
+		{
+			Worker& stats = *s_workers[worker];
+			stats.BusyNs.fetch_add(static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()), std::memory_order_relaxed);
+			stats.JobsExecuted.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		const JobCounter* counter = job->Counter;
+		const b8 finished = job->Counter->m_pending.fetch_sub(1, std::memory_order_seq_cst) == 1;
+		FreeJob(job);
+
+		// From here on the counter may already be destroyed by a waiter, it's only compared as a key
+		if (finished && s_deferredCount.load(std::memory_order_seq_cst) > 0)
+		{
+			ReleaseDeferred(counter);
+		}
+	}
+
+	void JobSystem::ReleaseDeferred(const JobCounter* counter)
+	{
+		Vector<Job*> released;
+
+		{
+			std::lock_guard lock(s_deferredMutex);
+			auto it = std::remove_if(s_deferredJobs.begin(), s_deferredJobs.end(), [&](const DeferredJob& deferred)
+			{
+				if (deferred.Dependency != counter)
+					return false;
+
+				released.push_back(deferred.Pending);
+				return true;
+			});
+
+			s_deferredJobs.erase(it, s_deferredJobs.end());
+			s_deferredCount.fetch_sub(static_cast<u32>(released.size()), std::memory_order_relaxed);
+		}
+
+		for (Job* job : released)
+		{
+			Submit(job);
+		}
+	}
+
+	void JobSystem::WorkerMain(u32 worker)
+	{
+		t_workerIndex = worker;
+		t_stealSeed = worker * 2654435761u;
+		Profiler::SetThreadName("Worker " + std::to_string(worker));
+
+		u32 idleSpins = 0;
+		while (s_running.load(std::memory_order_acquire))
+		{
+			if (Job* job = FindJob(worker))
+			{
+				Execute(job, worker);
+				idleSpins = 0;
+				continue;
+			}
+
+			if (++idleSpins < SPINS_BEFORE_SLEEP)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock lock(s_sleepMutex);
+			s_sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (!HasQueuedJobs() && s_running.load(std::memory_order_acquire))
+			{
+				s_wakeCondition.wait(lock);
+			}
+
+			s_sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+			idleSpins = 0;
+		}
+	}
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace zn
+{
+	struct Job;
+
+	// Number of unfinished jobs started against it. Waiting on a counter waits for all of them, and a
+	// job can be held back until a counter reaches zero, which is how dependencies are expressed.
+	// A counter must outlive the jobs started against it
+	class JobCounter
+	{
+	public:
+		JobCounter() = default;
+		~JobCounter() = default;
+
+		JobCounter(const JobCounter& other) = delete;
+		JobCounter(JobCounter&& other) noexcept = delete;
+
+		JobCounter& operator=(const JobCounter& other) = delete;
+		JobCounter& operator=(JobCounter&& other) noexcept = delete;
+
+		[[nodiscard]] b8 IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+
+		std::atomic<u32> m_pending{0};
+	};
+
+	// void() callable stored inline in the job, so starting a job never touches the heap. Captures
+	// that don't fit are a compile error; capture by reference or keep the state elsewhere
+	class JobFunction
+	{
+	public:
+		static constexpr uSize CAPACITY = 48;
+
+		JobFunction() = default;
+
+		template<typename F>
+			requires (!std::is_same_v<std::decay_t<F>, JobFunction> && std::is_invocable_v<std::decay_t<F>&>)
+		JobFunction(F&& function)
+		{
+			using T = std::decay_t<F>;
+			static_assert(sizeof(T) <= CAPACITY, "Job captures too much state to be stored inline");
+			static_assert(alignof(T) <= alignof(std::max_align_t), "Job callable is over aligned");
+			static_assert(std::is_nothrow_move_constructible_v<T>, "Job callable must be nothrow movable");
+
+			new (m_storage) T(std::forward<F>(function));
+
+			m_invoke = [](void* storage) { (*static_cast<T*>(storage))(); };
+			m_move = [](void* destination, void* source)
+			{
+				new (destination) T(std::move(*static_cast<T*>(source)));
+				static_cast<T*>(source)->~T();
+			};
+			m_destroy = [](void* storage) { static_cast<T*>(storage)->~T(); };
+		}
+
+		~JobFunction() { Reset(); }
+
+		JobFunction(const JobFunction& other) = delete;
+		JobFunction(JobFunction&& other) noexcept { MoveFrom(other); }
+
+		JobFunction& operator=(const JobFunction& other) = delete;
+		JobFunction& operator=(JobFunction&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Reset();
+				MoveFrom(other);
+			}
+
+			return *this;
+		}
+
+		void operator()() { m_invoke(m_storage); }
+		explicit operator b8() const { return m_invoke != nullptr; }
+
+		void Reset()
+		{
+			if (m_destroy)
+			{
+				m_destroy(m_storage);
+			}
+
+			m_invoke = nullptr;
+			m_move = nullptr;
+			m_destroy = nullptr;
+		}
+
+	private:
+		void MoveFrom(JobFunction& other)
+		{
+			if (!other.m_invoke)
+				return;
+
+			other.m_move(m_storage, other.m_storage);
+			m_invoke = other.m_invoke;
+			m_move = other.m_move;
+			m_destroy = other.m_destroy;
+
+			other.m_invoke = nullptr;
+			other.m_move = nullptr;
+			other.m_destroy = nullptr;
+		}
+
+		alignas(std::max_align_t) Byte m_storage[CAPACITY];
+		void (*m_invoke)(void* storage) = nullptr;
+		void (*m_move)(void* destination, void* source) = nullptr;
+		void (*m_destroy)(void* storage) = nullptr;
+	};
+
+	// Work stealing thread pool. Every worker owns a Chase-Lev deque: jobs started from a worker go to
+	// its own deque, idle workers steal from the others. The thread that called Init is worker 0 and
+	// runs jobs while it waits, so waiting never just blocks. Jobs started from threads that aren't
+	// workers go through a shared queue.
+	//
+	// Jobs come from a fixed pool per worker (plus one for the other threads) and are recycled once
+	// they ran; only a pool that's exhausted falls back to the heap.
+	//
+	// Without Init (tools, tests) everything runs inline on the calling thread.
+	class JobSystem
+	{
+	public:
+		using JobFn = JobFunction;
+
+		struct WorkerStats
+		{
+			u32 JobsExecuted = 0;
+			u32 JobsStolen = 0;
+			f64 BusyMs = 0.0;
+			f32 Utilization = 0.0f; // Busy time over wall time of the last UpdateStats interval
+		};
+
+		// Per worker queue size. A worker that fills it runs further jobs inline
+		static constexpr u32 QUEUE_CAPACITY = 4096;
+		// Jobs preallocated per worker, and for the threads that aren't workers
+		static constexpr u32 JOB_POOL_SIZE = QUEUE_CAPACITY;
+		static constexpr u32 INVALID_WORKER = 0xFFFFFFFF;
+
+		JobSystem() = delete;
+
+		// workerCount 0 uses one thread per hardware thread, the calling thread included
+		static void Init(u32 workerCount = 0);
+		static void Shutdown();
+
+		[[nodiscard]] static b8 IsInitialized();
+		// Worker threads plus the main thread
+		[[nodiscard]] static u32 GetThreadCount();
+
+		static void Run(JobFn job, JobCounter& counter);
+		// The job starts once dependency reaches zero. counter covers it from now on
+		static void Run(JobFn job, JobCounter& counter, const JobCounter& dependency);
+
+		// Runs other jobs until counter reaches zero
+		static void Wait(const JobCounter& counter);
+		// Runs one queued job on the calling thread, if there is any. For loops waiting on something
+		// other than a JobCounter
+		static b8 RunPendingJob();
+
+		// 0 on the main thread, INVALID_WORKER on threads that aren't workers
+		[[nodiscard]] static u32 GetWorkerIndex();
+
+		// body(begin, end) over [0, count), split into chunks of at least minChunk. Chunks are claimed
+		// from a shared cursor and shrink as the range runs out, so uneven work still balances.
+		// The calling thread takes part and the call returns when the whole range is done
+		static void ParallelFor(u32 count, u32 minChunk, const Func<void(u32 begin, u32 end)>& body);
+
+		// Samples per worker statistics since the previous call, once per frame
+		static void UpdateStats();
+		[[nodiscard]] static const Vector<WorkerStats>& GetWorkerStats();
+
+	private:
+		static void Submit(Job* job);
+		static void Execute(Job* job, u32 worker);
+		static void ReleaseDeferred(const JobCounter* counter);
+		static void WorkerMain(u32 worker);
+	};
+}
@@ -1,24 +1,398 @@
 #include "Log.hpp"
 
+#include "Core/BinaryLogSink.hpp"
+#include "Memory/MemoryTracker.hpp"
+#include "Memory/MemoryUtils.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <imgui.h>
+
 #pragma warning(push, 0)
 #include "spdlog/sinks/stdout_color_sinks.h"
 #pragma warning(pop)
 
 namespace zn
 {
-	SharedPtr<spdlog::logger> Log::s_coreLogger;
+	namespace
+	{
+		constexpr uSize SLOT_SIZE = 256;
+		constexpr auto IDLE_SLEEP = std::chrono::milliseconds(1);
+
+		// Indexed by spdlog::level::level_enum
+		constexpr Array<const c8*, 7> LEVEL_NAMES = { "Trace", "Debug", "Info", "Warning", "Error", "Critical", "Off" };
+
+		struct RecordHeader
+		{
+			Log::FormatFn Format;
+			const c8* FormatString;
+			u32 FormatSize;
+			u32 PayloadSize;
+			spdlog::log_clock::time_point Time;
+			uSize Thread;
+			spdlog::level::level_enum Level;
+			LogChannel Channel;
+		};
+
+		// Vyukov bounded queue cell: Sequence == position when free, position + 1 once written
+		struct alignas(CACHE_LINE_SIZE) Slot
+		{
+			std::atomic<u64> Sequence{0};
+			RecordHeader Header;
+			Byte Payload[SLOT_SIZE - sizeof(std::atomic<u64>) - sizeof(RecordHeader)];
+		};
+
+		static_assert(sizeof(Slot) == SLOT_SIZE);
+
+		constexpr uSize MAX_PAYLOAD_SIZE = sizeof(Slot::Payload);
+
+		UniquePtr<Slot[]> s_slots;
+		u64 s_mask = 0;
+		LogOverflowPolicy s_overflow = LogOverflowPolicy::Block;
+
+		alignas(CACHE_LINE_SIZE) std::atomic<u64> s_head{0};
+		// Everything before this position has been handed to the sinks
+		alignas(CACHE_LINE_SIZE) std::atomic<u64> s_consumed{0};
+		std::atomic<u64> s_dropped{0};
+
+		// Set between BeginRecord and EndRecord on the producing thread
+		thread_local Slot* t_pendingSlot = nullptr;
+		thread_local u64 t_pendingPosition = 0;
+
+		std::thread s_thread;
+		std::atomic<b8> s_running{false};
+
+		// Producers between BeginRecord and EndRecord. Shutdown waits for it to reach zero
+		// before stopping the logging thread, so no committed record is left behind
+		std::atomic<u32> s_activeProducers{0};
+
+		// Only used to wake the logging thread early; producers never take the lock on the fast path
+		std::mutex s_wakeMutex;
+		std::condition_variable s_wakeCondition;
+		b8 s_wakeRequested = false;
+
+		void SetFlushOnEveryMessage()
+		{
+			for (u32 channel = 0; channel < LOG_CHANNEL_COUNT; ++channel)
+			{
+				Log::GetLogger(static_cast<LogChannel>(channel))->flush_on(spdlog::level::trace);
+			}
+		}
+
+		void WakeLoggingThread()
+		{
+			{
+				std::lock_guard lock(s_wakeMutex);
+				s_wakeRequested = true;
+			}
+			s_wakeCondition.notify_one();
+		}
+
+		// Formats and writes every committed record. Returns how many were written
+		u64 DrainQueue(spdlog::memory_buf_t& buffer)
+		{
+			// Every channel logger shares the same sinks
+			const Vector<spdlog::sink_ptr>& sinks = Log::GetCoreLogger()->sinks();
+
+			u64 position = s_consumed.load(std::memory_order_relaxed);
+			u64 written = 0;
+
+			for (;;)
+			{
+				Slot& slot = s_slots[position & s_mask];
+				if (slot.Sequence.load(std::memory_order_acquire) != position + 1)
+					break;
+
+				const RecordHeader& header = slot.Header;
+
+				buffer.clear();
+				header.Format(StringView(header.FormatString, header.FormatSize), slot.Payload, buffer);
+
+				const String& loggerName = Log::GetLogger(header.Channel)->name();
+				spdlog::details::log_msg message(header.Time, spdlog::source_loc{}, loggerName, header.Level, spdlog::string_view_t(buffer.data(), buffer.size()));
+				message.thread_id = header.Thread;
+
+				for (const spdlog::sink_ptr& sink : sinks)
+				{
+					if (sink->should_log(header.Level))
+					{
+						sink->log(message);
+					}
+				}
 
-	void Log::Init()
+				slot.Sequence.store(position + s_mask + 1, std::memory_order_release);
+				s_consumed.store(++position, std::memory_order_release);
+				written++;
+			}
+
+			if (written > 0)
+			{
+				for (const spdlog::sink_ptr& sink : sinks)
+				{
+					sink->flush();
+				}
+			}
+
+			return written;
+		}
+
+		void LoggingThreadMain()
+		{
+			MemoryTagScope memoryTag(MemoryTag::Logging);
+
+			spdlog::memory_buf_t buffer;
+
+			while (s_running.load(std::memory_order_acquire))
+			{
+				if (DrainQueue(buffer) > 0)
+					continue;
+
+				std::unique_lock lock(s_wakeMutex);
+				s_wakeCondition.wait_for(lock, IDLE_SLEEP, [] { return s_wakeRequested; });
+				s_wakeRequested = false;
+			}
+
+			// Producers still running past Shutdown fall back to synchronous logging
+			DrainQueue(buffer);
+		}
+	}
+
+	Array<SharedPtr<spdlog::logger>, LOG_CHANNEL_COUNT> Log::s_loggers;
+	Array<std::atomic<spdlog::level::level_enum>, LOG_CHANNEL_COUNT> Log::s_channelLevels{};
+	std::atomic<b8> Log::s_initialized{false};
+	std::atomic<b8> Log::s_async{false};
+
+	void Log::Init(const LogConfig& config)
 	{
+		MemoryTagScope memoryTag(MemoryTag::Logging);
+
 		Vector<spdlog::sink_ptr> logSinks;
 		logSinks.emplace_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
 
 		logSinks[0]->set_pattern("%^[%T] %n: %v%$");
 
-		s_coreLogger = CreateShared<spdlog::logger>("ZenonCore", begin(logSinks), end(logSinks));
-		spdlog::register_logger(s_coreLogger);
-		s_coreLogger->set_level(spdlog::level::trace);
-		s_coreLogger->flush_on(spdlog::level::trace);
+		if (!config.BinaryFilePath.empty())
+		{
+			SharedPtr<BinaryLogSink> binarySink = CreateShared<BinaryLogSink>(config.BinaryFilePath, config.BinaryFileMaxBytes, config.BinaryFileCount);
+			if (binarySink->IsOpen())
+			{
+				logSinks.emplace_back(std::move(binarySink));
+			}
+		}
+
+		// Channels filter on their own level; the loggers let everything through
+		for (u32 channel = 0; channel < LOG_CHANNEL_COUNT; ++channel)
+		{
+			s_loggers[channel] = CreateShared<spdlog::logger>(String(LOG_CHANNEL_NAMES[channel]), begin(logSinks), end(logSinks));
+			spdlog::register_logger(s_loggers[channel]);
+			s_loggers[channel]->set_level(spdlog::level::trace);
+			s_channelLevels[channel].store(config.DefaultLevel, std::memory_order_relaxed);
+		}
+
+		if (config.Async)
+		{
+			const u64 capacity = std::bit_ceil(std::max<u64>(config.QueueCapacity, 2));
+
+			s_slots = UniquePtr<Slot[]>(new Slot[capacity]);
+			for (u64 i = 0; i < capacity; ++i)
+			{
+				s_slots[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+
+			s_mask = capacity - 1;
+			s_overflow = config.Overflow;
+			s_head.store(0, std::memory_order_relaxed);
+			s_consumed.store(0, std::memory_order_relaxed);
+			s_dropped.store(0, std::memory_order_relaxed);
+
+			s_running.store(true, std::memory_order_release);
+			s_thread = std::thread(&LoggingThreadMain);
+			s_async.store(true);
+		}
+		else
+		{
+			SetFlushOnEveryMessage();
+		}
+
+		s_initialized.store(true, std::memory_order_release);
+
+		if (!config.BinaryFilePath.empty() && logSinks.size() == 1)
+		{
+			ZN_CORE_WARN("[Log::Init] Failed to open binary log {}", config.BinaryFilePath);
+		}
 	}
-}
 
+	void Log::Shutdown()
+	{
+		if (!s_async.exchange(false))
+			return;
+
+		// New messages go straight to the sinks from here on. The ones already being written
+		// still land in the queue, and the logging thread keeps draining until they're done
+		SetFlushOnEveryMessage();
+
+		while (s_activeProducers.load() > 0)
+		{
+			std::this_thread::yield();
+		}
+
+		s_running.store(false, std::memory_order_release);
+		WakeLoggingThread();
+		s_thread.join();
+
+		// Nothing can be pushed anymore; write out whatever the logging thread didn't get to
+		spdlog::memory_buf_t buffer;
+		DrainQueue(buffer);
+
+		GetCoreLogger()->flush();
+
+		const u64 dropped = s_dropped.load(std::memory_order_relaxed);
+		if (dropped > 0)
+		{
+			ZN_CORE_WARN("[Log::Shutdown] {} messages were dropped because the log queue was full", dropped);
+		}
+	}
+
+	void Log::Flush()
+	{
+		if (!s_initialized.load(std::memory_order_acquire))
+			return;
+
+		if (s_async.load(std::memory_order_acquire))
+		{
+			const u64 target = s_head.load(std::memory_order_acquire);
+			WakeLoggingThread();
+
+			while (s_consumed.load(std::memory_order_acquire) < target)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		GetCoreLogger()->flush();
+	}
+
+	u64 Log::GetDroppedCount()
+	{
+		return s_dropped.load(std::memory_order_relaxed);
+	}
+
+	void Log::SetChannelLevel(LogChannel channel, spdlog::level::level_enum level)
+	{
+		s_channelLevels[static_cast<u32>(channel)].store(level, std::memory_order_relaxed);
+	}
+
+	spdlog::level::level_enum Log::GetChannelLevel(LogChannel channel)
+	{
+		return s_channelLevels[static_cast<u32>(channel)].load(std::memory_order_relaxed);
+	}
+
+	void Log::OnImGui()
+	{
+		ImGui::Begin("Log");
+
+		ImGui::Text("Mode: %s", IsAsync() ? "Async" : "Sync");
+		ImGui::Text("Dropped messages: %llu", static_cast<unsigned long long>(GetDroppedCount()));
+
+		ImGui::Separator();
+
+		for (u32 channel = 0; channel < LOG_CHANNEL_COUNT; ++channel)
+		{
+			const String& name = s_loggers[channel]->name();
+
+			i32 level = static_cast<i32>(GetChannelLevel(static_cast<LogChannel>(channel)));
+			if (ImGui::Combo(name.c_str(), &level, LEVEL_NAMES.data(), static_cast<int>(LEVEL_NAMES.size())))
+			{
+				SetChannelLevel(static_cast<LogChannel>(channel), static_cast<spdlog::level::level_enum>(level));
+			}
+		}
+
+		ImGui::End();
+	}
+
+	Byte* Log::BeginRecord(LogChannel channel, spdlog::level::level_enum level, StringView format, FormatFn formatFn, uSize payloadSize)
+	{
+		if (payloadSize > MAX_PAYLOAD_SIZE)
+			return nullptr;
+
+		// Pairs with Shutdown: either it sees this producer and waits for it, or this sees the
+		// queue closed and logs synchronously
+		s_activeProducers.fetch_add(1);
+		if (!s_async.load())
+		{
+			s_activeProducers.fetch_sub(1);
+			return nullptr;
+		}
+
+		u64 position = s_head.load(std::memory_order_relaxed);
+		Slot* slot = nullptr;
+
+		for (;;)
+		{
+			slot = &s_slots[position & s_mask];
+			const i64 difference = static_cast<i64>(slot->Sequence.load(std::memory_order_acquire) - position);
+
+			if (difference == 0)
+			{
+				if (s_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+			{
+				// Full: the slot still holds a record from the previous lap
+				if (s_overflow == LogOverflowPolicy::Drop)
+				{
+					s_dropped.fetch_add(1, std::memory_order_relaxed);
+					s_activeProducers.fetch_sub(1, std::memory_order_release);
+					return nullptr;
+				}
+
+				WakeLoggingThread();
+				std::this_thread::yield();
+				position = s_head.load(std::memory_order_relaxed);
+			}
+			else
+			{
+				position = s_head.load(std::memory_order_relaxed);
+			}
+		}
+
+		RecordHeader& header = slot->Header;
+		header.Format = formatFn;
+		header.FormatString = format.data();
+		header.FormatSize = static_cast<u32>(format.size());
+		header.PayloadSize = static_cast<u32>(payloadSize);
+		header.Time = spdlog::log_clock::now();
+		header.Thread = spdlog::details::os::thread_id();
+		header.Level = level;
+		header.Channel = channel;
+
+		t_pendingSlot = slot;
+		t_pendingPosition = position;
+
+		return slot->Payload;
+	}
+
+	void Log::EndRecord(spdlog::level::level_enum level)
+	{
+		t_pendingSlot->Sequence.store(t_pendingPosition + 1, std::memory_order_release);
+		t_pendingSlot = nullptr;
+		s_activeProducers.fetch_sub(1, std::memory_order_release);
+
+		// Errors usually come right before an assert; make sure they're visible when it fires
+		if (level >= spdlog::level::err)
+		{
+			Flush();
+		}
+	}
+
+	uSize Log::GetMaxPayloadSize()
+	{
+		return MAX_PAYLOAD_SIZE;
+	}
+}
@@ -2,36 +2,406 @@
 
 #include "Core/Base.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <tuple>
+
 #pragma warning(push, 0)
 #include "spdlog/spdlog.h"
 #pragma warning(pop)
 
+// Compile time minimum level per channel, as SPDLOG_LEVEL_* values. Calls below it compile to nothing
+#ifndef ZN_LOG_MIN_LEVEL
+	#define ZN_LOG_MIN_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+#ifndef ZN_LOG_MIN_LEVEL_CORE
+	#define ZN_LOG_MIN_LEVEL_CORE ZN_LOG_MIN_LEVEL
+#endif
+#ifndef ZN_LOG_MIN_LEVEL_RENDERER
+	#define ZN_LOG_MIN_LEVEL_RENDERER ZN_LOG_MIN_LEVEL
+#endif
+#ifndef ZN_LOG_MIN_LEVEL_RESOURCE
+	#define ZN_LOG_MIN_LEVEL_RESOURCE ZN_LOG_MIN_LEVEL
+#endif
+#ifndef ZN_LOG_MIN_LEVEL_FILESYSTEM
+	#define ZN_LOG_MIN_LEVEL_FILESYSTEM ZN_LOG_MIN_LEVEL
+#endif
+#ifndef ZN_LOG_MIN_LEVEL_INPUT
+	#define ZN_LOG_MIN_LEVEL_INPUT ZN_LOG_MIN_LEVEL
+#endif
+#ifndef ZN_LOG_MIN_LEVEL_PLATFORM
+	#define ZN_LOG_MIN_LEVEL_PLATFORM ZN_LOG_MIN_LEVEL
+#endif
+#ifndef ZN_LOG_MIN_LEVEL_EVENTS
+	#define ZN_LOG_MIN_LEVEL_EVENTS ZN_LOG_MIN_LEVEL
+#endif
+#ifndef ZN_LOG_MIN_LEVEL_MEMORY
+	#define ZN_LOG_MIN_LEVEL_MEMORY ZN_LOG_MIN_LEVEL
+#endif
+#ifndef ZN_LOG_MIN_LEVEL_JOBS
+	#define ZN_LOG_MIN_LEVEL_JOBS ZN_LOG_MIN_LEVEL
+#endif
+#ifndef ZN_LOG_MIN_LEVEL_SCENE
+	#define ZN_LOG_MIN_LEVEL_SCENE ZN_LOG_MIN_LEVEL
+#endif
+
 namespace zn
 {
+	enum class LogChannel : u8
+	{
+		Core,
+		Renderer,
+		Resource,
+		FileSystem,
+		Input,
+		Platform,
+		Events,
+		Memory,
+		Jobs,
+		Scene,
+
+		Count
+	};
+
+	inline constexpr u32 LOG_CHANNEL_COUNT = static_cast<u32>(LogChannel::Count);
+
+	inline constexpr Array<StringView, LOG_CHANNEL_COUNT> LOG_CHANNEL_NAMES =
+	{
+		"ZenonCore", "Renderer", "Resource", "FileSystem", "Input", "Platform", "Events", "Memory", "Jobs", "Scene"
+	};
+
+	inline constexpr Array<i32, LOG_CHANNEL_COUNT> LOG_CHANNEL_MIN_LEVELS =
+	{
+		ZN_LOG_MIN_LEVEL_CORE, ZN_LOG_MIN_LEVEL_RENDERER, ZN_LOG_MIN_LEVEL_RESOURCE, ZN_LOG_MIN_LEVEL_FILESYSTEM, ZN_LOG_MIN_LEVEL_INPUT,
+		ZN_LOG_MIN_LEVEL_PLATFORM, ZN_LOG_MIN_LEVEL_EVENTS, ZN_LOG_MIN_LEVEL_MEMORY, ZN_LOG_MIN_LEVEL_JOBS, ZN_LOG_MIN_LEVEL_SCENE
+	};
+
+	[[nodiscard]] constexpr b8 IsLogCompiledIn(LogChannel channel, spdlog::level::level_enum level)
+	{
+		return static_cast<i32>(level) >= LOG_CHANNEL_MIN_LEVELS[static_cast<u32>(channel)];
+	}
+
+	// Lets one message through per interval. Calls in between are only counted, so a warning hit
+	// every frame shows up once a second followed by how many times it repeated
+	class LogRateLimiter
+	{
+	public:
+		static constexpr i64 DEFAULT_INTERVAL_MS = 1000;
+
+		explicit LogRateLimiter(i64 intervalMs = DEFAULT_INTERVAL_MS)
+			: m_intervalNs(intervalMs * 1000000)
+		{
+		}
+
+		LogRateLimiter(const LogRateLimiter& other) = delete;
+		LogRateLimiter(LogRateLimiter&& other) noexcept = delete;
+
+		LogRateLimiter& operator=(const LogRateLimiter& other) = delete;
+		LogRateLimiter& operator=(LogRateLimiter&& other) noexcept = delete;
+
+		// True when the message should be logged. suppressed is set to how many calls were skipped
+		// since the last one that went through
+		b8 Acquire(u32& suppressed)
+		{
+			const i64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+			i64 next = m_nextNs.load(std::memory_order_relaxed);
+			if (now < next || !m_nextNs.compare_exchange_strong(next, now + m_intervalNs, std::memory_order_relaxed))
+			{
+				m_suppressed.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+			return true;
+		}
+
+	private:
+		const i64 m_intervalNs;
+		std::atomic<i64> m_nextNs{0};
+		std::atomic<u32> m_suppressed{0};
+	};
+
+	// What a producer does when the async queue is full
+	enum class LogOverflowPolicy : u8
+	{
+		Block, // Wait for the logging thread to make room. Nothing is lost
+		Drop   // Discard the message and count it. Logging never stalls the caller
+	};
+
+	struct LogConfig
+	{
+		// Messages are formatted and written on a background thread. Sync formats on the caller
+		b8 Async = true;
+		// Number of queue slots, rounded up to a power of two
+		u32 QueueCapacity = 8192;
+		LogOverflowPolicy Overflow = LogOverflowPolicy::Block;
+
+		// Runtime level every channel starts at
+		spdlog::level::level_enum DefaultLevel = spdlog::level::trace;
+
+		// Optional compact binary log next to the console, rotated by size. Empty to disable
+		String BinaryFilePath;
+		uSize BinaryFileMaxBytes = 16ull * 1024 * 1024;
+		u32 BinaryFileCount = 3;
+	};
+
+	namespace detail
+	{
+		// Arguments are packed into the queue by value when they're trivially copyable, strings are
+		// copied as length + bytes, and anything else is formatted to a string up front. Formatting
+		// proper happens on the logging thread, so trivially copyable views of the caller's memory
+		// (fmt::join, spans) must be turned into a String before they're logged.
+		template<typename T>
+		inline constexpr b8 IS_LOG_STRING = std::is_same_v<T, const c8*> || std::is_same_v<T, c8*> || std::is_same_v<T, String> || std::is_same_v<T, StringView>;
+
+		template<typename T>
+		inline constexpr b8 IS_LOG_TRIVIAL = !IS_LOG_STRING<T> && std::is_trivially_copyable_v<T>;
+
+		template<typename T>
+		using LogDecoded = std::conditional_t<IS_LOG_TRIVIAL<T>, T, StringView>;
+
+		inline StringView AsLogString(const c8* text) { return text ? StringView(text) : StringView("(null)"); }
+		inline StringView AsLogString(StringView text) { return text; }
+
+		template<typename T>
+		uSize GetEncodedSize(const T& value, String& formatted)
+		{
+			using Type = std::decay_t<T>;
+			if constexpr (IS_LOG_TRIVIAL<Type>)
+			{
+				return sizeof(Type);
+			}
+			else if constexpr (IS_LOG_STRING<Type>)
+			{
+				return sizeof(u32) + AsLogString(value).size();
+			}
+			else
+			{
+				const uSize start = formatted.size();
+				formatted += fmt::format("{}", value);
+				const uSize length = formatted.size() - start;
+				formatted.push_back('\0');
+
+				return sizeof(u32) + length;
+			}
+		}
+
+		template<typename T>
+		Byte* Encode(Byte* cursor, const T& value, const c8*& formatted)
+		{
+			using Type = std::decay_t<T>;
+			if constexpr (IS_LOG_TRIVIAL<Type>)
+			{
+				std::memcpy(cursor, &value, sizeof(Type));
+				return cursor + sizeof(Type);
+			}
+			else
+			{
+				StringView text;
+				if constexpr (IS_LOG_STRING<Type>)
+				{
+					text = AsLogString(value);
+				}
+				else
+				{
+					text = formatted;
+					formatted += text.size() + 1;
+				}
+
+				const u32 size = static_cast<u32>(text.size());
+				std::memcpy(cursor, &size, sizeof(u32));
+				std::memcpy(cursor + sizeof(u32), text.data(), size);
+				return cursor + sizeof(u32) + size;
+			}
+		}
+
+		template<typename T>
+		LogDecoded<T> Decode(const Byte*& cursor)
+		{
+			if constexpr (IS_LOG_TRIVIAL<T>)
+			{
+				T value;
+				std::memcpy(&value, cursor, sizeof(T));
+				cursor += sizeof(T);
+				return value;
+			}
+			else
+			{
+				u32 size;
+				std::memcpy(&size, cursor, sizeof(u32));
+				const StringView text(reinterpret_cast<const c8*>(cursor + sizeof(u32)), size);
+				cursor += sizeof(u32) + size;
+				return text;
+			}
+		}
+
+		// Instantiated per argument list; the queue stores a pointer to it next to the payload
+		template<typename... Args>
+		void FormatLogPayload(StringView format, const Byte* payload, spdlog::memory_buf_t& out)
+		{
+			// Braced initialization decodes the arguments left to right
+			std::tuple<LogDecoded<Args>...> values{ Decode<Args>(payload)... };
+			std::apply([&](auto&... decoded)
+			{
+				fmt::vformat_to(fmt::appender(out), fmt::string_view(format.data(), format.size()), fmt::make_format_args(decoded...));
+			}, values);
+		}
+	}
+
 	class Log
 	{
 	public:
-		static void Init();
+		using FormatFn = void (*)(StringView format, const Byte* payload, spdlog::memory_buf_t& out);
+
+		static void Init(const LogConfig& config = {});
+		// Drains the queue and stops the logging thread. Safe to call more than once
+		static void Shutdown();
+
+		// Blocks until every message logged so far reached the sinks, then flushes them
+		static void Flush();
+
+		[[nodiscard]] static b8 IsAsync() { return s_async.load(std::memory_order_relaxed); }
+		[[nodiscard]] static u64 GetDroppedCount();
+
+		static SharedPtr<spdlog::logger>& GetCoreLogger() { return s_loggers[static_cast<u32>(LogChannel::Core)]; }
+		static SharedPtr<spdlog::logger>& GetLogger(LogChannel channel) { return s_loggers[static_cast<u32>(channel)]; }
+
+		// Runtime level of a channel, on top of its compile time minimum
+		static void SetChannelLevel(LogChannel channel, spdlog::level::level_enum level);
+		[[nodiscard]] static spdlog::level::level_enum GetChannelLevel(LogChannel channel);
 
-		static SharedPtr<spdlog::logger>& GetCoreLogger() { return s_coreLogger; }
+		[[nodiscard]] static b8 IsEnabled(LogChannel channel, spdlog::level::level_enum level)
+		{
+			return s_initialized.load(std::memory_order_relaxed) && level >= s_channelLevels[static_cast<u32>(channel)].load(std::memory_order_relaxed);
+		}
+
+		static void OnImGui();
+
+		template<typename... Args>
+		static void Write(LogChannel channel, spdlog::level::level_enum level, fmt::format_string<Args...> format, Args&&... args)
+		{
+			if (!IsEnabled(channel, level))
+				return;
+
+			if (!IsAsync())
+			{
+				GetLogger(channel)->log(level, format, std::forward<Args>(args)...);
+				return;
+			}
+
+			const fmt::string_view formatString = format;
+			const StringView formatView(formatString.data(), formatString.size());
+
+			// Only filled for arguments that have to be formatted up front. The comma fold runs left to
+			// right, the same order Encode reads the formatted strings back in
+			String formatted;
+			uSize payloadSize = 0;
+			((payloadSize += detail::GetEncodedSize(args, formatted)), ...);
+
+			Byte* payload = BeginRecord(channel, level, formatView, &detail::FormatLogPayload<std::decay_t<Args>...>, payloadSize);
+			if (payload == nullptr)
+			{
+				// Too large for a queue slot, logged after Shutdown closed the queue, or dropped
+				if (payloadSize > GetMaxPayloadSize() || !IsAsync())
+				{
+					GetLogger(channel)->log(level, format, std::forward<Args>(args)...);
+				}
+				return;
+			}
+
+			const c8* nextFormatted = formatted.c_str();
+			((payload = detail::Encode(payload, args, nextFormatted)), ...);
+
+			EndRecord(level);
+		}
+
+		// A single argument is logged as is, without going through the formatter
+		template<typename T>
+		static void Write(LogChannel channel, spdlog::level::level_enum level, const T& message)
+		{
+			if constexpr (std::is_convertible_v<const T&, StringView>)
+			{
+				Write(channel, level, "{}", StringView(message));
+			}
+			else
+			{
+				Write(channel, level, "{}", message);
+			}
+		}
 
 	private:
-		static SharedPtr<spdlog::logger> s_coreLogger;
+		// Reserves a slot and fills its header. Returns where the payload goes, or null when the
+		// message has to be logged synchronously (too large, or the queue is closed) or was dropped
+		static Byte* BeginRecord(LogChannel channel, spdlog::level::level_enum level, StringView format, FormatFn formatFn, uSize payloadSize);
+		static void EndRecord(spdlog::level::level_enum level);
+		static uSize GetMaxPayloadSize();
+
+		static Array<SharedPtr<spdlog::logger>, LOG_CHANNEL_COUNT> s_loggers;
+		static Array<std::atomic<spdlog::level::level_enum>, LOG_CHANNEL_COUNT> s_channelLevels;
+		static std::atomic<b8> s_initialized;
+		static std::atomic<b8> s_async;
 	};
 }
 
 #ifdef ZN_DEBUG
-	#define ZN_CORE_TRACE(...)    ::zn::Log::GetCoreLogger()->trace(__VA_ARGS__)
-	#define ZN_CORE_INFO(...)     ::zn::Log::GetCoreLogger()->info(__VA_ARGS__)
-	#define ZN_CORE_WARN(...)     ::zn::Log::GetCoreLogger()->warn(__VA_ARGS__)
-	#define ZN_CORE_ERROR(...)    ::zn::Log::GetCoreLogger()->error(__VA_ARGS__)
-	#define ZN_CORE_CRITICAL(...) ::zn::Log::GetCoreLogger()->critical(__VA_ARGS__)
+	#define ZN_LOG_IMPL(channel, level, ...) \
+		do { \
+			if constexpr (::zn::IsLogCompiledIn(::zn::LogChannel::channel, level)) \
+			{ \
+				::zn::Log::Write(::zn::LogChannel::channel, level, __VA_ARGS__); \
+			} \
+		} while (0)
+
+	// One limiter per call site; only calls that pass the channel level are counted
+	#define ZN_LOG_LIMITED_IMPL(channel, level, ...) \
+		do { \
+			if constexpr (::zn::IsLogCompiledIn(::zn::LogChannel::channel, level)) \
+			{ \
+				static ::zn::LogRateLimiter logLimiter; \
+				::zn::u32 suppressed = 0; \
+				if (::zn::Log::IsEnabled(::zn::LogChannel::channel, level) && logLimiter.Acquire(suppressed)) \
+				{ \
+					if (suppressed > 0) \
+					{ \
+						::zn::Log::Write(::zn::LogChannel::channel, level, "Previous message repeated {} times", suppressed); \
+					} \
+					::zn::Log::Write(::zn::LogChannel::channel, level, __VA_ARGS__); \
+				} \
+			} \
+		} while (0)
+
+	#define ZN_LOG_TRACE(channel, ...)    ZN_LOG_IMPL(channel, ::spdlog::level::trace, __VA_ARGS__)
+	#define ZN_LOG_INFO(channel, ...)     ZN_LOG_IMPL(channel, ::spdlog::level::info, __VA_ARGS__)
+	#define ZN_LOG_WARN(channel, ...)     ZN_LOG_IMPL(channel, ::spdlog::level::warn, __VA_ARGS__)
+	#define ZN_LOG_ERROR(channel, ...)    ZN_LOG_IMPL(channel, ::spdlog::level::err, __VA_ARGS__)
+	#define ZN_LOG_CRITICAL(channel, ...) ZN_LOG_IMPL(channel, ::spdlog::level::critical, __VA_ARGS__)
 
-	#define ZN_CORE_FLUSH_LOG()   ::zn::Log::GetCoreLogger()->flush()
+	// For call sites that can fire every frame
+	#define ZN_LOG_WARN_LIMITED(channel, ...)  ZN_LOG_LIMITED_IMPL(channel, ::spdlog::level::warn, __VA_ARGS__)
+	#define ZN_LOG_ERROR_LIMITED(channel, ...) ZN_LOG_LIMITED_IMPL(channel, ::spdlog::level::err, __VA_ARGS__)
+
+	#define ZN_CORE_TRACE(...)    ZN_LOG_TRACE(Core, __VA_ARGS__)
+	#define ZN_CORE_INFO(...)     ZN_LOG_INFO(Core, __VA_ARGS__)
+	#define ZN_CORE_WARN(...)     ZN_LOG_WARN(Core, __VA_ARGS__)
+	#define ZN_CORE_ERROR(...)    ZN_LOG_ERROR(Core, __VA_ARGS__)
+	#define ZN_CORE_CRITICAL(...) ZN_LOG_CRITICAL(Core, __VA_ARGS__)
+
+	#define ZN_CORE_FLUSH_LOG()   ::zn::Log::Flush()
 #else
-	#define ZN_CORE_INFO(...)    
-	#define ZN_CORE_TRACE(...)   
-	#define ZN_CORE_WARN(...)    
-	#define ZN_CORE_ERROR(...)   
+	#define ZN_LOG_TRACE(channel, ...)
+	#define ZN_LOG_INFO(channel, ...)
+	#define ZN_LOG_WARN(channel, ...)
+	#define ZN_LOG_ERROR(channel, ...)
+	#define ZN_LOG_CRITICAL(channel, ...)
+
+	#define ZN_LOG_WARN_LIMITED(channel, ...)
+	#define ZN_LOG_ERROR_LIMITED(channel, ...)
+
+	#define ZN_CORE_INFO(...)
+	#define ZN_CORE_TRACE(...)
+	#define ZN_CORE_WARN(...)
+	#define ZN_CORE_ERROR(...)
 	#define ZN_CORE_CRITICAL(...)
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,420 @@
+#include "Profiler.hpp"
+
+#include "Core/Log.hpp"
+#include "Memory/AllocationGuard.hpp"
+#include "Memory/MemoryUtils.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace zn
+{
+	std::atomic<b8> Profiler::s_enabled{ true };
+
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		constexpr u64 EVENT_MASK = Profiler::EVENTS_PER_THREAD - 1;
+		static_assert((Profiler::EVENTS_PER_THREAD & EVENT_MASK) == 0, "The ring buffer size must be a power of two");
+
+		// Ticks are re-measured against the steady clock once this much time has passed
+		constexpr f64 CALIBRATION_MIN_MS = 10.0;
+
+		constexpr f32 FLAME_ROW_PADDING = 1.0f;
+
+		// Single producer (the owning thread), single consumer (BeginFrame on the main thread)
+		struct ThreadBuffer
+		{
+			Array<ProfileEvent, Profiler::EVENTS_PER_THREAD> Events;
+
+			alignas(CACHE_LINE_SIZE) std::atomic<u64> Head{0};
+			// Producer side copy of Tail, so the consumer's cache line is only read when the ring looks full
+			u64 CachedTail = 0;
+			u32 Depth = 0;
+
+			alignas(CACHE_LINE_SIZE) std::atomic<u64> Tail{0};
+			std::atomic<u64> Dropped{0};
+
+			u32 Index = 0;
+			String Name;
+		};
+
+		std::mutex s_threadsMutex;
+		Vector<UniquePtr<ThreadBuffer>> s_threads;
+
+		thread_local ThreadBuffer* t_buffer = nullptr;
+
+		std::mutex s_namesMutex;
+		std::set<String, std::less<>> s_names;
+
+		u64 s_calibrationTicks = 0;
+		Clock::time_point s_calibrationTime{};
+		std::atomic<f64> s_msPerTick{ 1.0e-6 };
+
+		// Main thread only
+		Vector<ProfileEvent> s_drainedEvents;
+		Vector<ProfileEvent> s_frameEvents;
+		u64 s_frameBeginTicks = 0;
+		u64 s_displayBeginTicks = 0;
+		u64 s_displayEndTicks = 0;
+		b8 s_paused = false;
+
+		b8 s_capturing = false;
+		u64 s_captureBeginTicks = 0;
+		Vector<ProfileEvent> s_captureEvents;
+		b8 s_captureTruncated = false;
+
+		ThreadBuffer& GetThreadBuffer()
+		{
+			if (t_buffer == nullptr)
+			{
+				// The first scope of a thread may well be inside a no-alloc region
+				ZN_ALLOW_ALLOC_SCOPE();
+
+				UniquePtr<ThreadBuffer> buffer = CreateUnique<ThreadBuffer>();
+
+				std::lock_guard lock(s_threadsMutex);
+				buffer->Index = static_cast<u32>(s_threads.size());
+				buffer->Name = "Thread " + std::to_string(buffer->Index);
+				t_buffer = buffer.get();
+				s_threads.push_back(std::move(buffer));
+			}
+
+			return *t_buffer;
+		}
+
+		void Calibrate()
+		{
+#if defined(ZN_CPU_X86)
+			const u64 ticks = Profiler::ReadTicks();
+			const Clock::time_point now = Clock::now();
+			const f64 elapsedMs = std::chrono::duration<f64, std::milli>(now - s_calibrationTime).count();
+
+			if (elapsedMs >= CALIBRATION_MIN_MS && ticks > s_calibrationTicks)
+			{
+				s_msPerTick.store(elapsedMs / static_cast<f64>(ticks - s_calibrationTicks), std::memory_order_relaxed);
+			}
+#endif
+		}
+
+		void Drain()
+		{
+			s_drainedEvents.clear();
+
+			std::lock_guard lock(s_threadsMutex);
+			for (const UniquePtr<ThreadBuffer>& buffer : s_threads)
+			{
+				const u64 tail = buffer->Tail.load(std::memory_order_relaxed);
+				const u64 head = buffer->Head.load(std::memory_order_acquire);
+
+				for (u64 i = tail; i < head; ++i)
+				{
+					s_drainedEvents.push_back(buffer->Events[i & EVENT_MASK]);
+				}
+
+				buffer->Tail.store(head, std::memory_order_release);
+			}
+		}
+
+		void WriteJsonString(std::ofstream& file, StringView text)
+		{
+			file << '"';
+			for (const c8 c : text)
+			{
+				if (c == '"' || c == '\\')
+					file << '\\';
+
+				if (static_cast<unsigned char>(c) >= 0x20)
+					file << c;
+			}
+			file << '"';
+		}
+	}
+
+	void Profiler::Init()
+	{
+		s_calibrationTicks = ReadTicks();
+		s_calibrationTime = Clock::now();
+
+#if defined(ZN_CPU_X86)
+		// A first estimate so the opening frames already show sensible times
+		std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<i64>(CALIBRATION_MIN_MS)));
+		Calibrate();
+#endif
+
+		s_frameBeginTicks = ReadTicks();
+		SetThreadName("Main");
+	}
+
+	void Profiler::Shutdown()
+	{
+		if (s_capturing)
+		{
+			s_capturing = false;
+			s_captureEvents.clear();
+		}
+
+		std::lock_guard lock(s_threadsMutex);
+		s_threads.clear();
+		t_buffer = nullptr;
+	}
+
+	void Profiler::SetEnabled(b8 enabled)
+	{
+		s_enabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	void Profiler::SetThreadName(StringView name)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+
+		std::lock_guard lock(s_threadsMutex);
+		buffer.Name = name;
+	}
+
+	void Profiler::BeginFrame()
+	{
+		Calibrate();
+		Drain();
+
+		const u64 now = ReadTicks();
+
+		if (s_capturing)
+		{
+			const uSize room = MAX_CAPTURE_EVENTS - std::min(MAX_CAPTURE_EVENTS, s_captureEvents.size());
+			const uSize count = std::min(room, s_drainedEvents.size());
+			s_captureEvents.insert(s_captureEvents.end(), s_drainedEvents.begin(), s_drainedEvents.begin() + static_cast<std::ptrdiff_t>(count));
+
+			if (count < s_drainedEvents.size() && !s_captureTruncated)
+			{
+				ZN_CORE_WARN("[Profiler::BeginFrame] Capture reached {} events, later events are dropped", MAX_CAPTURE_EVENTS);
+				s_captureTruncated = true;
+			}
+		}
+
+		if (!s_paused)
+		{
+			s_frameEvents.swap(s_drainedEvents);
+			s_displayBeginTicks = s_frameBeginTicks;
+			s_displayEndTicks = now;
+		}
+
+		s_frameBeginTicks = now;
+	}
+
+	void Profiler::BeginCapture()
+	{
+		s_captureEvents.clear();
+		s_captureTruncated = false;
+		s_captureBeginTicks = ReadTicks();
+		s_capturing = true;
+	}
+
+	b8 Profiler::EndCapture(const String& path)
+	{
+		if (!s_capturing)
+			return false;
+
+		s_capturing = false;
+
+		std::ofstream file(path, std::ios::trunc);
+		if (!file)
+		{
+			ZN_CORE_ERROR("[Profiler::EndCapture] Failed to open {}", path);
+			s_captureEvents.clear();
+			return false;
+		}
+
+		const f64 msPerTick = s_msPerTick.load(std::memory_order_relaxed);
+
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+		b8 first = true;
+		{
+			std::lock_guard lock(s_threadsMutex);
+			for (const UniquePtr<ThreadBuffer>& buffer : s_threads)
+			{
+				file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->Index << ",\"args\":{\"name\":";
+				WriteJsonString(file, buffer->Name);
+				file << "}}";
+				first = false;
+			}
+		}
+
+		for (const ProfileEvent& event : s_captureEvents)
+		{
+			// Scopes that started before the capture are clipped to it
+			const u64 begin = std::max(event.BeginTicks, s_captureBeginTicks);
+			const f64 timestampUs = static_cast<f64>(begin - s_captureBeginTicks) * msPerTick * 1000.0;
+			const f64 durationUs = static_cast<f64>(event.EndTicks - begin) * msPerTick * 1000.0;
+
+			file << (first ? "" : ",") << "\n{\"name\":";
+			WriteJsonString(file, event.Name);
+			file << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.Thread << ",\"ts\":" << timestampUs << ",\"dur\":" << durationUs << "}";
+			first = false;
+		}
+
+		file << "\n]}\n";
+
+		ZN_CORE_INFO("[Profiler::EndCapture] Wrote {} events to {}", s_captureEvents.size(), path);
+		s_captureEvents.clear();
+		s_captureEvents.shrink_to_fit();
+
+		return static_cast<b8>(file);
+	}
+
+	b8 Profiler::IsCapturing()
+	{
+		return s_capturing;
+	}
+
+	const c8* Profiler::InternName(StringView name)
+	{
+		std::lock_guard lock(s_namesMutex);
+
+		auto it = s_names.find(name);
+		if (it == s_names.end())
+		{
+			ZN_ALLOW_ALLOC_SCOPE();
+			it = s_names.emplace(name).first;
+		}
+
+		return it->c_str();
+	}
+
+	f64 Profiler::TicksToMs(u64 ticks)
+	{
+		return static_cast<f64>(ticks) * s_msPerTick.load(std::memory_order_relaxed);
+	}
+
+	u32 Profiler::BeginScope()
+	{
+		return GetThreadBuffer().Depth++;
+	}
+
+	void Profiler::EndScope(const c8* name, u64 beginTicks, u64 endTicks, u32 depth)
+	{
+		// Only ever called after BeginScope on the same thread, so the buffer exists
+		ThreadBuffer& buffer = *t_buffer;
+		buffer.Depth = depth;
+
+		const u64 head = buffer.Head.load(std::memory_order_relaxed);
+		if (head - buffer.CachedTail >= EVENTS_PER_THREAD)
+		{
+			buffer.CachedTail = buffer.Tail.load(std::memory_order_acquire);
+			if (head - buffer.CachedTail >= EVENTS_PER_THREAD)
+			{
+				buffer.Dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+
+		buffer.Events[head & EVENT_MASK] = ProfileEvent{ name, beginTicks, endTicks, depth, buffer.Index };
+		buffer.Head.store(head + 1, std::memory_order_release);
+	}
+
+	void Profiler::OnImGui()
+	{
+		ImGui::Begin("Profiler");
+
+		b8 enabled = IsEnabled();
+		if (ImGui::Checkbox("Enabled", &enabled))
+		{
+			SetEnabled(enabled);
+		}
+
+		ImGui::SameLine();
+		ImGui::Checkbox("Pause", &s_paused);
+
+		ImGui::SameLine();
+		if (!s_capturing && ImGui::Button("Record trace"))
+		{
+			BeginCapture();
+		}
+		else if (s_capturing && ImGui::Button("Save ProfileTrace.json"))
+		{
+			EndCapture("ProfileTrace.json");
+		}
+
+		const u64 span = std::max<u64>(s_displayEndTicks - s_displayBeginTicks, 1);
+		ImGui::Text("Frame: %.3f ms, %zu scopes", TicksToMs(span), s_frameEvents.size());
+		if (s_capturing)
+		{
+			ImGui::SameLine();
+			ImGui::Text("(recording, %zu events)", s_captureEvents.size());
+		}
+		ImGui::Separator();
+
+		std::lock_guard lock(s_threadsMutex);
+
+		const f32 rowHeight = ImGui::GetTextLineHeight() + FLAME_ROW_PADDING;
+		const f32 width = std::max(ImGui::GetContentRegionAvail().x, 50.0f);
+		ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+		for (const UniquePtr<ThreadBuffer>& buffer : s_threads)
+		{
+			u32 rows = 0;
+			for (const ProfileEvent& event : s_frameEvents)
+			{
+				if (event.Thread == buffer->Index)
+					rows = std::max(rows, event.Depth + 1);
+			}
+
+			if (rows == 0)
+				continue;
+
+			const u64 dropped = buffer->Dropped.load(std::memory_order_relaxed);
+			if (dropped > 0)
+				ImGui::Text("%s (%llu dropped)", buffer->Name.c_str(), static_cast<unsigned long long>(dropped));
+			else
+				ImGui::Text("%s", buffer->Name.c_str());
+
+			const ImVec2 origin = ImGui::GetCursorScreenPos();
+			drawList->PushClipRect(origin, ImVec2(origin.x + width, origin.y + rowHeight * static_cast<f32>(rows)), true);
+
+			for (const ProfileEvent& event : s_frameEvents)
+			{
+				if (event.Thread != buffer->Index)
+					continue;
+
+				const u64 begin = std::clamp(event.BeginTicks, s_displayBeginTicks, s_displayEndTicks);
+				const u64 end = std::clamp(event.EndTicks, s_displayBeginTicks, s_displayEndTicks);
+
+				const f32 x0 = origin.x + static_cast<f32>(static_cast<f64>(begin - s_displayBeginTicks) / static_cast<f64>(span)) * width;
+				const f32 x1 = std::max(origin.x + static_cast<f32>(static_cast<f64>(end - s_displayBeginTicks) / static_cast<f64>(span)) * width, x0 + 1.0f);
+				const f32 y0 = origin.y + static_cast<f32>(event.Depth) * rowHeight;
+
+				const ImVec2 min(x0, y0);
+				const ImVec2 max(x1, y0 + rowHeight - FLAME_ROW_PADDING);
+
+				// Stable color per name, so a scope keeps its color from frame to frame
+				const uintptr_t hash = reinterpret_cast<uintptr_t>(event.Name) * 2654435761u;
+				const ImU32 color = IM_COL32(90 + (hash >> 8) % 100, 110 + (hash >> 16) % 90, 150 + (hash >> 24) % 80, 255);
+
+				drawList->AddRectFilled(min, max, color);
+				if (x1 - x0 > 30.0f)
+				{
+					drawList->PushClipRect(min, max, true);
+					drawList->AddText(ImVec2(x0 + 2.0f, y0), IM_COL32(0, 0, 0, 255), event.Name);
+					drawList->PopClipRect();
+				}
+
+				if (ImGui::IsMouseHoveringRect(min, max))
+				{
+					ImGui::SetTooltip("%s: %.3f ms", event.Name, TicksToMs(event.EndTicks - event.BeginTicks));
+				}
+			}
+
+			drawList->PopClipRect();
+			ImGui::Dummy(ImVec2(width, rowHeight * static_cast<f32>(rows)));
+		}
+
+		ImGui::End();
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Core/CpuFeatures.hpp"
+
+#include <atomic>
+#include <chrono>
+
+#if defined(ZN_CPU_X86)
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+#endif
+
+namespace zn
+{
+	// One finished scope. Names are never copied, so they must outlive the profiler: string
+	// literals, or names returned by Profiler::InternName
+	struct ProfileEvent
+	{
+		const c8* Name = nullptr;
+		u64 BeginTicks = 0;
+		u64 EndTicks = 0;
+		u32 Depth = 0;
+		u32 Thread = 0;
+	};
+
+	// Instrumentation profiler. Scopes are written to a lock free ring buffer owned by their thread,
+	// and the main thread drains every buffer once a frame in BeginFrame. The last frame is shown as
+	// a flame view, and a capture of many frames can be saved as Chrome trace JSON (chrome://tracing,
+	// ui.perfetto.dev).
+	//
+	// Timestamps are raw TSC ticks on x86 (invariant TSC assumed) and steady clock nanoseconds
+	// elsewhere; they're converted to time only when displayed or exported.
+	class Profiler
+	{
+	public:
+		static constexpr u32 EVENTS_PER_THREAD = 1u << 14;
+		static constexpr uSize MAX_CAPTURE_EVENTS = 4u * 1024 * 1024;
+
+		Profiler() = delete;
+
+		static void Init();
+		static void Shutdown();
+
+		// Scopes started while disabled aren't recorded. Enabled by default
+		static void SetEnabled(b8 enabled);
+		[[nodiscard]] static b8 IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+		// Shown in the flame view and in the trace instead of the thread index
+		static void SetThreadName(StringView name);
+
+		// Drains the thread buffers and starts a new frame in the flame view
+		static void BeginFrame();
+
+		// Keeps every drained event until EndCapture writes them out
+		static void BeginCapture();
+		static b8 EndCapture(const String& path);
+		[[nodiscard]] static b8 IsCapturing();
+
+		// Stable copy of a runtime name (e.g. a render graph pass), for scopes named at runtime
+		[[nodiscard]] static const c8* InternName(StringView name);
+
+		static void OnImGui();
+
+		static u64 ReadTicks()
+		{
+#if defined(ZN_CPU_X86)
+			return __rdtsc();
+#else
+			return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+		}
+
+		[[nodiscard]] static f64 TicksToMs(u64 ticks);
+
+		// Called by ProfileScope. BeginScope returns the nesting depth of the new scope
+		static u32 BeginScope();
+		static void EndScope(const c8* name, u64 beginTicks, u64 endTicks, u32 depth);
+
+	private:
+		static std::atomic<b8> s_enabled;
+	};
+
+	class ProfileScope
+	{
+	public:
+		explicit ProfileScope(const c8* name)
+		{
+			if (Profiler::IsEnabled())
+			{
+				m_name = name;
+				m_depth = Profiler::BeginScope();
+				m_beginTicks = Profiler::ReadTicks();
+			}
+		}
+
+		~ProfileScope()
+		{
+			if (m_name)
+			{
+				Profiler::EndScope(m_name, m_beginTicks, Profiler::ReadTicks(), m_depth);
+			}
+		}
+
+		ProfileScope(const ProfileScope& other) = delete;
+		ProfileScope(ProfileScope&& other) noexcept = delete;
+
+		ProfileScope& operator=(const ProfileScope& other) = delete;
+		ProfileScope& operator=(ProfileScope&& other) noexcept = delete;
+
+	private:
+		const c8* m_name = nullptr;
+		u64 m_beginTicks = 0;
+		u32 m_depth = 0;
+	};
+}
+
+#if defined(ZN_PROFILING)
+	#define ZN_PROFILE_SCOPE(name) ::zn::ProfileScope ZN_CONCAT_MACRO(profileScope, __LINE__)(name)
+	#define ZN_PROFILE_SCOPE_DYNAMIC(name) ::zn::ProfileScope ZN_CONCAT_MACRO(profileScope, __LINE__)(::zn::Profiler::InternName(name))
+	#define ZN_PROFILE_FUNCTION() ZN_PROFILE_SCOPE(__FUNCTION__)
+#else
+	#define ZN_PROFILE_SCOPE(name)
+	#define ZN_PROFILE_SCOPE_DYNAMIC(name)
+	#define ZN_PROFILE_FUNCTION()
+#endif
@@ -0,0 +1,383 @@
+#include "StatsRegistry.hpp"
+
+#include "Core/Assert.hpp"
+#include "Core/Log.hpp"
+#include "Memory/AllocationGuard.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+
+namespace zn
+{
+	namespace
+	{
+		constexpr u32 MAX_STATS = StatsRegistry::MAX_STATS;
+		constexpr u32 HISTORY_SIZE = StatsRegistry::HISTORY_SIZE;
+
+		// Plotted with its percentiles at the top of the overlay
+		constexpr StringView FRAME_TIME_STAT = "Frame/Frame ms";
+
+		constexpr u32 CSV_FLUSH_INTERVAL = 120;
+
+		// Only the owning thread writes Totals, so plain load + store is enough to add to them
+		struct ThreadTotals
+		{
+			Array<std::atomic<i64>, MAX_STATS> Totals{};
+			Array<i64, MAX_STATS> Collected{}; // Totals as of the last EndFrame, main thread only
+		};
+
+		std::mutex s_threadsMutex;
+		Vector<UniquePtr<ThreadTotals>> s_threads;
+		thread_local ThreadTotals* t_totals = nullptr;
+
+		// Names and kinds are written before the count is published, so readers never lock
+		std::mutex s_registryMutex;
+		Array<String, MAX_STATS> s_names;
+		Array<StatKind, MAX_STATS> s_kinds{};
+		std::atomic<u32> s_statCount{0};
+
+		Array<std::atomic<f64>, MAX_STATS> s_gauges{};
+
+		// Main thread only
+		Array<Array<f64, HISTORY_SIZE>, MAX_STATS> s_history{};
+		u32 s_historyHead = 0;
+		u32 s_historyCount = 0;
+		u64 s_frameIndex = 0;
+
+		std::ofstream s_csv;
+		u32 s_csvColumns = 0;
+		u64 s_csvRows = 0;
+
+		ThreadTotals& GetThreadTotals()
+		{
+			if (t_totals == nullptr)
+			{
+				// The first stat of a thread may be added inside a no-alloc region
+				ZN_ALLOW_ALLOC_SCOPE();
+
+				UniquePtr<ThreadTotals> totals = CreateUnique<ThreadTotals>();
+
+				std::lock_guard lock(s_threadsMutex);
+				t_totals = totals.get();
+				s_threads.push_back(std::move(totals));
+			}
+
+			return *t_totals;
+		}
+
+		StringView GetCategory(StringView name)
+		{
+			const uSize separator = name.find('/');
+			return separator == StringView::npos ? StringView("Other") : name.substr(0, separator);
+		}
+
+		StringView GetShortName(StringView name)
+		{
+			const uSize separator = name.find('/');
+			return separator == StringView::npos ? name : name.substr(separator + 1);
+		}
+
+		// Oldest first, as ImGui plots it
+		u32 CopyHistory(StatId id, Array<f32, HISTORY_SIZE>& values)
+		{
+			for (u32 i = 0; i < s_historyCount; ++i)
+			{
+				values[i] = static_cast<f32>(StatsRegistry::GetHistory(id, s_historyCount - 1 - i));
+			}
+
+			return s_historyCount;
+		}
+	}
+
+	StatId StatsRegistry::Register(StringView name, StatKind kind)
+	{
+		std::lock_guard lock(s_registryMutex);
+
+		const u32 count = s_statCount.load(std::memory_order_relaxed);
+		for (StatId id = 0; id < count; ++id)
+		{
+			if (s_names[id] == name)
+			{
+				ZN_ASSERT(s_kinds[id] == kind, "Stat registered again with a different kind");
+				return id;
+			}
+		}
+
+		if (count == MAX_STATS)
+		{
+			ZN_CORE_WARN("[StatsRegistry::Register] Can't register {}, all {} stats are in use", name, MAX_STATS);
+			return INVALID_STAT;
+		}
+
+		{
+			ZN_ALLOW_ALLOC_SCOPE();
+			s_names[count] = name;
+		}
+		s_kinds[count] = kind;
+		s_statCount.store(count + 1, std::memory_order_release);
+
+		return count;
+	}
+
+	void StatsRegistry::Add(StatId id, i64 value)
+	{
+		if (id == INVALID_STAT)
+			return;
+
+		std::atomic<i64>& total = GetThreadTotals().Totals[id];
+		total.store(total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	void StatsRegistry::Set(StatId id, f64 value)
+	{
+		if (id == INVALID_STAT)
+			return;
+
+		s_gauges[id].store(value, std::memory_order_relaxed);
+	}
+
+	void StatsRegistry::EndFrame()
+	{
+		const u32 count = s_statCount.load(std::memory_order_acquire);
+
+		for (StatId id = 0; id < count; ++id)
+		{
+			if (s_kinds[id] == StatKind::Gauge)
+			{
+				s_history[id][s_historyHead] = s_gauges[id].load(std::memory_order_relaxed);
+			}
+		}
+
+		{
+			std::lock_guard lock(s_threadsMutex);
+
+			for (StatId id = 0; id < count; ++id)
+			{
+				if (s_kinds[id] != StatKind::Counter)
+					continue;
+
+				i64 frameTotal = 0;
+				for (const UniquePtr<ThreadTotals>& totals : s_threads)
+				{
+					const i64 total = totals->Totals[id].load(std::memory_order_relaxed);
+					frameTotal += total - totals->Collected[id];
+					totals->Collected[id] = total;
+				}
+
+				s_history[id][s_historyHead] = static_cast<f64>(frameTotal);
+			}
+		}
+
+		s_historyHead = (s_historyHead + 1) % HISTORY_SIZE;
+		s_historyCount = std::min(s_historyCount + 1, HISTORY_SIZE);
+
+		if (s_csv.is_open())
+		{
+			s_csv << s_frameIndex;
+			for (StatId id = 0; id < s_csvColumns; ++id)
+			{
+				s_csv << ',' << GetValue(id);
+			}
+			s_csv << '\n';
+
+			if (++s_csvRows % CSV_FLUSH_INTERVAL == 0)
+			{
+				s_csv.flush();
+			}
+		}
+
+		s_frameIndex++;
+	}
+
+	u32 StatsRegistry::GetStatCount()
+	{
+		return s_statCount.load(std::memory_order_acquire);
+	}
+
+	StatId StatsRegistry::Find(StringView name)
+	{
+		const u32 count = GetStatCount();
+		for (StatId id = 0; id < count; ++id)
+		{
+			if (s_names[id] == name)
+				return id;
+		}
+
+		return INVALID_STAT;
+	}
+
+	const String& StatsRegistry::GetName(StatId id)
+	{
+		ZN_ASSERT(id < GetStatCount(), "Stat id out of range");
+		return s_names[id];
+	}
+
+	StatKind StatsRegistry::GetKind(StatId id)
+	{
+		ZN_ASSERT(id < GetStatCount(), "Stat id out of range");
+		return s_kinds[id];
+	}
+
+	f64 StatsRegistry::GetValue(StatId id)
+	{
+		return GetHistory(id, 0);
+	}
+
+	f64 StatsRegistry::GetHistory(StatId id, u32 framesAgo)
+	{
+		if (id >= MAX_STATS || framesAgo >= s_historyCount)
+			return 0.0;
+
+		return s_history[id][(s_historyHead + HISTORY_SIZE - 1 - framesAgo) % HISTORY_SIZE];
+	}
+
+	u32 StatsRegistry::GetHistoryCount()
+	{
+		return s_historyCount;
+	}
+
+	f64 StatsRegistry::GetPercentile(StatId id, f64 percentile)
+	{
+		if (id >= MAX_STATS || s_historyCount == 0)
+			return 0.0;
+
+		Array<f64, HISTORY_SIZE> sorted;
+		for (u32 i = 0; i < s_historyCount; ++i)
+		{
+			sorted[i] = GetHistory(id, i);
+		}
+
+		const f64 rank = std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<f64>(s_historyCount - 1);
+		const auto nth = sorted.begin() + static_cast<std::ptrdiff_t>(rank + 0.5);
+		std::nth_element(sorted.begin(), nth, sorted.begin() + s_historyCount);
+
+		return *nth;
+	}
+
+	b8 StatsRegistry::BeginCsvStream(const String& path)
+	{
+		EndCsvStream();
+
+		s_csv.open(path, std::ios::trunc);
+		if (!s_csv)
+		{
+			ZN_CORE_ERROR("[StatsRegistry::BeginCsvStream] Failed to open {}", path);
+			return false;
+		}
+
+		s_csvColumns = GetStatCount();
+		s_csvRows = 0;
+
+		s_csv << "frame";
+		for (StatId id = 0; id < s_csvColumns; ++id)
+		{
+			s_csv << ',' << s_names[id];
+		}
+		s_csv << '\n';
+
+		ZN_CORE_INFO("[StatsRegistry::BeginCsvStream] Streaming {} stats to {}", s_csvColumns, path);
+		return true;
+	}
+
+	void StatsRegistry::EndCsvStream()
+	{
+		if (s_csv.is_open())
+		{
+			s_csv.close();
+			ZN_CORE_INFO("[StatsRegistry::EndCsvStream] Wrote {} frames", s_csvRows);
+		}
+	}
+
+	b8 StatsRegistry::IsCsvStreaming()
+	{
+		return s_csv.is_open();
+	}
+
+	void StatsRegistry::OnImGui()
+	{
+		ImGui::Begin("Statistics");
+
+		if (const StatId frameTime = Find(FRAME_TIME_STAT); frameTime != INVALID_STAT && s_historyCount > 0)
+		{
+			Array<f32, HISTORY_SIZE> values;
+			const u32 count = CopyHistory(frameTime, values);
+
+			const f64 p99 = GetPercentile(frameTime, 99.0);
+
+			c8 overlay[96];
+			std::snprintf(overlay, sizeof(overlay), "p50 %.2f  p95 %.2f  p99 %.2f ms", GetPercentile(frameTime, 50.0), GetPercentile(frameTime, 95.0), p99);
+			ImGui::PlotLines("##FrameTime", values.data(), static_cast<int>(count), 0, overlay, 0.0f, static_cast<f32>(p99 * 1.25), ImVec2(-1.0f, 80.0f));
+		}
+
+		if (!IsCsvStreaming() && ImGui::Button("Stream Stats.csv"))
+		{
+			BeginCsvStream("Stats.csv");
+		}
+		else if (IsCsvStreaming() && ImGui::Button("Stop CSV stream"))
+		{
+			EndCsvStream();
+		}
+
+		const u32 count = GetStatCount();
+
+		// Categories in order of first registration
+		Vector<StringView> categories;
+		for (StatId id = 0; id < count; ++id)
+		{
+			const StringView category = GetCategory(s_names[id]);
+			if (std::find(categories.begin(), categories.end(), category) == categories.end())
+			{
+				categories.push_back(category);
+			}
+		}
+
+		for (const StringView category : categories)
+		{
+			ImGui::PushID(category.data(), category.data() + category.size());
+
+			const String header(category);
+			if (ImGui::CollapsingHeader(header.c_str(), ImGuiTreeNodeFlags_DefaultOpen) && ImGui::BeginTable("Stats", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+			{
+				ImGui::TableSetupColumn("Stat");
+				ImGui::TableSetupColumn("Last");
+				ImGui::TableSetupColumn("Average");
+				ImGui::TableSetupColumn("Max");
+				ImGui::TableHeadersRow();
+
+				for (StatId id = 0; id < count; ++id)
+				{
+					if (GetCategory(s_names[id]) != category)
+						continue;
+
+					f64 sum = 0.0;
+					f64 max = 0.0;
+					for (u32 i = 0; i < s_historyCount; ++i)
+					{
+						const f64 value = GetHistory(id, i);
+						sum += value;
+						max = std::max(max, value);
+					}
+
+					const StringView name = GetShortName(s_names[id]);
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn(); ImGui::Text("%.*s", static_cast<int>(name.size()), name.data());
+					ImGui::TableNextColumn(); ImGui::Text("%.2f", GetValue(id));
+					ImGui::TableNextColumn(); ImGui::Text("%.2f", s_historyCount > 0 ? sum / s_historyCount : 0.0);
+					ImGui::TableNextColumn(); ImGui::Text("%.2f", max);
+				}
+
+				ImGui::EndTable();
+			}
+
+			ImGui::PopID();
+		}
+
+		ImGui::End();
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+namespace zn
+{
+	using StatId = u32;
+
+	enum class StatKind : u8
+	{
+		Counter, // Summed over a frame and reset for the next one (draw calls, event posts...)
+		Gauge    // Keeps the last value set (frame time, memory in use...)
+	};
+
+	// Engine wide counters and gauges, sampled once per frame into rolling histories.
+	//
+	// Counters are accumulated per thread without atomic read-modify-writes: each thread only ever
+	// adds to its own running totals, and EndFrame takes the difference to the totals it saw last
+	// frame. Names are "Category/Name"; the category groups stats in the overlay and the CSV.
+	class StatsRegistry
+	{
+	public:
+		static constexpr u32 MAX_STATS = 128;
+		static constexpr u32 HISTORY_SIZE = 512;
+		static constexpr StatId INVALID_STAT = U32_MAX;
+
+		StatsRegistry() = delete;
+
+		// Registering an existing name returns its id. Returns INVALID_STAT once MAX_STATS is reached
+		static StatId Register(StringView name, StatKind kind);
+
+		static void Add(StatId id, i64 value = 1);
+		static void Set(StatId id, f64 value);
+
+		// Main thread, once per frame: snapshots every stat into its history and streams the CSV row
+		static void EndFrame();
+
+		[[nodiscard]] static u32 GetStatCount();
+		[[nodiscard]] static StatId Find(StringView name);
+		[[nodiscard]] static const String& GetName(StatId id);
+		[[nodiscard]] static StatKind GetKind(StatId id);
+
+		// Value of the last finished frame
+		[[nodiscard]] static f64 GetValue(StatId id);
+		// Value framesAgo frames back, 0 is the last finished frame
+		[[nodiscard]] static f64 GetHistory(StatId id, u32 framesAgo);
+		[[nodiscard]] static u32 GetHistoryCount();
+		// Percentile (0-100) over the rolling history
+		[[nodiscard]] static f64 GetPercentile(StatId id, f64 percentile);
+
+		// Appends one row per frame to a CSV file, for soak tests. Stats registered after the stream
+		// starts are left out of it
+		static b8 BeginCsvStream(const String& path);
+		static void EndCsvStream();
+		[[nodiscard]] static b8 IsCsvStreaming();
+
+		static void OnImGui();
+	};
+}
+
+// Registers the stat on first use, so call sites don't need to keep the id around
+#define ZN_STAT_ADD(name, value) \
+	do { \
+		static const ::zn::StatId ZN_CONCAT_MACRO(statId, __LINE__) = ::zn::StatsRegistry::Register(name, ::zn::StatKind::Counter); \
+		::zn::StatsRegistry::Add(ZN_CONCAT_MACRO(statId, __LINE__), static_cast<::zn::i64>(value)); \
+	} while (0)
+
+#define ZN_STAT_SET(name, value) \
+	do { \
+		static const ::zn::StatId ZN_CONCAT_MACRO(statId, __LINE__) = ::zn::StatsRegistry::Register(name, ::zn::StatKind::Gauge); \
+		::zn::StatsRegistry::Set(ZN_CONCAT_MACRO(statId, __LINE__), static_cast<::zn::f64>(value)); \
+	} while (0)
@@ -0,0 +1,180 @@
+#include "TaskGraph.hpp"
+
+#include "Core/Assert.hpp"
+#include "Core/Profiler.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace zn
+{
+	namespace
+	{
+		f64 ToMs(std::chrono::steady_clock::duration duration)
+		{
+			return std::chrono::duration<f64, std::milli>(duration).count();
+		}
+	}
+
+	TaskId TaskGraph::AddTask(StringView name, TaskAffinity affinity, Func<void()> function, const Vector<TaskId>& dependencies)
+	{
+		ZN_ASSERT(m_pendingTasks.load() == 0, "Tasks can't be added while the graph executes");
+
+		const TaskId id = static_cast<TaskId>(m_tasks.size());
+
+		Task& task = m_tasks.emplace_back();
+		task.Name = String(name);
+		task.Affinity = affinity;
+		task.Function = std::move(function);
+		task.Dependencies = dependencies;
+
+		for (TaskId dependency : dependencies)
+		{
+			ZN_ASSERT(dependency < id, "Tasks can only depend on tasks added before them");
+			m_tasks[dependency].Dependents.push_back(id);
+		}
+
+		m_remainingDependencies = CreateUnique<std::atomic<u32>[]>(m_tasks.size());
+		m_timings.resize(m_tasks.size());
+
+		return id;
+	}
+
+	void TaskGraph::Execute()
+	{
+		if (m_tasks.empty())
+			return;
+
+		m_executeStart = Clock::now();
+		m_pendingTasks.store(static_cast<u32>(m_tasks.size()), std::memory_order_relaxed);
+
+		for (TaskId task = 0; task < m_tasks.size(); ++task)
+		{
+			m_remainingDependencies[task].store(static_cast<u32>(m_tasks[task].Dependencies.size()), std::memory_order_relaxed);
+		}
+
+		for (TaskId task = 0; task < m_tasks.size(); ++task)
+		{
+			if (m_tasks[task].Dependencies.empty())
+			{
+				Schedule(task);
+			}
+		}
+
+		while (m_pendingTasks.load(std::memory_order_acquire) > 0)
+		{
+			Opt<TaskId> mainTask;
+			{
+				std::lock_guard lock(m_mainQueueMutex);
+				if (!m_mainQueue.empty())
+				{
+					// Oldest first, so main thread tasks run in the order they became ready
+					mainTask = m_mainQueue.front();
+					m_mainQueue.erase(m_mainQueue.begin());
+				}
+			}
+
+			if (mainTask)
+			{
+				RunTask(mainTask.value());
+			}
+			else if (!JobSystem::RunPendingJob())
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		// The last task may still be returning from its job
+		JobSystem::Wait(m_jobs);
+
+		m_lastTimings = m_timings;
+		m_lastExecuteMs = ToMs(Clock::now() - m_executeStart);
+	}
+
+	void TaskGraph::Schedule(TaskId task)
+	{
+		if (m_tasks[task].Affinity == TaskAffinity::MainThread)
+		{
+			std::lock_guard lock(m_mainQueueMutex);
+			m_mainQueue.push_back(task);
+			return;
+		}
+
+		JobSystem::Run([this, task] { RunTask(task); }, m_jobs);
+	}
+
+	void TaskGraph::RunTask(TaskId task)
+	{
+		const Clock::time_point start = Clock::now();
+
+		if (m_tasks[task].Function)
+		{
+			ZN_PROFILE_SCOPE(m_tasks[task].Name.c_str());
+			m_tasks[task].Function();
+		}
+
+		TaskTiming& timing = m_timings[task];
+		timing.StartMs = ToMs(start - m_executeStart);
+		timing.EndMs = ToMs(Clock::now() - m_executeStart);
+		timing.Worker = JobSystem::GetWorkerIndex();
+
+		for (TaskId dependent : m_tasks[task].Dependents)
+		{
+			if (m_remainingDependencies[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				Schedule(dependent);
+			}
+		}
+
+		m_pendingTasks.fetch_sub(1, std::memory_order_release);
+	}
+
+	void TaskGraph::OnImGui() const
+	{
+		ImGui::Begin("Frame tasks");
+
+		ImGui::Text("Last frame: %.3f ms", m_lastExecuteMs);
+		ImGui::Separator();
+
+		// One row per task, bar placed on a timeline spanning the whole Execute
+		const f32 nameWidth = 140.0f;
+		const f32 barHeight = ImGui::GetTextLineHeight();
+		const f32 timelineWidth = std::max(ImGui::GetContentRegionAvail().x - nameWidth, 50.0f);
+		const f64 span = std::max(m_lastExecuteMs, 0.001);
+
+		ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+		for (TaskId task = 0; task < m_tasks.size() && task < m_lastTimings.size(); ++task)
+		{
+			const TaskTiming& timing = m_lastTimings[task];
+
+			ImGui::Text("%s", m_tasks[task].Name.c_str());
+			ImGui::SameLine(nameWidth);
+
+			const ImVec2 origin = ImGui::GetCursorScreenPos();
+			const f32 x0 = origin.x + static_cast<f32>(timing.StartMs / span) * timelineWidth;
+			const f32 x1 = origin.x + std::max(static_cast<f32>(timing.EndMs / span) * timelineWidth, x0 - origin.x + 2.0f);
+
+			const ImU32 color = m_tasks[task].Affinity == TaskAffinity::MainThread ? IM_COL32(220, 140, 60, 255) : IM_COL32(80, 160, 220, 255);
+			drawList->AddRectFilled(ImVec2(x0, origin.y), ImVec2(x1, origin.y + barHeight), color);
+			ImGui::Dummy(ImVec2(timelineWidth, barHeight));
+
+			if (ImGui::IsItemHovered())
+			{
+				ImGui::BeginTooltip();
+				ImGui::Text("%s: %.3f ms (%.3f - %.3f), worker %u", m_tasks[task].Name.c_str(), timing.EndMs - timing.StartMs, timing.StartMs, timing.EndMs, timing.Worker);
+
+				for (TaskId dependency : m_tasks[task].Dependencies)
+				{
+					ImGui::Text("  after %s", m_tasks[dependency].Name.c_str());
+				}
+
+				ImGui::EndTooltip();
+			}
+		}
+
+		ImGui::End();
+	}
+}
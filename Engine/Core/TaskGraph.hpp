@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Core/JobSystem.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace zn
+{
+	enum class TaskAffinity : u8
+	{
+		Any,        // Runs as a job on whichever thread picks it up
+		MainThread, // Windowing and GL work
+	};
+
+	using TaskId = u32;
+
+	// Fixed set of tasks with explicit dependencies, executed once per Execute. Tasks whose
+	// dependencies are done run concurrently on the job system; main thread tasks are run by the
+	// thread calling Execute, which runs jobs while it has nothing else to do.
+	//
+	// Tasks can only depend on tasks added before them, so the graph can't have cycles.
+	class TaskGraph
+	{
+	public:
+		struct TaskTiming
+		{
+			f64 StartMs = 0.0; // Relative to the start of Execute
+			f64 EndMs = 0.0;
+			u32 Worker = 0;    // JobSystem worker index, 0 is the main thread
+		};
+
+		TaskGraph() = default;
+		~TaskGraph() = default;
+
+		TaskGraph(const TaskGraph& other) = delete;
+		TaskGraph(TaskGraph&& other) noexcept = delete;
+
+		TaskGraph& operator=(const TaskGraph& other) = delete;
+		TaskGraph& operator=(TaskGraph&& other) noexcept = delete;
+
+		TaskId AddTask(StringView name, TaskAffinity affinity, Func<void()> function, const Vector<TaskId>& dependencies = {});
+
+		// Runs every task once and returns when all of them finished. Main thread only
+		void Execute();
+
+		// Tasks with their dependencies and a timeline of the last Execute
+		void OnImGui() const;
+
+		[[nodiscard]] const Vector<TaskTiming>& GetLastTimings() const { return m_lastTimings; }
+		[[nodiscard]] f64 GetLastExecuteMs() const { return m_lastExecuteMs; }
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct Task
+		{
+			String Name;
+			TaskAffinity Affinity = TaskAffinity::Any;
+			Func<void()> Function;
+			Vector<TaskId> Dependencies;
+			Vector<TaskId> Dependents;
+		};
+
+		void Schedule(TaskId task);
+		void RunTask(TaskId task);
+
+		Vector<Task> m_tasks;
+
+		// State of the running Execute
+		UniquePtr<std::atomic<u32>[]> m_remainingDependencies;
+		std::atomic<u32> m_pendingTasks{0};
+		std::mutex m_mainQueueMutex;
+		Vector<TaskId> m_mainQueue;
+		JobCounter m_jobs;
+		Clock::time_point m_executeStart;
+		Vector<TaskTiming> m_timings;
+
+		Vector<TaskTiming> m_lastTimings;
+		f64 m_lastExecuteMs = 0.0;
+	};
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Core/Assert.hpp"
+#include "Core/Base.hpp"
+
+#include <atomic>
+
+namespace zn
+{
+	// Fixed capacity Chase-Lev deque (with the memory orderings from Le et al., "Correct and Efficient
+	// Work-Stealing for Weak Memory Models"). The owning thread pushes and pops at the bottom without
+	// locking, any other thread steals from the top; only the last item is contended.
+	template<typename T>
+	class WorkStealingDeque
+	{
+	public:
+		explicit WorkStealingDeque(u32 capacity)
+			: m_items(capacity), m_mask(static_cast<i64>(capacity) - 1)
+		{
+			ZN_ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0, "WorkStealingDeque capacity must be a power of two");
+		}
+
+		WorkStealingDeque(const WorkStealingDeque& other) = delete;
+		WorkStealingDeque(WorkStealingDeque&& other) noexcept = delete;
+
+		WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+		WorkStealingDeque& operator=(WorkStealingDeque&& other) noexcept = delete;
+
+		// Owner only. Returns false when full
+		b8 Push(T* item)
+		{
+			const i64 bottom = m_bottom.load(std::memory_order_relaxed);
+			const i64 top = m_top.load(std::memory_order_acquire);
+
+			if (bottom - top > m_mask)
+				return false;
+
+			// Release publishes the item (and what it points to) to thieves reading bottom with acquire
+			m_items[bottom & m_mask].store(item, std::memory_order_relaxed);
+			m_bottom.store(bottom + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		// Owner only. Most recently pushed item, nullptr when empty
+		T* Pop()
+		{
+			const i64 bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+			m_bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			i64 top = m_top.load(std::memory_order_relaxed);
+
+			if (top > bottom)
+			{
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			T* item = m_items[bottom & m_mask].load(std::memory_order_relaxed);
+
+			// Last item, race the thieves for it
+			if (top == bottom)
+			{
+				if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				{
+					item = nullptr;
+				}
+
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+
+			return item;
+		}
+
+		// Any thread. Oldest item, nullptr when empty or when another thread won the race
+		T* Steal()
+		{
+			i64 top = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const i64 bottom = m_bottom.load(std::memory_order_acquire);
+
+			if (top >= bottom)
+				return nullptr;
+
+			T* item = m_items[top & m_mask].load(std::memory_order_relaxed);
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+
+			return item;
+		}
+
+		// Approximate when other threads are pushing or stealing
+		[[nodiscard]] b8 IsEmpty() const
+		{
+			return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+		}
+
+	private:
+		// Thieves hammer top while the owner works on bottom, keep them on different cache lines
+		alignas(64) std::atomic<i64> m_top{0};
+		alignas(64) std::atomic<i64> m_bottom{0};
+
+		Vector<std::atomic<T*>> m_items;
+		i64 m_mask = 0;
+	};
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Math/Bounds.hpp"
+#include "Math/Math.hpp"
+
+namespace zn
+{
+    class Frustum
+    {
+    public:
+        Frustum() = default;
+
+        // Extracts the six clip planes from a (projection * view) matrix (Gribb & Hartmann).
+        // Planes point inwards and are normalized
+        explicit Frustum(const math::m4& viewProjection)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                const math::v4 row{ viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i] };
+                const math::v4 w{ viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3] };
+
+                m_planes[i * 2 + 0] = w + row;
+                m_planes[i * 2 + 1] = w - row;
+            }
+
+            for (math::v4& plane : m_planes)
+            {
+                const f32 length = glm::length(math::v3(plane));
+                plane = plane * (1.0f / length);
+            }
+        }
+
+        [[nodiscard]] b8 Intersects(const math::AABB& box) const
+        {
+            for (const math::v4& plane : m_planes)
+            {
+                // Corner of the box furthest along the plane normal
+                const math::v3 positive{
+                    plane.x >= 0.0f ? box.Max.x : box.Min.x,
+                    plane.y >= 0.0f ? box.Max.y : box.Min.y,
+                    plane.z >= 0.0f ? box.Max.z : box.Min.z };
+
+                if (glm::dot(math::v3(plane), positive) + plane.w < 0.0f)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        // Left, Right, Bottom, Top, Near, Far
+        Array<math::v4, 6> m_planes{};
+    };
+}
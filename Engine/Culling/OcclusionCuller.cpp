@@ -0,0 +1,457 @@
+#include "OcclusionCuller.hpp"
+
+#include "Core/Assert.hpp"
+#include "Core/CpuFeatures.hpp"
+#include "Core/Log.hpp"
+#include "Core/Timer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(ZN_CPU_X86)
+    #include <immintrin.h>
+#endif
+
+namespace zn
+{
+    namespace
+    {
+        enum Visibility : u8
+        {
+            Visible = 0,
+            FrustumCulled,
+            Occluded,
+        };
+
+        // Vertices closer than this (in clip space w) are not handled by the rasterizer
+        constexpr f32 MIN_CLIP_W = 1e-4f;
+
+        // Smallest batch of candidates tested per job. Small batches are not worth the handoff
+        constexpr uSize CANDIDATES_PER_TASK = 512;
+
+        f32 ToDepth(f32 ndcZ)
+        {
+            return ndcZ * 0.5f + 0.5f;
+        }
+
+        struct EdgeFunction
+        {
+            f32 A, B, C;
+
+            [[nodiscard]] f32 Evaluate(f32 x, f32 y) const { return A * x + B * y + C; }
+        };
+
+        // Edges of a counter-clockwise triangle, positive inside
+        Array<EdgeFunction, 3> SetupEdges(const Array<f32, 3>& x, const Array<f32, 3>& y)
+        {
+            Array<EdgeFunction, 3> edges{};
+            for (int i = 0; i < 3; ++i)
+            {
+                const int j = (i + 1) % 3;
+                edges[i].A = y[i] - y[j];
+                edges[i].B = x[j] - x[i];
+                edges[i].C = (y[j] - y[i]) * x[i] - (x[j] - x[i]) * y[i];
+            }
+
+            return edges;
+        }
+    }
+
+    OcclusionCuller::OcclusionCuller(u32 width, u32 height)
+    {
+        ZN_ASSERT(width % TILE_WIDTH == 0 && height % TILE_HEIGHT == 0, "Occlusion buffer size must be a multiple of the tile size");
+
+        m_width = width;
+        m_height = height;
+        m_tilesX = width / TILE_WIDTH;
+        m_tilesY = height / TILE_HEIGHT;
+
+        m_depth.resize(static_cast<uSize>(m_width) * m_height, 1.0f);
+        m_tileMaxDepth.resize(static_cast<uSize>(m_tilesX) * m_tilesY, 1.0f);
+
+        m_useAVX2 = CpuFeatures::Supports(CpuIsa::AVX2);
+        ZN_LOG_INFO(Renderer, "[OcclusionCuller] {}x{} depth buffer, rasterizer path: {}", m_width, m_height, m_useAVX2 ? "AVX2" : "Scalar");
+    }
+
+    OcclusionCuller::~OcclusionCuller()
+    {
+        if (m_inFlight)
+        {
+            JobSystem::Wait(m_task);
+        }
+    }
+
+    void OcclusionCuller::BeginFrame(const math::m4& viewProjection)
+    {
+        ZN_ASSERT(!m_inFlight, "OcclusionCuller::BeginFrame called while the previous frame is still in flight");
+
+        m_viewProjection = viewProjection;
+        m_frustum = Frustum(viewProjection);
+
+        // Picked up per frame so a forced ISA applies without recreating the culler
+        m_useAVX2 = CpuFeatures::Supports(CpuIsa::AVX2);
+
+        m_occluders.clear();
+        m_candidates.clear();
+        m_visibility.clear();
+    }
+
+    void OcclusionCuller::AddOccluder(const f32* positions, u32 vertexCount, const math::m4& model)
+    {
+        ZN_ASSERT(vertexCount % 3 == 0, "Occluders must be triangle lists");
+        m_occluders.push_back({ positions, vertexCount, model });
+    }
+
+    u32 OcclusionCuller::AddCandidate(const math::AABB& worldBounds)
+    {
+        m_candidates.push_back(worldBounds);
+        return static_cast<u32>(m_candidates.size() - 1);
+    }
+
+    void OcclusionCuller::Kick()
+    {
+        ZN_ASSERT(!m_inFlight, "OcclusionCuller::Kick called twice in the same frame");
+
+        m_visibility.assign(m_candidates.size(), Visible);
+        m_inFlight = true;
+        JobSystem::Run([this] { Execute(); }, m_task);
+    }
+
+    void OcclusionCuller::Wait()
+    {
+        if (!m_inFlight)
+        {
+            return;
+        }
+
+        Time::Timer waitTimer;
+        waitTimer.Start();
+        JobSystem::Wait(m_task);
+        m_inFlight = false;
+        m_stats.WaitTimeMs = waitTimer.GetElapsedTime() * 1000.0;
+    }
+
+    b8 OcclusionCuller::IsVisible(u32 candidate) const
+    {
+        ZN_ASSERT(!m_inFlight, "Querying occlusion results before calling Wait()");
+
+        if (candidate >= m_visibility.size())
+        {
+            return true;
+        }
+
+        return m_visibility[candidate] == Visible;
+    }
+
+    void OcclusionCuller::Execute()
+    {
+        Time::Timer timer;
+        timer.Start();
+
+        m_stats.Candidates = static_cast<u32>(m_candidates.size());
+        m_stats.RasterizedTriangles = 0;
+
+        RasterizeOccluders();
+
+        // The depth buffer is read-only from here on, so candidates can be tested from several threads
+        JobSystem::ParallelFor(static_cast<u32>(m_candidates.size()), static_cast<u32>(CANDIDATES_PER_TASK), [this](u32 begin, u32 end)
+        {
+            TestCandidates(begin, end);
+        });
+
+        m_stats.FrustumRejected = static_cast<u32>(std::count(m_visibility.begin(), m_visibility.end(), FrustumCulled));
+        m_stats.OcclusionRejected = static_cast<u32>(std::count(m_visibility.begin(), m_visibility.end(), Occluded));
+        m_stats.CullingTimeMs = timer.GetElapsedTime() * 1000.0;
+    }
+
+    void OcclusionCuller::RasterizeOccluders()
+    {
+        std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+        std::fill(m_tileMaxDepth.begin(), m_tileMaxDepth.end(), 1.0f);
+
+        if (!m_enabled)
+        {
+            return;
+        }
+
+        const f32 halfWidth = static_cast<f32>(m_width) * 0.5f;
+        const f32 halfHeight = static_cast<f32>(m_height) * 0.5f;
+
+        for (const Occluder& occluder : m_occluders)
+        {
+            const math::m4 modelViewProjection = m_viewProjection * occluder.Model;
+
+            for (u32 v = 0; v < occluder.VertexCount; v += 3)
+            {
+                ScreenTriangle triangle{};
+                triangle.MaxDepth = 0.0f;
+
+                b8 clipped = false;
+                for (u32 i = 0; i < 3; ++i)
+                {
+                    const f32* p = occluder.Positions + (v + i) * 3;
+                    const math::v4 clip = modelViewProjection * math::v4(p[0], p[1], p[2], 1.0f);
+
+                    // Triangles crossing the near plane would need clipping. Dropping them only
+                    // loses some occlusion, it never hides something visible
+                    if (clip.w < MIN_CLIP_W)
+                    {
+                        clipped = true;
+                        break;
+                    }
+
+                    const f32 invW = 1.0f / clip.w;
+                    triangle.X[i] = (clip.x * invW + 1.0f) * halfWidth;
+                    triangle.Y[i] = (clip.y * invW + 1.0f) * halfHeight;
+                    triangle.MaxDepth = std::max(triangle.MaxDepth, ToDepth(clip.z * invW));
+                }
+
+                if (clipped || triangle.MaxDepth > 1.0f)
+                {
+                    continue;
+                }
+
+                RasterizeTriangle(triangle);
+                ++m_stats.RasterizedTriangles;
+            }
+        }
+    }
+
+    void OcclusionCuller::RasterizeTriangle(const ScreenTriangle& triangle)
+    {
+        ScreenTriangle tri = triangle;
+
+        const f32 area = (tri.X[1] - tri.X[0]) * (tri.Y[2] - tri.Y[0]) - (tri.X[2] - tri.X[0]) * (tri.Y[1] - tri.Y[0]);
+        if (std::abs(area) < F32_EPSILON)
+        {
+            return;
+        }
+
+        // Occluders are rasterized double sided, so just make every triangle counter-clockwise
+        if (area < 0.0f)
+        {
+            std::swap(tri.X[1], tri.X[2]);
+            std::swap(tri.Y[1], tri.Y[2]);
+        }
+
+        const f32 minX = std::min({ tri.X[0], tri.X[1], tri.X[2] });
+        const f32 maxX = std::max({ tri.X[0], tri.X[1], tri.X[2] });
+        const f32 minY = std::min({ tri.Y[0], tri.Y[1], tri.Y[2] });
+        const f32 maxY = std::max({ tri.Y[0], tri.Y[1], tri.Y[2] });
+
+        if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<f32>(m_width) || minY >= static_cast<f32>(m_height))
+        {
+            return;
+        }
+
+        const u32 pixelX0 = static_cast<u32>(std::max(minX, 0.0f));
+        const u32 pixelY0 = static_cast<u32>(std::max(minY, 0.0f));
+        const u32 pixelX1 = static_cast<u32>(std::min(maxX, static_cast<f32>(m_width - 1)));
+        const u32 pixelY1 = static_cast<u32>(std::min(maxY, static_cast<f32>(m_height - 1)));
+
+        const u32 tileX0 = pixelX0 / TILE_WIDTH;
+        const u32 tileX1 = pixelX1 / TILE_WIDTH;
+        const u32 tileY0 = pixelY0 / TILE_HEIGHT;
+        const u32 tileY1 = pixelY1 / TILE_HEIGHT;
+
+#if defined(ZN_CPU_X86)
+        if (m_useAVX2)
+        {
+            RasterizeTriangleAVX2(tri, tileX0, tileX1, tileY0, tileY1);
+            return;
+        }
+#endif
+        RasterizeTriangleScalar(tri, tileX0, tileX1, tileY0, tileY1);
+    }
+
+    void OcclusionCuller::RasterizeTriangleScalar(const ScreenTriangle& triangle, u32 tileX0, u32 tileX1, u32 tileY0, u32 tileY1)
+    {
+        const Array<EdgeFunction, 3> edges = SetupEdges(triangle.X, triangle.Y);
+
+        for (u32 tileY = tileY0; tileY <= tileY1; ++tileY)
+        {
+            for (u32 tileX = tileX0; tileX <= tileX1; ++tileX)
+            {
+                const uSize tileIndex = static_cast<uSize>(tileY) * m_tilesX + tileX;
+                f32* tileDepth = &m_depth[tileIndex * TILE_WIDTH * TILE_HEIGHT];
+
+                f32 tileMax = 0.0f;
+                for (u32 row = 0; row < TILE_HEIGHT; ++row)
+                {
+                    const f32 y = static_cast<f32>(tileY * TILE_HEIGHT + row) + 0.5f;
+                    for (u32 column = 0; column < TILE_WIDTH; ++column)
+                    {
+                        const f32 x = static_cast<f32>(tileX * TILE_WIDTH + column) + 0.5f;
+                        f32& depth = tileDepth[row * TILE_WIDTH + column];
+
+                        if (edges[0].Evaluate(x, y) >= 0.0f && edges[1].Evaluate(x, y) >= 0.0f && edges[2].Evaluate(x, y) >= 0.0f)
+                        {
+                            depth = std::min(depth, triangle.MaxDepth);
+                        }
+
+                        tileMax = std::max(tileMax, depth);
+                    }
+                }
+
+                m_tileMaxDepth[tileIndex] = tileMax;
+            }
+        }
+    }
+
+#if defined(ZN_CPU_X86)
+    ZN_TARGET_AVX2
+    void OcclusionCuller::RasterizeTriangleAVX2(const ScreenTriangle& triangle, u32 tileX0, u32 tileX1, u32 tileY0, u32 tileY1)
+    {
+        static_assert(TILE_WIDTH == 8, "The AVX2 rasterizer processes one 8-wide tile row per register");
+
+        const Array<EdgeFunction, 3> edges = SetupEdges(triangle.X, triangle.Y);
+
+        const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+        const __m256 triangleDepth = _mm256_set1_ps(triangle.MaxDepth);
+        const __m256 zero = _mm256_setzero_ps();
+
+        Array<__m256, 3> edgeA;
+        for (int i = 0; i < 3; ++i)
+        {
+            edgeA[i] = _mm256_set1_ps(edges[i].A);
+        }
+
+        for (u32 tileY = tileY0; tileY <= tileY1; ++tileY)
+        {
+            for (u32 tileX = tileX0; tileX <= tileX1; ++tileX)
+            {
+                const uSize tileIndex = static_cast<uSize>(tileY) * m_tilesX + tileX;
+                f32* tileDepth = &m_depth[tileIndex * TILE_WIDTH * TILE_HEIGHT];
+
+                const __m256 x = _mm256_add_ps(_mm256_set1_ps(static_cast<f32>(tileX * TILE_WIDTH)), laneOffsets);
+                __m256 tileMax = zero;
+
+                for (u32 row = 0; row < TILE_HEIGHT; ++row)
+                {
+                    const f32 y = static_cast<f32>(tileY * TILE_HEIGHT + row) + 0.5f;
+
+                    // E(x, y) = A * x + (B * y + C)
+                    const __m256 e0 = _mm256_fmadd_ps(edgeA[0], x, _mm256_set1_ps(edges[0].B * y + edges[0].C));
+                    const __m256 e1 = _mm256_fmadd_ps(edgeA[1], x, _mm256_set1_ps(edges[1].B * y + edges[1].C));
+                    const __m256 e2 = _mm256_fmadd_ps(edgeA[2], x, _mm256_set1_ps(edges[2].B * y + edges[2].C));
+
+                    // Inside when no edge function is negative: OR the sign bits together
+                    const __m256 outside = _mm256_or_ps(_mm256_or_ps(e0, e1), e2);
+
+                    f32* rowDepth = tileDepth + row * TILE_WIDTH;
+                    const __m256 current = _mm256_loadu_ps(rowDepth);
+                    const __m256 nearest = _mm256_min_ps(current, triangleDepth);
+                    // blendv picks 'current' where the sign bit of 'outside' is set
+                    const __m256 result = _mm256_blendv_ps(nearest, current, outside);
+
+                    _mm256_storeu_ps(rowDepth, result);
+                    tileMax = _mm256_max_ps(tileMax, result);
+                }
+
+                // Horizontal max of the 8 lanes
+                __m128 max4 = _mm_max_ps(_mm256_castps256_ps128(tileMax), _mm256_extractf128_ps(tileMax, 1));
+                max4 = _mm_max_ps(max4, _mm_movehl_ps(max4, max4));
+                max4 = _mm_max_ss(max4, _mm_shuffle_ps(max4, max4, 0x1));
+
+                m_tileMaxDepth[tileIndex] = _mm_cvtss_f32(max4);
+            }
+        }
+    }
+#else
+    void OcclusionCuller::RasterizeTriangleAVX2(const ScreenTriangle& triangle, u32 tileX0, u32 tileX1, u32 tileY0, u32 tileY1)
+    {
+        RasterizeTriangleScalar(triangle, tileX0, tileX1, tileY0, tileY1);
+    }
+#endif
+
+    void OcclusionCuller::TestCandidates(uSize begin, uSize end)
+    {
+        for (uSize i = begin; i < end; ++i)
+        {
+            const math::AABB& box = m_candidates[i];
+
+            if (!m_frustum.Intersects(box))
+            {
+                m_visibility[i] = FrustumCulled;
+            }
+            else if (m_enabled && !TestBox(box))
+            {
+                m_visibility[i] = Occluded;
+            }
+        }
+    }
+
+    b8 OcclusionCuller::TestBox(const math::AABB& box) const
+    {
+        f32 minX = std::numeric_limits<f32>::max();
+        f32 minY = std::numeric_limits<f32>::max();
+        f32 maxX = std::numeric_limits<f32>::lowest();
+        f32 maxY = std::numeric_limits<f32>::lowest();
+        f32 nearestDepth = 1.0f;
+
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            const math::v4 clip = m_viewProjection * math::v4(box.GetCorner(corner), 1.0f);
+
+            // The box reaches behind the camera, treat it as visible
+            if (clip.w < MIN_CLIP_W)
+            {
+                return true;
+            }
+
+            const f32 invW = 1.0f / clip.w;
+            const f32 x = (clip.x * invW + 1.0f) * 0.5f * static_cast<f32>(m_width);
+            const f32 y = (clip.y * invW + 1.0f) * 0.5f * static_cast<f32>(m_height);
+
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            nearestDepth = std::min(nearestDepth, ToDepth(clip.z * invW));
+        }
+
+        if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<f32>(m_width) || minY >= static_cast<f32>(m_height))
+        {
+            return false;
+        }
+
+        const u32 pixelX0 = static_cast<u32>(std::max(minX, 0.0f));
+        const u32 pixelY0 = static_cast<u32>(std::max(minY, 0.0f));
+        const u32 pixelX1 = static_cast<u32>(std::min(maxX, static_cast<f32>(m_width - 1)));
+        const u32 pixelY1 = static_cast<u32>(std::min(maxY, static_cast<f32>(m_height - 1)));
+
+        for (u32 tileY = pixelY0 / TILE_HEIGHT; tileY <= pixelY1 / TILE_HEIGHT; ++tileY)
+        {
+            for (u32 tileX = pixelX0 / TILE_WIDTH; tileX <= pixelX1 / TILE_WIDTH; ++tileX)
+            {
+                const uSize tileIndex = static_cast<uSize>(tileY) * m_tilesX + tileX;
+
+                // Coarse level: every occluder in this tile is in front of the box
+                if (m_tileMaxDepth[tileIndex] < nearestDepth)
+                {
+                    continue;
+                }
+
+                // Fine level: only the pixels of the tile the box actually covers
+                const u32 x0 = std::max(pixelX0, tileX * TILE_WIDTH);
+                const u32 x1 = std::min(pixelX1, tileX * TILE_WIDTH + TILE_WIDTH - 1);
+                const u32 y0 = std::max(pixelY0, tileY * TILE_HEIGHT);
+                const u32 y1 = std::min(pixelY1, tileY * TILE_HEIGHT + TILE_HEIGHT - 1);
+
+                const f32* tileDepth = &m_depth[tileIndex * TILE_WIDTH * TILE_HEIGHT];
+                for (u32 y = y0; y <= y1; ++y)
+                {
+                    for (u32 x = x0; x <= x1; ++x)
+                    {
+                        if (tileDepth[(y % TILE_HEIGHT) * TILE_WIDTH + (x % TILE_WIDTH)] >= nearestDepth)
+                        {
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+}
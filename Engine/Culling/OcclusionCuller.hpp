@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Core/JobSystem.hpp"
+#include "Culling/Frustum.hpp"
+#include "Math/Bounds.hpp"
+#include "Math/Math.hpp"
+
+namespace zn
+{
+    // CPU occlusion culling in the spirit of Intel's Masked Occlusion Culling.
+    //
+    // A handful of large occluders are rasterized into a small depth buffer laid out in 8x4 pixel tiles
+    // (one AVX2 register per tile row). A second, coarser level keeps the farthest depth of every tile,
+    // so most candidate boxes are accepted or rejected without touching individual pixels.
+    //
+    // Usage per frame:
+    //   BeginFrame(viewProj) -> AddOccluder/AddCandidate -> Kick() -> ...other work... -> Wait() -> IsVisible(i)
+    class OcclusionCuller
+    {
+    public:
+        struct Stats
+        {
+            u32 Candidates = 0;
+            u32 FrustumRejected = 0;
+            u32 OcclusionRejected = 0;
+            u32 RasterizedTriangles = 0;
+
+            f64 CullingTimeMs = 0.0; // Time spent in culling jobs
+            f64 WaitTimeMs = 0.0;    // Time the calling thread spent in Wait(), running jobs meanwhile
+        };
+
+        static constexpr u32 TILE_WIDTH = 8;
+        static constexpr u32 TILE_HEIGHT = 4;
+        static constexpr u32 DEFAULT_WIDTH = 256;
+        static constexpr u32 DEFAULT_HEIGHT = 128;
+
+        OcclusionCuller(u32 width = DEFAULT_WIDTH, u32 height = DEFAULT_HEIGHT);
+        ~OcclusionCuller();
+
+        OcclusionCuller(const OcclusionCuller& other) = delete;
+        OcclusionCuller(OcclusionCuller&& other) noexcept = delete;
+
+        OcclusionCuller& operator=(const OcclusionCuller& other) = delete;
+        OcclusionCuller& operator=(OcclusionCuller&& other) noexcept = delete;
+
+        void BeginFrame(const math::m4& viewProjection);
+
+        // positions is a triangle list of xyz triplets in model space. The data is only
+        // referenced, so it must stay alive until Wait() returns
+        void AddOccluder(const f32* positions, u32 vertexCount, const math::m4& model);
+
+        // Returns the index to query with IsVisible once the results are ready
+        u32 AddCandidate(const math::AABB& worldBounds);
+
+        // Starts rasterization and visibility tests as jobs
+        void Kick();
+        void Wait();
+
+        [[nodiscard]] b8 IsVisible(u32 candidate) const;
+        [[nodiscard]] const Stats& GetStats() const { return m_stats; }
+
+        void SetEnabled(b8 enabled) { m_enabled = enabled; }
+        [[nodiscard]] b8 IsEnabled() const { return m_enabled; }
+
+    private:
+        struct Occluder
+        {
+            const f32* Positions;
+            u32 VertexCount;
+            math::m4 Model;
+        };
+
+        struct ScreenTriangle
+        {
+            Array<f32, 3> X;
+            Array<f32, 3> Y;
+            f32 MaxDepth; // Farthest vertex, keeps the written depth conservative
+        };
+
+        void Execute();
+        void RasterizeOccluders();
+        void TestCandidates(uSize begin, uSize end);
+
+        void RasterizeTriangle(const ScreenTriangle& triangle);
+        void RasterizeTriangleScalar(const ScreenTriangle& triangle, u32 tileX0, u32 tileX1, u32 tileY0, u32 tileY1);
+        void RasterizeTriangleAVX2(const ScreenTriangle& triangle, u32 tileX0, u32 tileX1, u32 tileY0, u32 tileY1);
+
+        [[nodiscard]] b8 TestBox(const math::AABB& box) const;
+
+    private:
+        u32 m_width = 0;
+        u32 m_height = 0;
+        u32 m_tilesX = 0;
+        u32 m_tilesY = 0;
+
+        // Full resolution depth, tile-major: TILE_WIDTH * TILE_HEIGHT consecutive floats per tile
+        Vector<f32> m_depth;
+        // Farthest depth stored in each tile
+        Vector<f32> m_tileMaxDepth;
+
+        math::m4 m_viewProjection{1.0f};
+        Frustum m_frustum;
+
+        Vector<Occluder> m_occluders;
+        Vector<math::AABB> m_candidates;
+        Vector<u8> m_visibility;
+
+        JobCounter m_task;
+        b8 m_inFlight = false; // Kicked and not waited on yet
+        Stats m_stats;
+
+        b8 m_useAVX2 = false;
+        b8 m_enabled = true;
+    };
+}
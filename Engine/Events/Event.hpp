@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Core/Base.hpp"
+#include "Core/StatsRegistry.hpp"
+#include "Memory/AllocationGuard.hpp"
+#include "Memory/MemoryTracker.hpp"
 
 #include <typeindex>
 #include <any>
@@ -74,6 +77,9 @@ namespace zn
 		[[nodiscard]]
 	    SharedPtr<Connection<EventT>> Subscribe(Callable&& callback, int priority = 0, FilterCallable&& filter = nullptr)
 	    {
+	        // Only the handler storage is charged here; handlers allocate under their caller's tag when posted
+	        MemoryTagScope memoryTag(MemoryTag::Events);
+
 	        Func<b8(const EventT&)> func = std::forward<Callable>(callback);
 	    	
 	        Func<b8(const EventT&)> filterFunc;
@@ -83,16 +89,17 @@ namespace zn
 	        }
 
 	        HandlerId id = m_nextHandlerId++;
-	        auto& list = GetHandlerList<EventT>();
 	        HandlerEntry<EventT> entry{ id, priority, std::move(func), std::move(filterFunc) };
 
-	        auto it = std::lower_bound(list.begin(), list.end(), entry,
-	        [](const HandlerEntry<EventT>& a, const HandlerEntry<EventT>& b) 
+	        if (m_postDepth > 0)
 	        {
-	            return a.Priority > b.Priority;
-	        });
+	            m_deferredChanges.push_back([this, entry = std::move(entry)]() mutable { Insert<EventT>(std::move(entry)); });
+	        }
+	        else
+	        {
+	            Insert<EventT>(std::move(entry));
+	        }
 
-	        list.insert(it, std::move(entry));
 	        return CreateShared<Connection<EventT>>(this, id);
 	    }
 
@@ -118,7 +125,24 @@ namespace zn
 	    template<typename EventT>
 	    void Unsubscribe(HandlerId id) 
 	    {
-	        auto& list = GetHandlerList<EventT>();
+	        auto* found = FindHandlerList<EventT>();
+	        if (found == nullptr)
+	            return;
+
+	        auto& list = *found;
+
+	        if (m_postDepth > 0)
+	        {
+	            // The handler may be the one running, so it's only flagged until Post returns
+	            for (auto& entry : list)
+	            {
+	                if (entry.Id == id)
+	                    entry.Removed = true;
+	            }
+
+	            m_deferredChanges.push_back([this, id]() { Unsubscribe<EventT>(id); });
+	            return;
+	        }
 	        
 	        auto it = std::remove_if(list.begin(), list.end(),
 	            [id](const HandlerEntry<EventT>& entry) { return entry.Id == id; });
@@ -129,14 +153,37 @@ namespace zn
 	    template<typename EventT>
 	    void Post(const EventT& event)
 	    {
-	        const auto handlers = GetHandlerList<EventT>();  // Safe copy for iteration
-	        for (const auto& handler : handlers) 
+	        // Handlers run straight from the list instead of a copy of it. Subscribing and unsubscribing
+	        // from inside a handler is applied once the outermost Post returns
+	        ZN_STAT_ADD("Events/Posts", 1);
+
+	        // Looked up without creating the list: a handler may post a type nobody subscribed to yet,
+	        // inside the no-alloc scope of the outer Post
+	        const auto* handlers = FindHandlerList<EventT>();
+	        if (handlers == nullptr)
+	            return;
+
+	        ++m_postDepth;
+	        {
+	            // Dispatch and the handlers must not allocate; applying deferred changes may
+	            ZN_NO_ALLOC_SCOPE("EventSystem::Post");
+
+	            for (const auto& handler : *handlers) 
+	            {
+	                if (handler.Removed)
+	                    continue;
+
+	                if (handler.Filter && !handler.Filter(event))
+	                    continue;
+	                
+	                if (handler.Callback(event))
+	                    break;
+	            }
+	        }
+
+	        if (--m_postDepth == 0 && !m_deferredChanges.empty())
 	        {
-	            if (handler.Filter && !handler.Filter(event))
-	                continue;
-	            
-	            if (handler.Callback(event))
-	                break;
+	            ApplyDeferredChanges();
 	        }
 	    }
 	    
@@ -149,7 +196,34 @@ namespace zn
 	    	
 	        Func<b8(const EventT&)> Callback;
 	        Func<b8(const EventT&)> Filter;
+	        b8 Removed = false;
 	    };
+
+	    template<typename EventT>
+	    void Insert(HandlerEntry<EventT>&& entry)
+	    {
+	        auto& list = GetHandlerList<EventT>();
+
+	        auto it = std::lower_bound(list.begin(), list.end(), entry,
+	        [](const HandlerEntry<EventT>& a, const HandlerEntry<EventT>& b) 
+	        {
+	            return a.Priority > b.Priority;
+	        });
+
+	        list.insert(it, std::move(entry));
+	    }
+
+	    void ApplyDeferredChanges()
+	    {
+	        // Changes may be deferred again if applying one posts an event
+	        Vector<Func<void()>> changes;
+	        changes.swap(m_deferredChanges);
+
+	        for (auto& change : changes)
+	        {
+	            change();
+	        }
+	    }
 	    
 	    template<typename EventT>
 	    Vector<HandlerEntry<EventT>>& GetHandlerList() 
@@ -164,9 +238,23 @@ namespace zn
 	        
 	        return *std::any_cast<Vector<HandlerEntry<EventT>>>(&it->second);
 	    }
+
+	    // Null until something subscribes to EventT
+	    template<typename EventT>
+	    Vector<HandlerEntry<EventT>>* FindHandlerList()
+	    {
+	        auto it = m_handlerMap.find(std::type_index(typeid(EventT)));
+	        if (it == m_handlerMap.end())
+	            return nullptr;
+
+	        return std::any_cast<Vector<HandlerEntry<EventT>>>(&it->second);
+	    }
 	    
 	    UMap<std::type_index, std::any> m_handlerMap;
 	    HandlerId m_nextHandlerId = 0;
+
+	    u32 m_postDepth = 0;
+	    Vector<Func<void()>> m_deferredChanges;
 	};
 }
 
@@ -1,6 +1,7 @@
 ﻿#include "FileSystem.hpp"
 
 #include "Core/Log.hpp"
+#include "Memory/MemoryTracker.hpp"
 
 #include <fstream>
 
@@ -101,12 +102,14 @@ namespace zn
             return entries;
         }
 
-        ZN_CORE_WARN("[FileSystem::ListDirectory] Could not list directory. Returning empty list");
+        ZN_LOG_WARN(FileSystem, "[FileSystem::ListDirectory] Could not list directory. Returning empty list");
         return {};
     }
 
     Opt<Vector<Byte>> FileSystem::ReadFileAsBinary(const String& path)
     {
+        MemoryTagScope memoryTag(MemoryTag::FileSystem);
+
         try
         {
             if (auto fullPath = GetFullPath(path))
@@ -114,7 +117,7 @@ namespace zn
                 std::ifstream file(fullPath.value(), std::ios::binary | std::ios::ate);
                 if (!file.is_open())
                 {
-                    ZN_CORE_ERROR("[FileSystem::ReadFileAsBinary] Failed to open file at '" + path + "'");
+                    ZN_LOG_ERROR(FileSystem, "[FileSystem::ReadFileAsBinary] Failed to open file at '" + path + "'");
                     return std::nullopt;
                 }
 
@@ -124,7 +127,7 @@ namespace zn
                 Vector<Byte> buffer(size);
                 if (!file.read(reinterpret_cast<char*>(buffer.data()), size))
                 {
-                    ZN_CORE_ERROR("[FileSystem::ReadFileAsBinary] Failed to read file at '" + path + "'");
+                    ZN_LOG_ERROR(FileSystem, "[FileSystem::ReadFileAsBinary] Failed to read file at '" + path + "'");
                     return std::nullopt;
                 }
 
@@ -132,7 +135,7 @@ namespace zn
             }
             else
             {
-                ZN_CORE_ERROR("[FileSystem::ReadFileAsBinary] Failed to read file at '" + path + "'");
+                ZN_LOG_ERROR(FileSystem, "[FileSystem::ReadFileAsBinary] Failed to read file at '" + path + "'");
                 return std::nullopt;
             }
         } catch (...)
@@ -143,6 +146,8 @@ namespace zn
 
     Opt<String> FileSystem::ReadFileAsString(const String& path)
     {
+        MemoryTagScope memoryTag(MemoryTag::FileSystem);
+
         try
         {
             if (auto fullPath = GetFullPath(path))
@@ -150,7 +155,7 @@ namespace zn
                 std::ifstream file(fullPath.value(), std::ios::binary | std::ios::ate);
                 if (!file.is_open())
                 {
-                    ZN_CORE_ERROR("[FileSystem::ReadFileAsString] Failed to open file at '" + path + "'");
+                    ZN_LOG_ERROR(FileSystem, "[FileSystem::ReadFileAsString] Failed to open file at '" + path + "'");
                     return std::nullopt;
                 }
 
@@ -162,7 +167,7 @@ namespace zn
             
                 if (!file.read(buffer.data(), size))
                 {
-                    ZN_CORE_ERROR("[FileSystem::ReadFileAsString] Failed to read file at '" + path + "'");
+                    ZN_LOG_ERROR(FileSystem, "[FileSystem::ReadFileAsString] Failed to read file at '" + path + "'");
                     return std::nullopt;
                 }
 
@@ -170,7 +175,7 @@ namespace zn
             }
             else
             {
-                ZN_CORE_ERROR("[FileSystem::ReadFileAsString] Failed to read file at '" + path + "'");
+                ZN_LOG_ERROR(FileSystem, "[FileSystem::ReadFileAsString] Failed to read file at '" + path + "'");
                 return std::nullopt;
             }
         } catch (...)
@@ -186,7 +191,7 @@ namespace zn
             
         if (fileSystemPath.is_absolute())
         {
-            ZN_CORE_ERROR("[FileSystem::GetFullPath] Absolute paths not allowed: " + normalized);
+            ZN_LOG_ERROR(FileSystem, "[FileSystem::GetFullPath] Absolute paths not allowed: " + normalized);
             return std::nullopt;
         }
             
@@ -196,7 +201,7 @@ namespace zn
         Path relativeToRoot = fullPath.lexically_relative(GetRoot());
         if (relativeToRoot.generic_string().find("..") != String::npos)
         {
-            ZN_CORE_ERROR("[FileSystem::GetFullPath] Path escapes root directory: " + normalized);
+            ZN_LOG_ERROR(FileSystem, "[FileSystem::GetFullPath] Path escapes root directory: " + normalized);
             return std::nullopt;
         }
 
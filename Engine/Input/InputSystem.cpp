@@ -21,7 +21,7 @@ namespace zn
     {
         if(!window)
         {
-            ZN_CORE_ERROR("[InputSystem::Init] Failed to initialize InputSystem. Invalid GLFW window");
+            ZN_LOG_ERROR(Input, "[InputSystem::Init] Failed to initialize InputSystem. Invalid GLFW window");
             return false;
         }
 
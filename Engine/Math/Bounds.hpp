@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Math/Math.hpp"
+
+namespace zn::math
+{
+    //-----------------------------------------------------------------------------
+    // Axis Aligned Bounding Box
+    //-----------------------------------------------------------------------------
+    struct AABB
+    {
+        v3 Min{0.0f};
+        v3 Max{0.0f};
+
+        [[nodiscard]] v3 GetCenter() const { return (Min + Max) * 0.5f; }
+        [[nodiscard]] v3 GetExtents() const { return (Max - Min) * 0.5f; }
+
+        [[nodiscard]] v3 GetCorner(int index) const
+        {
+            return v3(index & 1 ? Max.x : Min.x, index & 2 ? Max.y : Min.y, index & 4 ? Max.z : Min.z);
+        }
+
+        // Bounds of the box after being transformed by an affine matrix (Arvo's method)
+        [[nodiscard]] static AABB Transform(const AABB& box, const m4& transform)
+        {
+            const v3 center = v3(transform * v4(box.GetCenter(), 1.0f));
+            const v3 extents = box.GetExtents();
+
+            v3 newExtents{0.0f};
+            for (int row = 0; row < 3; ++row)
+            {
+                newExtents[row] = glm::abs(transform[0][row]) * extents.x
+                                + glm::abs(transform[1][row]) * extents.y
+                                + glm::abs(transform[2][row]) * extents.z;
+            }
+
+            return { center - newExtents, center + newExtents };
+        }
+    };
+}
@@ -0,0 +1,839 @@
+#include "SimdMath.hpp"
+
+#include "Core/Assert.hpp"
+#include "Core/Log.hpp"
+#include "Core/Timer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#if defined(ZN_CPU_X86)
+    #include <immintrin.h>
+#endif
+
+namespace zn::math::simd
+{
+    namespace
+    {
+        constexpr u32 BENCHMARK_ITERATIONS = 5;
+
+        //-----------------------------------------------------------------------------
+        // Scalar reference, plain glm
+        //-----------------------------------------------------------------------------
+
+        m4 ComposeTRSScalar(const v3& translation, const quat& rotation, const v3& scale)
+        {
+            m4 result = glm::mat4_cast(rotation);
+            result[0] = result[0] * scale.x;
+            result[1] = result[1] * scale.y;
+            result[2] = result[2] * scale.z;
+            result[3] = v4(translation, 1.0f);
+            return result;
+        }
+
+        void ComposeTRSScalar(const Vec3SoA& translations, const QuatSoA& rotations, const Vec3SoA& scales, m4* out, uSize begin, uSize end)
+        {
+            for (uSize i = begin; i < end; ++i)
+            {
+                out[i] = ComposeTRSScalar(translations.Get(i), rotations.Get(i), scales.Get(i));
+            }
+        }
+
+        void MultiplyMatricesScalar(const m4* lhs, const m4* rhs, m4* out, uSize begin, uSize end)
+        {
+            for (uSize i = begin; i < end; ++i)
+            {
+                out[i] = lhs[i] * rhs[i];
+            }
+        }
+
+        void MultiplyMatricesScalar(const m4& lhs, const m4* rhs, m4* out, uSize begin, uSize end)
+        {
+            for (uSize i = begin; i < end; ++i)
+            {
+                out[i] = lhs * rhs[i];
+            }
+        }
+
+        void TransformPointsScalar(const m4& matrix, const Vec3SoA& points, Vec3SoA& out, uSize begin, uSize end)
+        {
+            for (uSize i = begin; i < end; ++i)
+            {
+                out.Set(i, v3(matrix * v4(points.Get(i), 1.0f)));
+            }
+        }
+
+        void TransformNormalsScalar(const m3& normalMatrix, const Vec3SoA& normals, Vec3SoA& out, uSize begin, uSize end)
+        {
+            for (uSize i = begin; i < end; ++i)
+            {
+                out.Set(i, glm::normalize(normalMatrix * normals.Get(i)));
+            }
+        }
+
+        void TransformAABBsScalar(const m4* matrices, const AABB* boxes, AABB* out, uSize begin, uSize end)
+        {
+            for (uSize i = begin; i < end; ++i)
+            {
+                out[i] = AABB::Transform(boxes[i], matrices[i]);
+            }
+        }
+
+        m3 GetNormalMatrix(const m4& matrix)
+        {
+            return glm::transpose(glm::inverse(m3(matrix)));
+        }
+
+#if defined(ZN_CPU_X86)
+        //-----------------------------------------------------------------------------
+        // SSE, 4 elements per register. Only uses SSE2, but is dispatched at the SSE4.2 tier
+        //-----------------------------------------------------------------------------
+
+        // Takes one column (x, y, z, w registers) of 4 SoA matrices and writes it into 4 AoS matrices
+        void StoreColumn4(m4* out, int column, __m128 x, __m128 y, __m128 z, __m128 w)
+        {
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+            _mm_storeu_ps(&out[0][column][0], x);
+            _mm_storeu_ps(&out[1][column][0], y);
+            _mm_storeu_ps(&out[2][column][0], z);
+            _mm_storeu_ps(&out[3][column][0], w);
+        }
+
+        __m128 LoadV3(const v3& value)
+        {
+            return _mm_setr_ps(value.x, value.y, value.z, 0.0f);
+        }
+
+        v3 StoreV3(__m128 value)
+        {
+            alignas(16) f32 result[4];
+            _mm_store_ps(result, value);
+            return v3(result[0], result[1], result[2]);
+        }
+
+        template<int Lane>
+        __m128 Splat(__m128 value)
+        {
+            return _mm_shuffle_ps(value, value, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+        }
+
+        __m128 MultiplyColumnSSE(__m128 a0, __m128 a1, __m128 a2, __m128 a3, __m128 column)
+        {
+            __m128 result = _mm_mul_ps(a0, Splat<0>(column));
+            result = _mm_add_ps(result, _mm_mul_ps(a1, Splat<1>(column)));
+            result = _mm_add_ps(result, _mm_mul_ps(a2, Splat<2>(column)));
+            result = _mm_add_ps(result, _mm_mul_ps(a3, Splat<3>(column)));
+            return result;
+        }
+
+        void ComposeTRSSSE(const Vec3SoA& translations, const QuatSoA& rotations, const Vec3SoA& scales, m4* out, uSize count)
+        {
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 zero = _mm_setzero_ps();
+
+            uSize i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128 x = _mm_loadu_ps(&rotations.X[i]);
+                const __m128 y = _mm_loadu_ps(&rotations.Y[i]);
+                const __m128 z = _mm_loadu_ps(&rotations.Z[i]);
+                const __m128 w = _mm_loadu_ps(&rotations.W[i]);
+
+                const __m128 x2 = _mm_add_ps(x, x);
+                const __m128 y2 = _mm_add_ps(y, y);
+                const __m128 z2 = _mm_add_ps(z, z);
+
+                const __m128 xx = _mm_mul_ps(x, x2);
+                const __m128 yy = _mm_mul_ps(y, y2);
+                const __m128 zz = _mm_mul_ps(z, z2);
+                const __m128 xy = _mm_mul_ps(x, y2);
+                const __m128 xz = _mm_mul_ps(x, z2);
+                const __m128 yz = _mm_mul_ps(y, z2);
+                const __m128 wx = _mm_mul_ps(w, x2);
+                const __m128 wy = _mm_mul_ps(w, y2);
+                const __m128 wz = _mm_mul_ps(w, z2);
+
+                const __m128 sx = _mm_loadu_ps(&scales.X[i]);
+                const __m128 sy = _mm_loadu_ps(&scales.Y[i]);
+                const __m128 sz = _mm_loadu_ps(&scales.Z[i]);
+
+                StoreColumn4(out + i, 0,
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx),
+                    _mm_mul_ps(_mm_add_ps(xy, wz), sx),
+                    _mm_mul_ps(_mm_sub_ps(xz, wy), sx),
+                    zero);
+
+                StoreColumn4(out + i, 1,
+                    _mm_mul_ps(_mm_sub_ps(xy, wz), sy),
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy),
+                    _mm_mul_ps(_mm_add_ps(yz, wx), sy),
+                    zero);
+
+                StoreColumn4(out + i, 2,
+                    _mm_mul_ps(_mm_add_ps(xz, wy), sz),
+                    _mm_mul_ps(_mm_sub_ps(yz, wx), sz),
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz),
+                    zero);
+
+                StoreColumn4(out + i, 3,
+                    _mm_loadu_ps(&translations.X[i]),
+                    _mm_loadu_ps(&translations.Y[i]),
+                    _mm_loadu_ps(&translations.Z[i]),
+                    one);
+            }
+
+            ComposeTRSScalar(translations, rotations, scales, out, i, count);
+        }
+
+        void MultiplyMatricesSSE(const m4* lhs, const m4* rhs, m4* out, uSize count)
+        {
+            for (uSize i = 0; i < count; ++i)
+            {
+                const __m128 a0 = _mm_loadu_ps(&lhs[i][0][0]);
+                const __m128 a1 = _mm_loadu_ps(&lhs[i][1][0]);
+                const __m128 a2 = _mm_loadu_ps(&lhs[i][2][0]);
+                const __m128 a3 = _mm_loadu_ps(&lhs[i][3][0]);
+
+                for (int column = 0; column < 4; ++column)
+                {
+                    const __m128 b = _mm_loadu_ps(&rhs[i][column][0]);
+                    _mm_storeu_ps(&out[i][column][0], MultiplyColumnSSE(a0, a1, a2, a3, b));
+                }
+            }
+        }
+
+        void MultiplyMatricesSSE(const m4& lhs, const m4* rhs, m4* out, uSize count)
+        {
+            const __m128 a0 = _mm_loadu_ps(&lhs[0][0]);
+            const __m128 a1 = _mm_loadu_ps(&lhs[1][0]);
+            const __m128 a2 = _mm_loadu_ps(&lhs[2][0]);
+            const __m128 a3 = _mm_loadu_ps(&lhs[3][0]);
+
+            for (uSize i = 0; i < count; ++i)
+            {
+                for (int column = 0; column < 4; ++column)
+                {
+                    const __m128 b = _mm_loadu_ps(&rhs[i][column][0]);
+                    _mm_storeu_ps(&out[i][column][0], MultiplyColumnSSE(a0, a1, a2, a3, b));
+                }
+            }
+        }
+
+        void TransformPointsSSE(const m4& matrix, const Vec3SoA& points, Vec3SoA& out, uSize count)
+        {
+            const __m128 m00 = _mm_set1_ps(matrix[0][0]), m01 = _mm_set1_ps(matrix[0][1]), m02 = _mm_set1_ps(matrix[0][2]);
+            const __m128 m10 = _mm_set1_ps(matrix[1][0]), m11 = _mm_set1_ps(matrix[1][1]), m12 = _mm_set1_ps(matrix[1][2]);
+            const __m128 m20 = _mm_set1_ps(matrix[2][0]), m21 = _mm_set1_ps(matrix[2][1]), m22 = _mm_set1_ps(matrix[2][2]);
+            const __m128 m30 = _mm_set1_ps(matrix[3][0]), m31 = _mm_set1_ps(matrix[3][1]), m32 = _mm_set1_ps(matrix[3][2]);
+
+            uSize i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128 x = _mm_loadu_ps(&points.X[i]);
+                const __m128 y = _mm_loadu_ps(&points.Y[i]);
+                const __m128 z = _mm_loadu_ps(&points.Z[i]);
+
+                const __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)), _mm_add_ps(_mm_mul_ps(m20, z), m30));
+                const __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)), _mm_add_ps(_mm_mul_ps(m21, z), m31));
+                const __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)), _mm_add_ps(_mm_mul_ps(m22, z), m32));
+
+                _mm_storeu_ps(&out.X[i], rx);
+                _mm_storeu_ps(&out.Y[i], ry);
+                _mm_storeu_ps(&out.Z[i], rz);
+            }
+
+            TransformPointsScalar(matrix, points, out, i, count);
+        }
+
+        void TransformNormalsSSE(const m3& normalMatrix, const Vec3SoA& normals, Vec3SoA& out, uSize count)
+        {
+            const __m128 m00 = _mm_set1_ps(normalMatrix[0][0]), m01 = _mm_set1_ps(normalMatrix[0][1]), m02 = _mm_set1_ps(normalMatrix[0][2]);
+            const __m128 m10 = _mm_set1_ps(normalMatrix[1][0]), m11 = _mm_set1_ps(normalMatrix[1][1]), m12 = _mm_set1_ps(normalMatrix[1][2]);
+            const __m128 m20 = _mm_set1_ps(normalMatrix[2][0]), m21 = _mm_set1_ps(normalMatrix[2][1]), m22 = _mm_set1_ps(normalMatrix[2][2]);
+            const __m128 one = _mm_set1_ps(1.0f);
+
+            uSize i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m128 x = _mm_loadu_ps(&normals.X[i]);
+                const __m128 y = _mm_loadu_ps(&normals.Y[i]);
+                const __m128 z = _mm_loadu_ps(&normals.Z[i]);
+
+                const __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)), _mm_mul_ps(m20, z));
+                const __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)), _mm_mul_ps(m21, z));
+                const __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)), _mm_mul_ps(m22, z));
+
+                // Full precision sqrt + div rather than rsqrt, so results match the reference
+                const __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)), _mm_mul_ps(rz, rz));
+                const __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSq));
+
+                _mm_storeu_ps(&out.X[i], _mm_mul_ps(rx, invLength));
+                _mm_storeu_ps(&out.Y[i], _mm_mul_ps(ry, invLength));
+                _mm_storeu_ps(&out.Z[i], _mm_mul_ps(rz, invLength));
+            }
+
+            TransformNormalsScalar(normalMatrix, normals, out, i, count);
+        }
+
+        void TransformAABBsSSE(const m4* matrices, const AABB* boxes, AABB* out, uSize count)
+        {
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+            for (uSize i = 0; i < count; ++i)
+            {
+                const __m128 boxMin = LoadV3(boxes[i].Min);
+                const __m128 boxMax = LoadV3(boxes[i].Max);
+                const __m128 center = _mm_mul_ps(_mm_add_ps(boxMin, boxMax), half);
+                const __m128 extents = _mm_mul_ps(_mm_sub_ps(boxMax, boxMin), half);
+
+                const __m128 c0 = _mm_loadu_ps(&matrices[i][0][0]);
+                const __m128 c1 = _mm_loadu_ps(&matrices[i][1][0]);
+                const __m128 c2 = _mm_loadu_ps(&matrices[i][2][0]);
+                const __m128 c3 = _mm_loadu_ps(&matrices[i][3][0]);
+
+                // Points have w = 1, so the translation column is added as is
+                __m128 newCenter = _mm_add_ps(_mm_mul_ps(c0, Splat<0>(center)), c3);
+                newCenter = _mm_add_ps(newCenter, _mm_mul_ps(c1, Splat<1>(center)));
+                newCenter = _mm_add_ps(newCenter, _mm_mul_ps(c2, Splat<2>(center)));
+
+                __m128 newExtents = _mm_mul_ps(_mm_and_ps(c0, absMask), Splat<0>(extents));
+                newExtents = _mm_add_ps(newExtents, _mm_mul_ps(_mm_and_ps(c1, absMask), Splat<1>(extents)));
+                newExtents = _mm_add_ps(newExtents, _mm_mul_ps(_mm_and_ps(c2, absMask), Splat<2>(extents)));
+
+                out[i].Min = StoreV3(_mm_sub_ps(newCenter, newExtents));
+                out[i].Max = StoreV3(_mm_add_ps(newCenter, newExtents));
+            }
+        }
+
+        //-----------------------------------------------------------------------------
+        // AVX2 + FMA, 8 elements per register
+        //-----------------------------------------------------------------------------
+
+        ZN_TARGET_AVX2
+        __m256 Combine(__m128 low, __m128 high)
+        {
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+        }
+
+        ZN_TARGET_AVX2
+        __m256 BroadcastColumn(const v4& column)
+        {
+            return _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&column[0]));
+        }
+
+        // Same as StoreColumn4, for 8 matrices
+        ZN_TARGET_AVX2
+        void StoreColumn8(m4* out, int column, __m256 x, __m256 y, __m256 z, __m256 w)
+        {
+            __m128 x0 = _mm256_castps256_ps128(x), y0 = _mm256_castps256_ps128(y), z0 = _mm256_castps256_ps128(z), w0 = _mm256_castps256_ps128(w);
+            __m128 x1 = _mm256_extractf128_ps(x, 1), y1 = _mm256_extractf128_ps(y, 1), z1 = _mm256_extractf128_ps(z, 1), w1 = _mm256_extractf128_ps(w, 1);
+
+            _MM_TRANSPOSE4_PS(x0, y0, z0, w0);
+            _MM_TRANSPOSE4_PS(x1, y1, z1, w1);
+
+            _mm_storeu_ps(&out[0][column][0], x0);
+            _mm_storeu_ps(&out[1][column][0], y0);
+            _mm_storeu_ps(&out[2][column][0], z0);
+            _mm_storeu_ps(&out[3][column][0], w0);
+            _mm_storeu_ps(&out[4][column][0], x1);
+            _mm_storeu_ps(&out[5][column][0], y1);
+            _mm_storeu_ps(&out[6][column][0], z1);
+            _mm_storeu_ps(&out[7][column][0], w1);
+        }
+
+        // Multiplies two columns at once: columns holds rhs columns j and j + 1, a0..a3 hold each lhs column in both halves
+        ZN_TARGET_AVX2
+        __m256 MultiplyColumnPairAVX2(__m256 a0, __m256 a1, __m256 a2, __m256 a3, __m256 columns)
+        {
+            __m256 result = _mm256_mul_ps(a0, _mm256_permute_ps(columns, 0x00));
+            result = _mm256_fmadd_ps(a1, _mm256_permute_ps(columns, 0x55), result);
+            result = _mm256_fmadd_ps(a2, _mm256_permute_ps(columns, 0xAA), result);
+            result = _mm256_fmadd_ps(a3, _mm256_permute_ps(columns, 0xFF), result);
+            return result;
+        }
+
+        ZN_TARGET_AVX2
+        void ComposeTRSAVX2(const Vec3SoA& translations, const QuatSoA& rotations, const Vec3SoA& scales, m4* out, uSize count)
+        {
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 zero = _mm256_setzero_ps();
+
+            uSize i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m256 x = _mm256_loadu_ps(&rotations.X[i]);
+                const __m256 y = _mm256_loadu_ps(&rotations.Y[i]);
+                const __m256 z = _mm256_loadu_ps(&rotations.Z[i]);
+                const __m256 w = _mm256_loadu_ps(&rotations.W[i]);
+
+                const __m256 x2 = _mm256_add_ps(x, x);
+                const __m256 y2 = _mm256_add_ps(y, y);
+                const __m256 z2 = _mm256_add_ps(z, z);
+
+                const __m256 xx = _mm256_mul_ps(x, x2);
+                const __m256 yy = _mm256_mul_ps(y, y2);
+                const __m256 zz = _mm256_mul_ps(z, z2);
+                const __m256 xy = _mm256_mul_ps(x, y2);
+                const __m256 xz = _mm256_mul_ps(x, z2);
+                const __m256 yz = _mm256_mul_ps(y, z2);
+                const __m256 wx = _mm256_mul_ps(w, x2);
+                const __m256 wy = _mm256_mul_ps(w, y2);
+                const __m256 wz = _mm256_mul_ps(w, z2);
+
+                const __m256 sx = _mm256_loadu_ps(&scales.X[i]);
+                const __m256 sy = _mm256_loadu_ps(&scales.Y[i]);
+                const __m256 sz = _mm256_loadu_ps(&scales.Z[i]);
+
+                StoreColumn8(out + i, 0,
+                    _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx),
+                    _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+                    _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx),
+                    zero);
+
+                StoreColumn8(out + i, 1,
+                    _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy),
+                    _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+                    _mm256_mul_ps(_mm256_add_ps(yz, wx), sy),
+                    zero);
+
+                StoreColumn8(out + i, 2,
+                    _mm256_mul_ps(_mm256_add_ps(xz, wy), sz),
+                    _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+                    _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz),
+                    zero);
+
+                StoreColumn8(out + i, 3,
+                    _mm256_loadu_ps(&translations.X[i]),
+                    _mm256_loadu_ps(&translations.Y[i]),
+                    _mm256_loadu_ps(&translations.Z[i]),
+                    one);
+            }
+
+            ComposeTRSScalar(translations, rotations, scales, out, i, count);
+        }
+
+        ZN_TARGET_AVX2
+        void MultiplyMatricesAVX2(const m4* lhs, const m4* rhs, m4* out, uSize count)
+        {
+            for (uSize i = 0; i < count; ++i)
+            {
+                const __m256 a0 = BroadcastColumn(lhs[i][0]);
+                const __m256 a1 = BroadcastColumn(lhs[i][1]);
+                const __m256 a2 = BroadcastColumn(lhs[i][2]);
+                const __m256 a3 = BroadcastColumn(lhs[i][3]);
+
+                const __m256 b01 = _mm256_loadu_ps(&rhs[i][0][0]);
+                const __m256 b23 = _mm256_loadu_ps(&rhs[i][2][0]);
+
+                _mm256_storeu_ps(&out[i][0][0], MultiplyColumnPairAVX2(a0, a1, a2, a3, b01));
+                _mm256_storeu_ps(&out[i][2][0], MultiplyColumnPairAVX2(a0, a1, a2, a3, b23));
+            }
+        }
+
+        ZN_TARGET_AVX2
+        void MultiplyMatricesAVX2(const m4& lhs, const m4* rhs, m4* out, uSize count)
+        {
+            const __m256 a0 = BroadcastColumn(lhs[0]);
+            const __m256 a1 = BroadcastColumn(lhs[1]);
+            const __m256 a2 = BroadcastColumn(lhs[2]);
+            const __m256 a3 = BroadcastColumn(lhs[3]);
+
+            for (uSize i = 0; i < count; ++i)
+            {
+                const __m256 b01 = _mm256_loadu_ps(&rhs[i][0][0]);
+                const __m256 b23 = _mm256_loadu_ps(&rhs[i][2][0]);
+
+                _mm256_storeu_ps(&out[i][0][0], MultiplyColumnPairAVX2(a0, a1, a2, a3, b01));
+                _mm256_storeu_ps(&out[i][2][0], MultiplyColumnPairAVX2(a0, a1, a2, a3, b23));
+            }
+        }
+
+        ZN_TARGET_AVX2
+        void TransformPointsAVX2(const m4& matrix, const Vec3SoA& points, Vec3SoA& out, uSize count)
+        {
+            const __m256 m00 = _mm256_set1_ps(matrix[0][0]), m01 = _mm256_set1_ps(matrix[0][1]), m02 = _mm256_set1_ps(matrix[0][2]);
+            const __m256 m10 = _mm256_set1_ps(matrix[1][0]), m11 = _mm256_set1_ps(matrix[1][1]), m12 = _mm256_set1_ps(matrix[1][2]);
+            const __m256 m20 = _mm256_set1_ps(matrix[2][0]), m21 = _mm256_set1_ps(matrix[2][1]), m22 = _mm256_set1_ps(matrix[2][2]);
+            const __m256 m30 = _mm256_set1_ps(matrix[3][0]), m31 = _mm256_set1_ps(matrix[3][1]), m32 = _mm256_set1_ps(matrix[3][2]);
+
+            uSize i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m256 x = _mm256_loadu_ps(&points.X[i]);
+                const __m256 y = _mm256_loadu_ps(&points.Y[i]);
+                const __m256 z = _mm256_loadu_ps(&points.Z[i]);
+
+                const __m256 rx = _mm256_fmadd_ps(m00, x, _mm256_fmadd_ps(m10, y, _mm256_fmadd_ps(m20, z, m30)));
+                const __m256 ry = _mm256_fmadd_ps(m01, x, _mm256_fmadd_ps(m11, y, _mm256_fmadd_ps(m21, z, m31)));
+                const __m256 rz = _mm256_fmadd_ps(m02, x, _mm256_fmadd_ps(m12, y, _mm256_fmadd_ps(m22, z, m32)));
+
+                _mm256_storeu_ps(&out.X[i], rx);
+                _mm256_storeu_ps(&out.Y[i], ry);
+                _mm256_storeu_ps(&out.Z[i], rz);
+            }
+
+            TransformPointsScalar(matrix, points, out, i, count);
+        }
+
+        ZN_TARGET_AVX2
+        void TransformNormalsAVX2(const m3& normalMatrix, const Vec3SoA& normals, Vec3SoA& out, uSize count)
+        {
+            const __m256 m00 = _mm256_set1_ps(normalMatrix[0][0]), m01 = _mm256_set1_ps(normalMatrix[0][1]), m02 = _mm256_set1_ps(normalMatrix[0][2]);
+            const __m256 m10 = _mm256_set1_ps(normalMatrix[1][0]), m11 = _mm256_set1_ps(normalMatrix[1][1]), m12 = _mm256_set1_ps(normalMatrix[1][2]);
+            const __m256 m20 = _mm256_set1_ps(normalMatrix[2][0]), m21 = _mm256_set1_ps(normalMatrix[2][1]), m22 = _mm256_set1_ps(normalMatrix[2][2]);
+            const __m256 one = _mm256_set1_ps(1.0f);
+
+            uSize i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m256 x = _mm256_loadu_ps(&normals.X[i]);
+                const __m256 y = _mm256_loadu_ps(&normals.Y[i]);
+                const __m256 z = _mm256_loadu_ps(&normals.Z[i]);
+
+                const __m256 rx = _mm256_fmadd_ps(m00, x, _mm256_fmadd_ps(m10, y, _mm256_mul_ps(m20, z)));
+                const __m256 ry = _mm256_fmadd_ps(m01, x, _mm256_fmadd_ps(m11, y, _mm256_mul_ps(m21, z)));
+                const __m256 rz = _mm256_fmadd_ps(m02, x, _mm256_fmadd_ps(m12, y, _mm256_mul_ps(m22, z)));
+
+                const __m256 lengthSq = _mm256_fmadd_ps(rx, rx, _mm256_fmadd_ps(ry, ry, _mm256_mul_ps(rz, rz)));
+                const __m256 invLength = _mm256_div_ps(one, _mm256_sqrt_ps(lengthSq));
+
+                _mm256_storeu_ps(&out.X[i], _mm256_mul_ps(rx, invLength));
+                _mm256_storeu_ps(&out.Y[i], _mm256_mul_ps(ry, invLength));
+                _mm256_storeu_ps(&out.Z[i], _mm256_mul_ps(rz, invLength));
+            }
+
+            TransformNormalsScalar(normalMatrix, normals, out, i, count);
+        }
+
+        // Two boxes per iteration, one in each 128 bit half
+        ZN_TARGET_AVX2
+        void TransformAABBsAVX2(const m4* matrices, const AABB* boxes, AABB* out, uSize count)
+        {
+            const __m256 half = _mm256_set1_ps(0.5f);
+            const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+            uSize i = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                const __m256 boxMin = Combine(LoadV3(boxes[i].Min), LoadV3(boxes[i + 1].Min));
+                const __m256 boxMax = Combine(LoadV3(boxes[i].Max), LoadV3(boxes[i + 1].Max));
+                const __m256 center = _mm256_mul_ps(_mm256_add_ps(boxMin, boxMax), half);
+                const __m256 extents = _mm256_mul_ps(_mm256_sub_ps(boxMax, boxMin), half);
+
+                const __m256 c0 = Combine(_mm_loadu_ps(&matrices[i][0][0]), _mm_loadu_ps(&matrices[i + 1][0][0]));
+                const __m256 c1 = Combine(_mm_loadu_ps(&matrices[i][1][0]), _mm_loadu_ps(&matrices[i + 1][1][0]));
+                const __m256 c2 = Combine(_mm_loadu_ps(&matrices[i][2][0]), _mm_loadu_ps(&matrices[i + 1][2][0]));
+                const __m256 c3 = Combine(_mm_loadu_ps(&matrices[i][3][0]), _mm_loadu_ps(&matrices[i + 1][3][0]));
+
+                __m256 newCenter = _mm256_fmadd_ps(c0, _mm256_permute_ps(center, 0x00), c3);
+                newCenter = _mm256_fmadd_ps(c1, _mm256_permute_ps(center, 0x55), newCenter);
+                newCenter = _mm256_fmadd_ps(c2, _mm256_permute_ps(center, 0xAA), newCenter);
+
+                __m256 newExtents = _mm256_mul_ps(_mm256_and_ps(c0, absMask), _mm256_permute_ps(extents, 0x00));
+                newExtents = _mm256_fmadd_ps(_mm256_and_ps(c1, absMask), _mm256_permute_ps(extents, 0x55), newExtents);
+                newExtents = _mm256_fmadd_ps(_mm256_and_ps(c2, absMask), _mm256_permute_ps(extents, 0xAA), newExtents);
+
+                const __m256 newMin = _mm256_sub_ps(newCenter, newExtents);
+                const __m256 newMax = _mm256_add_ps(newCenter, newExtents);
+
+                out[i].Min = StoreV3(_mm256_castps256_ps128(newMin));
+                out[i].Max = StoreV3(_mm256_castps256_ps128(newMax));
+                out[i + 1].Min = StoreV3(_mm256_extractf128_ps(newMin, 1));
+                out[i + 1].Max = StoreV3(_mm256_extractf128_ps(newMax, 1));
+            }
+
+            TransformAABBsScalar(matrices, boxes, out, i, count);
+        }
+
+        //-----------------------------------------------------------------------------
+        // AVX-512, 16 elements per register. Only the streaming SoA kernels benefit from the wider
+        // registers; the per matrix ones are bound by the 4x4 shape and keep using AVX2
+        //-----------------------------------------------------------------------------
+
+        ZN_TARGET_AVX512
+        void TransformPointsAVX512(const m4& matrix, const Vec3SoA& points, Vec3SoA& out, uSize count)
+        {
+            const __m512 m00 = _mm512_set1_ps(matrix[0][0]), m01 = _mm512_set1_ps(matrix[0][1]), m02 = _mm512_set1_ps(matrix[0][2]);
+            const __m512 m10 = _mm512_set1_ps(matrix[1][0]), m11 = _mm512_set1_ps(matrix[1][1]), m12 = _mm512_set1_ps(matrix[1][2]);
+            const __m512 m20 = _mm512_set1_ps(matrix[2][0]), m21 = _mm512_set1_ps(matrix[2][1]), m22 = _mm512_set1_ps(matrix[2][2]);
+            const __m512 m30 = _mm512_set1_ps(matrix[3][0]), m31 = _mm512_set1_ps(matrix[3][1]), m32 = _mm512_set1_ps(matrix[3][2]);
+
+            uSize i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                const __m512 x = _mm512_loadu_ps(&points.X[i]);
+                const __m512 y = _mm512_loadu_ps(&points.Y[i]);
+                const __m512 z = _mm512_loadu_ps(&points.Z[i]);
+
+                _mm512_storeu_ps(&out.X[i], _mm512_fmadd_ps(m00, x, _mm512_fmadd_ps(m10, y, _mm512_fmadd_ps(m20, z, m30))));
+                _mm512_storeu_ps(&out.Y[i], _mm512_fmadd_ps(m01, x, _mm512_fmadd_ps(m11, y, _mm512_fmadd_ps(m21, z, m31))));
+                _mm512_storeu_ps(&out.Z[i], _mm512_fmadd_ps(m02, x, _mm512_fmadd_ps(m12, y, _mm512_fmadd_ps(m22, z, m32))));
+            }
+
+            TransformPointsScalar(matrix, points, out, i, count);
+        }
+
+        ZN_TARGET_AVX512
+        void TransformNormalsAVX512(const m3& normalMatrix, const Vec3SoA& normals, Vec3SoA& out, uSize count)
+        {
+            const __m512 m00 = _mm512_set1_ps(normalMatrix[0][0]), m01 = _mm512_set1_ps(normalMatrix[0][1]), m02 = _mm512_set1_ps(normalMatrix[0][2]);
+            const __m512 m10 = _mm512_set1_ps(normalMatrix[1][0]), m11 = _mm512_set1_ps(normalMatrix[1][1]), m12 = _mm512_set1_ps(normalMatrix[1][2]);
+            const __m512 m20 = _mm512_set1_ps(normalMatrix[2][0]), m21 = _mm512_set1_ps(normalMatrix[2][1]), m22 = _mm512_set1_ps(normalMatrix[2][2]);
+            const __m512 one = _mm512_set1_ps(1.0f);
+
+            uSize i = 0;
+            for (; i + 16 <= count; i += 16)
+            {
+                const __m512 x = _mm512_loadu_ps(&normals.X[i]);
+                const __m512 y = _mm512_loadu_ps(&normals.Y[i]);
+                const __m512 z = _mm512_loadu_ps(&normals.Z[i]);
+
+                const __m512 rx = _mm512_fmadd_ps(m00, x, _mm512_fmadd_ps(m10, y, _mm512_mul_ps(m20, z)));
+                const __m512 ry = _mm512_fmadd_ps(m01, x, _mm512_fmadd_ps(m11, y, _mm512_mul_ps(m21, z)));
+                const __m512 rz = _mm512_fmadd_ps(m02, x, _mm512_fmadd_ps(m12, y, _mm512_mul_ps(m22, z)));
+
+                const __m512 lengthSq = _mm512_fmadd_ps(rx, rx, _mm512_fmadd_ps(ry, ry, _mm512_mul_ps(rz, rz)));
+                const __m512 invLength = _mm512_div_ps(one, _mm512_sqrt_ps(lengthSq));
+
+                _mm512_storeu_ps(&out.X[i], _mm512_mul_ps(rx, invLength));
+                _mm512_storeu_ps(&out.Y[i], _mm512_mul_ps(ry, invLength));
+                _mm512_storeu_ps(&out.Z[i], _mm512_mul_ps(rz, invLength));
+            }
+
+            TransformNormalsScalar(normalMatrix, normals, out, i, count);
+        }
+#endif
+
+        //-----------------------------------------------------------------------------
+        // Dispatch tables
+        //-----------------------------------------------------------------------------
+
+        using ComposeTRSFn = void(*)(const Vec3SoA&, const QuatSoA&, const Vec3SoA&, m4*, uSize);
+        using MultiplyMatricesFn = void(*)(const m4*, const m4*, m4*, uSize);
+        using MultiplySharedFn = void(*)(const m4&, const m4*, m4*, uSize);
+        using TransformPointsFn = void(*)(const m4&, const Vec3SoA&, Vec3SoA&, uSize);
+        using TransformNormalsFn = void(*)(const m3&, const Vec3SoA&, Vec3SoA&, uSize);
+        using TransformAABBsFn = void(*)(const m4*, const AABB*, AABB*, uSize);
+
+        const IsaDispatch<ComposeTRSFn> s_composeTRS = {
+            [](const Vec3SoA& translations, const QuatSoA& rotations, const Vec3SoA& scales, m4* out, uSize count)
+            {
+                ComposeTRSScalar(translations, rotations, scales, out, 0, count);
+            },
+            ZN_ISA_VARIANT(ComposeTRSSSE),
+            ZN_ISA_VARIANT(ComposeTRSAVX2),
+        };
+
+        const IsaDispatch<MultiplyMatricesFn> s_multiplyMatrices = {
+            [](const m4* lhs, const m4* rhs, m4* out, uSize count) { MultiplyMatricesScalar(lhs, rhs, out, 0, count); },
+            ZN_ISA_VARIANT(static_cast<MultiplyMatricesFn>(MultiplyMatricesSSE)),
+            ZN_ISA_VARIANT(static_cast<MultiplyMatricesFn>(MultiplyMatricesAVX2)),
+        };
+
+        const IsaDispatch<MultiplySharedFn> s_multiplyShared = {
+            [](const m4& lhs, const m4* rhs, m4* out, uSize count) { MultiplyMatricesScalar(lhs, rhs, out, 0, count); },
+            ZN_ISA_VARIANT(static_cast<MultiplySharedFn>(MultiplyMatricesSSE)),
+            ZN_ISA_VARIANT(static_cast<MultiplySharedFn>(MultiplyMatricesAVX2)),
+        };
+
+        const IsaDispatch<TransformPointsFn> s_transformPoints = {
+            [](const m4& matrix, const Vec3SoA& points, Vec3SoA& out, uSize count) { TransformPointsScalar(matrix, points, out, 0, count); },
+            ZN_ISA_VARIANT(TransformPointsSSE),
+            ZN_ISA_VARIANT(TransformPointsAVX2),
+            ZN_ISA_VARIANT(TransformPointsAVX512),
+        };
+
+        const IsaDispatch<TransformNormalsFn> s_transformNormals = {
+            [](const m3& normalMatrix, const Vec3SoA& normals, Vec3SoA& out, uSize count) { TransformNormalsScalar(normalMatrix, normals, out, 0, count); },
+            ZN_ISA_VARIANT(TransformNormalsSSE),
+            ZN_ISA_VARIANT(TransformNormalsAVX2),
+            ZN_ISA_VARIANT(TransformNormalsAVX512),
+        };
+
+        const IsaDispatch<TransformAABBsFn> s_transformAABBs = {
+            [](const m4* matrices, const AABB* boxes, AABB* out, uSize count) { TransformAABBsScalar(matrices, boxes, out, 0, count); },
+            ZN_ISA_VARIANT(TransformAABBsSSE),
+            ZN_ISA_VARIANT(TransformAABBsAVX2),
+        };
+
+        //-----------------------------------------------------------------------------
+        // Benchmark helpers
+        //-----------------------------------------------------------------------------
+
+        f32 MaxError(const Vector<m4>& results, const Vector<m4>& reference)
+        {
+            f32 maxError = 0.0f;
+            for (uSize i = 0; i < results.size(); ++i)
+                for (int column = 0; column < 4; ++column)
+                    for (int row = 0; row < 4; ++row)
+                        maxError = std::max(maxError, std::abs(results[i][column][row] - reference[i][column][row]));
+
+            return maxError;
+        }
+
+        f32 MaxError(const Vec3SoA& results, const Vec3SoA& reference)
+        {
+            f32 maxError = 0.0f;
+            for (uSize i = 0; i < results.Size(); ++i)
+            {
+                maxError = std::max(maxError, std::abs(results.X[i] - reference.X[i]));
+                maxError = std::max(maxError, std::abs(results.Y[i] - reference.Y[i]));
+                maxError = std::max(maxError, std::abs(results.Z[i] - reference.Z[i]));
+            }
+
+            return maxError;
+        }
+
+        f32 MaxError(const Vector<AABB>& results, const Vector<AABB>& reference)
+        {
+            f32 maxError = 0.0f;
+            for (uSize i = 0; i < results.size(); ++i)
+            {
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    maxError = std::max(maxError, std::abs(results[i].Min[axis] - reference[i].Min[axis]));
+                    maxError = std::max(maxError, std::abs(results[i].Max[axis] - reference[i].Max[axis]));
+                }
+            }
+
+            return maxError;
+        }
+
+        // Runs the kernel with the ISA forced to scalar to get the reference output, then times every
+        // variant the table has and the CPU supports
+        template<typename Fn, typename Output, typename Kernel>
+        void BenchmarkKernel(const c8* name, const IsaDispatch<Fn>& table, u32 count, Output& output, Kernel&& kernel, Vector<BenchmarkResult>& results)
+        {
+            CpuFeatures::ForceIsa(CpuIsa::Scalar);
+            kernel();
+            const Output reference = output;
+
+            for (CpuIsa isa : { CpuIsa::Scalar, CpuIsa::SSE42, CpuIsa::AVX2, CpuIsa::AVX512 })
+            {
+                if (isa > CpuFeatures::GetDetectedIsa())
+                    break;
+
+                if (!table.Get(isa))
+                    continue;
+
+                CpuFeatures::ForceIsa(isa);
+
+                f64 bestTime = std::numeric_limits<f64>::max();
+                for (u32 iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration)
+                {
+                    Time::Timer timer;
+                    timer.Start();
+                    kernel();
+                    bestTime = std::min(bestTime, timer.GetElapsedTime());
+                }
+
+                BenchmarkResult result;
+                result.Kernel = name;
+                result.Isa = isa;
+                result.MsPerMillion = bestTime * 1000.0 * (1000000.0 / static_cast<f64>(count));
+                result.MaxError = MaxError(output, reference);
+                results.push_back(result);
+
+                ZN_CORE_INFO("[simd::RunBenchmarks] {} ({}): {:.3f} ms per million, max error {}",
+                    name, CpuFeatures::GetIsaName(isa), result.MsPerMillion, result.MaxError);
+            }
+        }
+    }
+
+    void ComposeTRS(const Vec3SoA& translations, const QuatSoA& rotations, const Vec3SoA& scales, m4* out)
+    {
+        const uSize count = translations.Size();
+        ZN_ASSERT(rotations.Size() == count && scales.Size() == count, "TRS streams must have the same size");
+
+        s_composeTRS.Select()(translations, rotations, scales, out, count);
+    }
+
+    void MultiplyMatrices(const m4* lhs, const m4* rhs, m4* out, uSize count)
+    {
+        s_multiplyMatrices.Select()(lhs, rhs, out, count);
+    }
+
+    void MultiplyMatrices(const m4& lhs, const m4* rhs, m4* out, uSize count)
+    {
+        s_multiplyShared.Select()(lhs, rhs, out, count);
+    }
+
+    void TransformPoints(const m4& matrix, const Vec3SoA& points, Vec3SoA& out)
+    {
+        out.Resize(points.Size());
+        s_transformPoints.Select()(matrix, points, out, points.Size());
+    }
+
+    void TransformNormals(const m4& matrix, const Vec3SoA& normals, Vec3SoA& out)
+    {
+        out.Resize(normals.Size());
+        s_transformNormals.Select()(GetNormalMatrix(matrix), normals, out, normals.Size());
+    }
+
+    void TransformAABBs(const m4* matrices, const AABB* boxes, AABB* out, uSize count)
+    {
+        s_transformAABBs.Select()(matrices, boxes, out, count);
+    }
+
+    Vector<BenchmarkResult> RunBenchmarks(u32 count)
+    {
+        const CpuIsa previousIsa = CpuFeatures::GetIsa();
+        count = std::max(count, 1u);
+
+        // Fixed seed so runs are comparable
+        std::mt19937 rng(1337);
+        std::uniform_real_distribution<f32> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<f32> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<f32> scale(0.5f, 2.0f);
+
+        Vec3SoA translations, scales, points, normals, pointsOut, normalsOut;
+        QuatSoA rotations;
+        translations.Resize(count);
+        scales.Resize(count);
+        points.Resize(count);
+        normals.Resize(count);
+        rotations.Resize(count);
+
+        Vector<AABB> boxes(count);
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            translations.Set(i, v3(position(rng), position(rng), position(rng)));
+            scales.Set(i, v3(scale(rng), scale(rng), scale(rng)));
+            points.Set(i, v3(position(rng), position(rng), position(rng)));
+            normals.Set(i, glm::normalize(v3(unit(rng), unit(rng), unit(rng)) + v3(0.0f, 0.0f, 1e-3f)));
+            rotations.Set(i, glm::normalize(quat(unit(rng), unit(rng), unit(rng), unit(rng) + 1e-3f)));
+
+            const v3 center(position(rng), position(rng), position(rng));
+            const v3 extents(scale(rng), scale(rng), scale(rng));
+            boxes[i] = { center - extents, center + extents };
+        }
+
+        Vector<m4> matrices(count);
+        Vector<m4> matricesOut(count);
+        Vector<AABB> boxesOut(count);
+
+        ComposeTRSScalar(translations, rotations, scales, matrices.data(), 0, count);
+        const m4 sharedMatrix = matrices[0];
+
+        Vector<BenchmarkResult> results;
+
+        BenchmarkKernel("ComposeTRS", s_composeTRS, count, matricesOut,
+            [&]() { ComposeTRS(translations, rotations, scales, matricesOut.data()); }, results);
+        BenchmarkKernel("MultiplyMatrices", s_multiplyMatrices, count, matricesOut,
+            [&]() { MultiplyMatrices(matrices.data(), matrices.data(), matricesOut.data(), count); }, results);
+        BenchmarkKernel("MultiplyMatrices (shared lhs)", s_multiplyShared, count, matricesOut,
+            [&]() { MultiplyMatrices(sharedMatrix, matrices.data(), matricesOut.data(), count); }, results);
+        BenchmarkKernel("TransformPoints", s_transformPoints, count, pointsOut,
+            [&]() { TransformPoints(sharedMatrix, points, pointsOut); }, results);
+        BenchmarkKernel("TransformNormals", s_transformNormals, count, normalsOut,
+            [&]() { TransformNormals(sharedMatrix, normals, normalsOut); }, results);
+        BenchmarkKernel("TransformAABBs", s_transformAABBs, count, boxesOut,
+            [&]() { TransformAABBs(matrices.data(), boxes.data(), boxesOut.data(), count); }, results);
+
+        CpuFeatures::ForceIsa(previousIsa);
+        return results;
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Core/CpuFeatures.hpp"
+#include "Math/Bounds.hpp"
+#include "Math/Math.hpp"
+
+#include <glm/gtc/quaternion.hpp>
+
+namespace zn::math
+{
+    //-----------------------------------------------------------------------------
+    // Structure of arrays storage for batched kernels. Every component lives in its own
+    // array, so a SIMD register loads the same component of 4 (SSE) or 8 (AVX2) elements
+    //-----------------------------------------------------------------------------
+    struct Vec3SoA
+    {
+        Vector<f32> X;
+        Vector<f32> Y;
+        Vector<f32> Z;
+
+        void Resize(uSize count) { X.resize(count); Y.resize(count); Z.resize(count); }
+        [[nodiscard]] uSize Size() const { return X.size(); }
+
+        void Set(uSize i, const v3& value) { X[i] = value.x; Y[i] = value.y; Z[i] = value.z; }
+        [[nodiscard]] v3 Get(uSize i) const { return v3(X[i], Y[i], Z[i]); }
+    };
+
+    struct QuatSoA
+    {
+        Vector<f32> X;
+        Vector<f32> Y;
+        Vector<f32> Z;
+        Vector<f32> W;
+
+        void Resize(uSize count) { X.resize(count); Y.resize(count); Z.resize(count); W.resize(count, 1.0f); }
+        [[nodiscard]] uSize Size() const { return X.size(); }
+
+        void Set(uSize i, const quat& value) { X[i] = value.x; Y[i] = value.y; Z[i] = value.z; W[i] = value.w; }
+        [[nodiscard]] quat Get(uSize i) const { return quat(W[i], X[i], Y[i], Z[i]); }
+    };
+
+    //-----------------------------------------------------------------------------
+    // Batched transform kernels. Matrices stay glm::mat4 (column major AoS), since that's what
+    // glm, the culler and the GPU consume; the kernels transpose in registers where needed.
+    //
+    // Every kernel has a scalar variant written with plain glm, which is the reference the SIMD
+    // variants are checked against (see RunBenchmarks). Remainders that don't fill a register go
+    // through the scalar code too, so counts don't need padding. The variant is picked from
+    // CpuFeatures::GetIsa() on every call, so CpuFeatures::ForceIsa takes effect immediately.
+    //-----------------------------------------------------------------------------
+    namespace simd
+    {
+        // out[i] = T(translations[i]) * R(rotations[i]) * S(scales[i]). Rotations must be normalized
+        void ComposeTRS(const Vec3SoA& translations, const QuatSoA& rotations, const Vec3SoA& scales, m4* out);
+
+        // out[i] = lhs[i] * rhs[i]. out may alias lhs or rhs
+        void MultiplyMatrices(const m4* lhs, const m4* rhs, m4* out, uSize count);
+        // out[i] = lhs * rhs[i]. out may alias rhs
+        void MultiplyMatrices(const m4& lhs, const m4* rhs, m4* out, uSize count);
+
+        // Affine transform of points (w = 1). out may be the same as points
+        void TransformPoints(const m4& matrix, const Vec3SoA& points, Vec3SoA& out);
+        // Transforms directions by the inverse transpose of the upper 3x3 and renormalizes them
+        void TransformNormals(const m4& matrix, const Vec3SoA& normals, Vec3SoA& out);
+
+        // Same as AABB::Transform for every box: out[i] = bounds of boxes[i] transformed by matrices[i]
+        void TransformAABBs(const m4* matrices, const AABB* boxes, AABB* out, uSize count);
+
+        struct BenchmarkResult
+        {
+            const c8* Kernel = "";
+            CpuIsa Isa = CpuIsa::Scalar;
+            f64 MsPerMillion = 0.0; // Time to process one million elements
+            f32 MaxError = 0.0f;    // Largest absolute difference to the scalar glm reference
+        };
+
+        // Runs every ISA variant of every kernel the CPU supports over count random elements, checking
+        // the results against the scalar reference. Results are also logged. The active ISA is restored
+        [[nodiscard]] Vector<BenchmarkResult> RunBenchmarks(u32 count);
+    }
+}
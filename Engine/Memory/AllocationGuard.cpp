@@ -0,0 +1,240 @@
+#include "AllocationGuard.hpp"
+
+#include "MemoryTracker.hpp"
+
+#include "Core/Log.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(ZN_CRT_ALLOCATION_HOOK)
+	#include <crtdbg.h>
+#endif
+
+namespace zn
+{
+	namespace
+	{
+		constexpr u32 MAX_REPORTED_FRAMES = 12;
+		constexpr u32 MAX_REPORTED_STACKS = 256;
+		constexpr u32 MAX_PENDING_REPORTS = 32;
+
+		// OnAllocation itself
+		constexpr u32 SKIPPED_FRAMES = 1;
+
+		thread_local const c8* t_scope = nullptr;
+
+		// Capturing the call stack may allocate on first use, so the guard is off while it runs
+		thread_local b8 t_reporting = false;
+
+		std::atomic<AllocationGuardMode> s_mode{ AllocationGuardMode::Count };
+		std::atomic<u64> s_violations{0};
+
+		// Hashes of the stacks already logged, so a leak in a per frame path is reported once
+		std::atomic<u64> s_reportedStacks[MAX_REPORTED_STACKS];
+
+		enum class ReportState : u8
+		{
+			Free,
+			Writing,
+			Ready,
+			Reading
+		};
+
+		// Logging from inside the allocator can recurse into it or block on a flush, so violations
+		// are only recorded here and logged once the thread leaves its no-alloc scopes
+		struct PendingReport
+		{
+			std::atomic<ReportState> State{ ReportState::Free };
+			const c8* Scope = nullptr;
+			uSize Bytes = 0;
+			u32 FrameCount = 0;
+			void* Frames[MAX_REPORTED_FRAMES];
+		};
+
+		PendingReport s_pendingReports[MAX_PENDING_REPORTS];
+		std::atomic<u32> s_pendingCount{0};
+		std::atomic<u64> s_lostReports{0};
+
+		PendingReport* ClaimReport()
+		{
+			for (PendingReport& report : s_pendingReports)
+			{
+				ReportState expected = ReportState::Free;
+				if (report.State.compare_exchange_strong(expected, ReportState::Writing, std::memory_order_acquire))
+					return &report;
+			}
+
+			return nullptr;
+		}
+
+		b8 MarkReported(u64 hash)
+		{
+			for (u32 probe = 0; probe < MAX_REPORTED_STACKS; ++probe)
+			{
+				std::atomic<u64>& slot = s_reportedStacks[(hash + probe) % MAX_REPORTED_STACKS];
+
+				u64 expected = 0;
+				if (slot.compare_exchange_strong(expected, hash, std::memory_order_relaxed))
+					return true;
+
+				if (expected == hash)
+					return false;
+			}
+
+			// Table full: keep counting, stop logging
+			return false;
+		}
+
+#if defined(ZN_CRT_ALLOCATION_HOOK)
+		_CRT_ALLOC_HOOK s_previousHook = nullptr;
+
+		int __cdecl CrtAllocationHook(int allocType, void* userData, size_t size, int blockType, long requestNumber,
+			const unsigned char* fileName, int lineNumber)
+		{
+			// CRT internal blocks are bookkeeping of the runtime, not allocations of the caller
+			if ((allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC) && _BLOCK_TYPE(blockType) != _CRT_BLOCK)
+			{
+				AllocationGuard::OnAllocation(size);
+			}
+
+			return s_previousHook ? s_previousHook(allocType, userData, size, blockType, requestNumber, fileName, lineNumber) : TRUE;
+		}
+
+		void InstallCrtHook()
+		{
+			static const b8 installed = []()
+			{
+				s_previousHook = _CrtSetAllocHook(CrtAllocationHook);
+				return true;
+			}();
+
+			(void)installed;
+		}
+#endif
+	}
+
+	NoAllocScope::NoAllocScope(const c8* name)
+		: m_previous(AllocationGuard::GetCurrentScope())
+	{
+#if defined(ZN_CRT_ALLOCATION_HOOK)
+		InstallCrtHook();
+#endif
+
+		AllocationGuard::SetCurrentScope(name);
+	}
+
+	NoAllocScope::~NoAllocScope()
+	{
+		AllocationGuard::SetCurrentScope(m_previous);
+
+		if (m_previous == nullptr)
+		{
+			AllocationGuard::ReportViolations();
+		}
+	}
+
+	void AllocationGuard::SetMode(AllocationGuardMode mode)
+	{
+		s_mode.store(mode, std::memory_order_relaxed);
+	}
+
+	AllocationGuardMode AllocationGuard::GetMode()
+	{
+		return s_mode.load(std::memory_order_relaxed);
+	}
+
+	u64 AllocationGuard::GetViolationCount()
+	{
+		return s_violations.load(std::memory_order_relaxed);
+	}
+
+	void AllocationGuard::ResetViolationCount()
+	{
+		s_violations.store(0, std::memory_order_relaxed);
+	}
+
+	const c8* AllocationGuard::GetCurrentScope()
+	{
+		return t_scope;
+	}
+
+	void AllocationGuard::SetCurrentScope(const c8* name)
+	{
+		t_scope = name;
+	}
+
+	void AllocationGuard::OnAllocation(uSize bytes)
+	{
+		const c8* scope = t_scope;
+		if (scope == nullptr || t_reporting)
+			return;
+
+		t_reporting = true;
+		s_violations.fetch_add(1, std::memory_order_relaxed);
+
+		void* frames[MAX_REPORTED_FRAMES];
+		const u32 frameCount = MemoryTracker::CaptureCallStack(frames, MAX_REPORTED_FRAMES, SKIPPED_FRAMES);
+
+		// FNV-1a over the return addresses
+		u64 hash = 14695981039346656037ull;
+		for (u32 i = 0; i < frameCount; ++i)
+		{
+			hash = (hash ^ reinterpret_cast<uintptr_t>(frames[i])) * 1099511628211ull;
+		}
+		hash = hash == 0 ? 1 : hash;
+
+		if (MarkReported(hash))
+		{
+			if (PendingReport* report = ClaimReport())
+			{
+				report->Scope = scope;
+				report->Bytes = bytes;
+				report->FrameCount = frameCount;
+				std::copy(frames, frames + frameCount, report->Frames);
+
+				report->State.store(ReportState::Ready, std::memory_order_release);
+				s_pendingCount.fetch_add(1, std::memory_order_release);
+			}
+			else
+			{
+				s_lostReports.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		if (GetMode() == AllocationGuardMode::Trap)
+		{
+			ZN_DEBUGBREAK();
+		}
+
+		t_reporting = false;
+	}
+
+	void AllocationGuard::ReportViolations()
+	{
+		if (s_pendingCount.load(std::memory_order_acquire) == 0 || t_scope != nullptr)
+			return;
+
+		for (PendingReport& report : s_pendingReports)
+		{
+			ReportState expected = ReportState::Ready;
+			if (!report.State.compare_exchange_strong(expected, ReportState::Reading, std::memory_order_acquire))
+				continue;
+
+			s_pendingCount.fetch_sub(1, std::memory_order_relaxed);
+
+			ZN_LOG_ERROR(Memory, "[AllocationGuard::ReportViolations] {} byte allocation inside no-alloc scope '{}'", report.Bytes, report.Scope);
+			for (u32 i = 0; i < report.FrameCount; ++i)
+			{
+				ZN_LOG_ERROR(Memory, "    {}", MemoryTracker::DescribeFrame(report.Frames[i]));
+			}
+
+			report.State.store(ReportState::Free, std::memory_order_release);
+		}
+
+		if (const u64 lost = s_lostReports.exchange(0, std::memory_order_relaxed); lost > 0)
+		{
+			ZN_LOG_ERROR(Memory, "[AllocationGuard::ReportViolations] {} more call stacks allocated inside no-alloc scopes while the report buffer was full", lost);
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+// The debug CRT reports every malloc/realloc through its allocation hook, which also covers code
+// that bypasses operator new. Elsewhere the tracked operator new (ZN_MEMORY_TRACKING) is the hook
+#if defined(ZN_DEBUG) && defined(_MSC_VER) && defined(_DEBUG)
+	#define ZN_CRT_ALLOCATION_HOOK
+#endif
+
+namespace zn
+{
+	enum class AllocationGuardMode : u8
+	{
+		Count, // Counts and logs the first allocation of every call stack
+		Trap   // Additionally breaks into the debugger on every allocation
+	};
+
+	// Marks a region of the calling thread that must not touch the heap. Scopes nest; a scope with a
+	// null name allows allocations again until it ends (e.g. for a handler that resizes targets)
+	class NoAllocScope
+	{
+	public:
+		explicit NoAllocScope(const c8* name);
+		~NoAllocScope();
+
+		NoAllocScope(const NoAllocScope& other) = delete;
+		NoAllocScope(NoAllocScope&& other) noexcept = delete;
+
+		NoAllocScope& operator=(const NoAllocScope& other) = delete;
+		NoAllocScope& operator=(NoAllocScope&& other) noexcept = delete;
+
+	private:
+		const c8* m_previous;
+	};
+
+	// Reports allocations made inside a NoAllocScope together with the offending call stack
+	class AllocationGuard
+	{
+	public:
+		AllocationGuard() = delete;
+
+		static void SetMode(AllocationGuardMode mode);
+		[[nodiscard]] static AllocationGuardMode GetMode();
+
+		// Allocations caught inside scopes since startup or the last reset, meant to be checked by tests
+		[[nodiscard]] static u64 GetViolationCount();
+		static void ResetViolationCount();
+
+		// Name of the innermost no-alloc scope of the calling thread, null when allocating is allowed
+		[[nodiscard]] static const c8* GetCurrentScope();
+
+		// Called by the allocation hooks before the heap is touched. Only records the violation;
+		// nothing is logged from inside the allocator
+		static void OnAllocation(uSize bytes);
+
+		// Logs the violations recorded so far. Runs when a thread leaves its outermost no-alloc
+		// scope, and does nothing while the calling thread is still inside one
+		static void ReportViolations();
+
+	private:
+		friend class NoAllocScope;
+
+		static void SetCurrentScope(const c8* name);
+	};
+}
+
+#if defined(ZN_DEBUG)
+	#define ZN_NO_ALLOC_SCOPE(name) ::zn::NoAllocScope ZN_CONCAT_MACRO(noAllocScope, __LINE__)(name)
+	#define ZN_ALLOW_ALLOC_SCOPE() ::zn::NoAllocScope ZN_CONCAT_MACRO(allowAllocScope, __LINE__)(nullptr)
+#else
+	#define ZN_NO_ALLOC_SCOPE(name)
+	#define ZN_ALLOW_ALLOC_SCOPE()
+#endif
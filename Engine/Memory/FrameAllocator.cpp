@@ -0,0 +1,97 @@
+#include "FrameAllocator.hpp"
+
+#include "Core/Assert.hpp"
+#include "Core/Log.hpp"
+
+#include <algorithm>
+
+namespace zn
+{
+	namespace
+	{
+		struct FrameArena
+		{
+			explicit FrameArena(uSize capacity)
+				: Allocator(capacity), Resource(Allocator) {}
+
+			LinearAllocator Allocator;
+			LinearMemoryResource Resource;
+		};
+
+		Vector<UniquePtr<FrameArena>> s_arenas;
+		FrameArena* s_current = nullptr;
+		FrameAllocator::Stats s_stats;
+		b8 s_overflowReported = false;
+	}
+
+	void FrameAllocator::Init(uSize bytesPerFrame)
+	{
+		ZN_ASSERT(!IsInitialized(), "FrameAllocator initialized twice");
+
+		for (u32 i = 0; i < FRAMES_IN_FLIGHT; i++)
+		{
+			s_arenas.push_back(CreateUnique<FrameArena>(bytesPerFrame));
+		}
+
+		s_current = s_arenas[0].get();
+		s_stats = {};
+		s_stats.Capacity = bytesPerFrame;
+
+		ZN_LOG_INFO(Memory, "[FrameAllocator::Init] {} frame arenas of {} KB", FRAMES_IN_FLIGHT, bytesPerFrame / 1024);
+	}
+
+	void FrameAllocator::Shutdown()
+	{
+		s_current = nullptr;
+		s_arenas.clear();
+	}
+
+	b8 FrameAllocator::IsInitialized()
+	{
+		return s_current != nullptr;
+	}
+
+	void FrameAllocator::BeginFrame(u64 frame)
+	{
+		if (!IsInitialized())
+			return;
+
+		s_stats.Used = s_current->Allocator.GetUsed();
+		s_stats.HighWaterMark = std::max(s_stats.HighWaterMark, s_stats.Used);
+		s_stats.OverflowBytes = s_current->Resource.GetOverflowBytes();
+
+		StackAllocator& scratch = StackAllocator::GetThreadScratch();
+		s_stats.ScratchHighWaterMark = scratch.GetHighWaterMark();
+		scratch.ResetHighWaterMark();
+
+		// Once, the stats keep showing it afterwards
+		if (s_stats.OverflowBytes > 0 && !s_overflowReported)
+		{
+			ZN_LOG_WARN(Memory, "[FrameAllocator::BeginFrame] {} bytes didn't fit the {} KB frame arena and went to the heap", s_stats.OverflowBytes, s_stats.Capacity / 1024);
+			s_overflowReported = true;
+		}
+
+		// Two frames old, nothing references it anymore
+		s_current = s_arenas[frame % s_arenas.size()].get();
+		s_current->Allocator.Reset();
+		s_current->Resource.Release();
+	}
+
+	void* FrameAllocator::Allocate(uSize size, uSize alignment)
+	{
+		return GetResource()->allocate(size, alignment);
+	}
+
+	std::pmr::memory_resource* FrameAllocator::GetResource()
+	{
+		if (!IsInitialized())
+			return std::pmr::new_delete_resource();
+
+		return &s_current->Resource;
+	}
+
+	const FrameAllocator::Stats& FrameAllocator::GetStats()
+	{
+		return s_stats;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Memory/MemoryResource.hpp"
+
+namespace zn
+{
+	// Per frame linear arenas for transient data: draw lists, sort keys, render packets. Frames are
+	// pipelined (the main thread submits frame N - 1 while frame N is simulated), so there's one arena
+	// per frame in flight. BeginFrame resets the oldest one in O(1); memory allocated during a frame
+	// stays valid until the BeginFrame after the next.
+	//
+	// Allocation is thread safe. Before Init, or once an arena is full, allocations go to the heap.
+	class FrameAllocator
+	{
+	public:
+		struct Stats
+		{
+			uSize Used = 0;          // Bytes the last finished frame allocated from its arena
+			uSize Capacity = 0;
+			uSize HighWaterMark = 0; // Largest frame so far
+			uSize OverflowBytes = 0; // Bytes of the last finished frame that didn't fit and went to the heap
+			uSize ScratchHighWaterMark = 0; // Main thread scratch stack peak during the last frame
+		};
+
+		static constexpr u32 FRAMES_IN_FLIGHT = 2;
+		static constexpr uSize DEFAULT_CAPACITY = 4 * 1024 * 1024;
+
+		FrameAllocator() = delete;
+
+		static void Init(uSize bytesPerFrame = DEFAULT_CAPACITY);
+		static void Shutdown();
+
+		[[nodiscard]] static b8 IsInitialized();
+
+		// Main thread, while no other thread allocates
+		static void BeginFrame(u64 frame);
+
+		[[nodiscard]] static void* Allocate(uSize size, uSize alignment = alignof(std::max_align_t));
+
+		// Memory resource of the current frame, for PmrVector and friends
+		[[nodiscard]] static std::pmr::memory_resource* GetResource();
+
+		[[nodiscard]] static const Stats& GetStats();
+	};
+}
@@ -0,0 +1,50 @@
+#include "LinearAllocator.hpp"
+
+#include "Core/Assert.hpp"
+#include "Memory/MemoryUtils.hpp"
+
+#include <new>
+
+namespace zn
+{
+	LinearAllocator::LinearAllocator(uSize capacity)
+		: m_capacity(capacity)
+	{
+		m_buffer = static_cast<Byte*>(::operator new(capacity, std::align_val_t{ CACHE_LINE_SIZE }));
+	}
+
+	LinearAllocator::~LinearAllocator()
+	{
+		::operator delete(m_buffer, std::align_val_t{ CACHE_LINE_SIZE });
+	}
+
+	void* LinearAllocator::Allocate(uSize size, uSize alignment)
+	{
+		ZN_ASSERT(IsPowerOfTwo(alignment), "Alignment must be a power of two");
+
+		const uintptr_t base = reinterpret_cast<uintptr_t>(m_buffer);
+		uSize offset = m_offset.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			const uSize aligned = AlignUp(base + offset, alignment) - base;
+			if (aligned + size > m_capacity)
+				return nullptr;
+
+			if (m_offset.compare_exchange_weak(offset, aligned + size, std::memory_order_relaxed))
+				return m_buffer + aligned;
+		}
+	}
+
+	void LinearAllocator::Reset()
+	{
+		m_highWaterMark = GetHighWaterMark();
+		m_offset.store(0, std::memory_order_relaxed);
+	}
+
+	b8 LinearAllocator::Owns(const void* pointer) const
+	{
+		const Byte* bytes = static_cast<const Byte*>(pointer);
+		return bytes >= m_buffer && bytes < m_buffer + m_capacity;
+	}
+}
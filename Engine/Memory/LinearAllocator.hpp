@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+namespace zn
+{
+	// Bump allocator over a fixed block. Allocation is a pointer increment and can be done from any
+	// thread; nothing is freed individually, Reset releases everything at once in O(1)
+	class LinearAllocator
+	{
+	public:
+		explicit LinearAllocator(uSize capacity);
+		~LinearAllocator();
+
+		LinearAllocator(const LinearAllocator& other) = delete;
+		LinearAllocator(LinearAllocator&& other) noexcept = delete;
+
+		LinearAllocator& operator=(const LinearAllocator& other) = delete;
+		LinearAllocator& operator=(LinearAllocator&& other) noexcept = delete;
+
+		// Thread safe. Returns nullptr when the block is full
+		[[nodiscard]] void* Allocate(uSize size, uSize alignment = alignof(std::max_align_t));
+
+		// Uninitialized storage for count elements
+		template<typename T>
+		[[nodiscard]] T* AllocateArray(uSize count)
+		{
+			return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		// Invalidates everything allocated so far. Not thread safe
+		void Reset();
+
+		[[nodiscard]] b8 Owns(const void* pointer) const;
+
+		[[nodiscard]] uSize GetUsed() const { return m_offset.load(std::memory_order_relaxed); }
+		[[nodiscard]] uSize GetCapacity() const { return m_capacity; }
+		// Highest usage seen before any Reset
+		[[nodiscard]] uSize GetHighWaterMark() const
+		{
+			const uSize used = GetUsed();
+			return used > m_highWaterMark ? used : m_highWaterMark;
+		}
+
+	private:
+		Byte* m_buffer = nullptr;
+		uSize m_capacity = 0;
+		std::atomic<uSize> m_offset{0};
+		uSize m_highWaterMark = 0;
+	};
+}
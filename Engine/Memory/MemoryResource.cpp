@@ -0,0 +1,48 @@
+#include "MemoryResource.hpp"
+
+namespace zn
+{
+	void LinearMemoryResource::Release()
+	{
+		std::lock_guard lock(m_overflowMutex);
+
+		for (const OverflowBlock& block : m_overflowBlocks)
+		{
+			m_upstream->deallocate(block.Pointer, block.Size, block.Alignment);
+		}
+
+		m_overflowBlocks.clear();
+		m_overflowBytes.store(0, std::memory_order_relaxed);
+	}
+
+	void* LinearMemoryResource::do_allocate(uSize bytes, uSize alignment)
+	{
+		if (void* pointer = m_allocator.Allocate(bytes, alignment))
+			return pointer;
+
+		void* pointer = m_upstream->allocate(bytes, alignment);
+		m_overflowBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+		std::lock_guard lock(m_overflowMutex);
+		m_overflowBlocks.push_back({ pointer, bytes, alignment });
+
+		return pointer;
+	}
+
+	void* StackMemoryResource::do_allocate(uSize bytes, uSize alignment)
+	{
+		if (void* pointer = m_allocator.Allocate(bytes, alignment))
+			return pointer;
+
+		m_overflowBytes += bytes;
+		return m_upstream->allocate(bytes, alignment);
+	}
+
+	void StackMemoryResource::do_deallocate(void* pointer, uSize bytes, uSize alignment)
+	{
+		if (!m_allocator.Owns(pointer))
+		{
+			m_upstream->deallocate(pointer, bytes, alignment);
+		}
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Memory/LinearAllocator.hpp"
+#include "Memory/StackAllocator.hpp"
+
+#include <atomic>
+#include <memory_resource>
+#include <mutex>
+
+namespace zn
+{
+	// Containers whose memory comes from one of the engine allocators. They must not outlive the
+	// allocator's reset (end of frame, end of scratch scope)
+	template<typename T>
+	using PmrVector = std::pmr::vector<T>;
+
+	//-----------------------------------------------------------------------------
+	// std::pmr adapters. When the allocator is full, allocations fall back to the upstream resource
+	// instead of failing, and the bytes are counted so the allocator can be resized. Deallocation of
+	// allocator memory is a no-op; it is released by Reset / FreeToMarker
+	//-----------------------------------------------------------------------------
+
+	// Monotonic like the arena it wraps: blocks that went to upstream are kept until Release, so
+	// memory from Allocate never has to be given back
+	class LinearMemoryResource final : public std::pmr::memory_resource
+	{
+	public:
+		explicit LinearMemoryResource(LinearAllocator& allocator, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+			: m_allocator(allocator), m_upstream(upstream) {}
+
+		~LinearMemoryResource() override { Release(); }
+
+		LinearMemoryResource(const LinearMemoryResource& other) = delete;
+		LinearMemoryResource& operator=(const LinearMemoryResource& other) = delete;
+
+		// Frees the upstream blocks. Call together with LinearAllocator::Reset
+		void Release();
+
+		[[nodiscard]] LinearAllocator& GetAllocator() const { return m_allocator; }
+		[[nodiscard]] uSize GetOverflowBytes() const { return m_overflowBytes.load(std::memory_order_relaxed); }
+
+	private:
+		struct OverflowBlock
+		{
+			void* Pointer;
+			uSize Size;
+			uSize Alignment;
+		};
+
+		void* do_allocate(uSize bytes, uSize alignment) override;
+		void do_deallocate(void*, uSize, uSize) override {}
+		b8 do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+		LinearAllocator& m_allocator;
+		std::pmr::memory_resource* m_upstream;
+		std::atomic<uSize> m_overflowBytes{0};
+
+		std::mutex m_overflowMutex;
+		Vector<OverflowBlock> m_overflowBlocks;
+	};
+
+	class StackMemoryResource final : public std::pmr::memory_resource
+	{
+	public:
+		explicit StackMemoryResource(StackAllocator& allocator, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+			: m_allocator(allocator), m_upstream(upstream) {}
+
+		[[nodiscard]] StackAllocator& GetAllocator() const { return m_allocator; }
+		[[nodiscard]] uSize GetOverflowBytes() const { return m_overflowBytes; }
+
+	private:
+		void* do_allocate(uSize bytes, uSize alignment) override;
+		void do_deallocate(void* pointer, uSize bytes, uSize alignment) override;
+		b8 do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+		StackAllocator& m_allocator;
+		std::pmr::memory_resource* m_upstream;
+		uSize m_overflowBytes = 0;
+	};
+
+	// Temporary allocations from the calling thread's scratch stack, released when the scope ends:
+	//
+	//   ScratchScope scratch;
+	//   PmrVector<u32> indices(scratch.GetResource());
+	class ScratchScope
+	{
+	public:
+		ScratchScope()
+			: m_scope(StackAllocator::GetThreadScratch()), m_resource(StackAllocator::GetThreadScratch()) {}
+
+		ScratchScope(const ScratchScope& other) = delete;
+		ScratchScope(ScratchScope&& other) noexcept = delete;
+
+		ScratchScope& operator=(const ScratchScope& other) = delete;
+		ScratchScope& operator=(ScratchScope&& other) noexcept = delete;
+
+		[[nodiscard]] std::pmr::memory_resource* GetResource() { return &m_resource; }
+
+	private:
+		StackAllocator::Scope m_scope;
+		StackMemoryResource m_resource;
+	};
+}
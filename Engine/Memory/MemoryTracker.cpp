@@ -0,0 +1,812 @@
+#include "MemoryTracker.hpp"
+
+#include "AllocationGuard.hpp"
+
+#include "Core/Log.hpp"
+#include "Core/StatsRegistry.hpp"
+
+#include <imgui.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <sstream>
+
+#if defined(ZN_WINDOWS_PLATFORM)
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+	#include <dbghelp.h>
+	#pragma comment(lib, "dbghelp.lib")
+#else
+	#include <cxxabi.h>
+	#include <dlfcn.h>
+	#include <execinfo.h>
+#endif
+
+namespace zn
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		constexpr uSize TAG_COUNT = static_cast<uSize>(MemoryTag::Count);
+		constexpr uSize HEAP_COUNT = static_cast<uSize>(MemoryHeap::Count);
+
+		constexpr uSize DEFAULT_CPU_BUDGET = 1024ull * 1024 * 1024;
+		constexpr uSize DEFAULT_GPU_BUDGET = 512ull * 1024 * 1024;
+
+		// Frames of the tracker itself on top of every captured stack
+		constexpr u32 SKIPPED_FRAMES = 2;
+
+		constexpr f64 RATE_WINDOW_SECONDS = 0.5;
+
+		constexpr f64 BYTES_PER_MB = 1024.0 * 1024.0;
+
+		// Everything here is constant initialized, so it works for allocations made before main
+		struct Counters
+		{
+			std::atomic<i64> LiveBytes{0};
+			std::atomic<i64> PeakBytes{0};
+			std::atomic<i64> LiveAllocations{0};
+			std::atomic<u64> TotalAllocations{0};
+			std::atomic<u64> TotalBytes{0};
+		};
+
+		Counters s_counters[HEAP_COUNT][TAG_COUNT];
+		std::atomic<i64> s_heapLiveBytes[HEAP_COUNT];
+		std::atomic<i64> s_heapPeakBytes[HEAP_COUNT];
+		std::atomic<u64> s_budgets[HEAP_COUNT] = { DEFAULT_CPU_BUDGET, DEFAULT_GPU_BUDGET };
+
+		thread_local MemoryTag t_tag = MemoryTag::Untagged;
+
+		// Set while the tracker itself runs, so its own allocations are counted but never sampled
+		thread_local b8 t_inTracker = false;
+		thread_local u32 t_allocationsSinceSample = 0;
+
+		std::atomic<u32> s_sampleInterval{ MemoryTracker::DEFAULT_SAMPLE_INTERVAL };
+
+		struct CallSiteSlot
+		{
+			u64 Hash = 0; // 0 for empty slots
+			MemoryTracker::CallSite Site;
+		};
+
+		// Open addressing on the hash of the frames. Once full, new call sites are dropped
+		CallSiteSlot s_callSites[MemoryTracker::MAX_CALL_SITES];
+		std::atomic_flag s_callSiteLock = ATOMIC_FLAG_INIT;
+		std::atomic<u64> s_droppedSamples{0};
+
+		// Only touched by Update, on the main thread
+		struct RateState
+		{
+			u64 Allocations = 0;
+			u64 Bytes = 0;
+			f64 AllocationsPerSecond = 0.0;
+			f64 BytesPerSecond = 0.0;
+		};
+
+		RateState s_rates[HEAP_COUNT][TAG_COUNT];
+		Clock::time_point s_lastRateUpdate{};
+		b8 s_budgetReported[HEAP_COUNT] = {};
+
+		void UpdateMax(std::atomic<i64>& max, i64 value)
+		{
+			i64 current = max.load(std::memory_order_relaxed);
+			while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		Counters& GetCounters(MemoryHeap heap, MemoryTag tag)
+		{
+			return s_counters[static_cast<uSize>(heap)][static_cast<uSize>(tag)];
+		}
+
+		class CallSiteLock
+		{
+		public:
+			CallSiteLock()
+			{
+				while (s_callSiteLock.test_and_set(std::memory_order_acquire))
+				{
+				}
+			}
+
+			~CallSiteLock() { s_callSiteLock.clear(std::memory_order_release); }
+		};
+
+		void RecordSample(MemoryTag tag, uSize bytes)
+		{
+			t_inTracker = true;
+
+			void* frames[MemoryTracker::MAX_CALLSTACK_FRAMES];
+			const u32 frameCount = MemoryTracker::CaptureCallStack(frames, MemoryTracker::MAX_CALLSTACK_FRAMES, SKIPPED_FRAMES);
+
+			// FNV-1a over the return addresses and the tag
+			u64 hash = 14695981039346656037ull ^ static_cast<u64>(tag);
+			for (u32 i = 0; i < frameCount; ++i)
+			{
+				hash = (hash ^ reinterpret_cast<uintptr_t>(frames[i])) * 1099511628211ull;
+			}
+			hash = hash == 0 ? 1 : hash;
+
+			{
+				CallSiteLock lock;
+
+				b8 recorded = false;
+				for (u32 probe = 0; probe < MemoryTracker::MAX_CALL_SITES && !recorded; ++probe)
+				{
+					CallSiteSlot& slot = s_callSites[(hash + probe) % MemoryTracker::MAX_CALL_SITES];
+
+					if (slot.Hash == 0)
+					{
+						slot.Hash = hash;
+						slot.Site.Tag = tag;
+						slot.Site.FrameCount = frameCount;
+						std::copy(frames, frames + frameCount, slot.Site.Frames.begin());
+					}
+
+					if (slot.Hash == hash)
+					{
+						slot.Site.Samples++;
+						slot.Site.SampledBytes += bytes;
+						recorded = true;
+					}
+				}
+
+				if (!recorded)
+				{
+					s_droppedSamples.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+
+			t_inTracker = false;
+		}
+
+		String EscapeJson(StringView text)
+		{
+			String escaped;
+			escaped.reserve(text.size());
+
+			for (const c8 c : text)
+			{
+				switch (c)
+				{
+					case '"':  escaped += "\\\""; break;
+					case '\\': escaped += "\\\\"; break;
+					case '\n': escaped += "\\n"; break;
+					case '\t': escaped += "\\t"; break;
+					default:
+						if (static_cast<unsigned char>(c) >= 0x20)
+							escaped += c;
+						break;
+				}
+			}
+
+			return escaped;
+		}
+
+		u64 EstimateBytes(const MemoryTracker::CallSite& site, u32 sampleInterval)
+		{
+			return site.SampledBytes * std::max<u64>(sampleInterval, 1);
+		}
+	}
+
+	MemoryTagScope::MemoryTagScope(MemoryTag tag)
+		: m_previous(MemoryTracker::GetCurrentTag())
+	{
+		MemoryTracker::SetCurrentTag(tag);
+	}
+
+	MemoryTagScope::~MemoryTagScope()
+	{
+		MemoryTracker::SetCurrentTag(m_previous);
+	}
+
+	MemoryTag MemoryTracker::GetCurrentTag()
+	{
+		return t_tag;
+	}
+
+	void MemoryTracker::SetCurrentTag(MemoryTag tag)
+	{
+		t_tag = tag;
+	}
+
+	void MemoryTracker::TrackAllocation(MemoryHeap heap, MemoryTag tag, uSize bytes)
+	{
+		Counters& counters = GetCounters(heap, tag);
+		const i64 size = static_cast<i64>(bytes);
+
+		UpdateMax(counters.PeakBytes, counters.LiveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+		counters.LiveAllocations.fetch_add(1, std::memory_order_relaxed);
+		counters.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+		counters.TotalBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+		std::atomic<i64>& heapLive = s_heapLiveBytes[static_cast<uSize>(heap)];
+		UpdateMax(s_heapPeakBytes[static_cast<uSize>(heap)], heapLive.fetch_add(size, std::memory_order_relaxed) + size);
+
+		if (heap != MemoryHeap::Cpu || t_inTracker)
+			return;
+
+		const u32 interval = s_sampleInterval.load(std::memory_order_relaxed);
+		if (interval != 0 && ++t_allocationsSinceSample >= interval)
+		{
+			t_allocationsSinceSample = 0;
+			RecordSample(tag, bytes);
+		}
+	}
+
+	void MemoryTracker::TrackFree(MemoryHeap heap, MemoryTag tag, uSize bytes)
+	{
+		Counters& counters = GetCounters(heap, tag);
+		const i64 size = static_cast<i64>(bytes);
+
+		counters.LiveBytes.fetch_sub(size, std::memory_order_relaxed);
+		counters.LiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+		s_heapLiveBytes[static_cast<uSize>(heap)].fetch_sub(size, std::memory_order_relaxed);
+	}
+
+	void MemoryTracker::SetSampleInterval(u32 interval)
+	{
+		s_sampleInterval.store(interval, std::memory_order_relaxed);
+	}
+
+	u32 MemoryTracker::GetSampleInterval()
+	{
+		return s_sampleInterval.load(std::memory_order_relaxed);
+	}
+
+	void MemoryTracker::SetBudget(MemoryHeap heap, uSize bytes)
+	{
+		s_budgets[static_cast<uSize>(heap)].store(bytes, std::memory_order_relaxed);
+		s_budgetReported[static_cast<uSize>(heap)] = false;
+	}
+
+	uSize MemoryTracker::GetBudget(MemoryHeap heap)
+	{
+		return s_budgets[static_cast<uSize>(heap)].load(std::memory_order_relaxed);
+	}
+
+	void MemoryTracker::Update()
+	{
+		const Clock::time_point now = Clock::now();
+		const f64 elapsed = std::chrono::duration<f64>(now - s_lastRateUpdate).count();
+
+		if (elapsed >= RATE_WINDOW_SECONDS)
+		{
+			for (uSize heap = 0; heap < HEAP_COUNT; ++heap)
+			{
+				for (uSize tag = 0; tag < TAG_COUNT; ++tag)
+				{
+					const Counters& counters = s_counters[heap][tag];
+					RateState& rate = s_rates[heap][tag];
+
+					const u64 allocations = counters.TotalAllocations.load(std::memory_order_relaxed);
+					const u64 bytes = counters.TotalBytes.load(std::memory_order_relaxed);
+
+					rate.AllocationsPerSecond = static_cast<f64>(allocations - rate.Allocations) / elapsed;
+					rate.BytesPerSecond = static_cast<f64>(bytes - rate.Bytes) / elapsed;
+					rate.Allocations = allocations;
+					rate.Bytes = bytes;
+				}
+			}
+
+			s_lastRateUpdate = now;
+		}
+
+		for (uSize heap = 0; heap < HEAP_COUNT; ++heap)
+		{
+			const i64 live = s_heapLiveBytes[heap].load(std::memory_order_relaxed);
+			const uSize budget = s_budgets[heap].load(std::memory_order_relaxed);
+
+			if (budget > 0 && live > static_cast<i64>(budget) && !s_budgetReported[heap])
+			{
+				ZN_LOG_WARN(Memory, "[MemoryTracker::Update] {} memory over budget: {:.1f} MB of {:.1f} MB", GetHeapName(static_cast<MemoryHeap>(heap)),
+					static_cast<f64>(live) / BYTES_PER_MB, static_cast<f64>(budget) / BYTES_PER_MB);
+				s_budgetReported[heap] = true;
+			}
+		}
+
+		ZN_STAT_SET("Memory/CPU MB", static_cast<f64>(GetLiveBytes(MemoryHeap::Cpu)) / BYTES_PER_MB);
+		ZN_STAT_SET("Memory/GPU MB", static_cast<f64>(GetLiveBytes(MemoryHeap::Gpu)) / BYTES_PER_MB);
+		ZN_STAT_SET("Memory/Texture MB", static_cast<f64>(GetTagStats(MemoryHeap::Gpu, MemoryTag::Resource).LiveBytes) / BYTES_PER_MB);
+	}
+
+	MemoryTracker::TagStats MemoryTracker::GetTagStats(MemoryHeap heap, MemoryTag tag)
+	{
+		const Counters& counters = GetCounters(heap, tag);
+		const RateState& rate = s_rates[static_cast<uSize>(heap)][static_cast<uSize>(tag)];
+
+		TagStats stats;
+		stats.LiveBytes = counters.LiveBytes.load(std::memory_order_relaxed);
+		stats.PeakBytes = counters.PeakBytes.load(std::memory_order_relaxed);
+		stats.LiveAllocations = counters.LiveAllocations.load(std::memory_order_relaxed);
+		stats.TotalAllocations = counters.TotalAllocations.load(std::memory_order_relaxed);
+		stats.TotalBytes = counters.TotalBytes.load(std::memory_order_relaxed);
+		stats.AllocationsPerSecond = rate.AllocationsPerSecond;
+		stats.BytesPerSecond = rate.BytesPerSecond;
+
+		return stats;
+	}
+
+	i64 MemoryTracker::GetLiveBytes(MemoryHeap heap)
+	{
+		return s_heapLiveBytes[static_cast<uSize>(heap)].load(std::memory_order_relaxed);
+	}
+
+	i64 MemoryTracker::GetPeakBytes(MemoryHeap heap)
+	{
+		return s_heapPeakBytes[static_cast<uSize>(heap)].load(std::memory_order_relaxed);
+	}
+
+	Vector<MemoryTracker::CallSite> MemoryTracker::GetCallSites()
+	{
+		// Reserved up front: allocating under the lock would sample into the same lock
+		Vector<CallSite> sites;
+		sites.reserve(MAX_CALL_SITES);
+
+		{
+			CallSiteLock lock;
+
+			for (const CallSiteSlot& slot : s_callSites)
+			{
+				if (slot.Hash != 0)
+				{
+					sites.push_back(slot.Site);
+				}
+			}
+		}
+
+		std::sort(sites.begin(), sites.end(), [](const CallSite& lhs, const CallSite& rhs) { return lhs.SampledBytes > rhs.SampledBytes; });
+		return sites;
+	}
+
+	u32 MemoryTracker::CaptureCallStack(void** frames, u32 maxFrames, u32 skippedFrames)
+	{
+		// This function's own frame
+		skippedFrames++;
+
+#if defined(ZN_WINDOWS_PLATFORM)
+		return RtlCaptureStackBackTrace(skippedFrames, maxFrames, frames, nullptr);
+#else
+		constexpr i32 MAX_RAW_FRAMES = 64;
+
+		void* raw[MAX_RAW_FRAMES];
+		const i32 captured = backtrace(raw, std::min(static_cast<i32>(maxFrames + skippedFrames), MAX_RAW_FRAMES));
+
+		u32 count = 0;
+		for (i32 i = static_cast<i32>(skippedFrames); i < captured; ++i)
+		{
+			frames[count++] = raw[i];
+		}
+
+		return count;
+#endif
+	}
+
+	String MemoryTracker::DescribeFrame(void* address)
+	{
+		std::ostringstream description;
+
+#if defined(ZN_WINDOWS_PLATFORM)
+		// DbgHelp isn't thread safe
+		static std::mutex symbolMutex;
+		std::lock_guard lock(symbolMutex);
+
+		const HANDLE process = GetCurrentProcess();
+		static const b8 symbolsLoaded = [process]()
+		{
+			SymSetOptions(SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS | SYMOPT_LOAD_LINES);
+			return SymInitialize(process, nullptr, TRUE) != FALSE;
+		}();
+
+		alignas(SYMBOL_INFO) c8 symbolBuffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+		SYMBOL_INFO* symbol = reinterpret_cast<SYMBOL_INFO*>(symbolBuffer);
+		symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+		symbol->MaxNameLen = MAX_SYM_NAME;
+
+		DWORD64 displacement = 0;
+		if (symbolsLoaded && SymFromAddr(process, reinterpret_cast<DWORD64>(address), &displacement, symbol))
+		{
+			description << symbol->Name;
+
+			IMAGEHLP_LINE64 line{};
+			line.SizeOfStruct = sizeof(IMAGEHLP_LINE64);
+			DWORD lineDisplacement = 0;
+			if (SymGetLineFromAddr64(process, reinterpret_cast<DWORD64>(address), &lineDisplacement, &line))
+			{
+				description << " (" << line.FileName << ":" << line.LineNumber << ")";
+			}
+
+			return description.str();
+		}
+#else
+		Dl_info info{};
+		if (dladdr(address, &info) != 0 && info.dli_sname != nullptr)
+		{
+			i32 status = 0;
+			c8* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+			description << (status == 0 && demangled != nullptr ? demangled : info.dli_sname);
+			std::free(demangled);
+
+			return description.str();
+		}
+#endif
+
+		description << address;
+		return description.str();
+	}
+
+	b8 MemoryTracker::ExportCsv(const String& path)
+	{
+		std::ofstream file(path);
+		if (!file)
+		{
+			ZN_LOG_ERROR(Memory, "[MemoryTracker::ExportCsv] Couldn't open {}", path);
+			return false;
+		}
+
+		file << "heap,tag,live_bytes,peak_bytes,live_allocations,total_allocations,total_bytes,allocations_per_second,bytes_per_second\n";
+		for (uSize heap = 0; heap < HEAP_COUNT; ++heap)
+		{
+			for (uSize tag = 0; tag < TAG_COUNT; ++tag)
+			{
+				const TagStats stats = GetTagStats(static_cast<MemoryHeap>(heap), static_cast<MemoryTag>(tag));
+				file << GetHeapName(static_cast<MemoryHeap>(heap)) << ',' << GetTagName(static_cast<MemoryTag>(tag)) << ','
+					<< stats.LiveBytes << ',' << stats.PeakBytes << ',' << stats.LiveAllocations << ',' << stats.TotalAllocations << ','
+					<< stats.TotalBytes << ',' << stats.AllocationsPerSecond << ',' << stats.BytesPerSecond << '\n';
+			}
+		}
+
+		const u32 sampleInterval = GetSampleInterval();
+
+		file << "\ntag,samples,sampled_bytes,estimated_bytes,callstack\n";
+		for (const CallSite& site : GetCallSites())
+		{
+			file << GetTagName(site.Tag) << ',' << site.Samples << ',' << site.SampledBytes << ',' << EstimateBytes(site, sampleInterval) << ",\"";
+			for (u32 frame = 0; frame < site.FrameCount; ++frame)
+			{
+				String symbol = DescribeFrame(site.Frames[frame]);
+				std::replace(symbol.begin(), symbol.end(), '"', '\'');
+				file << (frame > 0 ? " | " : "") << symbol;
+			}
+			file << "\"\n";
+		}
+
+		ZN_LOG_INFO(Memory, "[MemoryTracker::ExportCsv] Wrote {}", path);
+		return true;
+	}
+
+	b8 MemoryTracker::ExportJson(const String& path)
+	{
+		std::ofstream file(path);
+		if (!file)
+		{
+			ZN_LOG_ERROR(Memory, "[MemoryTracker::ExportJson] Couldn't open {}", path);
+			return false;
+		}
+
+		const u32 sampleInterval = GetSampleInterval();
+
+		file << "{\n  \"sampleInterval\": " << sampleInterval << ",\n  \"heaps\": [\n";
+		for (uSize heap = 0; heap < HEAP_COUNT; ++heap)
+		{
+			const MemoryHeap memoryHeap = static_cast<MemoryHeap>(heap);
+			file << "    { \"name\": \"" << GetHeapName(memoryHeap) << "\", \"liveBytes\": " << GetLiveBytes(memoryHeap)
+				<< ", \"peakBytes\": " << GetPeakBytes(memoryHeap) << ", \"budgetBytes\": " << GetBudget(memoryHeap) << ", \"tags\": [\n";
+
+			for (uSize tag = 0; tag < TAG_COUNT; ++tag)
+			{
+				const TagStats stats = GetTagStats(memoryHeap, static_cast<MemoryTag>(tag));
+				file << "      { \"tag\": \"" << GetTagName(static_cast<MemoryTag>(tag)) << "\", \"liveBytes\": " << stats.LiveBytes
+					<< ", \"peakBytes\": " << stats.PeakBytes << ", \"liveAllocations\": " << stats.LiveAllocations
+					<< ", \"totalAllocations\": " << stats.TotalAllocations << ", \"totalBytes\": " << stats.TotalBytes
+					<< ", \"allocationsPerSecond\": " << stats.AllocationsPerSecond << ", \"bytesPerSecond\": " << stats.BytesPerSecond
+					<< " }" << (tag + 1 < TAG_COUNT ? "," : "") << '\n';
+			}
+
+			file << "    ] }" << (heap + 1 < HEAP_COUNT ? "," : "") << '\n';
+		}
+
+		file << "  ],\n  \"callSites\": [\n";
+
+		const Vector<CallSite> sites = GetCallSites();
+		for (uSize i = 0; i < sites.size(); ++i)
+		{
+			const CallSite& site = sites[i];
+			file << "    { \"tag\": \"" << GetTagName(site.Tag) << "\", \"samples\": " << site.Samples << ", \"sampledBytes\": " << site.SampledBytes
+				<< ", \"estimatedBytes\": " << EstimateBytes(site, sampleInterval) << ", \"frames\": [";
+
+			for (u32 frame = 0; frame < site.FrameCount; ++frame)
+			{
+				file << (frame > 0 ? ", " : "") << '"' << EscapeJson(DescribeFrame(site.Frames[frame])) << '"';
+			}
+
+			file << "] }" << (i + 1 < sites.size() ? "," : "") << '\n';
+		}
+
+		file << "  ]\n}\n";
+
+		ZN_LOG_INFO(Memory, "[MemoryTracker::ExportJson] Wrote {}", path);
+		return true;
+	}
+
+	void MemoryTracker::OnImGui()
+	{
+		ImGui::Begin("Memory");
+
+		if (!IsCpuTrackingEnabled())
+		{
+			ImGui::Text("CPU tracking disabled (build with ZN_MEMORY_TRACKING)");
+		}
+
+		if (const u64 violations = AllocationGuard::GetViolationCount(); violations > 0)
+		{
+			ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%llu allocations inside no-alloc scopes", static_cast<unsigned long long>(violations));
+		}
+
+		for (uSize heap = 0; heap < HEAP_COUNT; ++heap)
+		{
+			const MemoryHeap memoryHeap = static_cast<MemoryHeap>(heap);
+			const f64 live = static_cast<f64>(GetLiveBytes(memoryHeap)) / BYTES_PER_MB;
+			const f64 budget = static_cast<f64>(GetBudget(memoryHeap)) / BYTES_PER_MB;
+
+			c8 overlay[96];
+			std::snprintf(overlay, sizeof(overlay), "%s: %.1f / %.0f MB (peak %.1f MB)", GetHeapName(memoryHeap), live, budget,
+				static_cast<f64>(GetPeakBytes(memoryHeap)) / BYTES_PER_MB);
+			ImGui::ProgressBar(budget > 0.0 ? static_cast<f32>(live / budget) : 0.0f, ImVec2(-1.0f, 0.0f), overlay);
+
+			ImGui::PushID(static_cast<int>(heap));
+			if (ImGui::BeginTable("Tags", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+			{
+				ImGui::TableSetupColumn("Tag");
+				ImGui::TableSetupColumn("Live KB");
+				ImGui::TableSetupColumn("Peak KB");
+				ImGui::TableSetupColumn("Allocations");
+				ImGui::TableSetupColumn("Allocs/s");
+				ImGui::TableSetupColumn("KB/s");
+				ImGui::TableHeadersRow();
+
+				for (uSize tag = 0; tag < TAG_COUNT; ++tag)
+				{
+					const TagStats stats = GetTagStats(memoryHeap, static_cast<MemoryTag>(tag));
+					if (stats.TotalAllocations == 0)
+						continue;
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn(); ImGui::Text("%s", GetTagName(static_cast<MemoryTag>(tag)));
+					ImGui::TableNextColumn(); ImGui::Text("%.1f", static_cast<f64>(stats.LiveBytes) / 1024.0);
+					ImGui::TableNextColumn(); ImGui::Text("%.1f", static_cast<f64>(stats.PeakBytes) / 1024.0);
+					ImGui::TableNextColumn(); ImGui::Text("%lld", static_cast<long long>(stats.LiveAllocations));
+					ImGui::TableNextColumn(); ImGui::Text("%.0f", stats.AllocationsPerSecond);
+					ImGui::TableNextColumn(); ImGui::Text("%.1f", stats.BytesPerSecond / 1024.0);
+				}
+
+				ImGui::EndTable();
+			}
+			ImGui::PopID();
+		}
+
+		if (ImGui::CollapsingHeader("Call sites"))
+		{
+			int interval = static_cast<int>(GetSampleInterval());
+			if (ImGui::SliderInt("Sample every N allocations", &interval, 0, 4096))
+			{
+				SetSampleInterval(static_cast<u32>(interval));
+			}
+
+			ImGui::Text("Dropped samples: %llu", static_cast<unsigned long long>(s_droppedSamples.load(std::memory_order_relaxed)));
+
+			constexpr uSize MAX_LISTED_SITES = 32;
+			const Vector<CallSite> sites = GetCallSites();
+			const u32 sampleInterval = GetSampleInterval();
+
+			for (uSize i = 0; i < sites.size() && i < MAX_LISTED_SITES; ++i)
+			{
+				const CallSite& site = sites[i];
+
+				c8 label[128];
+				std::snprintf(label, sizeof(label), "%s: ~%.1f KB (%llu samples)##%u", GetTagName(site.Tag),
+					static_cast<f64>(EstimateBytes(site, sampleInterval)) / 1024.0, static_cast<unsigned long long>(site.Samples), static_cast<u32>(i));
+
+				// Symbols are only resolved for expanded sites
+				if (ImGui::TreeNode(label))
+				{
+					for (u32 frame = 0; frame < site.FrameCount; ++frame)
+					{
+						ImGui::Text("%s", DescribeFrame(site.Frames[frame]).c_str());
+					}
+
+					ImGui::TreePop();
+				}
+			}
+		}
+
+		if (ImGui::Button("Export CSV"))
+		{
+			ExportCsv("MemoryReport.csv");
+		}
+
+		ImGui::SameLine();
+
+		if (ImGui::Button("Export JSON"))
+		{
+			ExportJson("MemoryReport.json");
+		}
+
+		ImGui::End();
+	}
+
+	const c8* MemoryTracker::GetTagName(MemoryTag tag)
+	{
+		switch (tag)
+		{
+			case MemoryTag::Untagged:   return "Untagged";
+			case MemoryTag::Core:       return "Core";
+			case MemoryTag::Renderer:   return "Renderer";
+			case MemoryTag::Resource:   return "Resource";
+			case MemoryTag::Scene:      return "Scene";
+			case MemoryTag::Events:     return "Events";
+			case MemoryTag::FileSystem: return "FileSystem";
+			case MemoryTag::Logging:    return "Logging";
+			case MemoryTag::Count:      break;
+		}
+
+		return "Unknown";
+	}
+
+	const c8* MemoryTracker::GetHeapName(MemoryHeap heap)
+	{
+		switch (heap)
+		{
+			case MemoryHeap::Cpu:   return "CPU";
+			case MemoryHeap::Gpu:   return "GPU";
+			case MemoryHeap::Count: break;
+		}
+
+		return "Unknown";
+	}
+
+#if defined(ZN_MEMORY_TRACKING)
+	namespace
+	{
+		// Header in front of every tracked allocation, right before the pointer handed out
+		struct AllocationHeader
+		{
+			u64 Size;
+			u32 Offset;  // From the start of the underlying block to the user pointer
+			MemoryTag Tag;
+			b8 OverAligned;
+			u16 Padding;
+		};
+
+		static_assert(sizeof(AllocationHeader) == 16, "The header must keep default new alignment");
+
+		void* TrackedAllocate(uSize size, uSize alignment)
+		{
+#if !defined(ZN_CRT_ALLOCATION_HOOK)
+			AllocationGuard::OnAllocation(size);
+#endif
+
+			const b8 overAligned = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+			const uSize offset = std::max<uSize>(alignment, sizeof(AllocationHeader));
+
+			Byte* block = nullptr;
+			if (overAligned)
+			{
+#if defined(_MSC_VER)
+				block = static_cast<Byte*>(_aligned_malloc(size + offset, alignment));
+#else
+				block = static_cast<Byte*>(std::aligned_alloc(alignment, (size + offset + alignment - 1) & ~(alignment - 1)));
+#endif
+			}
+			else
+			{
+				block = static_cast<Byte*>(std::malloc(size + offset));
+			}
+
+			if (block == nullptr)
+				return nullptr;
+
+			Byte* pointer = block + offset;
+			AllocationHeader* header = reinterpret_cast<AllocationHeader*>(pointer) - 1;
+			header->Size = size;
+			header->Offset = static_cast<u32>(offset);
+			header->Tag = t_tag;
+			header->OverAligned = overAligned;
+
+			MemoryTracker::TrackAllocation(MemoryHeap::Cpu, header->Tag, size);
+			return pointer;
+		}
+
+		void TrackedFree(void* pointer)
+		{
+			if (pointer == nullptr)
+				return;
+
+			const AllocationHeader* header = static_cast<AllocationHeader*>(pointer) - 1;
+			MemoryTracker::TrackFree(MemoryHeap::Cpu, header->Tag, header->Size);
+
+			Byte* block = static_cast<Byte*>(pointer) - header->Offset;
+			if (header->OverAligned)
+			{
+#if defined(_MSC_VER)
+				_aligned_free(block);
+#else
+				std::free(block);
+#endif
+			}
+			else
+			{
+				std::free(block);
+			}
+		}
+
+		void* TrackedNew(uSize size, uSize alignment)
+		{
+			while (true)
+			{
+				if (void* pointer = TrackedAllocate(size, alignment))
+					return pointer;
+
+				std::new_handler handler = std::get_new_handler();
+				if (handler == nullptr)
+					throw std::bad_alloc();
+
+				handler();
+			}
+		}
+
+		void* TrackedNewNoThrow(uSize size, uSize alignment) noexcept
+		{
+			try
+			{
+				return TrackedNew(size, alignment);
+			}
+			catch (...)
+			{
+				return nullptr;
+			}
+		}
+	}
+#endif
+}
+
+#if defined(ZN_MEMORY_TRACKING)
+
+// Replacing the global operators makes every CPU allocation of the process go through the tracker.
+// They live in this translation unit so they're always linked in together with the tracker
+void* operator new(std::size_t size) { return zn::TrackedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](std::size_t size) { return zn::TrackedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return zn::TrackedNewNoThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return zn::TrackedNewNoThrow(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return zn::TrackedNew(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return zn::TrackedNew(size, static_cast<std::size_t>(alignment)); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return zn::TrackedNewNoThrow(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return zn::TrackedNewNoThrow(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void* pointer) noexcept { zn::TrackedFree(pointer); }
+void operator delete[](void* pointer) noexcept { zn::TrackedFree(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { zn::TrackedFree(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { zn::TrackedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { zn::TrackedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { zn::TrackedFree(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { zn::TrackedFree(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { zn::TrackedFree(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { zn::TrackedFree(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { zn::TrackedFree(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { zn::TrackedFree(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { zn::TrackedFree(pointer); }
+
+#endif
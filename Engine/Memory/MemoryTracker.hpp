@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+namespace zn
+{
+	// Subsystem an allocation is charged to. CPU allocations take the tag of the calling thread
+	// (see MemoryTagScope), jobs inherit the tag of the thread that started them
+	enum class MemoryTag : u8
+	{
+		Untagged,
+		Core,
+		Renderer,
+		Resource,
+		Scene,
+		Events,
+		FileSystem,
+		Logging,
+
+		Count
+	};
+
+	enum class MemoryHeap : u8
+	{
+		Cpu,
+		Gpu,
+
+		Count
+	};
+
+	// Charges the calling thread's allocations to a tag until the scope ends. Scopes nest
+	class MemoryTagScope
+	{
+	public:
+		explicit MemoryTagScope(MemoryTag tag);
+		~MemoryTagScope();
+
+		MemoryTagScope(const MemoryTagScope& other) = delete;
+		MemoryTagScope(MemoryTagScope&& other) noexcept = delete;
+
+		MemoryTagScope& operator=(const MemoryTagScope& other) = delete;
+		MemoryTagScope& operator=(MemoryTagScope&& other) noexcept = delete;
+
+	private:
+		MemoryTag m_previous;
+	};
+
+	// Engine wide memory accounting per heap and tag. With ZN_MEMORY_TRACKING the global operator
+	// new/delete report every CPU allocation; GPU resources report their storage explicitly with
+	// TrackAllocation / TrackFree. Counters are lock free, so tracking is cheap enough to leave on.
+	//
+	// Call sites are sampled: every SampleInterval-th allocation of a thread captures its call stack
+	// into a fixed size table, so the tracker itself never allocates from inside operator new.
+	class MemoryTracker
+	{
+	public:
+		struct TagStats
+		{
+			i64 LiveBytes = 0;
+			i64 PeakBytes = 0;
+			i64 LiveAllocations = 0;
+			u64 TotalAllocations = 0;
+			u64 TotalBytes = 0;
+			f64 AllocationsPerSecond = 0.0; // Averaged between Update calls
+			f64 BytesPerSecond = 0.0;
+		};
+
+		static constexpr u32 MAX_CALLSTACK_FRAMES = 8;
+		static constexpr u32 MAX_CALL_SITES = 512;
+		static constexpr u32 DEFAULT_SAMPLE_INTERVAL = 128;
+
+		struct CallSite
+		{
+			MemoryTag Tag = MemoryTag::Untagged;
+			u64 Samples = 0;
+			u64 SampledBytes = 0;
+			u32 FrameCount = 0;
+			Array<void*, MAX_CALLSTACK_FRAMES> Frames{};
+		};
+
+		MemoryTracker() = delete;
+
+		// False when built without ZN_MEMORY_TRACKING; GPU tracking works either way
+		[[nodiscard]] static constexpr b8 IsCpuTrackingEnabled()
+		{
+#if defined(ZN_MEMORY_TRACKING)
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		[[nodiscard]] static MemoryTag GetCurrentTag();
+
+		static void TrackAllocation(MemoryHeap heap, MemoryTag tag, uSize bytes);
+		static void TrackFree(MemoryHeap heap, MemoryTag tag, uSize bytes);
+
+		// Allocations between two samples of a thread. 0 disables call site capture
+		static void SetSampleInterval(u32 interval);
+		[[nodiscard]] static u32 GetSampleInterval();
+
+		// Exceeding a budget is logged once and shown in the panel
+		static void SetBudget(MemoryHeap heap, uSize bytes);
+		[[nodiscard]] static uSize GetBudget(MemoryHeap heap);
+
+		// Once per frame: refreshes the rates and checks the budgets
+		static void Update();
+
+		[[nodiscard]] static TagStats GetTagStats(MemoryHeap heap, MemoryTag tag);
+		[[nodiscard]] static i64 GetLiveBytes(MemoryHeap heap);
+		[[nodiscard]] static i64 GetPeakBytes(MemoryHeap heap);
+
+		// Sampled call sites, most bytes first
+		[[nodiscard]] static Vector<CallSite> GetCallSites();
+		// Return addresses of the calling thread, skipping the innermost frames. Doesn't allocate
+		static u32 CaptureCallStack(void** frames, u32 maxFrames, u32 skippedFrames);
+		// Symbol (and file:line where available) of a captured frame
+		[[nodiscard]] static String DescribeFrame(void* address);
+
+		static b8 ExportCsv(const String& path);
+		static b8 ExportJson(const String& path);
+
+		static void OnImGui();
+
+		[[nodiscard]] static const c8* GetTagName(MemoryTag tag);
+		[[nodiscard]] static const c8* GetHeapName(MemoryHeap heap);
+
+	private:
+		friend class MemoryTagScope;
+
+		static void SetCurrentTag(MemoryTag tag);
+	};
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+namespace zn
+{
+	constexpr uSize CACHE_LINE_SIZE = 64;
+
+	constexpr b8 IsPowerOfTwo(uSize value)
+	{
+		return value != 0 && (value & (value - 1)) == 0;
+	}
+
+	constexpr uintptr_t AlignUp(uintptr_t value, uSize alignment)
+	{
+		return (value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+	}
+}
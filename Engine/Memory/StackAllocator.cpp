@@ -0,0 +1,54 @@
+#include "StackAllocator.hpp"
+
+#include "Core/Assert.hpp"
+#include "Memory/MemoryUtils.hpp"
+
+#include <new>
+
+namespace zn
+{
+	StackAllocator::StackAllocator(uSize capacity)
+		: m_capacity(capacity)
+	{
+		m_buffer = static_cast<Byte*>(::operator new(capacity, std::align_val_t{ CACHE_LINE_SIZE }));
+	}
+
+	StackAllocator::~StackAllocator()
+	{
+		ZN_ASSERT(m_offset == 0, "Stack allocator destroyed with live allocations");
+		::operator delete(m_buffer, std::align_val_t{ CACHE_LINE_SIZE });
+	}
+
+	void* StackAllocator::Allocate(uSize size, uSize alignment)
+	{
+		ZN_ASSERT(IsPowerOfTwo(alignment), "Alignment must be a power of two");
+
+		const uintptr_t base = reinterpret_cast<uintptr_t>(m_buffer);
+		const uSize aligned = AlignUp(base + m_offset, alignment) - base;
+		if (aligned + size > m_capacity)
+			return nullptr;
+
+		m_offset = aligned + size;
+		m_highWaterMark = m_offset > m_highWaterMark ? m_offset : m_highWaterMark;
+
+		return m_buffer + aligned;
+	}
+
+	void StackAllocator::FreeToMarker(Marker marker)
+	{
+		ZN_ASSERT(marker <= m_offset, "Freeing to a marker above the top of the stack");
+		m_offset = marker;
+	}
+
+	b8 StackAllocator::Owns(const void* pointer) const
+	{
+		const Byte* bytes = static_cast<const Byte*>(pointer);
+		return bytes >= m_buffer && bytes < m_buffer + m_capacity;
+	}
+
+	StackAllocator& StackAllocator::GetThreadScratch()
+	{
+		thread_local StackAllocator t_scratch(SCRATCH_CAPACITY);
+		return t_scratch;
+	}
+}
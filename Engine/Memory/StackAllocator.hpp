@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+#include <cstddef>
+
+namespace zn
+{
+	// LIFO allocator over a fixed block. Allocations are released in bulk by rolling back to a
+	// marker, usually through a Scope. Single threaded; every thread has its own scratch stack
+	class StackAllocator
+	{
+	public:
+		using Marker = uSize;
+
+		// Rolls the stack back to where it was when the scope was opened
+		class Scope
+		{
+		public:
+			explicit Scope(StackAllocator& allocator)
+				: m_allocator(allocator), m_marker(allocator.GetMarker()) {}
+
+			~Scope() { m_allocator.FreeToMarker(m_marker); }
+
+			Scope(const Scope& other) = delete;
+			Scope(Scope&& other) noexcept = delete;
+
+			Scope& operator=(const Scope& other) = delete;
+			Scope& operator=(Scope&& other) noexcept = delete;
+
+		private:
+			StackAllocator& m_allocator;
+			Marker m_marker;
+		};
+
+		// Size of the per thread scratch stacks
+		static constexpr uSize SCRATCH_CAPACITY = 256 * 1024;
+
+		explicit StackAllocator(uSize capacity);
+		~StackAllocator();
+
+		StackAllocator(const StackAllocator& other) = delete;
+		StackAllocator(StackAllocator&& other) noexcept = delete;
+
+		StackAllocator& operator=(const StackAllocator& other) = delete;
+		StackAllocator& operator=(StackAllocator&& other) noexcept = delete;
+
+		// Returns nullptr when the block is full
+		[[nodiscard]] void* Allocate(uSize size, uSize alignment = alignof(std::max_align_t));
+
+		template<typename T>
+		[[nodiscard]] T* AllocateArray(uSize count)
+		{
+			return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		[[nodiscard]] Marker GetMarker() const { return m_offset; }
+		// Frees everything allocated after the marker was taken
+		void FreeToMarker(Marker marker);
+
+		[[nodiscard]] b8 Owns(const void* pointer) const;
+
+		[[nodiscard]] uSize GetUsed() const { return m_offset; }
+		[[nodiscard]] uSize GetCapacity() const { return m_capacity; }
+		[[nodiscard]] uSize GetHighWaterMark() const { return m_highWaterMark; }
+		void ResetHighWaterMark() { m_highWaterMark = m_offset; }
+
+		// Scratch stack of the calling thread, created on first use
+		[[nodiscard]] static StackAllocator& GetThreadScratch();
+
+	private:
+		Byte* m_buffer = nullptr;
+		uSize m_capacity = 0;
+		uSize m_offset = 0;
+		uSize m_highWaterMark = 0;
+	};
+}
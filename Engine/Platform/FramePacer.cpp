@@ -0,0 +1,153 @@
+#include "FramePacer.hpp"
+
+#include "Core/Assert.hpp"
+#include "Core/Log.hpp"
+#include "Core/StatsRegistry.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <cmath>
+#include <thread>
+
+namespace zn
+{
+	namespace
+	{
+		// Weight of a new sample in the sleep estimate
+		constexpr f64 SLEEP_ESTIMATE_WEIGHT = 0.1;
+
+		f64 ToMilliseconds(Time::Duration duration)
+		{
+			return duration.count() * 1000.0;
+		}
+	}
+
+	void FramePacer::Init(GLFWwindow* window, Mode mode)
+	{
+		m_window = window;
+
+		m_adaptiveSupported = glfwExtensionSupported("WGL_EXT_swap_control_tear") == GLFW_TRUE
+			|| glfwExtensionSupported("GLX_EXT_swap_control_tear") == GLFW_TRUE;
+
+		SetMode(mode);
+
+		m_lastPresentEnd = Time::GetCurrentTime();
+	}
+
+	void FramePacer::SetMode(Mode mode)
+	{
+		if (mode == Mode::Adaptive && !m_adaptiveSupported)
+		{
+			ZN_LOG_WARN(Platform, "[FramePacer::SetMode] EXT_swap_control_tear is not supported, falling back to VSync");
+			mode = Mode::VSync;
+		}
+
+		switch (mode)
+		{
+			case Mode::VSync:    glfwSwapInterval(1);  break;
+			case Mode::Adaptive: glfwSwapInterval(-1); break;
+			case Mode::Uncapped:
+			case Mode::Limited:  glfwSwapInterval(0);  break;
+		}
+
+		m_mode = mode;
+
+		ZN_LOG_INFO(Platform, "[FramePacer::SetMode] Frame pacing mode: {}", GetModeName(m_mode));
+	}
+
+	void FramePacer::SetTargetFrameRate(f64 framesPerSecond)
+	{
+		ZN_ASSERT(framesPerSecond > 0.0, "Target frame rate must be positive");
+
+		m_targetFrameTime = Time::Duration(1.0 / framesPerSecond);
+		// Restart the deadline sequence from the next frame
+		m_nextDeadline = {};
+	}
+
+	void FramePacer::Present()
+	{
+		ZN_ASSERT(m_window, "FramePacer used before Init");
+
+		const Time::TimePoint cpuEnd = Time::GetCurrentTime();
+
+		if (m_mode == Mode::Limited)
+		{
+			const Time::Clock::duration period = std::chrono::duration_cast<Time::Clock::duration>(m_targetFrameTime);
+
+			// More than a period late (hitch, first Limited frame): start over instead of rushing to catch up
+			m_nextDeadline += period;
+			if (cpuEnd - m_nextDeadline > period)
+			{
+				m_nextDeadline = cpuEnd;
+			}
+
+			WaitUntil(m_nextDeadline);
+		}
+
+		const Time::TimePoint presentStart = Time::GetCurrentTime();
+		glfwSwapBuffers(m_window);
+		const Time::TimePoint presentEnd = Time::GetCurrentTime();
+
+		FrameTiming& timing = m_history[m_historyHead];
+		timing.CpuMs = ToMilliseconds(cpuEnd - m_lastPresentEnd);
+		timing.LimiterMs = ToMilliseconds(presentStart - cpuEnd);
+		timing.PresentMs = ToMilliseconds(presentEnd - presentStart);
+		timing.FrameMs = ToMilliseconds(presentEnd - m_lastPresentEnd);
+
+		ZN_STAT_SET("Frame/Frame ms", timing.FrameMs);
+		ZN_STAT_SET("Frame/CPU ms", timing.CpuMs);
+		ZN_STAT_SET("Frame/Present ms", timing.PresentMs);
+
+		m_historyHead = (m_historyHead + 1) % HISTORY_SIZE;
+		m_historyCount = std::min(m_historyCount + 1, HISTORY_SIZE);
+
+		m_lastPresentEnd = presentEnd;
+	}
+
+	const FramePacer::FrameTiming& FramePacer::GetTiming(u32 framesAgo) const
+	{
+		ZN_ASSERT(framesAgo < HISTORY_SIZE, "Frame timing history only keeps HISTORY_SIZE frames");
+
+		return m_history[(m_historyHead + HISTORY_SIZE - 1 - framesAgo) % HISTORY_SIZE];
+	}
+
+	const c8* FramePacer::GetModeName(Mode mode)
+	{
+		switch (mode)
+		{
+			case Mode::VSync:    return "VSync";
+			case Mode::Uncapped: return "Uncapped";
+			case Mode::Adaptive: return "Adaptive";
+			case Mode::Limited:  return "Limited";
+		}
+
+		return "Unknown";
+	}
+
+	void FramePacer::WaitUntil(Time::TimePoint deadline)
+	{
+		// Sleep in 1ms steps while there is clearly enough time left, since the OS can oversleep
+		// by a lot. The last stretch is spun, which is accurate but burns a core
+		while (true)
+		{
+			const f64 remaining = Time::Duration(deadline - Time::GetCurrentTime()).count();
+			const f64 sleepEstimate = m_sleepMean + std::sqrt(m_sleepVariance);
+
+			if (remaining <= sleepEstimate)
+				break;
+
+			const Time::TimePoint sleepStart = Time::GetCurrentTime();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			const f64 slept = Time::Duration(Time::GetCurrentTime() - sleepStart).count();
+
+			const f64 delta = slept - m_sleepMean;
+			m_sleepMean += SLEEP_ESTIMATE_WEIGHT * delta;
+			m_sleepVariance = (1.0 - SLEEP_ESTIMATE_WEIGHT) * (m_sleepVariance + SLEEP_ESTIMATE_WEIGHT * delta * delta);
+		}
+
+		while (Time::GetCurrentTime() < deadline)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Core/Timer.hpp"
+
+struct GLFWwindow;
+
+namespace zn
+{
+	// Controls how frames are presented and records how long each one took.
+	//
+	//  - VSync:    swap interval 1, locked to the display refresh.
+	//  - Uncapped: swap interval 0, presents as soon as the frame is done. Useful to measure real frame cost.
+	//  - Adaptive: swap interval -1 (EXT_swap_control_tear). Syncs like VSync, but a late frame tears
+	//              instead of waiting a full extra vblank. Falls back to VSync when unsupported.
+	//  - Limited:  swap interval 0 plus a CPU limiter that holds each frame to the target frame time.
+	class FramePacer
+	{
+	public:
+		enum class Mode : u8
+		{
+			VSync,
+			Uncapped,
+			Adaptive,
+			Limited,
+		};
+
+		struct FrameTiming
+		{
+			f64 CpuMs = 0.0;     // From the end of the previous present to the start of this one
+			f64 LimiterMs = 0.0; // Time held back by the frame limiter
+			f64 PresentMs = 0.0; // Time spent inside SwapBuffers (includes the vsync wait)
+			f64 FrameMs = 0.0;   // Total, present to present
+		};
+
+		static constexpr u32 HISTORY_SIZE = 256;
+		static constexpr f64 DEFAULT_TARGET_FPS = 60.0;
+
+		FramePacer() = default;
+
+		// Must be called with the window's context current
+		void Init(GLFWwindow* window, Mode mode = Mode::VSync);
+
+		void SetMode(Mode mode);
+		[[nodiscard]] Mode GetMode() const { return m_mode; }
+		[[nodiscard]] b8 IsAdaptiveSupported() const { return m_adaptiveSupported; }
+
+		// Only used in Limited mode
+		void SetTargetFrameRate(f64 framesPerSecond);
+		[[nodiscard]] f64 GetTargetFrameRate() const { return 1.0 / m_targetFrameTime.count(); }
+
+		// Waits for the frame limiter if needed, swaps buffers and records the timings of the frame
+		void Present();
+
+		// Ring buffer of the last HISTORY_SIZE frames. Index 0 is the most recent frame
+		[[nodiscard]] const FrameTiming& GetTiming(u32 framesAgo = 0) const;
+		[[nodiscard]] u32 GetHistoryCount() const { return m_historyCount; }
+
+		[[nodiscard]] static const c8* GetModeName(Mode mode);
+
+	private:
+		void WaitUntil(Time::TimePoint deadline);
+
+		GLFWwindow* m_window = nullptr;
+
+		Mode m_mode = Mode::VSync;
+		b8 m_adaptiveSupported = false;
+
+		Time::Duration m_targetFrameTime{ 1.0 / DEFAULT_TARGET_FPS };
+		Time::TimePoint m_lastPresentEnd{};
+		// Limited mode deadlines advance by exactly one target frame time, so time spent in present
+		// doesn't stretch the period
+		Time::TimePoint m_nextDeadline{};
+
+		// Moving estimate of how long a 1ms sleep really takes, in seconds. The limiter sleeps while
+		// the remaining time is above mean + stddev and spins for the rest
+		f64 m_sleepMean = 0.002;
+		f64 m_sleepVariance = 0.0;
+
+		Array<FrameTiming, HISTORY_SIZE> m_history{};
+		u32 m_historyHead = 0;
+		u32 m_historyCount = 0;
+	};
+}
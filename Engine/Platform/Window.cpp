@@ -6,6 +6,7 @@
 #include "Events/Event.hpp"
 #include "Events/KeyEvent.hpp"
 #include "FileSystem/FileSystem.hpp"
+#include "Renderer/GLStateCache.hpp"
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -17,6 +18,10 @@ namespace zn
 {
 	Window::~Window()
 	{
+		// Never initialized, e.g. a headless application
+		if (!m_window)
+			return;
+
 		// ImGui Cleanup
 		ImGui_ImplOpenGL3_Shutdown();
 		ImGui_ImplGlfw_Shutdown();
@@ -35,7 +40,7 @@ namespace zn
 		
 		if (!glfwInit())
 		{
-			ZN_CORE_CRITICAL("[Window::Init] Failed to initialize GLFW. Aborting");
+			ZN_LOG_CRITICAL(Platform, "[Window::Init] Failed to initialize GLFW. Aborting");
 			return false;
 		}
 
@@ -49,23 +54,23 @@ namespace zn
 		m_window = glfwCreateWindow(m_width, m_height, m_name.c_str(), nullptr, nullptr);
 		if (!m_window)
 		{
-			ZN_CORE_CRITICAL("[Window::Init] Failed to create GLFW window. Aborting");
+			ZN_LOG_CRITICAL(Platform, "[Window::Init] Failed to create GLFW window. Aborting");
 			glfwTerminate();
 			return false;
 		}
 
 		glfwMakeContextCurrent(m_window);
-		glfwSwapInterval(1); // Force VSYNC
+		m_framePacer.Init(m_window, FramePacer::Mode::VSync);
 
 		if (!gladLoadGL(glfwGetProcAddress))
 		{
-			ZN_CORE_CRITICAL("[Window::Init] Failed to initialize GLAD. Aborting");
+			ZN_LOG_CRITICAL(Platform, "[Window::Init] Failed to initialize GLAD. Aborting");
 			glfwTerminate();
 			return false;
 		}
 		
 		// Configure global opengl state
-		glEnable(GL_DEPTH_TEST);
+		GLStateCache::SetDepthTest(true);
 		
 		const char* glslVersion = "#version 450";
 		
@@ -119,7 +124,7 @@ namespace zn
 			glDebugMessageCallback(OpenGLDebugOutput, nullptr);
 			glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
 			
-			ZN_CORE_INFO("[Window::Init] OpenGL Debug Context successfully initialized");
+			ZN_LOG_INFO(Platform, "[Window::Init] OpenGL Debug Context successfully initialized");
 		}
 #endif
 		return true;
@@ -231,7 +236,7 @@ namespace zn
 		}
 	}
 
-	void Window::RenderImGUI() const
+	void Window::RenderImGUI(const Func<void()>& drawUI) const
 	{
 		// Start the Dear ImGui frame
 		ImGui_ImplOpenGL3_NewFrame();
@@ -241,6 +246,11 @@ namespace zn
 		bool show_demo_window = true;
 		ImGui::ShowDemoWindow(&show_demo_window);
 
+		if (drawUI)
+		{
+			drawUI();
+		}
+
 		ImGui::Render();
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
@@ -254,9 +264,9 @@ namespace zn
 		}
 	}
 	
-	void Window::SwapBuffers() const
+	void Window::SwapBuffers()
 	{
-		glfwSwapBuffers(m_window);
+		m_framePacer.Present();
 	}
 
 #ifdef ZN_DEBUG
@@ -295,19 +305,19 @@ namespace zn
 		switch (severity)
 		{
 			case GL_DEBUG_SEVERITY_HIGH:
-				ZN_CORE_ERROR("Debug message ({}): {}\n{}\n{}\n{}\n", id, message, messageSource, messageType, "Severity: high");
+				ZN_LOG_ERROR_LIMITED(Renderer, "Debug message ({}): {}\n{}\n{}\n{}\n", id, message, messageSource, messageType, "Severity: high");
 				break;
 
 			case GL_DEBUG_SEVERITY_MEDIUM:  
-				ZN_CORE_WARN("Debug message ({}): {}\n{}\n{}\n{}\n", id, message, messageSource, messageType, "Severity: medium");
+				ZN_LOG_WARN_LIMITED(Renderer, "Debug message ({}): {}\n{}\n{}\n{}\n", id, message, messageSource, messageType, "Severity: medium");
 				break;
 
 			case GL_DEBUG_SEVERITY_LOW:          
-				ZN_CORE_TRACE("Debug message ({}): {}\n{}\n{}\n{}\n", id, message, messageSource, messageType, "Severity: low");
+				ZN_LOG_TRACE(Renderer, "Debug message ({}): {}\n{}\n{}\n{}\n", id, message, messageSource, messageType, "Severity: low");
 				break;
 
 			case GL_DEBUG_SEVERITY_NOTIFICATION:
-				ZN_CORE_TRACE("Debug message ({}): {}\n{}\n{}\n{}\n", id, message, messageSource, messageType, "Severity: notification");
+				ZN_LOG_TRACE(Renderer, "Debug message ({}): {}\n{}\n{}\n{}\n", id, message, messageSource, messageType, "Severity: notification");
 				break;
 		}
 
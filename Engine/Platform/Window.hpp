@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core/Base.hpp"
+#include "Platform/FramePacer.hpp"
 
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
@@ -23,8 +24,10 @@ namespace zn
 		b8 Init(u32 width, u32 height, const String& name);
 		
 		void PollEvents() const;
-		void RenderImGUI() const;
-		void SwapBuffers() const;
+		// drawUI is called between NewFrame and Render, so callers can add their own windows
+		void RenderImGUI(const Func<void()>& drawUI = {}) const;
+		// Presents through the frame pacer, which applies the pacing mode and records frame timings
+		void SwapBuffers();
 		b8 ShouldClose() const;
 
 		[[nodiscard]] 
@@ -33,6 +36,9 @@ namespace zn
 		u32 GetWidth() const { return m_width; }
 		u32 GetHeight() const { return m_height; }
 
+		FramePacer& GetFramePacer() { return m_framePacer; }
+		const FramePacer& GetFramePacer() const { return m_framePacer; }
+
 	protected:
 		void CloseCallback();
 		void WindowResizedCallback(int width, int height);
@@ -56,5 +62,7 @@ namespace zn
 		
 		u32 m_width = 0;
 		u32 m_height = 0;
+
+		FramePacer m_framePacer;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "ClusteredLighting.hpp"
+
+#include "GLStateCache.hpp"
+#include "Shader.hpp"
+
+#include "Core/Timer.hpp"
+#include "Memory/MemoryTracker.hpp"
+
+#include <glad/gl.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace zn
+{
+	namespace
+	{
+		// Buffers never shrink, and grow with some headroom so a slowly increasing light count doesn't reallocate every frame
+		constexpr uSize MIN_BUFFER_SIZE = 256;
+		constexpr f32 BUFFER_GROWTH = 1.5f;
+
+		u32 NdcToTile(f32 ndc, u32 tileCount)
+		{
+			const f32 tile = (ndc * 0.5f + 0.5f) * static_cast<f32>(tileCount);
+			return static_cast<u32>(std::clamp(tile, 0.0f, static_cast<f32>(tileCount - 1)));
+		}
+	}
+
+	ClusteredLighting::ClusteredLighting()
+	{
+		glCreateBuffers(1, &m_lightsBuffer);
+		glCreateBuffers(1, &m_clustersBuffer);
+		glCreateBuffers(1, &m_indicesBuffer);
+
+		glNamedBufferStorage(m_clustersBuffer, sizeof(GPUCluster) * CLUSTER_COUNT, nullptr, GL_DYNAMIC_STORAGE_BIT);
+		MemoryTracker::TrackAllocation(MemoryHeap::Gpu, MemoryTag::Renderer, sizeof(GPUCluster) * CLUSTER_COUNT);
+
+		m_clusters.resize(CLUSTER_COUNT);
+
+		// Zero sized stores can't be bound, so start with a small allocation
+		UploadBuffer(m_lightsBuffer, m_lightsCapacity, nullptr, 0);
+		UploadBuffer(m_indicesBuffer, m_indicesCapacity, nullptr, 0);
+	}
+
+	ClusteredLighting::~ClusteredLighting()
+	{
+		MemoryTracker::TrackFree(MemoryHeap::Gpu, MemoryTag::Renderer, sizeof(GPUCluster) * CLUSTER_COUNT + m_lightsCapacity + m_indicesCapacity);
+
+		for (u32 buffer : { m_lightsBuffer, m_clustersBuffer, m_indicesBuffer })
+		{
+			glDeleteBuffers(1, &buffer);
+			GLStateCache::OnBufferDeleted(buffer);
+		}
+	}
+
+	void ClusteredLighting::Update(const Vector<PointLight>& lights, const math::m4& view, const math::m4& projection,
+		f32 nearClip, f32 farClip, u32 viewportWidth, u32 viewportHeight)
+	{
+		Time::Timer timer;
+		timer.Start();
+
+		m_stats = {};
+		m_stats.Lights = static_cast<u32>(lights.size());
+
+		m_nearClip = nearClip;
+		m_farClip = farClip;
+		m_viewportWidth = std::max(viewportWidth, 1u);
+		m_viewportHeight = std::max(viewportHeight, 1u);
+
+		const f32 logDepthRange = std::log(m_farClip / m_nearClip);
+		m_sliceScale = static_cast<f32>(CLUSTERS_Z) / logDepthRange;
+		m_sliceBias = -static_cast<f32>(CLUSTERS_Z) * std::log(m_nearClip) / logDepthRange;
+
+		m_gpuLights.clear();
+		m_lightRanges.clear();
+
+		for (const PointLight& light : lights)
+		{
+			const math::v3 viewPosition = math::v3(view * math::v4(light.Position, 1.0f));
+
+			ClusterRange range;
+			if (!ComputeClusterRange(viewPosition, light.Radius, projection, range))
+				continue;
+
+			m_gpuLights.push_back({ math::v4(viewPosition, light.Radius), math::v4(light.Color, light.Intensity) });
+			m_lightRanges.push_back(range);
+		}
+
+		m_stats.VisibleLights = static_cast<u32>(m_gpuLights.size());
+
+		// Counting sort into per cluster lists: count, prefix sum, then scatter
+		for (GPUCluster& cluster : m_clusters)
+		{
+			cluster = { 0, 0 };
+		}
+
+		auto forEachCluster = [](const ClusterRange& range, auto&& func)
+		{
+			for (u32 z = range.MinZ; z <= range.MaxZ; ++z)
+				for (u32 y = range.MinY; y <= range.MaxY; ++y)
+					for (u32 x = range.MinX; x <= range.MaxX; ++x)
+						func(x + y * CLUSTERS_X + z * CLUSTERS_X * CLUSTERS_Y);
+		};
+
+		for (const ClusterRange& range : m_lightRanges)
+		{
+			forEachCluster(range, [this](u32 cluster) { ++m_clusters[cluster].Count; });
+		}
+
+		u32 offset = 0;
+		for (GPUCluster& cluster : m_clusters)
+		{
+			cluster.Offset = offset;
+			offset += cluster.Count;
+
+			m_stats.MaxLightsPerCluster = std::max(m_stats.MaxLightsPerCluster, cluster.Count);
+			cluster.Count = 0;
+		}
+
+		m_lightIndices.resize(offset);
+		m_stats.LightIndices = offset;
+
+		for (u32 lightIndex = 0; lightIndex < m_lightRanges.size(); ++lightIndex)
+		{
+			forEachCluster(m_lightRanges[lightIndex], [this, lightIndex](u32 cluster)
+			{
+				GPUCluster& entry = m_clusters[cluster];
+				m_lightIndices[entry.Offset + entry.Count++] = lightIndex;
+			});
+		}
+
+		const uSize lightBytes = m_gpuLights.size() * sizeof(GPULight);
+		const uSize clusterBytes = m_clusters.size() * sizeof(GPUCluster);
+		const uSize indexBytes = m_lightIndices.size() * sizeof(u32);
+
+		UploadBuffer(m_lightsBuffer, m_lightsCapacity, m_gpuLights.data(), lightBytes);
+		glNamedBufferSubData(m_clustersBuffer, 0, static_cast<GLsizeiptr>(clusterBytes), m_clusters.data());
+		UploadBuffer(m_indicesBuffer, m_indicesCapacity, m_lightIndices.data(), indexBytes);
+
+		m_stats.UploadBytes = static_cast<u32>(lightBytes + clusterBytes + indexBytes);
+		m_stats.AssignmentTimeMs = timer.GetElapsedTime() * 1000.0;
+	}
+
+	void ClusteredLighting::BindBuffers() const
+	{
+		GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHTS_BINDING, m_lightsBuffer);
+		GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTERS_BINDING, m_clustersBuffer);
+		GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_INDICES_BINDING, m_indicesBuffer);
+	}
+
+	void ClusteredLighting::SetShaderUniforms(const Shader& shader) const
+	{
+		shader.SetVec3("clusterGrid", math::v3(CLUSTERS_X, CLUSTERS_Y, CLUSTERS_Z));
+		shader.SetVec3("clusterSlicing", math::v3(m_sliceScale, m_sliceBias, 0.0f));
+		shader.SetVec3("clusterViewport", math::v3(static_cast<f32>(m_viewportWidth), static_cast<f32>(m_viewportHeight), 0.0f));
+	}
+
+	u32 ClusteredLighting::GetDepthSlice(f32 viewDepth) const
+	{
+		// Exponential slices: each one covers the same ratio of depth, which matches perspective much
+		// better than uniform slices
+		const f32 slice = std::log(std::max(viewDepth, m_nearClip)) * m_sliceScale + m_sliceBias;
+		return static_cast<u32>(std::clamp(slice, 0.0f, static_cast<f32>(CLUSTERS_Z - 1)));
+	}
+
+	b8 ClusteredLighting::ComputeClusterRange(const math::v3& viewPosition, f32 radius, const math::m4& projection, ClusterRange& range) const
+	{
+		// View space looks down -Z
+		const f32 depth = -viewPosition.z;
+		if (depth + radius < m_nearClip || depth - radius > m_farClip)
+			return false;
+
+		const f32 nearDepth = std::max(depth - radius, m_nearClip);
+		const f32 farDepth = std::min(depth + radius, m_farClip);
+
+		// NDC extents of the sphere's view space box. x / depth is monotonic in both terms, so the
+		// extremes are at the corners of the (x, depth) and (y, depth) ranges
+		f32 minNdcX = std::numeric_limits<f32>::max();
+		f32 maxNdcX = std::numeric_limits<f32>::lowest();
+		f32 minNdcY = std::numeric_limits<f32>::max();
+		f32 maxNdcY = std::numeric_limits<f32>::lowest();
+
+		for (const f32 d : { nearDepth, farDepth })
+		{
+			for (const f32 sign : { -1.0f, 1.0f })
+			{
+				const f32 ndcX = projection[0][0] * (viewPosition.x + sign * radius) / d;
+				const f32 ndcY = projection[1][1] * (viewPosition.y + sign * radius) / d;
+
+				minNdcX = std::min(minNdcX, ndcX);
+				maxNdcX = std::max(maxNdcX, ndcX);
+				minNdcY = std::min(minNdcY, ndcY);
+				maxNdcY = std::max(maxNdcY, ndcY);
+			}
+		}
+
+		if (maxNdcX < -1.0f || minNdcX > 1.0f || maxNdcY < -1.0f || minNdcY > 1.0f)
+			return false;
+
+		range.MinX = NdcToTile(minNdcX, CLUSTERS_X);
+		range.MaxX = NdcToTile(maxNdcX, CLUSTERS_X);
+		range.MinY = NdcToTile(minNdcY, CLUSTERS_Y);
+		range.MaxY = NdcToTile(maxNdcY, CLUSTERS_Y);
+		range.MinZ = GetDepthSlice(nearDepth);
+		range.MaxZ = GetDepthSlice(farDepth);
+
+		return true;
+	}
+
+	void ClusteredLighting::UploadBuffer(u32 buffer, uSize& capacity, const void* data, uSize size)
+	{
+		if (size > capacity || capacity == 0)
+		{
+			MemoryTracker::TrackFree(MemoryHeap::Gpu, MemoryTag::Renderer, capacity);
+			capacity = std::max(MIN_BUFFER_SIZE, static_cast<uSize>(static_cast<f32>(size) * BUFFER_GROWTH));
+			glNamedBufferData(buffer, static_cast<GLsizeiptr>(capacity), nullptr, GL_DYNAMIC_DRAW);
+			MemoryTracker::TrackAllocation(MemoryHeap::Gpu, MemoryTag::Renderer, capacity);
+		}
+
+		if (size > 0)
+		{
+			glNamedBufferSubData(buffer, 0, static_cast<GLsizeiptr>(size), data);
+		}
+	}
+}
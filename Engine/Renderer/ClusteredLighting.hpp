@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Math/Math.hpp"
+
+namespace zn
+{
+	class Shader;
+
+	struct PointLight
+	{
+		math::v3 Position{0.0f}; // World space
+		f32 Radius = 1.0f;       // No contribution past this distance
+		math::v3 Color{1.0f};
+		f32 Intensity = 1.0f;
+	};
+
+	// Clustered forward shading. The view frustum is split into a CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z
+	// grid (screen tiles times exponential depth slices). Every frame the CPU bins the lights into the
+	// clusters they touch and uploads three storage buffers:
+	//
+	//   binding 2: lights, view space    { vec4 positionRadius; vec4 colorIntensity; }
+	//   binding 3: clusters              { uint offset; uint count; }
+	//   binding 4: light indices         uint[]
+	//
+	// Fragment shaders find their cluster from gl_FragCoord and the view depth, and only loop over
+	// the lights listed for it. See Content/Shaders/Include/clustered.glsl.
+	class ClusteredLighting
+	{
+	public:
+		struct Stats
+		{
+			u32 Lights = 0;
+			u32 VisibleLights = 0;
+			u32 LightIndices = 0;     // Total entries in the light index list
+			u32 MaxLightsPerCluster = 0;
+			u32 UploadBytes = 0;
+			f64 AssignmentTimeMs = 0.0;
+		};
+
+		static constexpr u32 CLUSTERS_X = 16;
+		static constexpr u32 CLUSTERS_Y = 9;
+		static constexpr u32 CLUSTERS_Z = 24;
+		static constexpr u32 CLUSTER_COUNT = CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z;
+
+		static constexpr u32 LIGHTS_BINDING = 2;
+		static constexpr u32 CLUSTERS_BINDING = 3;
+		static constexpr u32 LIGHT_INDICES_BINDING = 4;
+
+		ClusteredLighting();
+		~ClusteredLighting();
+
+		ClusteredLighting(const ClusteredLighting& other) = delete;
+		ClusteredLighting(ClusteredLighting&& other) noexcept = delete;
+
+		ClusteredLighting& operator=(const ClusteredLighting& other) = delete;
+		ClusteredLighting& operator=(ClusteredLighting&& other) noexcept = delete;
+
+		// Bins the lights against the camera described by view/projection and uploads the results
+		void Update(const Vector<PointLight>& lights, const math::m4& view, const math::m4& projection,
+			f32 nearClip, f32 farClip, u32 viewportWidth, u32 viewportHeight);
+
+		void BindBuffers() const;
+		// Uniforms the shaders need to locate their cluster
+		void SetShaderUniforms(const Shader& shader) const;
+
+		[[nodiscard]] const Stats& GetStats() const { return m_stats; }
+
+	private:
+		struct GPULight
+		{
+			math::v4 PositionRadius;
+			math::v4 ColorIntensity;
+		};
+
+		struct GPUCluster
+		{
+			u32 Offset;
+			u32 Count;
+		};
+
+		struct ClusterRange
+		{
+			u32 MinX, MaxX;
+			u32 MinY, MaxY;
+			u32 MinZ, MaxZ;
+		};
+
+		[[nodiscard]] u32 GetDepthSlice(f32 viewDepth) const;
+		[[nodiscard]] b8 ComputeClusterRange(const math::v3& viewPosition, f32 radius, const math::m4& projection, ClusterRange& range) const;
+
+		static void UploadBuffer(u32 buffer, uSize& capacity, const void* data, uSize size);
+
+		u32 m_lightsBuffer = 0;
+		u32 m_clustersBuffer = 0;
+		u32 m_indicesBuffer = 0;
+		uSize m_lightsCapacity = 0;
+		uSize m_indicesCapacity = 0;
+
+		f32 m_nearClip = 0.1f;
+		f32 m_farClip = 100.0f;
+		f32 m_sliceScale = 0.0f; // CLUSTERS_Z / log(far / near)
+		f32 m_sliceBias = 0.0f;  // -CLUSTERS_Z * log(near) / log(far / near)
+		u32 m_viewportWidth = 1;
+		u32 m_viewportHeight = 1;
+
+		// Scratch storage, kept between frames to avoid reallocating
+		Vector<GPULight> m_gpuLights;
+		Vector<ClusterRange> m_lightRanges;
+		Vector<GPUCluster> m_clusters;
+		Vector<u32> m_lightIndices;
+
+		Stats m_stats;
+	};
+}
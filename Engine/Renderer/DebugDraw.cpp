@@ -0,0 +1,247 @@
+#include "DebugDraw.hpp"
+
+#include "GLStateCache.hpp"
+#include "StreamingBuffer.hpp"
+#include "VertexArray.hpp"
+
+#include "Core/Log.hpp"
+#include "Resource/ResourceManager.hpp"
+
+#include <glad/gl.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+namespace zn
+{
+	UniquePtr<StreamingBuffer> DebugDraw::s_streamingBuffer;
+	UniquePtr<VertexArray> DebugDraw::s_vertexArray;
+	Handle<Shader> DebugDraw::s_shaderHandle{};
+
+	Vector<DebugDraw::Vertex> DebugDraw::s_depthTestedVertices;
+	Vector<DebugDraw::Vertex> DebugDraw::s_overlayVertices;
+	DebugDraw::Stats DebugDraw::s_currentStats{};
+	DebugDraw::Stats DebugDraw::s_lastFrameStats{};
+
+	b8 DebugDraw::Init()
+	{
+		if (auto shader = ResourceManager::LoadShader("Content/Shaders/debug_draw.vert", "Content/Shaders/debug_draw.frag"))
+		{
+			s_shaderHandle = shader.value();
+		}
+		else
+		{
+			ZN_LOG_ERROR(Renderer, "[DebugDraw::Init] Failed to load the debug draw shader");
+			return false;
+		}
+
+		// Enough for a full frame of lines in every region, so Flush never has to split the upload
+		s_streamingBuffer = CreateUnique<StreamingBuffer>(MAX_LINES_PER_FRAME * 2 * sizeof(Vertex));
+		if (!s_streamingBuffer->IsValid())
+		{
+			ZN_LOG_ERROR(Renderer, "[DebugDraw::Init] Failed to create the debug draw streaming buffer");
+			return false;
+		}
+
+		VertexBufferLayout layout;
+		layout.PushElement<f32>(3);           // position
+		layout.PushElement<unsigned char>(4); // color
+
+		s_vertexArray = CreateUnique<VertexArray>();
+		s_vertexArray->AddVertexBuffer(*s_streamingBuffer, layout);
+		s_vertexArray->Unbind();
+
+		s_depthTestedVertices.reserve(4096);
+		s_overlayVertices.reserve(1024);
+
+		return true;
+	}
+
+	void DebugDraw::Shutdown()
+	{
+		s_vertexArray.reset();
+		s_streamingBuffer.reset();
+
+		s_depthTestedVertices.clear();
+		s_overlayVertices.clear();
+	}
+
+	void DebugDraw::Line(const math::v3& from, const math::v3& to, const math::v4& color, DebugDrawMode mode)
+	{
+		PushLine(from, to, PackColor(color), mode);
+	}
+
+	void DebugDraw::Box(const math::AABB& box, const math::v4& color, DebugDrawMode mode)
+	{
+		Array<math::v3, 8> corners;
+		for (int i = 0; i < 8; ++i)
+		{
+			corners[i] = box.GetCorner(i);
+		}
+
+		PushBoxCorners(corners, PackColor(color), mode);
+	}
+
+	void DebugDraw::Box(const math::m4& transform, const math::v4& color, DebugDrawMode mode)
+	{
+		constexpr math::AABB unitCube{ math::v3(-0.5f), math::v3(0.5f) };
+
+		Array<math::v3, 8> corners;
+		for (int i = 0; i < 8; ++i)
+		{
+			corners[i] = math::v3(transform * math::v4(unitCube.GetCorner(i), 1.0f));
+		}
+
+		PushBoxCorners(corners, PackColor(color), mode);
+	}
+
+	void DebugDraw::Sphere(const math::v3& center, f32 radius, const math::v4& color, DebugDrawMode mode, u32 segments)
+	{
+		segments = std::max(segments, 4u);
+
+		const u32 packedColor = PackColor(color);
+		const f32 step = 2.0f * std::numbers::pi_v<f32> / static_cast<f32>(segments);
+
+		f32 prevSin = 0.0f;
+		f32 prevCos = 1.0f;
+
+		for (u32 i = 1; i <= segments; ++i)
+		{
+			const f32 angle = step * static_cast<f32>(i);
+			const f32 s = std::sin(angle);
+			const f32 c = std::cos(angle);
+
+			PushLine(center + radius * math::v3(prevCos, prevSin, 0.0f), center + radius * math::v3(c, s, 0.0f), packedColor, mode);
+			PushLine(center + radius * math::v3(prevCos, 0.0f, prevSin), center + radius * math::v3(c, 0.0f, s), packedColor, mode);
+			PushLine(center + radius * math::v3(0.0f, prevCos, prevSin), center + radius * math::v3(0.0f, c, s), packedColor, mode);
+
+			prevSin = s;
+			prevCos = c;
+		}
+	}
+
+	void DebugDraw::Frustum(const math::m4& viewProjection, const math::v4& color, DebugDrawMode mode)
+	{
+		const math::m4 inverseViewProjection = glm::inverse(viewProjection);
+
+		// Same corner order as AABB::GetCorner, over the NDC cube
+		Array<math::v3, 8> corners;
+		for (int i = 0; i < 8; ++i)
+		{
+			const math::v4 ndc{ i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 1.0f };
+			const math::v4 world = inverseViewProjection * ndc;
+			corners[i] = math::v3(world) / world.w;
+		}
+
+		PushBoxCorners(corners, PackColor(color), mode);
+	}
+
+	void DebugDraw::Flush(const math::m4& viewProjection)
+	{
+		s_lastFrameStats = s_currentStats;
+		s_currentStats = {};
+
+		const uSize depthTestedCount = s_depthTestedVertices.size();
+		const uSize overlayCount = s_overlayVertices.size();
+
+		const Shader& shader = ResourceManager::GetShader(s_shaderHandle).value();
+
+		// Debug lines are simply skipped until their shader finishes compiling
+		if ((depthTestedCount == 0 && overlayCount == 0) || !s_streamingBuffer || !shader.IsReady())
+		{
+			s_depthTestedVertices.clear();
+			s_overlayVertices.clear();
+			return;
+		}
+
+		s_streamingBuffer->BeginFrame();
+
+		// Stride aligned, so the allocation offset is a whole number of vertices
+		auto allocation = s_streamingBuffer->Allocate((depthTestedCount + overlayCount) * sizeof(Vertex), sizeof(Vertex));
+		if (!allocation)
+		{
+			ZN_LOG_WARN_LIMITED(Renderer, "[DebugDraw::Flush] Streaming buffer exhausted, skipping {} debug vertices", depthTestedCount + overlayCount);
+			s_streamingBuffer->EndFrame();
+			s_depthTestedVertices.clear();
+			s_overlayVertices.clear();
+			return;
+		}
+
+		Vertex* destination = static_cast<Vertex*>(allocation->Data);
+		std::memcpy(destination, s_depthTestedVertices.data(), depthTestedCount * sizeof(Vertex));
+		std::memcpy(destination + depthTestedCount, s_overlayVertices.data(), overlayCount * sizeof(Vertex));
+
+		const GLint firstVertex = static_cast<GLint>(allocation->Offset / sizeof(Vertex));
+
+		shader.Bind();
+		shader.SetMat4("viewProjection", viewProjection);
+
+		s_vertexArray->Bind();
+
+		if (depthTestedCount > 0)
+		{
+			GLStateCache::SetDepthTest(true);
+			glDrawArrays(GL_LINES, firstVertex, static_cast<GLsizei>(depthTestedCount));
+			++s_lastFrameStats.DrawCalls;
+		}
+
+		if (overlayCount > 0)
+		{
+			GLStateCache::SetDepthTest(false);
+			glDrawArrays(GL_LINES, firstVertex + static_cast<GLint>(depthTestedCount), static_cast<GLsizei>(overlayCount));
+			GLStateCache::SetDepthTest(true);
+			++s_lastFrameStats.DrawCalls;
+		}
+
+		s_streamingBuffer->EndFrame();
+
+		s_depthTestedVertices.clear();
+		s_overlayVertices.clear();
+	}
+
+	u32 DebugDraw::PackColor(const math::v4& color)
+	{
+		auto toByte = [](f32 value) { return static_cast<u32>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f); };
+
+		return toByte(color.x) | (toByte(color.y) << 8) | (toByte(color.z) << 16) | (toByte(color.w) << 24);
+	}
+
+	void DebugDraw::PushLine(const math::v3& from, const math::v3& to, u32 color, DebugDrawMode mode)
+	{
+		if (s_currentStats.DepthTestedLines + s_currentStats.OverlayLines >= MAX_LINES_PER_FRAME)
+		{
+			++s_currentStats.DroppedLines;
+			return;
+		}
+
+		if (mode == DebugDrawMode::DepthTested)
+		{
+			s_depthTestedVertices.push_back({ from, color });
+			s_depthTestedVertices.push_back({ to, color });
+			++s_currentStats.DepthTestedLines;
+		}
+		else
+		{
+			s_overlayVertices.push_back({ from, color });
+			s_overlayVertices.push_back({ to, color });
+			++s_currentStats.OverlayLines;
+		}
+	}
+
+	void DebugDraw::PushBoxCorners(const Array<math::v3, 8>& corners, u32 color, DebugDrawMode mode)
+	{
+		// Corners are indexed by their x/y/z bits, edges join corners that differ in a single bit
+		for (u32 corner = 0; corner < 8; ++corner)
+		{
+			for (u32 axisBit = 1; axisBit <= 4; axisBit <<= 1)
+			{
+				if ((corner & axisBit) == 0)
+				{
+					PushLine(corners[corner], corners[corner | axisBit], color, mode);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Math/Bounds.hpp"
+#include "Math/Math.hpp"
+#include "Resource/ResourceRegistry.hpp"
+
+namespace zn
+{
+	class Shader;
+	class StreamingBuffer;
+	class VertexArray;
+
+	enum class DebugDrawMode : u8
+	{
+		DepthTested, // Hidden by scene geometry
+		Overlay,     // Always drawn on top
+	};
+
+	// Immediate mode debug lines. Primitives are appended to CPU arrays during the frame and Flush
+	// uploads them into a persistently mapped streaming buffer and draws them with one glDrawArrays
+	// per mode. Nothing is retained between frames.
+	class DebugDraw
+	{
+	public:
+		struct Stats
+		{
+			u32 DepthTestedLines = 0;
+			u32 OverlayLines = 0;
+			u32 DroppedLines = 0; // Lines over MAX_LINES_PER_FRAME
+			u32 DrawCalls = 0;
+		};
+
+		static constexpr u32 MAX_LINES_PER_FRAME = 65536;
+		static constexpr u32 DEFAULT_SPHERE_SEGMENTS = 24;
+
+		DebugDraw() = delete;
+
+		static b8 Init();
+		static void Shutdown();
+
+		static void Line(const math::v3& from, const math::v3& to, const math::v4& color, DebugDrawMode mode = DebugDrawMode::DepthTested);
+		static void Box(const math::AABB& box, const math::v4& color, DebugDrawMode mode = DebugDrawMode::DepthTested);
+		// Unit cube centered at the origin, transformed by the given matrix
+		static void Box(const math::m4& transform, const math::v4& color, DebugDrawMode mode = DebugDrawMode::DepthTested);
+		// Three great circles, one per axis plane
+		static void Sphere(const math::v3& center, f32 radius, const math::v4& color, DebugDrawMode mode = DebugDrawMode::DepthTested, u32 segments = DEFAULT_SPHERE_SEGMENTS);
+		// Edges of the volume seen through a (projection * view) matrix
+		static void Frustum(const math::m4& viewProjection, const math::v4& color, DebugDrawMode mode = DebugDrawMode::DepthTested);
+
+		// Draws everything submitted since the last flush into the bound framebuffer and clears the lists
+		static void Flush(const math::m4& viewProjection);
+
+		[[nodiscard]] static const Stats& GetLastFrameStats() { return s_lastFrameStats; }
+
+	private:
+		struct Vertex
+		{
+			math::v3 Position;
+			u32 Color; // RGBA8, R in the lowest byte
+		};
+
+		static u32 PackColor(const math::v4& color);
+		static void PushLine(const math::v3& from, const math::v3& to, u32 color, DebugDrawMode mode);
+		static void PushBoxCorners(const Array<math::v3, 8>& corners, u32 color, DebugDrawMode mode);
+
+		static UniquePtr<StreamingBuffer> s_streamingBuffer;
+		static UniquePtr<VertexArray> s_vertexArray;
+		static Handle<Shader> s_shaderHandle;
+
+		static Vector<Vertex> s_depthTestedVertices;
+		static Vector<Vertex> s_overlayVertices;
+		static Stats s_currentStats;
+		static Stats s_lastFrameStats;
+	};
+}
@@ -0,0 +1,314 @@
+#include "GLStateCache.hpp"
+
+#include "Core/StatsRegistry.hpp"
+
+#include <glad/gl.h>
+
+namespace zn
+{
+	u32 GLStateCache::s_program = GLStateCache::UNKNOWN;
+	u32 GLStateCache::s_vertexArray = GLStateCache::UNKNOWN;
+	u32 GLStateCache::s_framebuffer = GLStateCache::UNKNOWN;
+	Array<u32, GLStateCache::MAX_TEXTURE_UNITS> GLStateCache::s_textures = [] { Array<u32, MAX_TEXTURE_UNITS> a; a.fill(UNKNOWN); return a; }();
+	Array<u32, GLStateCache::MAX_TEXTURE_UNITS> GLStateCache::s_samplers = [] { Array<u32, MAX_TEXTURE_UNITS> a; a.fill(UNKNOWN); return a; }();
+	Array<GLStateCache::BufferBinding, 5> GLStateCache::s_buffers {{
+		{ GL_ARRAY_BUFFER, GLStateCache::UNKNOWN },
+		{ GL_ELEMENT_ARRAY_BUFFER, GLStateCache::UNKNOWN },
+		{ GL_UNIFORM_BUFFER, GLStateCache::UNKNOWN },
+		{ GL_SHADER_STORAGE_BUFFER, GLStateCache::UNKNOWN },
+		{ GL_DRAW_INDIRECT_BUFFER, GLStateCache::UNKNOWN },
+	}};
+	Array<u32, GLStateCache::MAX_INDEXED_BUFFER_BINDINGS> GLStateCache::s_uniformBufferBases = [] { Array<u32, MAX_INDEXED_BUFFER_BINDINGS> a; a.fill(UNKNOWN); return a; }();
+	Array<u32, GLStateCache::MAX_INDEXED_BUFFER_BINDINGS> GLStateCache::s_storageBufferBases = [] { Array<u32, MAX_INDEXED_BUFFER_BINDINGS> a; a.fill(UNKNOWN); return a; }();
+
+	GLStateCache::Toggle GLStateCache::s_depthTest = GLStateCache::Toggle::Unknown;
+	GLStateCache::Toggle GLStateCache::s_depthWrite = GLStateCache::Toggle::Unknown;
+	GLStateCache::Toggle GLStateCache::s_blend = GLStateCache::Toggle::Unknown;
+	u32 GLStateCache::s_depthFunc = GLStateCache::UNKNOWN;
+	u32 GLStateCache::s_blendSrc = GLStateCache::UNKNOWN;
+	u32 GLStateCache::s_blendDst = GLStateCache::UNKNOWN;
+
+	GLStateCache::FrameStats GLStateCache::s_currentFrameStats{};
+	GLStateCache::FrameStats GLStateCache::s_lastFrameStats{};
+
+	void GLStateCache::UseProgram(u32 program)
+	{
+		if (ShouldIssue(s_program != program))
+		{
+			glUseProgram(program);
+			s_program = program;
+		}
+	}
+
+	void GLStateCache::BindVertexArray(u32 vertexArray)
+	{
+		if (ShouldIssue(s_vertexArray != vertexArray))
+		{
+			glBindVertexArray(vertexArray);
+			s_vertexArray = vertexArray;
+
+			// The element buffer binding is part of the VAO state
+			FindBufferBinding(GL_ELEMENT_ARRAY_BUFFER)->Buffer = UNKNOWN;
+		}
+	}
+
+	void GLStateCache::BindBuffer(u32 target, u32 buffer)
+	{
+		BufferBinding* binding = FindBufferBinding(target);
+		if (!binding)
+		{
+			ShouldIssue(true);
+			glBindBuffer(target, buffer);
+			return;
+		}
+
+		if (ShouldIssue(binding->Buffer != buffer))
+		{
+			glBindBuffer(target, buffer);
+			binding->Buffer = buffer;
+		}
+	}
+
+	void GLStateCache::BindBufferBase(u32 target, u32 index, u32 buffer)
+	{
+		Array<u32, MAX_INDEXED_BUFFER_BINDINGS>* bases = FindIndexedBindings(target);
+		if (!bases || index >= MAX_INDEXED_BUFFER_BINDINGS)
+		{
+			ShouldIssue(true);
+			glBindBufferBase(target, index, buffer);
+
+			if (BufferBinding* binding = FindBufferBinding(target))
+				binding->Buffer = buffer;
+			return;
+		}
+
+		if (ShouldIssue((*bases)[index] != buffer))
+		{
+			glBindBufferBase(target, index, buffer);
+			(*bases)[index] = buffer;
+
+			// glBindBufferBase also changes the generic binding point
+			FindBufferBinding(target)->Buffer = buffer;
+		}
+	}
+
+	void GLStateCache::BindTextureUnit(u32 unit, u32 texture)
+	{
+		if (unit >= MAX_TEXTURE_UNITS)
+		{
+			ShouldIssue(true);
+			glBindTextureUnit(unit, texture);
+			return;
+		}
+
+		if (ShouldIssue(s_textures[unit] != texture))
+		{
+			glBindTextureUnit(unit, texture);
+			s_textures[unit] = texture;
+		}
+	}
+
+	void GLStateCache::BindSampler(u32 unit, u32 sampler)
+	{
+		if (unit >= MAX_TEXTURE_UNITS)
+		{
+			ShouldIssue(true);
+			glBindSampler(unit, sampler);
+			return;
+		}
+
+		if (ShouldIssue(s_samplers[unit] != sampler))
+		{
+			glBindSampler(unit, sampler);
+			s_samplers[unit] = sampler;
+		}
+	}
+
+	void GLStateCache::BindFramebuffer(u32 framebuffer)
+	{
+		if (ShouldIssue(s_framebuffer != framebuffer))
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+			s_framebuffer = framebuffer;
+		}
+	}
+
+	void GLStateCache::SetDepthTest(b8 enabled)
+	{
+		SetCapability(GL_DEPTH_TEST, s_depthTest, enabled);
+	}
+
+	void GLStateCache::SetDepthWrite(b8 enabled)
+	{
+		const Toggle requested = enabled ? Toggle::Enabled : Toggle::Disabled;
+		if (ShouldIssue(s_depthWrite != requested))
+		{
+			glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+			s_depthWrite = requested;
+		}
+	}
+
+	void GLStateCache::SetDepthFunc(u32 func)
+	{
+		if (ShouldIssue(s_depthFunc != func))
+		{
+			glDepthFunc(func);
+			s_depthFunc = func;
+		}
+	}
+
+	void GLStateCache::SetBlend(b8 enabled)
+	{
+		SetCapability(GL_BLEND, s_blend, enabled);
+	}
+
+	void GLStateCache::SetBlendFunc(u32 srcFactor, u32 dstFactor)
+	{
+		if (ShouldIssue(s_blendSrc != srcFactor || s_blendDst != dstFactor))
+		{
+			glBlendFunc(srcFactor, dstFactor);
+			s_blendSrc = srcFactor;
+			s_blendDst = dstFactor;
+		}
+	}
+
+	void GLStateCache::OnProgramDeleted(u32 program)
+	{
+		if (s_program == program)
+			s_program = UNKNOWN;
+	}
+
+	void GLStateCache::OnVertexArrayDeleted(u32 vertexArray)
+	{
+		if (s_vertexArray == vertexArray)
+		{
+			s_vertexArray = UNKNOWN;
+			FindBufferBinding(GL_ELEMENT_ARRAY_BUFFER)->Buffer = UNKNOWN;
+		}
+	}
+
+	void GLStateCache::OnBufferDeleted(u32 buffer)
+	{
+		for (BufferBinding& binding : s_buffers)
+		{
+			if (binding.Buffer == buffer)
+				binding.Buffer = UNKNOWN;
+		}
+
+		for (u32& bound : s_uniformBufferBases)
+		{
+			if (bound == buffer)
+				bound = UNKNOWN;
+		}
+
+		for (u32& bound : s_storageBufferBases)
+		{
+			if (bound == buffer)
+				bound = UNKNOWN;
+		}
+	}
+
+	void GLStateCache::OnTextureDeleted(u32 texture)
+	{
+		for (u32& bound : s_textures)
+		{
+			if (bound == texture)
+				bound = UNKNOWN;
+		}
+	}
+
+	void GLStateCache::OnSamplerDeleted(u32 sampler)
+	{
+		for (u32& bound : s_samplers)
+		{
+			if (bound == sampler)
+				bound = UNKNOWN;
+		}
+	}
+
+	void GLStateCache::OnFramebufferDeleted(u32 framebuffer)
+	{
+		if (s_framebuffer == framebuffer)
+			s_framebuffer = UNKNOWN;
+	}
+
+	void GLStateCache::Invalidate()
+	{
+		s_program = UNKNOWN;
+		s_vertexArray = UNKNOWN;
+		s_framebuffer = UNKNOWN;
+		s_textures.fill(UNKNOWN);
+		s_samplers.fill(UNKNOWN);
+
+		for (BufferBinding& binding : s_buffers)
+			binding.Buffer = UNKNOWN;
+
+		s_uniformBufferBases.fill(UNKNOWN);
+		s_storageBufferBases.fill(UNKNOWN);
+
+		s_depthTest = Toggle::Unknown;
+		s_depthWrite = Toggle::Unknown;
+		s_blend = Toggle::Unknown;
+		s_depthFunc = UNKNOWN;
+		s_blendSrc = UNKNOWN;
+		s_blendDst = UNKNOWN;
+	}
+
+	void GLStateCache::BeginFrame()
+	{
+		s_lastFrameStats = s_currentFrameStats;
+		s_currentFrameStats = {};
+	}
+
+	b8 GLStateCache::ShouldIssue(b8 changed)
+	{
+		if (changed)
+		{
+			++s_currentFrameStats.IssuedCalls;
+			ZN_STAT_ADD("GL/State changes", 1);
+		}
+		else
+		{
+			++s_currentFrameStats.SkippedCalls;
+			ZN_STAT_ADD("GL/Redundant state skipped", 1);
+		}
+
+		return changed;
+	}
+
+	GLStateCache::BufferBinding* GLStateCache::FindBufferBinding(u32 target)
+	{
+		for (BufferBinding& binding : s_buffers)
+		{
+			if (binding.Target == target)
+				return &binding;
+		}
+
+		return nullptr;
+	}
+
+	Array<u32, GLStateCache::MAX_INDEXED_BUFFER_BINDINGS>* GLStateCache::FindIndexedBindings(u32 target)
+	{
+		switch (target)
+		{
+			case GL_UNIFORM_BUFFER:        return &s_uniformBufferBases;
+			case GL_SHADER_STORAGE_BUFFER: return &s_storageBufferBases;
+		}
+
+		return nullptr;
+	}
+
+	void GLStateCache::SetCapability(u32 capability, Toggle& current, b8 enabled)
+	{
+		const Toggle requested = enabled ? Toggle::Enabled : Toggle::Disabled;
+		if (ShouldIssue(current != requested))
+		{
+			if (enabled)
+				glEnable(capability);
+			else
+				glDisable(capability);
+
+			current = requested;
+		}
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+namespace zn
+{
+	// Shadow copy of the OpenGL state the engine touches. Every bind goes through here so
+	// calls that would not change anything (same program, same VAO, same texture in a unit...)
+	// are skipped before reaching the driver.
+	//
+	// The cache assumes it is the only one changing this state on the main context. Code that
+	// changes GL state behind its back must call Invalidate() afterwards.
+	class GLStateCache
+	{
+	public:
+		struct FrameStats
+		{
+			u32 IssuedCalls = 0;
+			u32 SkippedCalls = 0;
+		};
+
+		static constexpr u32 MAX_TEXTURE_UNITS = 32;
+		static constexpr u32 MAX_INDEXED_BUFFER_BINDINGS = 16;
+
+		GLStateCache() = delete;
+
+		static void UseProgram(u32 program);
+		static void BindVertexArray(u32 vertexArray);
+		static void BindBuffer(u32 target, u32 buffer);
+		// Indexed binding points, tracked for GL_UNIFORM_BUFFER and GL_SHADER_STORAGE_BUFFER
+		static void BindBufferBase(u32 target, u32 index, u32 buffer);
+		static void BindTextureUnit(u32 unit, u32 texture);
+		static void BindSampler(u32 unit, u32 sampler);
+		static void BindFramebuffer(u32 framebuffer);
+
+		static void SetDepthTest(b8 enabled);
+		static void SetDepthWrite(b8 enabled);
+		static void SetDepthFunc(u32 func);
+		static void SetBlend(b8 enabled);
+		static void SetBlendFunc(u32 srcFactor, u32 dstFactor);
+
+		// GL may hand out a deleted name again, so the cache must forget about it
+		static void OnProgramDeleted(u32 program);
+		static void OnVertexArrayDeleted(u32 vertexArray);
+		static void OnBufferDeleted(u32 buffer);
+		static void OnTextureDeleted(u32 texture);
+		static void OnSamplerDeleted(u32 sampler);
+		static void OnFramebufferDeleted(u32 framebuffer);
+
+		// Marks all the tracked state as unknown, so the next call of each kind is always issued
+		static void Invalidate();
+
+		// Closes the stats of the previous frame and starts counting a new one
+		static void BeginFrame();
+
+		[[nodiscard]] static const FrameStats& GetLastFrameStats() { return s_lastFrameStats; }
+		[[nodiscard]] static const FrameStats& GetCurrentFrameStats() { return s_currentFrameStats; }
+
+	private:
+		static constexpr u32 UNKNOWN = U32_MAX;
+
+		// Tri-state for capabilities, the initial value is unknown
+		enum class Toggle : u8 { Unknown, Disabled, Enabled };
+
+		struct BufferBinding
+		{
+			u32 Target;
+			u32 Buffer;
+		};
+
+		static b8 ShouldIssue(b8 changed);
+		static BufferBinding* FindBufferBinding(u32 target);
+		static Array<u32, MAX_INDEXED_BUFFER_BINDINGS>* FindIndexedBindings(u32 target);
+		static void SetCapability(u32 capability, Toggle& current, b8 enabled);
+
+		static u32 s_program;
+		static u32 s_vertexArray;
+		static u32 s_framebuffer;
+		static Array<u32, MAX_TEXTURE_UNITS> s_textures;
+		static Array<u32, MAX_TEXTURE_UNITS> s_samplers;
+		static Array<BufferBinding, 5> s_buffers;
+		static Array<u32, MAX_INDEXED_BUFFER_BINDINGS> s_uniformBufferBases;
+		static Array<u32, MAX_INDEXED_BUFFER_BINDINGS> s_storageBufferBases;
+
+		static Toggle s_depthTest;
+		static Toggle s_depthWrite;
+		static Toggle s_blend;
+		static u32 s_depthFunc;
+		static u32 s_blendSrc;
+		static u32 s_blendDst;
+
+		static FrameStats s_currentFrameStats;
+		static FrameStats s_lastFrameStats;
+	};
+}
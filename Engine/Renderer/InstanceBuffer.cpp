@@ -0,0 +1,81 @@
+#include "InstanceBuffer.hpp"
+
+#include "GLStateCache.hpp"
+
+#include "Core/Assert.hpp"
+#include "Memory/MemoryTracker.hpp"
+
+#include <glad/gl.h>
+
+#include <algorithm>
+
+namespace zn
+{
+	InstanceBuffer::InstanceBuffer(u32 initialCapacity)
+		: m_capacity(std::max(initialCapacity, 1u))
+	{
+		glCreateBuffers(1, &m_rendererID);
+		glNamedBufferData(m_rendererID, static_cast<GLsizeiptr>(m_capacity * sizeof(math::m4)), nullptr, GL_DYNAMIC_DRAW);
+		MemoryTracker::TrackAllocation(MemoryHeap::Gpu, MemoryTag::Renderer, m_capacity * sizeof(math::m4));
+	}
+
+	InstanceBuffer::~InstanceBuffer()
+	{
+		MemoryTracker::TrackFree(MemoryHeap::Gpu, MemoryTag::Renderer, m_capacity * sizeof(math::m4));
+		glDeleteBuffers(1, &m_rendererID);
+		GLStateCache::OnBufferDeleted(m_rendererID);
+	}
+
+	u32 InstanceBuffer::Allocate(u32 count)
+	{
+		const u32 first = static_cast<u32>(m_models.size());
+		m_models.resize(m_models.size() + count, math::m4(1.0f));
+
+		m_dirtyBegin = std::min(m_dirtyBegin, first);
+		m_dirtyEnd = static_cast<u32>(m_models.size());
+
+		return first;
+	}
+
+	void InstanceBuffer::Set(u32 instance, const math::m4& model)
+	{
+		ZN_ASSERT(instance < m_models.size(), "Instance out of range");
+
+		m_models[instance] = model;
+		m_dirtyBegin = std::min(m_dirtyBegin, instance);
+		m_dirtyEnd = std::max(m_dirtyEnd, instance + 1);
+	}
+
+	u32 InstanceBuffer::Upload()
+	{
+		if (m_models.size() > m_capacity)
+		{
+			// Growing orphans the old store, so everything goes up again
+			MemoryTracker::TrackFree(MemoryHeap::Gpu, MemoryTag::Renderer, m_capacity * sizeof(math::m4));
+			m_capacity = std::max(static_cast<u32>(m_models.size()), m_capacity * 2);
+			glNamedBufferData(m_rendererID, static_cast<GLsizeiptr>(m_capacity * sizeof(math::m4)), nullptr, GL_DYNAMIC_DRAW);
+			MemoryTracker::TrackAllocation(MemoryHeap::Gpu, MemoryTag::Renderer, m_capacity * sizeof(math::m4));
+
+			m_dirtyBegin = 0;
+			m_dirtyEnd = static_cast<u32>(m_models.size());
+		}
+
+		if (m_dirtyBegin >= m_dirtyEnd)
+		{
+			return 0;
+		}
+
+		const u32 bytes = (m_dirtyEnd - m_dirtyBegin) * static_cast<u32>(sizeof(math::m4));
+		glNamedBufferSubData(m_rendererID, static_cast<GLintptr>(m_dirtyBegin * sizeof(math::m4)), bytes, &m_models[m_dirtyBegin]);
+
+		m_dirtyBegin = NO_DIRTY_INSTANCE;
+		m_dirtyEnd = 0;
+
+		return bytes;
+	}
+
+	void InstanceBuffer::Bind() const
+	{
+		GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING, m_rendererID);
+	}
+}
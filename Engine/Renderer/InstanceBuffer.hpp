@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Math/Math.hpp"
+
+namespace zn
+{
+	// Per instance model matrices in a shader storage buffer, read by instanced shaders as
+	// 'layout(std430, binding = 5) readonly buffer InstanceTransforms { mat4 instanceModels[]; }'.
+	// A CPU copy is kept; Set only records the dirty range and Upload sends that range once per frame,
+	// so instances whose transform didn't change cost nothing.
+	class InstanceBuffer
+	{
+	public:
+		static constexpr u32 BINDING = 5;
+
+		explicit InstanceBuffer(u32 initialCapacity = 256);
+		~InstanceBuffer();
+
+		InstanceBuffer(const InstanceBuffer& other) = delete;
+		InstanceBuffer(InstanceBuffer&& other) noexcept = delete;
+
+		InstanceBuffer& operator=(const InstanceBuffer& other) = delete;
+		InstanceBuffer& operator=(InstanceBuffer&& other) noexcept = delete;
+
+		// Reserves count consecutive instances and returns the first one. The GL buffer grows on the next Upload
+		[[nodiscard]] u32 Allocate(u32 count);
+
+		void Set(u32 instance, const math::m4& model);
+
+		// Sends the dirty range to the GPU. Returns the number of bytes uploaded
+		u32 Upload();
+		void Bind() const;
+
+		[[nodiscard]] u32 GetCount() const { return static_cast<u32>(m_models.size()); }
+
+	private:
+		static constexpr u32 NO_DIRTY_INSTANCE = 0xFFFFFFFF;
+
+		u32 m_rendererID = 0;
+		u32 m_capacity = 0;
+
+		Vector<math::m4> m_models;
+		u32 m_dirtyBegin = NO_DIRTY_INSTANCE;
+		u32 m_dirtyEnd = 0;
+	};
+}
@@ -0,0 +1,190 @@
+#include "Material.hpp"
+
+#include "GLStateCache.hpp"
+
+#include "Core/Assert.hpp"
+#include "Core/Log.hpp"
+#include "Resource/ResourceManager.hpp"
+
+#include <glad/gl.h>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace zn
+{
+	namespace
+	{
+		struct Std140Layout
+		{
+			u32 Alignment;
+			u32 Size;
+		};
+
+		Std140Layout GetStd140Layout(MaterialParameterType type)
+		{
+			switch (type)
+			{
+				case MaterialParameterType::Int:   return { 4, 4 };
+				case MaterialParameterType::Float: return { 4, 4 };
+				case MaterialParameterType::Vec3:  return { 16, 12 };
+				case MaterialParameterType::Vec4:  return { 16, 16 };
+				case MaterialParameterType::Mat4:  return { 16, 64 };
+			}
+
+			return { 4, 4 };
+		}
+
+		u32 AlignUp(u32 value, u32 alignment)
+		{
+			return (value + alignment - 1) & ~(alignment - 1);
+		}
+	}
+
+	Material::Material(Handle<ShaderVariants> shader, u32 keywordMask, const Vector<MaterialParameter>& parameters)
+		: m_shader(shader), m_keywordMask(keywordMask)
+	{
+		u32 offset = 0;
+		for (const MaterialParameter& parameter : parameters)
+		{
+			const Std140Layout layout = GetStd140Layout(parameter.Type);
+			offset = AlignUp(offset, layout.Alignment);
+
+			m_slots.push_back({ parameter.Name, parameter.Type, offset });
+			offset += layout.Size;
+		}
+
+		// The block size is rounded up to a vec4, like the driver does
+		m_blockData.resize(AlignUp(std::max(offset, 16u), 16), 0);
+
+		glCreateBuffers(1, &m_uniformBuffer);
+		glNamedBufferStorage(m_uniformBuffer, static_cast<GLsizeiptr>(m_blockData.size()), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	}
+
+	Material::~Material()
+	{
+		if (m_uniformBuffer)
+		{
+			glDeleteBuffers(1, &m_uniformBuffer);
+			GLStateCache::OnBufferDeleted(m_uniformBuffer);
+			m_uniformBuffer = 0;
+		}
+	}
+
+	Material::Material(Material&& other) noexcept
+		: m_shader(other.m_shader), m_keywordMask(other.m_keywordMask), m_slots(std::move(other.m_slots)),
+		  m_blockData(std::move(other.m_blockData)), m_textures(other.m_textures),
+		  m_uniformBuffer(other.m_uniformBuffer), m_dirty(other.m_dirty)
+	{
+		other.m_uniformBuffer = 0;
+	}
+
+	Material& Material::operator=(Material&& other) noexcept
+	{
+		if (this != &other)
+		{
+			if (m_uniformBuffer)
+			{
+				glDeleteBuffers(1, &m_uniformBuffer);
+				GLStateCache::OnBufferDeleted(m_uniformBuffer);
+			}
+
+			m_shader = other.m_shader;
+			m_keywordMask = other.m_keywordMask;
+			m_slots = std::move(other.m_slots);
+			m_blockData = std::move(other.m_blockData);
+			m_textures = other.m_textures;
+			m_uniformBuffer = other.m_uniformBuffer;
+			m_dirty = other.m_dirty;
+
+			other.m_uniformBuffer = 0;
+		}
+
+		return *this;
+	}
+
+	void Material::SetInt(StringView name, i32 value)
+	{
+		Write(name, MaterialParameterType::Int, &value, sizeof(value));
+	}
+
+	void Material::SetFloat(StringView name, f32 value)
+	{
+		Write(name, MaterialParameterType::Float, &value, sizeof(value));
+	}
+
+	void Material::SetVec3(StringView name, const math::v3& value)
+	{
+		Write(name, MaterialParameterType::Vec3, glm::value_ptr(value), sizeof(f32) * 3);
+	}
+
+	void Material::SetVec4(StringView name, const math::v4& value)
+	{
+		Write(name, MaterialParameterType::Vec4, glm::value_ptr(value), sizeof(f32) * 4);
+	}
+
+	void Material::SetMat4(StringView name, const math::m4& value)
+	{
+		Write(name, MaterialParameterType::Mat4, glm::value_ptr(value), sizeof(f32) * 16);
+	}
+
+	void Material::SetTexture(u32 unit, Handle<Texture> texture)
+	{
+		ZN_ASSERT(unit < MAX_TEXTURES, "Material texture unit out of range");
+
+		m_textures[unit] = texture;
+	}
+
+	u32 Material::UploadIfDirty() const
+	{
+		if (!m_dirty)
+		{
+			return 0;
+		}
+
+		glNamedBufferSubData(m_uniformBuffer, 0, static_cast<GLsizeiptr>(m_blockData.size()), m_blockData.data());
+		m_dirty = false;
+
+		return static_cast<u32>(m_blockData.size());
+	}
+
+	void Material::BindResources() const
+	{
+		GLStateCache::BindBufferBase(GL_UNIFORM_BUFFER, UNIFORM_BLOCK_BINDING, m_uniformBuffer);
+
+		for (u32 unit = 0; unit < MAX_TEXTURES; ++unit)
+		{
+			if (!m_textures[unit])
+				continue;
+
+			if (auto texture = ResourceManager::GetTexture(m_textures[unit].value()))
+			{
+				texture.value().get().Bind(unit);
+			}
+		}
+	}
+
+	void Material::Write(StringView name, MaterialParameterType type, const void* data, uSize size)
+	{
+		auto slot = std::find_if(m_slots.begin(), m_slots.end(), [name](const ParameterSlot& s) { return s.Name == name; });
+		if (slot == m_slots.end())
+		{
+			ZN_LOG_WARN_LIMITED(Renderer, "[Material::Write] Material has no parameter named {}", name);
+			return;
+		}
+
+		if (slot->Type != type)
+		{
+			ZN_LOG_WARN_LIMITED(Renderer, "[Material::Write] Parameter {} was written with the wrong type", name);
+			return;
+		}
+
+		u8* destination = m_blockData.data() + slot->Offset;
+		if (std::memcmp(destination, data, size) != 0)
+		{
+			std::memcpy(destination, data, size);
+			m_dirty = true;
+		}
+	}
+}
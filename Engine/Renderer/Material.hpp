@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Math/Math.hpp"
+#include "Resource/ResourceRegistry.hpp"
+
+namespace zn
+{
+	class ShaderVariants;
+	class Texture;
+
+	enum class MaterialParameterType : u8
+	{
+		Int,
+		Float,
+		Vec3,
+		Vec4,
+		Mat4,
+	};
+
+	struct MaterialParameter
+	{
+		String Name;
+		MaterialParameterType Type = MaterialParameterType::Float;
+	};
+
+	// Shader variant + textures + a block of parameters. The parameters are declared in the same order
+	// as in the shader's 'layout(std140, binding = 1) uniform MaterialBlock', packed with std140 rules
+	// into a CPU copy, and uploaded to the material's own UBO only after they change.
+	class Material
+	{
+	public:
+		static constexpr u32 UNIFORM_BLOCK_BINDING = 1;
+		static constexpr u32 MAX_TEXTURES = 8;
+
+		Material(Handle<ShaderVariants> shader, u32 keywordMask, const Vector<MaterialParameter>& parameters);
+		~Material();
+
+		Material(const Material& other) = delete;
+		Material& operator=(const Material& other) = delete;
+
+		Material(Material&& other) noexcept;
+		Material& operator=(Material&& other) noexcept;
+
+		void SetInt(StringView name, i32 value);
+		void SetFloat(StringView name, f32 value);
+		void SetVec3(StringView name, const math::v3& value);
+		void SetVec4(StringView name, const math::v4& value);
+		void SetMat4(StringView name, const math::m4& value);
+
+		void SetTexture(u32 unit, Handle<Texture> texture);
+
+		// Uploads the parameter block if it changed since the last upload. Returns the number of bytes sent
+		u32 UploadIfDirty() const;
+		// Binds the textures and the parameter block. The shader is bound separately, so draws sorted by
+		// shader and then material only switch programs when the shader really changes
+		void BindResources() const;
+
+		[[nodiscard]] Handle<ShaderVariants> GetShaderVariants() const { return m_shader; }
+		[[nodiscard]] u32 GetKeywordMask() const { return m_keywordMask; }
+		[[nodiscard]] u32 GetBlockSize() const { return static_cast<u32>(m_blockData.size()); }
+
+	private:
+		struct ParameterSlot
+		{
+			String Name;
+			MaterialParameterType Type;
+			u32 Offset;
+		};
+
+		void Write(StringView name, MaterialParameterType type, const void* data, uSize size);
+
+		Handle<ShaderVariants> m_shader{};
+		u32 m_keywordMask = 0;
+
+		Vector<ParameterSlot> m_slots;
+		Vector<u8> m_blockData;
+		Array<Opt<Handle<Texture>>, MAX_TEXTURES> m_textures{};
+
+		u32 m_uniformBuffer = 0;
+		mutable b8 m_dirty = true;
+	};
+}
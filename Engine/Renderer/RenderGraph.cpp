@@ -0,0 +1,725 @@
+#include "RenderGraph.hpp"
+
+#include "GLStateCache.hpp"
+
+#include "Core/Assert.hpp"
+#include "Core/Log.hpp"
+#include "Core/Profiler.hpp"
+#include "Memory/MemoryResource.hpp"
+
+#include <glad/gl.h>
+
+#include <algorithm>
+
+namespace zn
+{
+	namespace
+	{
+		constexpr u64 FNV_OFFSET_BASIS = 14695981039346656037ull;
+		constexpr u64 FNV_PRIME = 1099511628211ull;
+
+		void HashBytes(u64& hash, const void* data, uSize size)
+		{
+			const u8* bytes = static_cast<const u8*>(data);
+			for (uSize i = 0; i < size; ++i)
+			{
+				hash ^= bytes[i];
+				hash *= FNV_PRIME;
+			}
+		}
+
+		template<typename T>
+		void HashValue(u64& hash, const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			HashBytes(hash, &value, sizeof(T));
+		}
+
+		b8 IsDepthStencilFormat(u32 format)
+		{
+			return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+		}
+	}
+
+	u32 RenderGraphContext::GetTexture(RenderGraphResource resource) const
+	{
+		return m_graph.GetPhysicalTexture(resource.Index);
+	}
+
+	u32 RenderGraphContext::GetBuffer(RenderGraphResource resource) const
+	{
+		ZN_ASSERT(resource.IsValid() && m_graph.m_resources[resource.Index].Type == RenderGraph::ResourceType::Buffer);
+		return m_graph.m_resources[resource.Index].ImportedID;
+	}
+
+	RenderGraphResource RenderGraph::PassBuilder::CreateTexture(StringView name, const RenderGraphTextureDesc& desc)
+	{
+		const u32 index = m_graph.AddResource(name, ResourceType::Texture);
+		m_graph.m_resources[index].Desc = desc;
+
+		return { index };
+	}
+
+	RenderGraphResource RenderGraph::PassBuilder::Read(RenderGraphResource resource)
+	{
+		ZN_ASSERT(resource.IsValid(), "Pass reads an invalid render graph resource");
+
+		Vector<u32>& reads = m_graph.m_passes[m_passIndex].Reads;
+		if (std::find(reads.begin(), reads.end(), resource.Index) == reads.end())
+		{
+			reads.push_back(resource.Index);
+		}
+
+		return resource;
+	}
+
+	RenderGraphResource RenderGraph::PassBuilder::Write(RenderGraphResource resource)
+	{
+		ZN_ASSERT(resource.IsValid(), "Pass writes an invalid render graph resource");
+
+		Pass& pass = m_graph.m_passes[m_passIndex];
+		if (std::find(pass.Writes.begin(), pass.Writes.end(), resource.Index) != pass.Writes.end())
+		{
+			return resource;
+		}
+
+		pass.Writes.push_back(resource.Index);
+
+		if (m_graph.m_resources[resource.Index].Type == ResourceType::Texture)
+		{
+			ZN_ASSERT(pass.ColorAttachments.size() < MAX_COLOR_ATTACHMENTS, "Too many color attachments in a render graph pass");
+			pass.ColorAttachments.push_back(resource.Index);
+		}
+
+		return resource;
+	}
+
+	RenderGraphResource RenderGraph::PassBuilder::WriteDepth(RenderGraphResource resource)
+	{
+		ZN_ASSERT(resource.IsValid(), "Pass writes an invalid render graph resource");
+		ZN_ASSERT(m_graph.m_resources[resource.Index].Type == ResourceType::Texture, "Depth attachments must be textures");
+
+		Pass& pass = m_graph.m_passes[m_passIndex];
+		if (std::find(pass.Writes.begin(), pass.Writes.end(), resource.Index) == pass.Writes.end())
+		{
+			pass.Writes.push_back(resource.Index);
+		}
+
+		pass.DepthAttachment = resource.Index;
+
+		return resource;
+	}
+
+	void RenderGraph::PassBuilder::SetSideEffect()
+	{
+		m_graph.m_passes[m_passIndex].SideEffect = true;
+	}
+
+	RenderGraph::~RenderGraph()
+	{
+		for (const CachedFramebuffer& framebuffer : m_framebuffers)
+		{
+			glDeleteFramebuffers(1, &framebuffer.RendererID);
+			GLStateCache::OnFramebufferDeleted(framebuffer.RendererID);
+		}
+
+		for (const PooledTexture& texture : m_texturePool)
+		{
+			if (texture.RendererID)
+			{
+				glDeleteTextures(1, &texture.RendererID);
+				GLStateCache::OnTextureDeleted(texture.RendererID);
+			}
+		}
+	}
+
+	void RenderGraph::BeginFrame(u32 backbufferWidth, u32 backbufferHeight)
+	{
+		++m_frameIndex;
+
+		// Last frame's entries keep their names and lists, so declaring the same passes again
+		// doesn't touch the heap
+		while (!m_passes.empty())
+		{
+			m_freePasses.push_back(std::move(m_passes.back()));
+			m_passes.pop_back();
+		}
+
+		while (!m_resources.empty())
+		{
+			m_freeResources.push_back(std::move(m_resources.back()));
+			m_resources.pop_back();
+		}
+
+		m_backbufferWidth = backbufferWidth;
+		m_backbufferHeight = backbufferHeight;
+
+		const u32 backbuffer = AddResource("Backbuffer", ResourceType::Texture);
+		m_resources[backbuffer].Desc = { backbufferWidth, backbufferHeight, 0 };
+		m_resources[backbuffer].Imported = true;
+		m_resources[backbuffer].ImportedID = 0;
+
+		m_backbuffer = { backbuffer };
+	}
+
+	RenderGraphResource RenderGraph::ImportTexture(StringView name, u32 texture, const RenderGraphTextureDesc& desc)
+	{
+		const u32 index = AddResource(name, ResourceType::Texture);
+		m_resources[index].Desc = desc;
+		m_resources[index].Imported = true;
+		m_resources[index].ImportedID = texture;
+
+		return { index };
+	}
+
+	RenderGraphResource RenderGraph::ImportBuffer(StringView name, u32 buffer)
+	{
+		const u32 index = AddResource(name, ResourceType::Buffer);
+		m_resources[index].Imported = true;
+		m_resources[index].ImportedID = buffer;
+
+		return { index };
+	}
+
+	void RenderGraph::AddPass(StringView name, const Func<void(PassBuilder&)>& setup, ExecuteFunc execute)
+	{
+		Pass pass;
+		if (!m_freePasses.empty())
+		{
+			pass = std::move(m_freePasses.back());
+			m_freePasses.pop_back();
+
+			pass.Reads.clear();
+			pass.Writes.clear();
+			pass.ColorAttachments.clear();
+			pass.DepthAttachment = U32_MAX;
+			pass.SideEffect = false;
+			pass.RefCount = 0;
+			pass.Culled = false;
+		}
+
+		pass.Name.assign(name);
+		pass.Execute = std::move(execute);
+
+		m_passes.push_back(std::move(pass));
+
+		PassBuilder builder(*this, static_cast<u32>(m_passes.size() - 1));
+		setup(builder);
+	}
+
+	void RenderGraph::Compile()
+	{
+		m_stats = {};
+		m_stats.DeclaredPasses = static_cast<u32>(m_passes.size());
+
+		for (PooledTexture& texture : m_texturePool)
+		{
+			texture.InUse = false;
+		}
+
+		const u64 hash = HashStructure();
+		b8 cacheValid = m_compiled && hash == m_compiledHash
+			&& m_cachedCulled.size() == m_passes.size() && m_cachedPhysical.size() == m_resources.size();
+
+		// Pool entries are released after a few idle frames, e.g. if the graph was not executed for a while
+		for (uSize i = 0; cacheValid && i < m_cachedPhysical.size(); ++i)
+		{
+			cacheValid = m_cachedPhysical[i] == U32_MAX || m_texturePool[m_cachedPhysical[i]].RendererID != 0;
+		}
+
+		if (cacheValid)
+		{
+			for (uSize i = 0; i < m_passes.size(); ++i)
+			{
+				m_passes[i].Culled = m_cachedCulled[i] != 0;
+			}
+
+			for (uSize i = 0; i < m_resources.size(); ++i)
+			{
+				m_resources[i].PhysicalIndex = m_cachedPhysical[i];
+				if (m_cachedPhysical[i] != U32_MAX)
+				{
+					m_texturePool[m_cachedPhysical[i]].LastUsedFrame = m_frameIndex;
+				}
+			}
+
+			m_stats.CompileCacheHit = true;
+		}
+		else
+		{
+			CullPasses();
+			SortPasses();
+			AssignPhysicalTextures();
+
+			m_cachedCulled.resize(m_passes.size());
+			for (uSize i = 0; i < m_passes.size(); ++i)
+			{
+				m_cachedCulled[i] = m_passes[i].Culled ? 1 : 0;
+			}
+
+			m_cachedPhysical.resize(m_resources.size());
+			for (uSize i = 0; i < m_resources.size(); ++i)
+			{
+				m_cachedPhysical[i] = m_resources[i].PhysicalIndex;
+			}
+
+			m_compiledHash = hash;
+			m_compiled = true;
+		}
+
+		ScratchScope scratch;
+		PmrVector<u32> physicalUsed(scratch.GetResource());
+		for (const VirtualResource& resource : m_resources)
+		{
+			if (resource.PhysicalIndex == U32_MAX)
+				continue;
+
+			++m_stats.TransientTextures;
+			if (std::find(physicalUsed.begin(), physicalUsed.end(), resource.PhysicalIndex) == physicalUsed.end())
+			{
+				physicalUsed.push_back(resource.PhysicalIndex);
+			}
+		}
+
+		m_stats.PhysicalTextures = static_cast<u32>(physicalUsed.size());
+		m_stats.CulledPasses = static_cast<u32>(std::count_if(m_passes.begin(), m_passes.end(), [](const Pass& pass) { return pass.Culled; }));
+
+		ReleaseUnusedPoolEntries();
+	}
+
+	void RenderGraph::Execute()
+	{
+		ZN_ASSERT(m_compiled, "RenderGraph::Compile must be called before Execute");
+
+		for (const u32 passIndex : m_executionOrder)
+		{
+			const Pass& pass = m_passes[passIndex];
+			if (pass.Culled)
+				continue;
+
+			ZN_PROFILE_SCOPE_DYNAMIC(pass.Name);
+
+			u32 targetWidth = m_backbufferWidth;
+			u32 targetHeight = m_backbufferHeight;
+
+			const b8 hasAttachments = !pass.ColorAttachments.empty() || pass.DepthAttachment != U32_MAX;
+			if (hasAttachments)
+			{
+				const u32 firstAttachment = !pass.ColorAttachments.empty() ? pass.ColorAttachments[0] : pass.DepthAttachment;
+				targetWidth = m_resources[firstAttachment].Desc.Width;
+				targetHeight = m_resources[firstAttachment].Desc.Height;
+
+				GLStateCache::BindFramebuffer(GetOrCreateFramebuffer(pass));
+				glViewport(0, 0, static_cast<GLsizei>(targetWidth), static_cast<GLsizei>(targetHeight));
+			}
+
+			pass.Execute(RenderGraphContext(*this, targetWidth, targetHeight));
+		}
+
+		// Leave the default framebuffer bound for whatever is drawn after the graph (ImGui)
+		GLStateCache::BindFramebuffer(0);
+		glViewport(0, 0, static_cast<GLsizei>(m_backbufferWidth), static_cast<GLsizei>(m_backbufferHeight));
+	}
+
+	u32 RenderGraph::AddResource(StringView name, ResourceType type)
+	{
+		VirtualResource resource;
+		if (!m_freeResources.empty())
+		{
+			resource = std::move(m_freeResources.back());
+			m_freeResources.pop_back();
+
+			resource.Desc = {};
+			resource.Imported = false;
+			resource.ImportedID = 0;
+			resource.PhysicalIndex = U32_MAX;
+			resource.FirstUse = U32_MAX;
+			resource.LastUse = 0;
+		}
+
+		resource.Name.assign(name);
+		resource.Type = type;
+
+		m_resources.push_back(std::move(resource));
+		return static_cast<u32>(m_resources.size() - 1);
+	}
+
+	u64 RenderGraph::HashStructure() const
+	{
+		u64 hash = FNV_OFFSET_BASIS;
+
+		for (const VirtualResource& resource : m_resources)
+		{
+			HashBytes(hash, resource.Name.data(), resource.Name.size());
+			HashValue(hash, resource.Type);
+			HashValue(hash, resource.Desc.Width);
+			HashValue(hash, resource.Desc.Height);
+			HashValue(hash, resource.Desc.InternalFormat);
+			HashValue(hash, resource.Imported);
+			HashValue(hash, resource.ImportedID);
+		}
+
+		for (const Pass& pass : m_passes)
+		{
+			HashBytes(hash, pass.Name.data(), pass.Name.size());
+			HashValue(hash, pass.SideEffect);
+			HashValue(hash, pass.DepthAttachment);
+
+			for (const u32 read : pass.Reads)
+				HashValue(hash, read);
+
+			HashValue(hash, U32_MAX); // Separator so reads and writes can't be confused
+
+			for (const u32 write : pass.Writes)
+				HashValue(hash, write);
+		}
+
+		return hash;
+	}
+
+	void RenderGraph::CullPasses()
+	{
+		// Reference counting as in Frostbite's FrameGraph: passes count the resources they write,
+		// resources count the passes reading them. Unreferenced resources release their producers.
+		ScratchScope scratch;
+		PmrVector<u32> resourceRefCounts(m_resources.size(), 0, scratch.GetResource());
+		PmrVector<PmrVector<u32>> producers(m_resources.size(), scratch.GetResource());
+
+		for (u32 passIndex = 0; passIndex < m_passes.size(); ++passIndex)
+		{
+			Pass& pass = m_passes[passIndex];
+			pass.Culled = false;
+			pass.RefCount = static_cast<u32>(pass.Writes.size()) + (pass.SideEffect ? 1 : 0);
+
+			for (const u32 read : pass.Reads)
+				++resourceRefCounts[read];
+
+			for (const u32 write : pass.Writes)
+				producers[write].push_back(passIndex);
+		}
+
+		PmrVector<u32> unreferenced(scratch.GetResource());
+		for (u32 resourceIndex = 0; resourceIndex < m_resources.size(); ++resourceIndex)
+		{
+			// Imported resources are visible outside the graph, so writing them is always useful
+			if (m_resources[resourceIndex].Imported)
+				++resourceRefCounts[resourceIndex];
+
+			if (resourceRefCounts[resourceIndex] == 0)
+				unreferenced.push_back(resourceIndex);
+		}
+
+		while (!unreferenced.empty())
+		{
+			const u32 resourceIndex = unreferenced.back();
+			unreferenced.pop_back();
+
+			for (const u32 producerIndex : producers[resourceIndex])
+			{
+				Pass& producer = m_passes[producerIndex];
+				if (producer.RefCount == 0 || --producer.RefCount > 0)
+					continue;
+
+				producer.Culled = true;
+
+				for (const u32 read : producer.Reads)
+				{
+					if (--resourceRefCounts[read] == 0)
+						unreferenced.push_back(read);
+				}
+			}
+		}
+	}
+
+	void RenderGraph::SortPasses()
+	{
+		// Dependencies follow declaration order: a pass depends on earlier passes that write what it
+		// reads or writes (RAW, WAW), and on earlier passes reading what it writes (WAR)
+		const uSize passCount = m_passes.size();
+
+		ScratchScope scratch;
+		PmrVector<PmrVector<u32>> dependents(passCount, scratch.GetResource());
+		PmrVector<u32> pendingDependencies(passCount, 0, scratch.GetResource());
+
+		auto touches = [](const Vector<u32>& list, u32 resource) { return std::find(list.begin(), list.end(), resource) != list.end(); };
+
+		for (u32 later = 0; later < passCount; ++later)
+		{
+			if (m_passes[later].Culled)
+				continue;
+
+			for (u32 earlier = 0; earlier < later; ++earlier)
+			{
+				if (m_passes[earlier].Culled)
+					continue;
+
+				const Pass& a = m_passes[earlier];
+				const Pass& b = m_passes[later];
+
+				b8 dependent = false;
+				for (const u32 write : a.Writes)
+					dependent = dependent || touches(b.Reads, write) || touches(b.Writes, write);
+				for (const u32 read : a.Reads)
+					dependent = dependent || touches(b.Writes, read);
+
+				if (dependent)
+				{
+					dependents[earlier].push_back(later);
+					++pendingDependencies[later];
+				}
+			}
+		}
+
+		// Kahn's algorithm. Among the ready passes, prefer the one consuming the most recently scheduled
+		// producer: it ends transient lifetimes sooner, so more textures can be shared through the pool
+		PmrVector<u32> ready(scratch.GetResource());
+		for (u32 passIndex = 0; passIndex < passCount; ++passIndex)
+		{
+			if (!m_passes[passIndex].Culled && pendingDependencies[passIndex] == 0)
+				ready.push_back(passIndex);
+		}
+
+		m_executionOrder.clear();
+		PmrVector<u32> latestProducerPosition(passCount, 0, scratch.GetResource());
+
+		while (!ready.empty())
+		{
+			auto best = std::max_element(ready.begin(), ready.end(), [&](u32 lhs, u32 rhs)
+			{
+				if (latestProducerPosition[lhs] != latestProducerPosition[rhs])
+					return latestProducerPosition[lhs] < latestProducerPosition[rhs];
+
+				return lhs > rhs; // Declaration order on ties
+			});
+
+			const u32 passIndex = *best;
+			ready.erase(best);
+
+			m_executionOrder.push_back(passIndex);
+			const u32 position = static_cast<u32>(m_executionOrder.size());
+
+			for (const u32 dependent : dependents[passIndex])
+			{
+				latestProducerPosition[dependent] = std::max(latestProducerPosition[dependent], position);
+				if (--pendingDependencies[dependent] == 0)
+					ready.push_back(dependent);
+			}
+		}
+	}
+
+	void RenderGraph::AssignPhysicalTextures()
+	{
+		for (VirtualResource& resource : m_resources)
+		{
+			resource.PhysicalIndex = U32_MAX;
+			resource.FirstUse = U32_MAX;
+			resource.LastUse = 0;
+		}
+
+		for (u32 position = 0; position < m_executionOrder.size(); ++position)
+		{
+			const Pass& pass = m_passes[m_executionOrder[position]];
+
+			auto markUse = [&](u32 resourceIndex)
+			{
+				VirtualResource& resource = m_resources[resourceIndex];
+				resource.FirstUse = std::min(resource.FirstUse, position);
+				resource.LastUse = std::max(resource.LastUse, position);
+			};
+
+			for (const u32 read : pass.Reads)
+				markUse(read);
+			for (const u32 write : pass.Writes)
+				markUse(write);
+		}
+
+		// Walk the passes in execution order: acquire textures on first use, hand them back to the pool
+		// after their last use so a later resource with the same description can alias them
+		for (u32 position = 0; position < m_executionOrder.size(); ++position)
+		{
+			for (VirtualResource& resource : m_resources)
+			{
+				if (resource.Imported || resource.Type != ResourceType::Texture || resource.FirstUse != position)
+					continue;
+
+				resource.PhysicalIndex = AcquirePooledTexture(resource.Desc);
+			}
+
+			for (const VirtualResource& resource : m_resources)
+			{
+				if (resource.PhysicalIndex != U32_MAX && resource.LastUse == position)
+				{
+					m_texturePool[resource.PhysicalIndex].InUse = false;
+				}
+			}
+		}
+	}
+
+	u32 RenderGraph::AcquirePooledTexture(const RenderGraphTextureDesc& desc)
+	{
+		u32 freeSlot = U32_MAX;
+
+		for (u32 i = 0; i < m_texturePool.size(); ++i)
+		{
+			PooledTexture& texture = m_texturePool[i];
+			if (texture.RendererID == 0)
+			{
+				freeSlot = std::min(freeSlot, i);
+				continue;
+			}
+
+			if (!texture.InUse && texture.Desc == desc)
+			{
+				texture.InUse = true;
+				texture.LastUsedFrame = m_frameIndex;
+				return i;
+			}
+		}
+
+		PooledTexture texture;
+		texture.Desc = desc;
+		texture.InUse = true;
+		texture.LastUsedFrame = m_frameIndex;
+
+		glCreateTextures(GL_TEXTURE_2D, 1, &texture.RendererID);
+		glTextureStorage2D(texture.RendererID, 1, desc.InternalFormat, static_cast<GLsizei>(desc.Width), static_cast<GLsizei>(desc.Height));
+		glTextureParameteri(texture.RendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTextureParameteri(texture.RendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTextureParameteri(texture.RendererID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(texture.RendererID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		if (freeSlot != U32_MAX)
+		{
+			m_texturePool[freeSlot] = texture;
+			return freeSlot;
+		}
+
+		m_texturePool.push_back(texture);
+		return static_cast<u32>(m_texturePool.size() - 1);
+	}
+
+	u32 RenderGraph::GetOrCreateFramebuffer(const Pass& pass)
+	{
+		FramebufferKey key{};
+		b8 usesBackbuffer = false;
+
+		for (uSize i = 0; i < pass.ColorAttachments.size(); ++i)
+		{
+			usesBackbuffer = usesBackbuffer || pass.ColorAttachments[i] == m_backbuffer.Index;
+			key.Colors[i] = GetPhysicalTexture(pass.ColorAttachments[i]);
+		}
+
+		if (pass.DepthAttachment != U32_MAX)
+		{
+			usesBackbuffer = usesBackbuffer || pass.DepthAttachment == m_backbuffer.Index;
+			key.Depth = GetPhysicalTexture(pass.DepthAttachment);
+		}
+
+		if (usesBackbuffer)
+		{
+			ZN_ASSERT(pass.ColorAttachments.size() <= 1, "Passes writing the backbuffer can't have other attachments");
+			return 0;
+		}
+
+		for (CachedFramebuffer& framebuffer : m_framebuffers)
+		{
+			if (framebuffer.Key == key)
+			{
+				framebuffer.LastUsedFrame = m_frameIndex;
+				return framebuffer.RendererID;
+			}
+		}
+
+		CachedFramebuffer framebuffer;
+		framebuffer.Key = key;
+		framebuffer.LastUsedFrame = m_frameIndex;
+
+		glCreateFramebuffers(1, &framebuffer.RendererID);
+
+		Array<GLenum, MAX_COLOR_ATTACHMENTS> drawBuffers{};
+		for (uSize i = 0; i < pass.ColorAttachments.size(); ++i)
+		{
+			drawBuffers[i] = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i);
+			glNamedFramebufferTexture(framebuffer.RendererID, drawBuffers[i], key.Colors[i], 0);
+		}
+
+		if (pass.DepthAttachment != U32_MAX)
+		{
+			const u32 format = m_resources[pass.DepthAttachment].Desc.InternalFormat;
+			const GLenum attachment = IsDepthStencilFormat(format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+			glNamedFramebufferTexture(framebuffer.RendererID, attachment, key.Depth, 0);
+		}
+
+		if (pass.ColorAttachments.empty())
+		{
+			glNamedFramebufferDrawBuffer(framebuffer.RendererID, GL_NONE);
+		}
+		else
+		{
+			glNamedFramebufferDrawBuffers(framebuffer.RendererID, static_cast<GLsizei>(pass.ColorAttachments.size()), drawBuffers.data());
+		}
+
+		const GLenum status = glCheckNamedFramebufferStatus(framebuffer.RendererID, GL_FRAMEBUFFER);
+		if (status != GL_FRAMEBUFFER_COMPLETE)
+		{
+			ZN_LOG_ERROR(Renderer, "[RenderGraph::GetOrCreateFramebuffer] Framebuffer for pass {} is incomplete (status: {:#x})", pass.Name, status);
+		}
+
+		++m_stats.FramebuffersCreated;
+		m_framebuffers.push_back(framebuffer);
+
+		return framebuffer.RendererID;
+	}
+
+	void RenderGraph::ReleaseUnusedPoolEntries()
+	{
+		auto isStale = [this](u64 lastUsedFrame) { return m_frameIndex - lastUsedFrame > POOL_RETENTION_FRAMES; };
+
+		for (PooledTexture& texture : m_texturePool)
+		{
+			if (texture.RendererID == 0 || !isStale(texture.LastUsedFrame))
+				continue;
+
+			// Framebuffers referencing the texture go with it
+			for (CachedFramebuffer& framebuffer : m_framebuffers)
+			{
+				const b8 referencesTexture = framebuffer.Key.Depth == texture.RendererID
+					|| std::find(framebuffer.Key.Colors.begin(), framebuffer.Key.Colors.end(), texture.RendererID) != framebuffer.Key.Colors.end();
+
+				if (referencesTexture)
+					framebuffer.LastUsedFrame = 0;
+			}
+
+			glDeleteTextures(1, &texture.RendererID);
+			GLStateCache::OnTextureDeleted(texture.RendererID);
+			texture = {};
+		}
+
+		auto staleFramebuffers = std::remove_if(m_framebuffers.begin(), m_framebuffers.end(), [&](const CachedFramebuffer& framebuffer)
+		{
+			if (!isStale(framebuffer.LastUsedFrame))
+				return false;
+
+			glDeleteFramebuffers(1, &framebuffer.RendererID);
+			GLStateCache::OnFramebufferDeleted(framebuffer.RendererID);
+			return true;
+		});
+
+		m_framebuffers.erase(staleFramebuffers, m_framebuffers.end());
+	}
+
+	u32 RenderGraph::GetPhysicalTexture(u32 resourceIndex) const
+	{
+		ZN_ASSERT(resourceIndex < m_resources.size());
+
+		const VirtualResource& resource = m_resources[resourceIndex];
+		if (resource.Imported)
+		{
+			return resource.ImportedID;
+		}
+
+		ZN_ASSERT(resource.PhysicalIndex != U32_MAX, "Transient texture has no physical texture, is it only used by culled passes?");
+
+		return resource.PhysicalIndex != U32_MAX ? m_texturePool[resource.PhysicalIndex].RendererID : 0;
+	}
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+namespace zn
+{
+	struct RenderGraphTextureDesc
+	{
+		u32 Width = 0;
+		u32 Height = 0;
+		u32 InternalFormat = 0; // GL sized internal format, e.g. GL_RGBA16F or GL_DEPTH24_STENCIL8
+
+		b8 operator==(const RenderGraphTextureDesc& other) const = default;
+	};
+
+	// Virtual resource handle, only meaningful for the graph that created it and for the current frame
+	struct RenderGraphResource
+	{
+		static constexpr u32 INVALID_INDEX = U32_MAX;
+
+		u32 Index = INVALID_INDEX;
+
+		[[nodiscard]] b8 IsValid() const { return Index != INVALID_INDEX; }
+		b8 operator==(const RenderGraphResource& other) const = default;
+	};
+
+	class RenderGraph;
+
+	// Handed to a pass while it executes, translates virtual resources into GL objects
+	class RenderGraphContext
+	{
+	public:
+		[[nodiscard]] u32 GetTexture(RenderGraphResource resource) const;
+		[[nodiscard]] u32 GetBuffer(RenderGraphResource resource) const;
+
+		[[nodiscard]] u32 GetTargetWidth() const { return m_targetWidth; }
+		[[nodiscard]] u32 GetTargetHeight() const { return m_targetHeight; }
+
+	private:
+		friend class RenderGraph;
+
+		RenderGraphContext(const RenderGraph& graph, u32 targetWidth, u32 targetHeight)
+			: m_graph(graph), m_targetWidth(targetWidth), m_targetHeight(targetHeight) {}
+
+		const RenderGraph& m_graph;
+		u32 m_targetWidth;
+		u32 m_targetHeight;
+	};
+
+	// Frame graph for the renderer. Passes declare what they read and write during setup, and the graph:
+	//  - culls passes whose results nobody consumes,
+	//  - orders the remaining passes from their dependencies,
+	//  - assigns transient textures from a pool, reusing a texture once the previous user is done with it,
+	//  - creates and caches the framebuffers each pass renders into.
+	// Compilation results are cached and reused while the graph structure does not change between frames.
+	class RenderGraph
+	{
+	public:
+		using ExecuteFunc = Func<void(const RenderGraphContext&)>;
+
+		static constexpr u32 MAX_COLOR_ATTACHMENTS = 4;
+		// Pooled textures not used for this many frames are released
+		static constexpr u32 POOL_RETENTION_FRAMES = 8;
+
+		struct Stats
+		{
+			u32 DeclaredPasses = 0;
+			u32 CulledPasses = 0;
+			u32 TransientTextures = 0;
+			u32 PhysicalTextures = 0;   // Pooled GL textures used to back the transient ones this frame
+			u32 FramebuffersCreated = 0;
+			b8 CompileCacheHit = false;
+		};
+
+		class PassBuilder
+		{
+		public:
+			RenderGraphResource CreateTexture(StringView name, const RenderGraphTextureDesc& desc);
+
+			RenderGraphResource Read(RenderGraphResource resource);
+			// Textures written by a pass become its color attachments, in declaration order
+			RenderGraphResource Write(RenderGraphResource resource);
+			RenderGraphResource WriteDepth(RenderGraphResource resource);
+
+			// Keeps the pass alive even if nothing reads its outputs (readbacks, timers...)
+			void SetSideEffect();
+
+		private:
+			friend class RenderGraph;
+
+			PassBuilder(RenderGraph& graph, u32 passIndex) : m_graph(graph), m_passIndex(passIndex) {}
+
+			RenderGraph& m_graph;
+			u32 m_passIndex;
+		};
+
+		RenderGraph() = default;
+		~RenderGraph();
+
+		RenderGraph(const RenderGraph& other) = delete;
+		RenderGraph(RenderGraph&& other) noexcept = delete;
+
+		RenderGraph& operator=(const RenderGraph& other) = delete;
+		RenderGraph& operator=(RenderGraph&& other) noexcept = delete;
+
+		// Clears the passes and virtual resources declared for the previous frame. Pooled GPU objects are kept,
+		// and so is the storage of the cleared passes: a graph with the same shape as last frame doesn't allocate
+		void BeginFrame(u32 backbufferWidth, u32 backbufferHeight);
+
+		[[nodiscard]] RenderGraphResource GetBackbuffer() const { return m_backbuffer; }
+		RenderGraphResource ImportTexture(StringView name, u32 texture, const RenderGraphTextureDesc& desc);
+		RenderGraphResource ImportBuffer(StringView name, u32 buffer);
+
+		void AddPass(StringView name, const Func<void(PassBuilder&)>& setup, ExecuteFunc execute);
+
+		void Compile();
+		void Execute();
+
+		[[nodiscard]] const Stats& GetStats() const { return m_stats; }
+
+	private:
+		friend class RenderGraphContext;
+
+		enum class ResourceType : u8
+		{
+			Texture,
+			Buffer,
+		};
+
+		struct VirtualResource
+		{
+			String Name;
+			ResourceType Type = ResourceType::Texture;
+			RenderGraphTextureDesc Desc{};
+
+			b8 Imported = false;
+			u32 ImportedID = 0;   // GL name when imported, 0 for the backbuffer
+			u32 PhysicalIndex = U32_MAX; // Index into the texture pool for transient textures
+
+			// Pass indices (in execution order) of the first and last use, for transient textures
+			u32 FirstUse = U32_MAX;
+			u32 LastUse = 0;
+		};
+
+		struct Pass
+		{
+			String Name;
+			ExecuteFunc Execute;
+
+			Vector<u32> Reads;
+			Vector<u32> Writes;
+			Vector<u32> ColorAttachments;
+			u32 DepthAttachment = U32_MAX;
+
+			b8 SideEffect = false;
+			u32 RefCount = 0;
+			b8 Culled = false;
+		};
+
+		struct PooledTexture
+		{
+			RenderGraphTextureDesc Desc{};
+			u32 RendererID = 0;
+			u64 LastUsedFrame = 0;
+			b8 InUse = false;
+		};
+
+		struct FramebufferKey
+		{
+			Array<u32, MAX_COLOR_ATTACHMENTS> Colors{};
+			u32 Depth = 0;
+
+			b8 operator==(const FramebufferKey& other) const = default;
+		};
+
+		struct CachedFramebuffer
+		{
+			FramebufferKey Key{};
+			u32 RendererID = 0;
+			u64 LastUsedFrame = 0;
+		};
+
+		u32 AddResource(StringView name, ResourceType type);
+		[[nodiscard]] u64 HashStructure() const;
+
+		void CullPasses();
+		void SortPasses();
+		void AssignPhysicalTextures();
+
+		u32 AcquirePooledTexture(const RenderGraphTextureDesc& desc);
+		u32 GetOrCreateFramebuffer(const Pass& pass);
+		void ReleaseUnusedPoolEntries();
+
+		[[nodiscard]] u32 GetPhysicalTexture(u32 resourceIndex) const;
+
+	private:
+		Vector<VirtualResource> m_resources;
+		Vector<Pass> m_passes;
+		Vector<u32> m_executionOrder;
+
+		// Entries cleared by BeginFrame, reused by AddPass / AddResource
+		Vector<Pass> m_freePasses;
+		Vector<VirtualResource> m_freeResources;
+
+		RenderGraphResource m_backbuffer{};
+		u32 m_backbufferWidth = 0;
+		u32 m_backbufferHeight = 0;
+
+		Vector<PooledTexture> m_texturePool;
+		Vector<CachedFramebuffer> m_framebuffers;
+
+		u64 m_frameIndex = 0;
+		u64 m_compiledHash = 0;
+		b8 m_compiled = false;
+
+		// Compilation results from the last compile, reapplied when the structure hash matches
+		Vector<u8> m_cachedCulled;
+		Vector<u32> m_cachedPhysical;
+
+		Stats m_stats;
+	};
+}
@@ -1,17 +1,63 @@
 ﻿#include "Renderer.hpp"
 
+#include "DebugDraw.hpp"
+#include "GLStateCache.hpp"
+#include "InstanceBuffer.hpp"
 #include "VertexArray.hpp"
+#include "Core/JobSystem.hpp"
+#include "Core/Profiler.hpp"
+#include "Core/StatsRegistry.hpp"
+#include "Culling/OcclusionCuller.hpp"
+#include "Math/Bounds.hpp"
+#include "Memory/AllocationGuard.hpp"
+#include "Memory/FrameAllocator.hpp"
+#include "Memory/MemoryTracker.hpp"
 #include "Resource/ResourceManager.hpp"
+#include "Scene/Components.hpp"
 
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <imgui.h>
+
+#include <algorithm>
+#include <tuple>
 
 namespace zn
 {
+    namespace
+    {
+        // Blends two TRS matrices: translation and scale linearly, rotation with slerp. Shear is lost,
+        // which is fine for the scene's uniformly scaled nodes
+        math::m4 InterpolateTransform(const math::m4& from, const math::m4& to, f32 alpha)
+        {
+            const auto decompose = [](const math::m4& matrix, math::v3& translation, math::quat& rotation, math::v3& scale)
+            {
+                translation = math::v3(matrix[3]);
+                scale = math::v3(glm::length(math::v3(matrix[0])), glm::length(math::v3(matrix[1])), glm::length(math::v3(matrix[2])));
+                rotation = glm::quat_cast(math::m3(math::v3(matrix[0]) / scale.x, math::v3(matrix[1]) / scale.y, math::v3(matrix[2]) / scale.z));
+            };
+
+            math::v3 fromTranslation, toTranslation, fromScale, toScale;
+            math::quat fromRotation, toRotation;
+            decompose(from, fromTranslation, fromRotation, fromScale);
+            decompose(to, toTranslation, toRotation, toScale);
+
+            math::m4 result = glm::mat4_cast(glm::slerp(fromRotation, toRotation, alpha));
+            const math::v3 scale = glm::mix(fromScale, toScale, alpha);
+            result[0] *= scale.x;
+            result[1] *= scale.y;
+            result[2] *= scale.z;
+            result[3] = math::v4(glm::mix(fromTranslation, toTranslation, alpha), 1.0f);
+
+            return result;
+        }
+    }
+
     Renderer::Renderer()
     {
         
@@ -24,30 +70,94 @@ namespace zn
 
     b8 Renderer::Init(u32 width, u32 height)
     {
+        MemoryTagScope memoryTag(MemoryTag::Renderer);
+
+        m_viewportWidth = width;
+        m_viewportHeight = height;
+
+        Shader::InitParallelCompile();
+
+        // The fallback is tiny and is what gets drawn while the other shaders compile, so it's the only one waited on
+        if (auto fallbackShader = ResourceManager::LoadShader("Content/Shaders/fallback.vert", "Content/Shaders/fallback.frag"))
+        {
+            m_fallbackShaderHandle = fallbackShader.value();
+
+            const Shader& shader = ResourceManager::GetShader(m_fallbackShaderHandle).value().get();
+            shader.WaitUntilReady();
+
+            // Everything else falls back to it, so there's nothing to draw with if it failed
+            if (shader.GetStatus() != Shader::Status::Ready)
+            {
+                ZN_LOG_ERROR(Renderer, "[Renderer::Init] The fallback shader failed to compile");
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+
         // TEMPORAL ///////////////////////////////////////
+        // Shaders are only kicked off here. Their compilation overlaps with the texture loading below
         if (auto shader = ResourceManager::LoadShader("Content/Shaders/default.vert", "Content/Shaders/default.frag"))
         {
             m_basicShaderHandle = shader.value();
         }
 
-        if (auto lightDebugCubeShader = ResourceManager::LoadShader("Content/Shaders/light_cube.vert", "Content/Shaders/light_cube.frag"))
+        if (auto lightingShader = ResourceManager::LoadShaderVariants("Content/Shaders/lighting.vert", "Content/Shaders/lighting.frag"))
         {
-            m_lightDebugCubeShaderHandle = lightDebugCubeShader.value();
-        }
+            m_lightingShaderVariants = lightingShader.value();
+            m_lightingKeywords = ResourceManager::GetShaderVariants(m_lightingShaderVariants).value().get().GetKeywordMask({ "SPECULAR" });
 
-        if (auto lightingShader = ResourceManager::LoadShader("Content/Shaders/lighting.vert", "Content/Shaders/lighting.frag"))
-        {
-            m_lightingShaderHandle = lightingShader.value();
+            // Variants compile lazily, request the one we use now instead of on the first frame
+            (void)ResourceManager::GetShaderVariant(m_lightingShaderVariants, m_lightingKeywords);
+
+            const Vector<MaterialParameter> phongParameters = {
+                { "ambient", MaterialParameterType::Vec3 },
+                { "diffuse", MaterialParameterType::Vec3 },
+                { "specular", MaterialParameterType::Vec3 },
+                { "shininess", MaterialParameterType::Float },
+            };
+
+            if (auto material = ResourceManager::CreateMaterial(m_lightingShaderVariants, m_lightingKeywords, phongParameters))
+            {
+                m_lightingMaterial = material.value();
+                ResourceManager::ModifyMaterial(m_lightingMaterial, [](Material& lightingMaterial)
+                {
+                    lightingMaterial.SetVec3("ambient", {1.0f, 0.5f, 0.31f});
+                    lightingMaterial.SetVec3("diffuse", {1.0f, 0.5f, 0.31f});
+                    lightingMaterial.SetVec3("specular", {0.5f, 0.5f, 0.5f});
+                    lightingMaterial.SetFloat("shininess", 32.0f);
+                });
+            }
+
+            // Same shading, model matrices come from the instance buffer
+            const u32 instancedKeywords = ResourceManager::GetShaderVariants(m_lightingShaderVariants).value().get().GetKeywordMask({ "SPECULAR", "INSTANCED" });
+            (void)ResourceManager::GetShaderVariant(m_lightingShaderVariants, instancedKeywords);
+
+            if (auto material = ResourceManager::CreateMaterial(m_lightingShaderVariants, instancedKeywords, phongParameters))
+            {
+                m_instancedLightingMaterial = material.value();
+                ResourceManager::ModifyMaterial(m_instancedLightingMaterial, [](Material& instancedMaterial)
+                {
+                    instancedMaterial.SetVec3("ambient", {0.31f, 0.5f, 1.0f});
+                    instancedMaterial.SetVec3("diffuse", {0.31f, 0.5f, 1.0f});
+                    instancedMaterial.SetVec3("specular", {0.5f, 0.5f, 0.5f});
+                    instancedMaterial.SetFloat("shininess", 32.0f);
+                });
+            }
         }
 
-        if (auto wallTexture = ResourceManager::LoadTexture("Content/Textures/wall.jpg"))
+        const Vector<Opt<Handle<Texture>>> textures = ResourceManager::LoadTextures({ "Content/Textures/wall.jpg", "Content/Textures/george.jpg" });
+
+        if (textures[0])
         {
-            m_wallTextureHandle = wallTexture.value();
+            m_wallTextureHandle = textures[0].value();
         }
 
-        if (auto georgeTexture = ResourceManager::LoadTexture("Content/Textures/george.jpg"))
+        if (textures[1])
         {
-            m_georgeTextureHandle = georgeTexture.value();
+            m_georgeTextureHandle = textures[1].value();
         }
 
         m_vertexArray = CreateUnique<zn::VertexArray>();
@@ -75,22 +185,6 @@ namespace zn
 
         // LIGHTING EXAMPLE SETUP
         // ------------------------------------------------
-        m_lightDegugCubeVA = CreateUnique<VertexArray>();
-        m_lightDegugCubeVA->Bind();
-
-        VertexBuffer lightDebugCubeVB{};
-        lightDebugCubeVB.Bind();
-        lightDebugCubeVB.SetData(lightDebugCubeVerts.data(), lightDebugCubeVerts.size() * sizeof(f32));
-		
-        VertexBufferLayout lightDebugCubeVBL;
-        lightDebugCubeVBL.PushElement<f32>(3); // positions
-
-        m_lightDegugCubeVA->AddVertexBuffer(lightDebugCubeVB, lightDebugCubeVBL);
-
-        lightDebugCubeVB.Unbind();
-        m_lightDegugCubeVA->Unbind();
-
-        // --------------------------------
         
         m_lightingCubeVA = CreateUnique<VertexArray>();
         m_lightingCubeVA->Bind();
@@ -107,13 +201,25 @@ namespace zn
 
         lightingCubeVB.Unbind();
         m_lightingCubeVA->Unbind();
+
+        m_occlusionCuller = CreateUnique<OcclusionCuller>();
+        m_clusteredLighting = CreateUnique<ClusteredLighting>();
+        m_lights.reserve(MAX_LIGHTS);
+
+        m_instanceBuffer = CreateUnique<InstanceBuffer>();
+        CreateScene();
+
+        if (!DebugDraw::Init())
+        {
+            return false;
+        }
         
         return true;
     }
 
     void Renderer::Shutdown()
     {
-        
+        DebugDraw::Shutdown();
     }
 
     void Renderer::ClearScreen(f32 r, f32 g, f32 b, f32 a) const
@@ -122,14 +228,97 @@ namespace zn
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
 
-    void Renderer::TexturedCubesExample(const Camera& camera) const
+    void Renderer::OnImGui()
+    {
+        ImGui::Begin("Renderer");
+
+        ImGui::SliderInt("Lights", &m_lightCount, 1, static_cast<int>(MAX_LIGHTS));
+        ImGui::Checkbox("Draw light bounds", &m_drawLightBounds);
+
+        const ClusteredLighting::Stats& lightingStats = m_clusteredLighting->GetStats();
+        ImGui::Text("Visible lights: %u / %u", lightingStats.VisibleLights, lightingStats.Lights);
+        ImGui::Text("Light assignment: %.3f ms", lightingStats.AssignmentTimeMs);
+        ImGui::Text("Light indices: %u (max %u per cluster)", lightingStats.LightIndices, lightingStats.MaxLightsPerCluster);
+        ImGui::Text("Light upload: %u bytes", lightingStats.UploadBytes);
+
+        ImGui::Separator();
+
+        // Lowering the ISA is how the scalar and narrower SIMD kernels get exercised on a fast machine
+        const c8* isaNames[] = { "Scalar", "SSE4.2", "AVX2", "AVX-512" };
+        int isa = static_cast<int>(CpuFeatures::GetIsa());
+        if (ImGui::Combo("Kernel ISA", &isa, isaNames, static_cast<int>(CpuFeatures::GetDetectedIsa()) + 1))
+        {
+            CpuFeatures::ForceIsa(static_cast<CpuIsa>(isa));
+        }
+
+        if (ImGui::Button("Run SIMD math benchmark"))
+        {
+            m_simdBenchmarkResults = math::simd::RunBenchmarks(1 << 20);
+        }
+
+        for (const math::simd::BenchmarkResult& result : m_simdBenchmarkResults)
+        {
+            ImGui::Text("%s (%s): %.2f ms / M, max error %g", result.Kernel, CpuFeatures::GetIsaName(result.Isa), result.MsPerMillion, result.MaxError);
+        }
+
+        ImGui::Separator();
+
+        // The hierarchy itself may already be updating the next frame
+        const TransformHierarchy::Stats& hierarchyStats = m_lastRenderedTransformStats;
+        ImGui::Text("Transforms: %u nodes, %u levels", hierarchyStats.Nodes, hierarchyStats.Levels);
+        ImGui::Text("Recomputed: %u in %u batches (%.3f ms)", hierarchyStats.Recomputed, hierarchyStats.Batches, hierarchyStats.UpdateTimeMs);
+        ImGui::Text("Instance upload: %u bytes", m_lastFrameMaterialStats.InstanceUploadBytes);
+        ImGui::Text("Scene instances drawn: %u / %u", m_visibleSceneInstances, m_sceneInstanceCount);
+
+        ImGui::Separator();
+
+        const FrameAllocator::Stats& frameMemory = FrameAllocator::GetStats();
+        ImGui::Text("Frame arena: %zu / %zu KB (peak %zu KB)", frameMemory.Used / 1024, frameMemory.Capacity / 1024, frameMemory.HighWaterMark / 1024);
+        ImGui::Text("Frame arena overflow: %zu bytes, scratch peak: %zu KB", frameMemory.OverflowBytes, frameMemory.ScratchHighWaterMark / 1024);
+
+        ImGui::Separator();
+
+        const Vector<JobSystem::WorkerStats>& workerStats = JobSystem::GetWorkerStats();
+        for (uSize i = 0; i < workerStats.size(); i++)
+        {
+            const JobSystem::WorkerStats& worker = workerStats[i];
+            ImGui::Text("%s %u: %3.0f%% busy, %u jobs, %u stolen", i == 0 ? "Main  " : "Worker", static_cast<u32>(i),
+                worker.Utilization * 100.0f, worker.JobsExecuted, worker.JobsStolen);
+        }
+
+        ImGui::Separator();
+
+        const MaterialStats& materialStats = m_lastFrameMaterialStats;
+        ImGui::Text("Draw calls: %u", materialStats.DrawCalls);
+        ImGui::Text("Shader binds: %u, material binds: %u", materialStats.ShaderBinds, materialStats.MaterialBinds);
+
+        ImGui::End();
+    }
+
+    void Renderer::SetViewportSize(u32 width, u32 height)
     {
-        const Shader& basicShader = ResourceManager::GetShader(m_basicShaderHandle).value();
+        m_viewportWidth = width;
+        m_viewportHeight = height;
+    }
+
+    const Shader& Renderer::SelectShader(const Shader& shader) const
+    {
+        if (shader.IsReady())
+        {
+            return shader;
+        }
+
+        return ResourceManager::GetShader(m_fallbackShaderHandle).value();
+    }
+
+    void Renderer::TexturedCubesExample(const RenderPacket& packet)
+    {
+        const Shader& basicShader = SelectShader(ResourceManager::GetShader(m_basicShaderHandle).value());
         basicShader.Bind();
         basicShader.SetInt("texture1", 0);
         basicShader.SetInt("texture2", 1);
-        basicShader.SetMat4("view", camera.GetViewMatrix());
-        basicShader.SetMat4("projection", camera.GetProjection());
+        basicShader.SetMat4("view", packet.View.GetViewMatrix());
+        basicShader.SetMat4("projection", packet.View.GetProjection());
 
         const Texture& wallTexture = ResourceManager::GetTexture(m_wallTextureHandle).value();
         wallTexture.Bind();
@@ -138,55 +327,39 @@ namespace zn
         georgeTexture.Bind(1);
         
         m_vertexArray->Bind();
-        
-        int counter = 0;
-        for(uSize i = 0; i < 10; i++)
+
+        for (const u32 instance : packet.VisibleInstances)
         {
-            math::m4 model = math::m4(1.0f);
-            model = glm::translate(model, cubePositions[i]);
-            f32 angle = 20.0f * i; 
-            model = glm::rotate(model, glm::radians(angle), math::v3(1.0f, 0.3f, 0.5f));
-        
-            if(i == 0 || counter == 3)
-            {
-                model = glm::rotate(model, glm::radians(f32(glfwGetTime() * 120.0f)), math::v3(1.0f, 1.0f, 1.0f));
-                counter = 0;
-            }
-        
-            basicShader.SetMat4("model", model);
-        
+            basicShader.SetMat4("model", m_renderInstanceWorlds[instance]);
+
             glDrawArrays(GL_TRIANGLES, 0, 36);
-        
-            counter++;
         }
 
         //glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
         glDrawArrays(GL_TRIANGLES, 0, 36);
     }
 
-    void Renderer::LightingExample(const Camera& camera) const
+    void Renderer::LightingExample(const RenderPacket& packet)
     {
-        const math::v3 cameraPos = camera.GetPosition();
-        const math::m4 view = camera.GetViewMatrix();
-        const math::m4 proj = camera.GetProjection();
-        
-        const glm::vec3 lightPos = glm::vec3(18.0f * cos(glfwGetTime()), -5.0f, 18.0f * sin(glfwGetTime()));
+        const Camera& camera = packet.View;
 
-        // Draw debug Light
-        // ======================================================================
-        math::m4 lightModel = math::m4(1.0f);
-        lightModel = glm::translate(lightModel, lightPos);
-        lightModel = glm::scale(lightModel, math::v3(.6f));
+        UpdateLights(packet.Time);
 
-        const Shader& lightDebugCubeShader = ResourceManager::GetShader(m_lightDebugCubeShaderHandle).value();
-        lightDebugCubeShader.Bind();
-        lightDebugCubeShader.SetMat4("model", lightModel);
-        lightDebugCubeShader.SetMat4("view", view);
-        lightDebugCubeShader.SetMat4("projection", proj);
+        m_clusteredLighting->Update(m_lights, camera.GetViewMatrix(), camera.GetProjection(),
+            camera.GetNearClip(), camera.GetFarClip(), m_viewportWidth, m_viewportHeight);
 
-        m_lightDegugCubeVA->Bind();
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        m_lightDegugCubeVA->Unbind();
+        // Draw debug Lights
+        // ======================================================================
+        for (const PointLight& light : m_lights)
+        {
+            const math::v4 color(light.Color, 1.0f);
+            DebugDraw::Box(math::AABB{ light.Position - math::v3(0.1f), light.Position + math::v3(0.1f) }, color);
+
+            if (m_drawLightBounds)
+            {
+                DebugDraw::Sphere(light.Position, light.Radius, color);
+            }
+        }
 
         // Phong Shading
         // ======================================================================
@@ -196,38 +369,468 @@ namespace zn
         cubeModel = glm::translate(cubeModel, cubePos);
         //cubeModel = glm::scale(cubeModel, math::v3(10.0f));
 
-        const Shader& lightingShader = ResourceManager::GetShader(m_lightingShaderHandle).value();
-        lightingShader.Bind();
-        lightingShader.SetMat4("model", cubeModel);
-        lightingShader.SetMat4("view", view);
-        lightingShader.SetMat4("projection", proj);
-        
-        math::m4 normalMatrix = glm::transpose(glm::inverse(glm::mat3(view * cubeModel)));
-        //lightingShader.SetMat4("normalMatrix", normalMatrix);
-
-        // Material properties
-        lightingShader.SetVec3("material.ambient",  {1.0f, 0.5f, 0.31f});
-        lightingShader.SetVec3("material.diffuse",  {1.0f, 0.5f, 0.31f});
-        lightingShader.SetVec3("material.specular", {0.5f, 0.5f, 0.5f});
-        lightingShader.SetFloat("material.shininess", 32.0f);
-
-        lightingShader.SetVec3("light.position", math::v3(view * math::v4(lightPos, 1.0f)));
-        lightingShader.SetVec3("light.ambient",  {0.2f, 0.2f, 0.2f});
-        lightingShader.SetVec3("light.diffuse",  {0.5f, 0.5f, 0.5f});
-        lightingShader.SetVec3("light.specular", {1.0f, 1.0f, 1.0f});
-        
-        lightingShader.SetVec3("viewPosition", cameraPos);
+        SubmitDraw(m_lightingMaterial, *m_lightingCubeVA, cubeModel, 36);
 
-        m_lightingCubeVA->Bind();
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        m_lightingCubeVA->Unbind();
+        // Floor for the lights to land on
+        math::m4 floorModel = glm::translate(math::m4(1.0f), math::v3(0.0f, -4.0f, 0.0f));
+        floorModel = glm::scale(floorModel, math::v3(48.0f, 0.5f, 48.0f));
+
+        SubmitDraw(m_lightingMaterial, *m_lightingCubeVA, floorModel, 36);
+
+        // Scene cubes and moons that survived culling, one draw for all of them
+        PublishSceneTransforms(packet);
+        SubmitDrawInstanced(m_instancedLightingMaterial, *m_lightingCubeVA, 36, m_firstSceneInstance, m_visibleSceneInstances);
+
+        FrameLighting lighting;
+        lighting.Ambient = {0.1f, 0.1f, 0.1f};
+
+        FlushDraws(camera, lighting);
+    }
+
+    void Renderer::UpdateLights(f32 time)
+    {
+        m_lights.resize(static_cast<uSize>(std::clamp<i32>(m_lightCount, 1, MAX_LIGHTS)));
+
+        // Lights orbit the cube on a disc just above the floor; odd and even lights spin in opposite directions
+        constexpr f32 goldenAngle = 2.39996323f;
+
+        for (u32 i = 0; i < m_lights.size(); i++)
+        {
+            const f32 index = static_cast<f32>(i);
+            const f32 orbitRadius = 1.0f + 20.0f * std::sqrt((index + 0.5f) / static_cast<f32>(MAX_LIGHTS));
+            const f32 direction = (i & 1) ? 1.0f : -1.0f;
+            const f32 angle = index * goldenAngle + direction * time * 0.5f;
+
+            PointLight& light = m_lights[i];
+            light.Position = math::v3(orbitRadius * std::cos(angle), -2.5f + 1.5f * std::sin(time + index * 0.37f), orbitRadius * std::sin(angle));
+            light.Radius = 3.0f;
+            light.Color = math::v3(0.5f + 0.5f * std::cos(index * 0.9f), 0.5f + 0.5f * std::cos(index * 0.9f + 2.1f), 0.5f + 0.5f * std::cos(index * 0.9f + 4.2f));
+            light.Intensity = 4.0f;
+        }
+    }
+
+    void Renderer::SubmitDraw(Handle<Material> material, const VertexArray& vertexArray, const math::m4& model, u32 vertexCount)
+    {
+        m_drawQueue.push_back({ material, &vertexArray, model, vertexCount });
+    }
+
+    void Renderer::SubmitDrawInstanced(Handle<Material> material, const VertexArray& vertexArray, u32 vertexCount, u32 firstInstance, u32 instanceCount)
+    {
+        if (instanceCount == 0)
+            return;
+
+        m_drawQueue.push_back({ material, &vertexArray, math::m4(1.0f), vertexCount, firstInstance, instanceCount });
     }
 
-    void Renderer::Render(const Camera& camera) const
+    void Renderer::FlushDraws(const Camera& camera, const FrameLighting& lighting)
     {
-        ClearScreen(0.3f, 0.3f, 0.3f, 1.0f);
+        ZN_PROFILE_FUNCTION();
+
+        // Group by shader permutation first and by material second, so programs and material
+        // resources are each bound once per group. Keys are built once per draw in the frame arena;
+        // the submission index breaks ties, which keeps the order stable without the temporary
+        // buffer std::stable_sort allocates
+        struct SortEntry
+        {
+            u32 Shader;
+            u32 Keywords;
+            u32 Material;
+            u32 Command;
+        };
+
+        PmrVector<SortEntry> sortedDraws(FrameAllocator::GetResource());
+        sortedDraws.reserve(m_drawQueue.size());
+
+        for (u32 i = 0; i < m_drawQueue.size(); i++)
+        {
+            auto material = ResourceManager::GetMaterial(m_drawQueue[i].MaterialHandle);
+            if (!material)
+                continue;
+
+            const Material& drawMaterial = material.value();
+            sortedDraws.push_back({ drawMaterial.GetShaderVariants().GetIndex(), drawMaterial.GetKeywordMask(), m_drawQueue[i].MaterialHandle.GetIndex(), i });
+        }
+
+        std::sort(sortedDraws.begin(), sortedDraws.end(), [](const SortEntry& lhs, const SortEntry& rhs)
+        {
+            return std::tie(lhs.Shader, lhs.Keywords, lhs.Material, lhs.Command) < std::tie(rhs.Shader, rhs.Keywords, rhs.Material, rhs.Command);
+        });
+
+        const math::m4 view = camera.GetViewMatrix();
+        const math::m4 projection = camera.GetProjection();
+
+        const Shader* boundShader = nullptr;
+        Opt<Handle<Material>> boundMaterial;
+
+        m_clusteredLighting->BindBuffers();
+        m_instanceBuffer->Bind();
+
+        for (const SortEntry& entry : sortedDraws)
+        {
+            const DrawCommand& command = m_drawQueue[entry.Command];
+
+            auto material = ResourceManager::GetMaterial(command.MaterialHandle);
+            if (!material)
+                continue;
+
+            const Material& drawMaterial = material.value();
+
+            auto variant = ResourceManager::GetShaderVariant(drawMaterial.GetShaderVariants(), drawMaterial.GetKeywordMask());
+            if (!variant)
+                continue;
+
+            const Shader& shader = SelectShader(variant.value());
+            if (&shader != boundShader)
+            {
+                shader.Bind();
+
+                // Per frame data, once per program
+                shader.SetMat4("view", view);
+                shader.SetMat4("projection", projection);
+                shader.SetVec3("ambientLight", lighting.Ambient);
+                m_clusteredLighting->SetShaderUniforms(shader);
+
+                m_materialStats.ShaderBinds++;
+                m_materialStats.UniformUploadBytes += 2 * sizeof(math::m4) + 4 * sizeof(math::v3);
+
+                boundShader = &shader;
+                boundMaterial.reset();
+            }
+
+            const b8 materialChanged = !boundMaterial
+                || boundMaterial->GetIndex() != command.MaterialHandle.GetIndex()
+                || boundMaterial->GetGeneration() != command.MaterialHandle.GetGeneration();
+
+            if (materialChanged)
+            {
+                m_materialStats.UniformUploadBytes += drawMaterial.UploadIfDirty();
+                drawMaterial.BindResources();
+
+                m_materialStats.MaterialBinds++;
+                boundMaterial = command.MaterialHandle;
+            }
+
+            command.Geometry->Bind();
+
+            if (command.InstanceCount > 0)
+            {
+                shader.SetInt("instanceOffset", static_cast<i32>(command.FirstInstance));
+                m_materialStats.UniformUploadBytes += sizeof(i32);
+
+                glDrawArraysInstanced(GL_TRIANGLES, 0, static_cast<GLsizei>(command.VertexCount), static_cast<GLsizei>(command.InstanceCount));
+            }
+            else
+            {
+                shader.SetMat4("model", command.Model);
+                m_materialStats.UniformUploadBytes += sizeof(math::m4);
+
+                glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(command.VertexCount));
+            }
+
+            m_materialStats.DrawCalls++;
+            ZN_STAT_ADD("Renderer/Draw calls", 1);
+            ZN_STAT_ADD("Renderer/Triangles", command.VertexCount / 3 * std::max<u32>(command.InstanceCount, 1));
+        }
+
+        m_drawQueue.clear();
+    }
+
+    void Renderer::CreateScene()
+    {
+        constexpr math::AABB unitCubeBounds{ math::v3(-0.5f), math::v3(0.5f) };
+        const math::v3 tiltAxis = glm::normalize(math::v3(1.0f, 0.3f, 0.5f));
+        const math::v3 spinAxis = glm::normalize(math::v3(1.0f, 1.0f, 1.0f));
+
+        const TransformHandle root = m_sceneTransforms.Create(std::nullopt, math::v3(0.0f, 1.0f, -6.0f));
+        m_scene.CreateEntity(TransformComponent{ root });
+
+        Vector<TransformHandle> cubes;
+
+        for (uSize i = 0; i < cubePositions.size(); i++)
+        {
+            const math::quat rotation = glm::angleAxis(glm::radians(20.0f * i), tiltAxis);
+            const TransformHandle cube = m_sceneTransforms.Create(root, cubePositions[i], rotation);
+            cubes.push_back(cube);
+
+            const Entity entity = m_scene.CreateEntity(TransformComponent{ cube }, WorldTransformComponent{},
+                MeshInstanceComponent{}, CullingComponent{ unitCubeBounds });
+
+            // Every third cube spins, the rest only move when a moon orbits them
+            if (i % 3 == 0)
+            {
+                m_scene.AddComponent<SpinComponent>(entity, SpinComponent{ rotation, spinAxis, 120.0f });
+            }
+        }
+
+        for (uSize i = 1; i < cubes.size(); i += 2)
+        {
+            const TransformHandle pivot = m_sceneTransforms.Create(cubes[i]);
+            m_scene.CreateEntity(TransformComponent{ pivot }, SpinComponent{ math::quat(1.0f, 0.0f, 0.0f, 0.0f), math::v3(0.0f, 1.0f, 0.0f), 90.0f });
+
+            const TransformHandle moon = m_sceneTransforms.Create(pivot, math::v3(1.2f, 0.0f, 0.0f), math::quat(1.0f, 0.0f, 0.0f, 0.0f), math::v3(0.3f));
+            m_scene.CreateEntity(TransformComponent{ moon }, WorldTransformComponent{}, MeshInstanceComponent{}, CullingComponent{ unitCubeBounds });
+        }
+
+        // One contiguous range, so the whole scene is a single instanced draw
+        m_sceneInstanceCount = m_scene.Query<MeshInstanceComponent>().Count();
+        m_firstSceneInstance = m_instanceBuffer->Allocate(m_sceneInstanceCount);
+
+        u32 nextInstance = m_firstSceneInstance;
+        m_scene.Query<TransformComponent, MeshInstanceComponent>().Each(
+            [&](Entity, const TransformComponent& transform, MeshInstanceComponent& mesh)
+            {
+                mesh.Instance = nextInstance++;
+
+                const u32 slot = transform.Node.GetIndex();
+                if (slot >= m_instanceOfNode.size())
+                {
+                    m_instanceOfNode.resize(slot + 1, NO_INSTANCE);
+                }
+
+                m_instanceOfNode[slot] = mesh.Instance;
+            });
+
+        m_previousInstanceWorlds.resize(m_sceneInstanceCount, math::m4(1.0f));
+        m_currentInstanceWorlds.resize(m_sceneInstanceCount, math::m4(1.0f));
+        m_instanceFlags.resize(m_sceneInstanceCount, 0);
+        m_movingInstances.reserve(m_sceneInstanceCount);
+        m_pendingInstances.reserve(m_sceneInstanceCount);
+
+        m_renderInstanceWorlds.resize(m_sceneInstanceCount, math::m4(1.0f));
+        m_renderInstanceVersions.resize(m_sceneInstanceCount, 0);
+        m_visibleSlotInstances.resize(m_sceneInstanceCount, NO_INSTANCE);
+        m_visibleSlotVersions.resize(m_sceneInstanceCount, 0);
+
+        for (RenderPacket& packet : m_renderPackets)
+        {
+            packet.InstanceUpdates.reserve(m_sceneInstanceCount);
+            packet.VisibleInstances.reserve(m_sceneInstanceCount);
+        }
+    }
+
+    void Renderer::UpdateScene(f32 time)
+    {
+        ZN_PROFILE_FUNCTION();
+
+        m_scene.Query<TransformComponent, SpinComponent>().Each(
+            [&](Entity, const TransformComponent& transform, const SpinComponent& spin)
+            {
+                const math::quat rotation = glm::angleAxis(glm::radians(time * spin.DegreesPerSecond), spin.Axis);
+                m_sceneTransforms.SetLocalRotation(transform.Node, spin.Base * rotation);
+            });
+
+        m_sceneTransforms.Update([](u32 taskCount, const Func<void(u32 task)>& body)
+        {
+            JobSystem::ParallelFor(taskCount, 1, [&body](u32 begin, u32 end)
+            {
+                for (u32 task = begin; task < end; task++)
+                {
+                    body(task);
+                }
+            });
+        });
+
+        m_scene.Query<TransformComponent, WorldTransformComponent>().EachChunk(
+            [this](u32 count, const Entity*, const TransformComponent* transforms, WorldTransformComponent* worlds)
+            {
+                for (u32 i = 0; i < count; i++)
+                {
+                    worlds[i].World = m_sceneTransforms.GetWorldMatrix(transforms[i].Node);
+                }
+            });
+    }
+
+    void Renderer::CaptureSceneStep()
+    {
+        // Instances that moved in the previous step and stopped still need their final matrix uploaded
+        for (const u32 local : m_movingInstances)
+        {
+            m_previousInstanceWorlds[local] = m_currentInstanceWorlds[local];
+            m_instanceFlags[local] &= ~INSTANCE_MOVING;
+        }
+        m_movingInstances.clear();
+
+        const b8 firstStep = m_simulationSteps == 0;
+
+        m_sceneTransforms.ForEachChanged([this, firstStep](TransformHandle node, const math::m4& world)
+        {
+            const u32 slot = node.GetIndex();
+            if (slot >= m_instanceOfNode.size() || m_instanceOfNode[slot] == NO_INSTANCE)
+                return;
+
+            const u32 local = m_instanceOfNode[slot] - m_firstSceneInstance;
+            m_currentInstanceWorlds[local] = world;
+
+            // Nothing to blend from before the first step
+            if (firstStep)
+            {
+                m_previousInstanceWorlds[local] = world;
+            }
+            else
+            {
+                m_instanceFlags[local] |= INSTANCE_MOVING;
+                m_movingInstances.push_back(local);
+            }
+
+            if (!(m_instanceFlags[local] & INSTANCE_PENDING))
+            {
+                m_instanceFlags[local] |= INSTANCE_PENDING;
+                m_pendingInstances.push_back(local);
+            }
+        });
+    }
+
+    void Renderer::PublishSceneTransforms(const RenderPacket& packet)
+    {
+        for (const auto& [instance, world] : packet.InstanceUpdates)
+        {
+            m_renderInstanceWorlds[instance] = world;
+            m_renderInstanceVersions[instance]++;
+        }
+
+        // Compact the visible instances into the front of the scene range. A slot is only rewritten when
+        // it now holds another instance or its instance moved, so the upload stays proportional to what changed
+        u32 slot = 0;
+        for (const u32 instance : packet.VisibleInstances)
+        {
+            if (m_visibleSlotInstances[slot] != instance || m_visibleSlotVersions[slot] != m_renderInstanceVersions[instance])
+            {
+                m_visibleSlotInstances[slot] = instance;
+                m_visibleSlotVersions[slot] = m_renderInstanceVersions[instance];
+                m_instanceBuffer->Set(m_firstSceneInstance + slot, m_renderInstanceWorlds[instance]);
+            }
+
+            slot++;
+        }
+
+        m_visibleSceneInstances = slot;
+        ZN_STAT_SET("Renderer/Scene instances drawn", m_visibleSceneInstances);
+        ZN_STAT_SET("Renderer/Scene instances culled", m_sceneInstanceCount - m_visibleSceneInstances);
+
+        m_materialStats.InstanceUploadBytes += m_instanceBuffer->Upload();
+    }
+
+    void Renderer::Simulate(f64 fixedDelta)
+    {
+        MemoryTagScope memoryTag(MemoryTag::Scene);
+
+        m_simulationTime += fixedDelta;
+        m_lastFixedDelta = fixedDelta;
+
+        UpdateScene(static_cast<f32>(m_simulationTime));
+        CaptureSceneStep();
+
+        m_simulationSteps++;
+    }
+
+    void Renderer::BeginCulling(const Camera& camera)
+    {
+        MemoryTagScope memoryTag(MemoryTag::Renderer);
+
+        m_occlusionCuller->BeginFrame(camera.GetViewProjectionMatrix());
+
+        m_scene.Query<WorldTransformComponent, CullingComponent>().Each(
+            [this](Entity, const WorldTransformComponent& transform, CullingComponent& culling)
+            {
+                // Solid objects are occluders and candidates at the same time. Occluder depth is
+                // conservative (farthest vertex of each triangle), so an object never hides itself
+                m_occlusionCuller->AddOccluder(lightDebugCubeVerts.data(), static_cast<u32>(lightDebugCubeVerts.size() / 3), transform.World);
+                culling.CandidateId = m_occlusionCuller->AddCandidate(math::AABB::Transform(culling.LocalBounds, transform.World));
+            });
+
+        m_occlusionCuller->Kick();
+    }
+
+    void Renderer::BuildRenderPacket(const Camera& camera, u64 frame, f32 alpha)
+    {
+        ZN_PROFILE_FUNCTION();
+        MemoryTagScope memoryTag(MemoryTag::Renderer);
+
+        RenderPacket& packet = m_renderPackets[frame % m_renderPackets.size()];
+        packet.View = camera;
+        packet.Time = static_cast<f32>(m_simulationTime - (1.0 - alpha) * m_lastFixedDelta);
+        packet.TransformStats = m_sceneTransforms.GetStats();
+
+        packet.InstanceUpdates.clear();
+        for (const u32 local : m_pendingInstances)
+        {
+            m_instanceFlags[local] &= ~INSTANCE_PENDING;
+
+            const math::m4 world = (m_instanceFlags[local] & INSTANCE_MOVING)
+                ? InterpolateTransform(m_previousInstanceWorlds[local], m_currentInstanceWorlds[local], alpha)
+                : m_currentInstanceWorlds[local];
+
+            packet.InstanceUpdates.emplace_back(local, world);
+        }
+        m_pendingInstances.clear();
+
+        // Alpha changes every frame, so moving instances go out again with the next packet
+        for (const u32 local : m_movingInstances)
+        {
+            m_instanceFlags[local] |= INSTANCE_PENDING;
+            m_pendingInstances.push_back(local);
+        }
+
+        m_occlusionCuller->Wait();
+
+        packet.VisibleInstances.clear();
+        m_scene.Query<MeshInstanceComponent, CullingComponent>().Each(
+            [this, &packet](Entity, const MeshInstanceComponent& mesh, const CullingComponent& culling)
+            {
+                if (m_occlusionCuller->IsVisible(culling.CandidateId))
+                {
+                    packet.VisibleInstances.push_back(mesh.Instance - m_firstSceneInstance);
+                }
+            });
+
+        packet.Valid = true;
+    }
+
+    void Renderer::Render(u64 frame)
+    {
+        ZN_PROFILE_FUNCTION();
+        MemoryTagScope memoryTag(MemoryTag::Renderer);
+        // Steady state submission only uses the frame arena and buffers that are already allocated
+        ZN_NO_ALLOC_SCOPE("Renderer::Render");
+
+        const RenderPacket& packet = m_renderPackets[frame % m_renderPackets.size()];
+        ZN_ASSERT(packet.Valid, "Rendered a frame without building its render packet");
+
+        if (!packet.Valid)
+            return;
+
+        GLStateCache::BeginFrame();
+
+        m_lastFrameMaterialStats = m_materialStats;
+        m_materialStats = {};
+        m_lastRenderedTransformStats = packet.TransformStats;
+
+        m_renderGraph.BeginFrame(m_viewportWidth, m_viewportHeight);
+
+        m_renderGraph.AddPass("Lighting",
+            [this](RenderGraph::PassBuilder& builder)
+            {
+                builder.Write(m_renderGraph.GetBackbuffer());
+            },
+            [this, &packet](const RenderGraphContext&)
+            {
+                ClearScreen(0.3f, 0.3f, 0.3f, 1.0f);
+                LightingExample(packet);
+            });
+
+        m_renderGraph.AddPass("DebugDraw",
+            [this](RenderGraph::PassBuilder& builder)
+            {
+                builder.Write(m_renderGraph.GetBackbuffer());
+            },
+            [&packet](const RenderGraphContext&)
+            {
+                DebugDraw::Flush(packet.View.GetViewProjectionMatrix());
+            });
+
+        m_renderGraph.Compile();
+        m_renderGraph.Execute();
 
-        //TexturedCubesExample(camera);
-        LightingExample(camera);
+        //TexturedCubesExample(packet);
     }
 }
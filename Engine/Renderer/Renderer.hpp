@@ -3,17 +3,35 @@
 #include "Core/Base.hpp"
 #include "Camera/Camera.hpp"
 #include "Math/Math.hpp"
+#include "Math/SimdMath.hpp"
+#include "Renderer/ClusteredLighting.hpp"
+#include "Renderer/RenderGraph.hpp"
 #include "Resource/ResourceRegistry.hpp"
+#include "Scene/TransformHierarchy.hpp"
+#include "Scene/World.hpp"
 
 namespace zn
 {
+    class InstanceBuffer;
+    class Material;
+    class OcclusionCuller;
     class Shader;
+    class ShaderVariants;
     class Texture;
     class VertexArray;
     
     class Renderer
     {
     public:
+        struct MaterialStats
+        {
+            u32 DrawCalls = 0;
+            u32 ShaderBinds = 0;
+            u32 MaterialBinds = 0;
+            u32 UniformUploadBytes = 0; // Material blocks plus per frame and per draw uniforms
+            u32 InstanceUploadBytes = 0;
+        };
+
         Renderer();
         ~Renderer();
 
@@ -26,24 +44,155 @@ namespace zn
         b8 Init(u32 width, u32 height);
         void Shutdown();
 
-        void Render(const Camera& camera) const;
+        // The frame is split so its stages can run as tasks of the application's frame graph:
+        //
+        //   Simulate (0..N fixed steps) -> BeginCulling -> BuildRenderPacket(frame)    any thread, no GL calls
+        //   Render(frame)                                                           main thread, GL only
+        //
+        // Everything Render needs is copied into the frame's render packet. Packets are double
+        // buffered, so Render(N) can run while frame N + 1 is simulated and culled
+
+        // Advances the scene by one fixed step and updates its transforms
+        void Simulate(f64 fixedDelta);
+        // Kicks frustum + occlusion culling of the simulated scene on worker threads
+        void BeginCulling(const Camera& camera);
+        // Waits for culling and captures what the frame draws. alpha is how far the frame is between
+        // the last two simulation steps; moving instances are drawn blended between them
+        void BuildRenderPacket(const Camera& camera, u64 frame, f32 alpha);
+        void Render(u64 frame);
         void ClearScreen(f32 r, f32 g, f32 b, f32 a) const;
+
+        // Renderer debug window: light count for the clustered lighting benchmark and stats
+        void OnImGui();
+
+        void SetViewportSize(u32 width, u32 height);
+        [[nodiscard]] const RenderGraph::Stats& GetRenderGraphStats() const { return m_renderGraph.GetStats(); }
+        [[nodiscard]] const MaterialStats& GetMaterialStats() const { return m_lastFrameMaterialStats; }
+        [[nodiscard]] const ClusteredLighting::Stats& GetLightingStats() const { return m_clusteredLighting->GetStats(); }
+
+        // Queues a draw. Queued draws are sorted by shader and material when flushed
+        void SubmitDraw(Handle<Material> material, const VertexArray& vertexArray, const math::m4& model, u32 vertexCount);
+        // Draws instanceCount instances whose model matrices live in the instance buffer, starting at firstInstance.
+        // The material's shader has to read them (INSTANCED keyword of the lighting shader)
+        void SubmitDrawInstanced(Handle<Material> material, const VertexArray& vertexArray, u32 vertexCount, u32 firstInstance, u32 instanceCount);
         
     private:
-        void TexturedCubesExample(const Camera& camera) const;
-        void LightingExample(const Camera& camera) const;
+        struct RenderPacket
+        {
+            Camera View;
+            f32 Time = 0.0f;
+            Vector<Pair<u32, math::m4>> InstanceUpdates; // Scene instance and world matrix of the nodes that moved
+            Vector<u32> VisibleInstances;                // Scene instances that passed culling
+            TransformHierarchy::Stats TransformStats;
+            b8 Valid = false;
+        };
+
+        void TexturedCubesExample(const RenderPacket& packet);
+        void LightingExample(const RenderPacket& packet);
+
+        void CreateScene();
+        void UpdateScene(f32 time);
+        void CaptureSceneStep();
+        void PublishSceneTransforms(const RenderPacket& packet);
+        void UpdateLights(f32 time);
+
+        struct FrameLighting
+        {
+            math::v3 Ambient{0.0f};
+        };
+
+        struct DrawCommand
+        {
+            Handle<Material> MaterialHandle;
+            const VertexArray* Geometry;
+            math::m4 Model;
+            u32 VertexCount;
+            u32 FirstInstance = 0;
+            u32 InstanceCount = 0; // 0 for non instanced draws, which use Model
+        };
+
+        void FlushDraws(const Camera& camera, const FrameLighting& lighting);
+
+        Vector<DrawCommand> m_drawQueue;
+        MaterialStats m_materialStats{};
+        MaterialStats m_lastFrameMaterialStats{};
+
+        // Returns the fallback shader while the given one is still compiling
+        [[nodiscard]] const Shader& SelectShader(const Shader& shader) const;
+
+        RenderGraph m_renderGraph;
+        u32 m_viewportWidth = 0;
+        u32 m_viewportHeight = 0;
         
         // TEMPORAL ///////////////////////////////////////
+        Handle<Shader> m_fallbackShaderHandle{};
         Handle<Shader> m_basicShaderHandle{};
-        Handle<Shader> m_lightDebugCubeShaderHandle{};
-        Handle<Shader> m_lightingShaderHandle{};
+        Handle<ShaderVariants> m_lightingShaderVariants{};
+        u32 m_lightingKeywords = 0;
+        Handle<Material> m_lightingMaterial{};
+        Handle<Material> m_instancedLightingMaterial{};
         
         Handle<Texture> m_wallTextureHandle{};
         Handle<Texture> m_georgeTextureHandle{};
         
         UniquePtr<VertexArray> m_vertexArray;
-        UniquePtr<VertexArray> m_lightDegugCubeVA;
         UniquePtr<VertexArray> m_lightingCubeVA;
+
+        static constexpr u32 MAX_LIGHTS = 1024;
+
+        UniquePtr<ClusteredLighting> m_clusteredLighting;
+        Vector<PointLight> m_lights;
+        i32 m_lightCount = 64;
+        b8 m_drawLightBounds = false;
+
+        Vector<math::simd::BenchmarkResult> m_simdBenchmarkResults;
+
+        UniquePtr<OcclusionCuller> m_occlusionCuller;
+
+        // The cubes hang from a root entity and every other one carries a spinning pivot with a moon.
+        // Cubes and moons are drawn instanced: the ones that pass culling are compacted into the front of
+        // their instance buffer range, and the draw only covers those
+        World m_scene;
+        TransformHierarchy m_sceneTransforms;
+        UniquePtr<InstanceBuffer> m_instanceBuffer;
+        Vector<u32> m_instanceOfNode; // Instance per hierarchy slot, NO_INSTANCE for nodes that aren't drawn
+        u32 m_firstSceneInstance = 0;
+        u32 m_sceneInstanceCount = 0;
+
+        static constexpr u32 NO_INSTANCE = 0xFFFFFFFF;
+
+        // Fixed step simulation clock. Render side time is interpolated between the last two steps
+        f64 m_simulationTime = 0.0;
+        f64 m_lastFixedDelta = 0.0;
+        u64 m_simulationSteps = 0;
+
+        // World matrices of the scene instances at the last two steps. Scene instances are numbered from
+        // 0; mesh instances and m_instanceOfNode are offset by m_firstSceneInstance.
+        // Moving instances are re-uploaded every frame with the new alpha; the rest only when they change
+        enum InstanceFlags : u8
+        {
+            INSTANCE_MOVING = 1 << 0,  // Changed in the last step, drawn interpolated
+            INSTANCE_PENDING = 1 << 1  // In m_pendingInstances
+        };
+
+        Vector<math::m4> m_previousInstanceWorlds;
+        Vector<math::m4> m_currentInstanceWorlds;
+        Vector<u8> m_instanceFlags;
+        Vector<u32> m_movingInstances;
+        Vector<u32> m_pendingInstances;
+
+        // Render side copy of the published world matrices, with a version bumped on every change. Each
+        // slot of the visible range remembers which instance and version it holds, so a frame where
+        // visibility and transforms didn't change uploads nothing
+        Vector<math::m4> m_renderInstanceWorlds;
+        Vector<u32> m_renderInstanceVersions;
+        Vector<u32> m_visibleSlotInstances;
+        Vector<u32> m_visibleSlotVersions;
+        u32 m_visibleSceneInstances = 0;
+
+        // Written by BuildRenderPacket(frame) and read by Render(frame), indexed by frame % 2
+        Array<RenderPacket, 2> m_renderPackets;
+        TransformHierarchy::Stats m_lastRenderedTransformStats;
 		
         static constexpr Array<f32, 180> vertices { 
             -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
@@ -1,5 +1,7 @@
 #include "Shader.hpp"
 
+#include "GLStateCache.hpp"
+
 #include "Core/Log.hpp"
 #include "FileSystem/FileSystem.hpp"
 
@@ -9,64 +11,158 @@
 
 namespace zn
 {
+	b8 Shader::s_parallelCompileSupported = false;
+
 	Shader::Shader(const c8* vertCode, const c8* fragCode)
 	{
-		GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertex, 1, &vertCode, nullptr);
-		glCompileShader(vertex);
-		CheckCompileErrors(vertex, "VERTEX");
+		m_vertexID = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(m_vertexID, 1, &vertCode, nullptr);
+		glCompileShader(m_vertexID);
 
-		GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragment, 1, &fragCode, nullptr);
-		glCompileShader(fragment);
-		CheckCompileErrors(fragment, "FRAGMENT");
+		m_fragmentID = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(m_fragmentID, 1, &fragCode, nullptr);
+		glCompileShader(m_fragmentID);
 
+		// Linking right away lets the driver chain the whole build on its own threads. Status
+		// queries are deferred to IsReady, querying here would wait for the compile to finish
 		m_rendererID = glCreateProgram();
-		glAttachShader(m_rendererID, vertex);
-		glAttachShader(m_rendererID, fragment);
+		glAttachShader(m_rendererID, m_vertexID);
+		glAttachShader(m_rendererID, m_fragmentID);
 		glLinkProgram(m_rendererID);
-		CheckCompileErrors(m_rendererID, "PROGRAM");
-
-		glDeleteShader(vertex);
-		glDeleteShader(fragment);
 	}
 
 	Shader::~Shader()
 	{
+		ReleaseStages();
+
 		if (m_rendererID)
 		{
 			glDeleteProgram(m_rendererID);
+			GLStateCache::OnProgramDeleted(m_rendererID);
 			m_rendererID = 0;
 		}
 	}
 
 	Shader::Shader(Shader&& other) noexcept
 	{
-		if (other.m_rendererID)
-		{
-			m_rendererID = other.m_rendererID;
-		}
+		m_rendererID = other.m_rendererID;
+		m_vertexID = other.m_vertexID;
+		m_fragmentID = other.m_fragmentID;
+		m_status = other.m_status;
 
 		other.m_rendererID = 0;
+		other.m_vertexID = 0;
+		other.m_fragmentID = 0;
 	}
 
 	Shader& Shader::operator=(Shader&& other) noexcept
 	{
 		if (this != &other)
 		{
+			ReleaseStages();
+
 			if (m_rendererID)
 			{
 				glDeleteProgram(m_rendererID);
-				m_rendererID = other.m_rendererID;
+				GLStateCache::OnProgramDeleted(m_rendererID);
 			}
 
+			m_rendererID = other.m_rendererID;
+			m_vertexID = other.m_vertexID;
+			m_fragmentID = other.m_fragmentID;
+			m_status = other.m_status;
+
 			other.m_rendererID = 0;
+			other.m_vertexID = 0;
+			other.m_fragmentID = 0;
 		}
 
 		return *this;
 	}
 
-	void Shader::CheckCompileErrors(u32 rendererId, const String& type)
+	void Shader::InitParallelCompile()
+	{
+		if (GLAD_GL_KHR_parallel_shader_compile)
+		{
+			// Let the driver pick the number of compiler threads
+			glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+			s_parallelCompileSupported = true;
+		}
+		else if (GLAD_GL_ARB_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+			s_parallelCompileSupported = true;
+		}
+
+		ZN_LOG_INFO(Renderer, "[Shader::InitParallelCompile] Parallel shader compilation {}", s_parallelCompileSupported ? "enabled" : "not supported");
+	}
+
+	b8 Shader::IsReady() const
+	{
+		if (m_status == Status::Pending)
+		{
+			if (s_parallelCompileSupported)
+			{
+				GLint completed = GL_FALSE;
+				glGetProgramiv(m_rendererID, GL_COMPLETION_STATUS_KHR, &completed);
+
+				if (!completed)
+				{
+					return false;
+				}
+			}
+
+			Finalize();
+		}
+
+		return m_status == Status::Ready;
+	}
+
+	void Shader::WaitUntilReady() const
+	{
+		if (m_status == Status::Pending)
+		{
+			Finalize();
+		}
+	}
+
+	void Shader::Finalize() const
+	{
+		const b8 vertexCompiled = CheckCompileErrors(m_vertexID, "VERTEX");
+		const b8 fragmentCompiled = CheckCompileErrors(m_fragmentID, "FRAGMENT");
+		const b8 linked = vertexCompiled && fragmentCompiled && CheckCompileErrors(m_rendererID, "PROGRAM");
+
+		m_status = linked ? Status::Ready : Status::Failed;
+
+		ReleaseStages();
+	}
+
+	void Shader::ReleaseStages() const
+	{
+		if (m_vertexID)
+		{
+			if (m_rendererID)
+			{
+				glDetachShader(m_rendererID, m_vertexID);
+			}
+
+			glDeleteShader(m_vertexID);
+			m_vertexID = 0;
+		}
+
+		if (m_fragmentID)
+		{
+			if (m_rendererID)
+			{
+				glDetachShader(m_rendererID, m_fragmentID);
+			}
+
+			glDeleteShader(m_fragmentID);
+			m_fragmentID = 0;
+		}
+	}
+
+	b8 Shader::CheckCompileErrors(u32 rendererId, const String& type)
 	{
 		GLint success;
 		GLchar infoLog[1024];
@@ -77,7 +173,7 @@ namespace zn
 			if (!success)
 			{
 				glGetShaderInfoLog(rendererId, 1024, nullptr, infoLog);
-				ZN_CORE_ERROR("ERROR::SHADER_COMPILATION_ERROR of type: " + type + "\n" + infoLog);
+				ZN_LOG_ERROR(Renderer, "ERROR::SHADER_COMPILATION_ERROR of type: " + type + "\n" + infoLog);
 			}
 		}
 		else
@@ -86,48 +182,50 @@ namespace zn
 			if (!success)
 			{
 				glGetProgramInfoLog(rendererId, 1024, nullptr, infoLog);
-				ZN_CORE_ERROR("ERROR::SHADER_LINKING_ERROR of type: " + type + "\n" + infoLog);
+				ZN_LOG_ERROR(Renderer, "ERROR::SHADER_LINKING_ERROR of type: " + type + "\n" + infoLog);
 			}
 		}
+
+		return success == GL_TRUE;
 	}
 
 	void Shader::Bind() const
 	{
-		glUseProgram(m_rendererID);
+		GLStateCache::UseProgram(m_rendererID);
 	}
 
 	void Shader::Unbind() const
 	{
-		glUseProgram(0);
+		GLStateCache::UseProgram(0);
 	}
 
-	void Shader::SetInt(const String& name, i32 value) const
+	void Shader::SetInt(const c8* name, i32 value) const
 	{
-		GLint location = glGetUniformLocation(m_rendererID, name.c_str());
+		GLint location = glGetUniformLocation(m_rendererID, name);
 		glUniform1i(location, value);
 	}
 
-	void Shader::SetFloat(const String& name, f32 value) const
+	void Shader::SetFloat(const c8* name, f32 value) const
 	{
-		GLint location = glGetUniformLocation(m_rendererID, name.c_str());
+		GLint location = glGetUniformLocation(m_rendererID, name);
 		glUniform1f(location, value);
 	}
 
-	void Shader::SetVec3(const String& name, const math::v3& value) const
+	void Shader::SetVec3(const c8* name, const math::v3& value) const
 	{
-		GLint location = glGetUniformLocation(m_rendererID, name.c_str());
+		GLint location = glGetUniformLocation(m_rendererID, name);
 		glUniform3fv(location, 1, glm::value_ptr(value));
 	}
 
-	void Shader::SetVec4(const String& name, const math::v4& value) const
+	void Shader::SetVec4(const c8* name, const math::v4& value) const
 	{
-		GLint location = glGetUniformLocation(m_rendererID, name.c_str());
+		GLint location = glGetUniformLocation(m_rendererID, name);
 		glUniform4fv(location, 1, glm::value_ptr(value));
 	}
 
-	void Shader::SetMat4(const String& name, const math::m4& value) const
+	void Shader::SetMat4(const c8* name, const math::m4& value) const
 	{
-		GLint location = glGetUniformLocation(m_rendererID, name.c_str());
+		GLint location = glGetUniformLocation(m_rendererID, name);
 		glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
 	}
 }
@@ -5,9 +5,19 @@
 
 namespace zn
 {
+	// GLSL program. Compilation and linking are only kicked off in the constructor: when the driver
+	// supports KHR_parallel_shader_compile they run on driver threads, and IsReady polls for
+	// completion without blocking. Without the extension IsReady finishes the compile synchronously.
 	class Shader 
 	{
 	public:
+		enum class Status : u8
+		{
+			Pending,
+			Ready,
+			Failed,
+		};
+
 		Shader(const c8* vertCode, const c8* fragCode);
 		~Shader();
 
@@ -17,18 +27,37 @@ namespace zn
 		Shader(Shader&& other) noexcept;
 		Shader& operator=(Shader&& other) noexcept;
 		
+		// Enables parallel compilation if available. Must be called once with a current context
+		static void InitParallelCompile();
+		[[nodiscard]] static b8 IsParallelCompileSupported() { return s_parallelCompileSupported; }
+
+		// Non-blocking when parallel compilation is supported
+		[[nodiscard]] b8 IsReady() const;
+		// Blocks until the program is linked
+		void WaitUntilReady() const;
+		[[nodiscard]] Status GetStatus() const { return m_status; }
+
 		void Bind() const;
 		void Unbind() const;
 
-		void SetInt(const String& name, i32 value) const;
-		void SetFloat(const String& name, f32 value) const;
-		void SetVec3(const String& name, const math::v3& value) const;
-		void SetVec4(const String& name, const math::v4& value) const;
-		void SetMat4(const String& name, const math::m4& value) const;
+		void SetInt(const c8* name, i32 value) const;
+		void SetFloat(const c8* name, f32 value) const;
+		void SetVec3(const c8* name, const math::v3& value) const;
+		void SetVec4(const c8* name, const math::v4& value) const;
+		void SetMat4(const c8* name, const math::m4& value) const;
 
 	private:
-		static void CheckCompileErrors(u32 rendererId, const String& type);
+		static b8 CheckCompileErrors(u32 rendererId, const String& type);
+		void Finalize() const;
+		void ReleaseStages() const;
 		
 		uint32_t m_rendererID;
+
+		// Stages are kept until the link result is known, so their compile logs can be reported
+		mutable u32 m_vertexID = 0;
+		mutable u32 m_fragmentID = 0;
+		mutable Status m_status = Status::Pending;
+
+		static b8 s_parallelCompileSupported;
 	};
 }
@@ -0,0 +1,198 @@
+#include "ShaderPreprocessor.hpp"
+
+#include "Core/Log.hpp"
+#include "FileSystem/FileSystem.hpp"
+
+#include <algorithm>
+
+namespace zn
+{
+	UMap<String, ShaderPreprocessor::Result> ShaderPreprocessor::s_processedCache;
+	UMap<String, String> ShaderPreprocessor::s_fileCache;
+
+	namespace
+	{
+		constexpr StringView INCLUDE_DIRECTIVE = "#include";
+		constexpr StringView KEYWORDS_DIRECTIVE = "#pragma keywords";
+
+		StringView TrimLeft(StringView line)
+		{
+			const uSize first = line.find_first_not_of(" \t");
+			return first == StringView::npos ? StringView{} : line.substr(first);
+		}
+	}
+
+	Opt<CRefWrapper<ShaderPreprocessor::Result>> ShaderPreprocessor::Process(const String& path)
+	{
+		if (auto it = s_processedCache.find(path); it != s_processedCache.end())
+		{
+			return std::cref(it->second);
+		}
+
+		Result result;
+		Vector<String> includeStack;
+
+		if (!Expand(path, result.Source, result.Keywords, includeStack))
+		{
+			return std::nullopt;
+		}
+
+		if (result.Keywords.size() > MAX_KEYWORDS)
+		{
+			ZN_LOG_ERROR(Renderer, "[ShaderPreprocessor::Process] {} declares {} keywords, the maximum is {}", path, result.Keywords.size(), MAX_KEYWORDS);
+			return std::nullopt;
+		}
+
+		auto [it, inserted] = s_processedCache.emplace(path, std::move(result));
+		return std::cref(it->second);
+	}
+
+	String ShaderPreprocessor::InjectKeywords(const String& source, const Vector<String>& keywords, u32 keywordMask)
+	{
+		String defines;
+		for (uSize i = 0; i < keywords.size(); ++i)
+		{
+			if (keywordMask & (1u << i))
+			{
+				defines += "#define " + keywords[i] + " 1\n";
+			}
+		}
+
+		if (defines.empty())
+		{
+			return source;
+		}
+
+		// #version must stay the first statement, so the defines go right after it
+		uSize insertPosition = 0;
+		u32 versionLine = 0;
+
+		if (const uSize versionPosition = source.find("#version"); versionPosition != String::npos)
+		{
+			const uSize lineEnd = source.find('\n', versionPosition);
+			insertPosition = lineEnd == String::npos ? source.size() : lineEnd + 1;
+			versionLine = static_cast<u32>(std::count(source.begin(), source.begin() + insertPosition, '\n'));
+		}
+
+		// Keeps compiler error line numbers matching the file
+		defines += "#line " + std::to_string(versionLine + 1) + "\n";
+
+		String result;
+		result.reserve(source.size() + defines.size() + 1);
+		result.append(source, 0, insertPosition);
+		if (insertPosition > 0 && result.back() != '\n')
+		{
+			result += '\n';
+		}
+		result += defines;
+		result.append(source, insertPosition, String::npos);
+
+		return result;
+	}
+
+	void ShaderPreprocessor::ClearCache()
+	{
+		s_processedCache.clear();
+		s_fileCache.clear();
+	}
+
+	b8 ShaderPreprocessor::Expand(const String& path, String& output, Vector<String>& keywords, Vector<String>& includeStack)
+	{
+		if (std::find(includeStack.begin(), includeStack.end(), path) != includeStack.end())
+		{
+			ZN_LOG_ERROR(Renderer, "[ShaderPreprocessor::Expand] Recursive include of {}", path);
+			return false;
+		}
+
+		auto source = ReadCached(path);
+		if (!source)
+		{
+			return false;
+		}
+
+		includeStack.push_back(path);
+
+		const StringView text = source.value().get();
+		u32 lineNumber = 0;
+		uSize lineStart = 0;
+
+		while (lineStart < text.size())
+		{
+			const uSize lineEnd = std::min(text.find('\n', lineStart), text.size());
+			const StringView line = text.substr(lineStart, lineEnd - lineStart);
+			const StringView trimmed = TrimLeft(line);
+
+			lineStart = lineEnd + 1;
+			++lineNumber;
+
+			if (trimmed.starts_with(INCLUDE_DIRECTIVE))
+			{
+				const uSize open = trimmed.find('"');
+				const uSize close = open == StringView::npos ? StringView::npos : trimmed.find('"', open + 1);
+
+				if (close == StringView::npos)
+				{
+					ZN_LOG_ERROR(Renderer, "[ShaderPreprocessor::Expand] Malformed #include in {}:{}", path, lineNumber);
+					includeStack.pop_back();
+					return false;
+				}
+
+				const FileSystem::Path includePath = FileSystem::Path(path).parent_path() / trimmed.substr(open + 1, close - open - 1);
+
+				output += "#line 1\n";
+				if (!Expand(includePath.lexically_normal().generic_string(), output, keywords, includeStack))
+				{
+					ZN_LOG_ERROR(Renderer, "[ShaderPreprocessor::Expand] Failed to include file from {}:{}", path, lineNumber);
+					includeStack.pop_back();
+					return false;
+				}
+				output += "\n#line " + std::to_string(lineNumber + 1) + "\n";
+				continue;
+			}
+
+			if (trimmed.starts_with(KEYWORDS_DIRECTIVE))
+			{
+				StringView names = trimmed.substr(KEYWORDS_DIRECTIVE.size());
+				while (!(names = TrimLeft(names)).empty())
+				{
+					const uSize nameEnd = std::min(names.find_first_of(" \t\r"), names.size());
+					String keyword(names.substr(0, nameEnd));
+					names = names.substr(nameEnd);
+
+					if (!keyword.empty() && std::find(keywords.begin(), keywords.end(), keyword) == keywords.end())
+					{
+						keywords.push_back(std::move(keyword));
+					}
+				}
+
+				// Keep an empty line so line numbers don't shift
+				output += '\n';
+				continue;
+			}
+
+			output.append(line);
+			output += '\n';
+		}
+
+		includeStack.pop_back();
+		return true;
+	}
+
+	Opt<CRefWrapper<String>> ShaderPreprocessor::ReadCached(const String& path)
+	{
+		if (auto it = s_fileCache.find(path); it != s_fileCache.end())
+		{
+			return std::cref(it->second);
+		}
+
+		auto source = FileSystem::ReadFileAsString(path);
+		if (!source)
+		{
+			ZN_LOG_WARN(Renderer, "[ShaderPreprocessor::ReadCached] Failed to read shader source {}", path);
+			return std::nullopt;
+		}
+
+		auto [it, inserted] = s_fileCache.emplace(path, std::move(source.value()));
+		return std::cref(it->second);
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+namespace zn
+{
+	// Expands engine specific directives in GLSL sources before they reach the driver:
+	//
+	//   #include "relative/path.glsl"   Inlined recursively, paths are relative to the including file
+	//   #pragma keywords A B C          Declares permutation keywords. Each one is a bit in a variant's
+	//                                   keyword mask, and enabled keywords become '#define <NAME> 1'
+	//
+	// Expanded sources are cached per path, and included files are only read from disk once.
+	class ShaderPreprocessor
+	{
+	public:
+		static constexpr u32 MAX_KEYWORDS = 32;
+
+		struct Result
+		{
+			String Source;
+			Vector<String> Keywords; // Declaration order, index = bit in the keyword mask
+		};
+
+		ShaderPreprocessor() = delete;
+
+		[[nodiscard]] static Opt<CRefWrapper<Result>> Process(const String& path);
+
+		// Adds a define for every keyword whose bit is set in the mask, right after the #version line
+		[[nodiscard]] static String InjectKeywords(const String& source, const Vector<String>& keywords, u32 keywordMask);
+
+		// Drops every cached file, so edited shaders are picked up by the next Process call
+		static void ClearCache();
+
+	private:
+		static b8 Expand(const String& path, String& output, Vector<String>& keywords, Vector<String>& includeStack);
+		static Opt<CRefWrapper<String>> ReadCached(const String& path);
+
+		static UMap<String, Result> s_processedCache;
+		static UMap<String, String> s_fileCache;
+	};
+}
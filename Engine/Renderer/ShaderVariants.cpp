@@ -0,0 +1,36 @@
+#include "ShaderVariants.hpp"
+
+#include "Core/Log.hpp"
+
+#include <algorithm>
+
+namespace zn
+{
+	ShaderVariants::ShaderVariants(String vertexSource, String fragmentSource, Vector<String> keywords)
+		: m_vertexSource(std::move(vertexSource)), m_fragmentSource(std::move(fragmentSource)), m_keywords(std::move(keywords))
+	{
+		const u64 vertexHash = std::hash<String>{}(m_vertexSource);
+		const u64 fragmentHash = std::hash<String>{}(m_fragmentSource);
+
+		m_sourceHash = vertexHash ^ (fragmentHash + 0x9E3779B97F4A7C15ull + (vertexHash << 6) + (vertexHash >> 2));
+	}
+
+	u32 ShaderVariants::GetKeywordMask(std::initializer_list<StringView> keywords) const
+	{
+		u32 mask = 0;
+
+		for (const StringView keyword : keywords)
+		{
+			auto it = std::find(m_keywords.begin(), m_keywords.end(), keyword);
+			if (it == m_keywords.end())
+			{
+				ZN_LOG_WARN_LIMITED(Renderer, "[ShaderVariants::GetKeywordMask] Keyword {} is not declared by the shader", keyword);
+				continue;
+			}
+
+			mask |= 1u << static_cast<u32>(it - m_keywords.begin());
+		}
+
+		return mask;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+#include <initializer_list>
+
+namespace zn
+{
+	// Identifies one compiled permutation of a shader
+	struct ShaderVariantKey
+	{
+		u64 SourceHash = 0;
+		u32 KeywordMask = 0;
+
+		b8 operator==(const ShaderVariantKey& other) const = default;
+	};
+
+	// Preprocessed vertex/fragment sources plus the keywords they declare. The compiled permutations
+	// are owned by the ResourceManager, which compiles each one the first time it is requested.
+	class ShaderVariants
+	{
+	public:
+		ShaderVariants(String vertexSource, String fragmentSource, Vector<String> keywords);
+
+		ShaderVariants(const ShaderVariants& other) = delete;
+		ShaderVariants& operator=(const ShaderVariants& other) = delete;
+
+		ShaderVariants(ShaderVariants&& other) noexcept = default;
+		ShaderVariants& operator=(ShaderVariants&& other) noexcept = default;
+
+		// Unknown keywords are reported and ignored
+		[[nodiscard]] u32 GetKeywordMask(std::initializer_list<StringView> keywords) const;
+
+		[[nodiscard]] ShaderVariantKey GetKey(u32 keywordMask) const { return { m_sourceHash, keywordMask }; }
+
+		[[nodiscard]] const String& GetVertexSource() const { return m_vertexSource; }
+		[[nodiscard]] const String& GetFragmentSource() const { return m_fragmentSource; }
+		[[nodiscard]] const Vector<String>& GetKeywords() const { return m_keywords; }
+		[[nodiscard]] u64 GetSourceHash() const { return m_sourceHash; }
+
+	private:
+		String m_vertexSource;
+		String m_fragmentSource;
+		Vector<String> m_keywords;
+		u64 m_sourceHash = 0;
+	};
+}
+
+template<>
+struct std::hash<zn::ShaderVariantKey>
+{
+	std::size_t operator()(const zn::ShaderVariantKey& key) const noexcept
+	{
+		return std::hash<zn::u64>{}(key.SourceHash ^ (static_cast<zn::u64>(key.KeywordMask) * 0x9E3779B97F4A7C15ull));
+	}
+};
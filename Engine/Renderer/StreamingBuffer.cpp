@@ -0,0 +1,148 @@
+#include "StreamingBuffer.hpp"
+
+#include "GLStateCache.hpp"
+
+#include "Core/Assert.hpp"
+#include "Core/Log.hpp"
+#include "Memory/MemoryTracker.hpp"
+
+namespace zn
+{
+	StreamingBuffer::StreamingBuffer(uSize regionSize, u32 regionCount)
+	{
+		ZN_ASSERT(regionSize > 0 && regionCount > 0, "StreamingBuffer needs at least one non-empty region");
+
+		m_regionSize = regionSize;
+		m_regionCount = regionCount;
+		// The first BeginFrame wraps it around to region 0
+		m_currentRegion = regionCount - 1;
+
+		m_fences.resize(m_regionCount, nullptr);
+
+		constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		const GLsizeiptr totalSize = static_cast<GLsizeiptr>(m_regionSize * m_regionCount);
+
+		glCreateBuffers(1, &m_rendererID);
+		glNamedBufferStorage(m_rendererID, totalSize, nullptr, flags | GL_DYNAMIC_STORAGE_BIT);
+		MemoryTracker::TrackAllocation(MemoryHeap::Gpu, MemoryTag::Renderer, m_regionSize * m_regionCount);
+
+		m_mappedData = static_cast<Byte*>(glMapNamedBufferRange(m_rendererID, 0, totalSize, flags));
+		if (!m_mappedData)
+		{
+			ZN_LOG_ERROR(Renderer, "[StreamingBuffer::StreamingBuffer] Failed to persistently map buffer of {} bytes", totalSize);
+		}
+	}
+
+	StreamingBuffer::~StreamingBuffer()
+	{
+		for (GLsync& fence : m_fences)
+		{
+			if (fence)
+			{
+				glDeleteSync(fence);
+				fence = nullptr;
+			}
+		}
+
+		if (m_rendererID)
+		{
+			if (m_mappedData)
+			{
+				glUnmapNamedBuffer(m_rendererID);
+				m_mappedData = nullptr;
+			}
+
+			glDeleteBuffers(1, &m_rendererID);
+			GLStateCache::OnBufferDeleted(m_rendererID);
+			m_rendererID = 0;
+
+			MemoryTracker::TrackFree(MemoryHeap::Gpu, MemoryTag::Renderer, m_regionSize * m_regionCount);
+		}
+	}
+
+	void StreamingBuffer::BeginFrame()
+	{
+		m_currentRegion = (m_currentRegion + 1) % m_regionCount;
+		m_head = 0;
+
+		WaitForRegion(m_currentRegion);
+	}
+
+	void StreamingBuffer::EndFrame()
+	{
+		GLsync& fence = m_fences[m_currentRegion];
+		if (fence)
+		{
+			glDeleteSync(fence);
+		}
+
+		fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	Opt<StreamingBuffer::Allocation> StreamingBuffer::Allocate(uSize size, uSize alignment)
+	{
+		ZN_ASSERT(alignment > 0, "Alignment must be greater than zero");
+
+		if (!m_mappedData || size == 0)
+		{
+			return std::nullopt;
+		}
+
+		const uSize regionStart = m_currentRegion * m_regionSize;
+
+		// Alignment is computed on the absolute buffer offset, as that's what GL sees (e.g. first vertex = Offset / stride)
+		uSize offset = regionStart + m_head;
+		offset = (offset + alignment - 1) / alignment * alignment;
+
+		if (offset + size > regionStart + m_regionSize)
+		{
+			ZN_LOG_WARN_LIMITED(Renderer, "[StreamingBuffer::Allocate] Region exhausted. Requested {} bytes, {} of {} already in use", size, m_head, m_regionSize);
+			return std::nullopt;
+		}
+
+		m_head = offset + size - regionStart;
+
+		return Allocation{ m_mappedData + offset, offset, size };
+	}
+
+	void StreamingBuffer::Bind() const
+	{
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_rendererID);
+	}
+
+	void StreamingBuffer::Unbind() const
+	{
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void StreamingBuffer::WaitForRegion(u32 region)
+	{
+		GLsync& fence = m_fences[region];
+		if (!fence)
+		{
+			return;
+		}
+
+		// Poll first so we can tell apart a free region from an actual stall
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED)
+		{
+			++m_stallCount;
+
+			constexpr GLuint64 timeoutNs = 1'000'000; // 1ms per try
+			do
+			{
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+			}
+			while (result == GL_TIMEOUT_EXPIRED);
+		}
+
+		if (result == GL_WAIT_FAILED)
+		{
+			ZN_LOG_ERROR(Renderer, "[StreamingBuffer::WaitForRegion] glClientWaitSync failed for region {}", region);
+		}
+
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+#include <glad/gl.h>
+
+namespace zn
+{
+	// Persistently mapped buffer for geometry that changes every frame (debug lines, particles, UI...).
+	// The storage is allocated once with glBufferStorage and kept mapped for the whole lifetime of the
+	// buffer. It is split into one region per frame in flight, and each region is guarded by a fence so
+	// the CPU never writes into memory the GPU may still be reading from.
+	class StreamingBuffer
+	{
+	public:
+		struct Allocation
+		{
+			void* Data = nullptr; // CPU write pointer. Writes are visible to the GPU without flushing (coherent mapping)
+			uSize Offset = 0;     // Offset in bytes from the start of the GL buffer
+			uSize Size = 0;
+		};
+
+		static constexpr u32 DEFAULT_FRAME_REGIONS = 3;
+
+		StreamingBuffer(uSize regionSize, u32 regionCount = DEFAULT_FRAME_REGIONS);
+		~StreamingBuffer();
+
+		StreamingBuffer(const StreamingBuffer& other) = delete;
+		StreamingBuffer(StreamingBuffer&& other) noexcept = delete;
+
+		StreamingBuffer& operator=(const StreamingBuffer& other) = delete;
+		StreamingBuffer& operator=(StreamingBuffer&& other) noexcept = delete;
+
+		// Moves to the next region and waits until the GPU is done with it
+		void BeginFrame();
+		// Places a fence after all the commands that read from the current region
+		void EndFrame();
+
+		// Bump allocates from the current region. Returns std::nullopt when the region is exhausted
+		[[nodiscard]]
+		Opt<Allocation> Allocate(uSize size, uSize alignment = 16);
+
+		void Bind() const;
+		void Unbind() const;
+
+		[[nodiscard]] b8 IsValid() const { return m_mappedData != nullptr; }
+		[[nodiscard]] u32 GetRendererID() const { return m_rendererID; }
+		[[nodiscard]] uSize GetRegionSize() const { return m_regionSize; }
+		[[nodiscard]] uSize GetUsedBytes() const { return m_head; }
+		[[nodiscard]] u32 GetStallCount() const { return m_stallCount; }
+
+	private:
+		void WaitForRegion(u32 region);
+
+		u32 m_rendererID = 0;
+		Byte* m_mappedData = nullptr;
+
+		uSize m_regionSize = 0;
+		u32 m_regionCount = 0;
+		u32 m_currentRegion = 0;
+		uSize m_head = 0;
+
+		Vector<GLsync> m_fences;
+
+		// Number of times BeginFrame had to block because the GPU was still using a region
+		u32 m_stallCount = 0;
+	};
+}
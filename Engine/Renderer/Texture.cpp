@@ -1,12 +1,37 @@
 #include "Texture.hpp"
 
+#include "GLStateCache.hpp"
+
 #include "FileSystem/FileSystem.hpp"
+#include "Memory/MemoryTracker.hpp"
 
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 
 namespace zn
 {
+	namespace
+	{
+		uSize GetStorageSize(u32 internalFormat, int width, int height, int channels)
+		{
+			uSize bytesPerPixel;
+			switch (internalFormat)
+			{
+				case GL_RGBA8:
+					bytesPerPixel = 4;
+					break;
+				case GL_RGB8:
+					bytesPerPixel = 3;
+					break;
+				default:
+					bytesPerPixel = static_cast<uSize>(channels);
+					break;
+			}
+
+			return static_cast<uSize>(width) * static_cast<uSize>(height) * bytesPerPixel;
+		}
+	}
+
 	Texture::Texture(
 		u8* data,
 		int width,
@@ -24,6 +49,7 @@ namespace zn
 
 		glCreateTextures(GL_TEXTURE_2D, 1, &m_rendererID);
 		glTextureStorage2D(m_rendererID, 1, m_internalFormat, m_width, m_height);
+		MemoryTracker::TrackAllocation(MemoryHeap::Gpu, MemoryTag::Resource, GetStorageSize(m_internalFormat, m_width, m_height, m_channels));
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -36,7 +62,13 @@ namespace zn
 
 	Texture::~Texture()
 	{
+		if (m_rendererID)
+		{
+			MemoryTracker::TrackFree(MemoryHeap::Gpu, MemoryTag::Resource, GetStorageSize(m_internalFormat, m_width, m_height, m_channels));
+		}
+
 		glDeleteTextures(1, &m_rendererID);
+		GLStateCache::OnTextureDeleted(m_rendererID);
 	}
 
 	Texture::Texture(Texture&& other) noexcept
@@ -58,7 +90,9 @@ namespace zn
 			// If initialized, release the texture from the GPU
 			if (m_rendererID)
 			{
+				MemoryTracker::TrackFree(MemoryHeap::Gpu, MemoryTag::Resource, GetStorageSize(m_internalFormat, m_width, m_height, m_channels));
 				glDeleteTextures(1, &m_rendererID);
+				GLStateCache::OnTextureDeleted(m_rendererID);
 			}
 			
 			m_width = other.m_width;
@@ -76,12 +110,12 @@ namespace zn
 
 	void Texture::Bind(uint32_t textureUnit) const
 	{
-		glBindTextureUnit(textureUnit, m_rendererID);
+		GLStateCache::BindTextureUnit(textureUnit, m_rendererID);
 	}
 
-	void Texture::Unbind() const
+	void Texture::Unbind(u32 textureUnit) const
 	{
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GLStateCache::BindTextureUnit(textureUnit, 0);
 	}
 }
 
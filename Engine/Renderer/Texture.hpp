@@ -23,7 +23,7 @@ namespace zn
 		Texture& operator=(Texture&& other) noexcept;
 
 		void Bind(u32 textureUnit = 0) const;
-		void Unbind() const;
+		void Unbind(u32 textureUnit = 0) const;
 		
 	private:
 		int m_width = 0;
@@ -1,5 +1,10 @@
 #include "VertexArray.hpp"
 
+#include "GLStateCache.hpp"
+#include "StreamingBuffer.hpp"
+
+#include "Memory/MemoryTracker.hpp"
+
 namespace zn
 {
 	VertexBuffer::VertexBuffer()
@@ -9,22 +14,29 @@ namespace zn
 
 	VertexBuffer::~VertexBuffer()
 	{
+		MemoryTracker::TrackFree(MemoryHeap::Gpu, MemoryTag::Renderer, m_size);
 		glDeleteBuffers(1, &m_rendererID);
+		GLStateCache::OnBufferDeleted(m_rendererID);
 	}
 
 	void VertexBuffer::SetData(const void* data, uSize size)
 	{
 		glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+
+		// Respecifying replaces the old store
+		MemoryTracker::TrackFree(MemoryHeap::Gpu, MemoryTag::Renderer, m_size);
+		m_size = size;
+		MemoryTracker::TrackAllocation(MemoryHeap::Gpu, MemoryTag::Renderer, m_size);
 	}
 
 	void VertexBuffer::Bind() const
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, m_rendererID);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_rendererID);
 	}
 
 	void VertexBuffer::Unbind() const
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
 	IndexBuffer::IndexBuffer()
@@ -34,22 +46,28 @@ namespace zn
 
 	IndexBuffer::~IndexBuffer()
 	{
+		MemoryTracker::TrackFree(MemoryHeap::Gpu, MemoryTag::Renderer, m_size);
 		glDeleteBuffers(1, &m_rendererID);
+		GLStateCache::OnBufferDeleted(m_rendererID);
 	}
 
 	void IndexBuffer::SetData(const unsigned int* indices, uSize count)
 	{
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+
+		MemoryTracker::TrackFree(MemoryHeap::Gpu, MemoryTag::Renderer, m_size);
+		m_size = count * sizeof(unsigned int);
+		MemoryTracker::TrackAllocation(MemoryHeap::Gpu, MemoryTag::Renderer, m_size);
 	}
 
 	void IndexBuffer::Bind() const
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_rendererID);
+		GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_rendererID);
 	}
 
 	void IndexBuffer::Unbind() const
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
 
 	VertexArray::VertexArray()
@@ -60,6 +78,7 @@ namespace zn
 	VertexArray::~VertexArray()
 	{
 		glDeleteVertexArrays(1, &m_rendererID);
+		GLStateCache::OnVertexArrayDeleted(m_rendererID);
 	}
 
 	void VertexArray::AddVertexBuffer(const VertexBuffer& vertexBuffer, const VertexBufferLayout& layout)
@@ -67,6 +86,21 @@ namespace zn
 		Bind();
 		vertexBuffer.Bind();
 
+		SetupAttributes(layout);
+	}
+
+	void VertexArray::AddVertexBuffer(const StreamingBuffer& streamingBuffer, const VertexBufferLayout& layout)
+	{
+		Bind();
+		streamingBuffer.Bind();
+
+		// Attributes start at offset 0 of the whole buffer. Draws select the per-frame
+		// data through the first vertex, i.e. Allocation::Offset / layout stride
+		SetupAttributes(layout);
+	}
+
+	void VertexArray::SetupAttributes(const VertexBufferLayout& layout)
+	{
 		const Vector<VertexBufferLayout::VertexBufferElement>& elements = layout.GetElements();
 		uSize offset = 0;
 
@@ -83,11 +117,11 @@ namespace zn
 
 	void VertexArray::Bind() const
 	{
-		glBindVertexArray(m_rendererID);
+		GLStateCache::BindVertexArray(m_rendererID);
 	}
 
 	void VertexArray::Unbind() const
 	{
-		glBindVertexArray(0);
+		GLStateCache::BindVertexArray(0);
 	}
 }
\ No newline at end of file
@@ -8,6 +8,8 @@
 
 namespace zn
 {
+	class StreamingBuffer;
+
 	class VertexBuffer
 	{
 	public:
@@ -27,6 +29,7 @@ namespace zn
 
 	private:
 		u32 m_rendererID;
+		uSize m_size = 0;
 	};
 
 	class IndexBuffer
@@ -50,6 +53,7 @@ namespace zn
 	private:
 		u32 m_rendererID;
 		uSize m_count;
+		uSize m_size = 0;
 	};
 
 	class VertexBufferLayout
@@ -130,8 +134,11 @@ namespace zn
 		void Unbind() const;
 
 		void AddVertexBuffer(const VertexBuffer& vertexBuffer, const VertexBufferLayout& layout);
+		void AddVertexBuffer(const StreamingBuffer& streamingBuffer, const VertexBufferLayout& layout);
 
 	private:
+		void SetupAttributes(const VertexBufferLayout& layout);
+
 		u32 m_rendererID;
 	};
 }
\ No newline at end of file
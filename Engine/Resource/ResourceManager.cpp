@@ -1,48 +1,58 @@
 #include "ResourceManager.hpp"
 
 #include "Core/Base.hpp"
+#include "Core/JobSystem.hpp"
 #include "Core/Log.hpp"
 #include "FileSystem/FileSystem.hpp"
+#include "Memory/MemoryTracker.hpp"
+#include "Renderer/ShaderPreprocessor.hpp"
 
 #include "glad/gl.h"
 
+#include <algorithm>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 namespace zn
 {
     ResourceRegistry<Shader> ResourceManager::s_shadersRegistry;
+    ResourceRegistry<ShaderVariants> ResourceManager::s_shaderVariantsRegistry;
+    UMap<ShaderVariantKey, Handle<Shader>> ResourceManager::s_shaderVariantCache;
+    ResourceRegistry<Material> ResourceManager::s_materialRegistry;
     ResourceRegistry<Texture> ResourceManager::s_textureRegistry;
     
     Opt<Handle<Shader>> ResourceManager::LoadShader(const String& vertPath, const String& fragPath)
     {
+        MemoryTagScope memoryTag(MemoryTag::Resource);
+
         if (!FileSystem::Exists(vertPath))
         {
-            ZN_CORE_WARN("[ResourceManager::LoadShader] Failed to load Shader. File {} does not exist", vertPath);
+            ZN_LOG_WARN(Resource, "[ResourceManager::LoadShader] Failed to load Shader. File {} does not exist", vertPath);
             return std::nullopt;
         }
 
         if (!FileSystem::Exists(fragPath))
         {
-            ZN_CORE_WARN("[ResourceManager::LoadShader] Failed to load Shader. File {} does not exist", fragPath);
+            ZN_LOG_WARN(Resource, "[ResourceManager::LoadShader] Failed to load Shader. File {} does not exist", fragPath);
             return std::nullopt;
         }
 		
-        auto vertexCode = FileSystem::ReadFileAsString(vertPath);
+        auto vertexCode = ShaderPreprocessor::Process(vertPath);
         if (!vertexCode)
         {
-            ZN_CORE_WARN("[ResourceManager::LoadShader] Failed to load Shader. Failed to read vertex shader code from {}", vertPath);
+            ZN_LOG_WARN(Resource, "[ResourceManager::LoadShader] Failed to load Shader. Failed to preprocess vertex shader code from {}", vertPath);
             return std::nullopt;
         }
 
-        auto fragmentCode = FileSystem::ReadFileAsString(fragPath);
+        auto fragmentCode = ShaderPreprocessor::Process(fragPath);
         if (!fragmentCode)
         {
-            ZN_CORE_WARN("[ResourceManager::LoadShader] Failed to load Shader. Failed to read fragment shader code from {}", fragPath);
+            ZN_LOG_WARN(Resource, "[ResourceManager::LoadShader] Failed to load Shader. Failed to preprocess fragment shader code from {}", fragPath);
             return std::nullopt;
         }
 
-        auto handle = s_shadersRegistry.EmplaceResource(vertexCode.value().c_str(), fragmentCode.value().c_str());
+        auto handle = s_shadersRegistry.EmplaceResource(vertexCode.value().get().Source.c_str(), fragmentCode.value().get().Source.c_str());
         if (!handle.has_value())
         {
             return std::nullopt;
@@ -58,7 +68,7 @@ namespace zn
             return shader;
         }
 
-        ZN_CORE_WARN("[ResourceManager::GetShader] Failed to retrieve Shader. The provided Shader handle (Id: {}, Gen: {}) is not valid", handle.GetIndex(), handle.GetGeneration());
+        ZN_LOG_WARN_LIMITED(Resource, "[ResourceManager::GetShader] Failed to retrieve Shader. The provided Shader handle (Id: {}, Gen: {}) is not valid", handle.GetIndex(), handle.GetGeneration());
         
         return std::nullopt;
     }
@@ -68,47 +78,200 @@ namespace zn
         return s_shadersRegistry.ReleaseResource(handle);
     }
 
-    Opt<Handle<Texture>> ResourceManager::LoadTexture(const String& path)
+    Opt<Handle<ShaderVariants>> ResourceManager::LoadShaderVariants(const String& vertPath, const String& fragPath)
     {
-        if (!FileSystem::Exists(path))
+        MemoryTagScope memoryTag(MemoryTag::Resource);
+
+        auto vertex = ShaderPreprocessor::Process(vertPath);
+        if (!vertex)
         {
-            ZN_CORE_WARN("[ResourceManager::LoadTexture] Failed to load Texture resource. File {} does not exist", path);
+            ZN_LOG_WARN(Resource, "[ResourceManager::LoadShaderVariants] Failed to load Shader variants. Failed to preprocess vertex shader code from {}", vertPath);
             return std::nullopt;
         }
-        
-        FileSystem::Path fullPath = FileSystem::GetFullPath(path).value();
+
+        auto fragment = ShaderPreprocessor::Process(fragPath);
+        if (!fragment)
+        {
+            ZN_LOG_WARN(Resource, "[ResourceManager::LoadShaderVariants] Failed to load Shader variants. Failed to preprocess fragment shader code from {}", fragPath);
+            return std::nullopt;
+        }
+
+        // Both stages share one keyword mask, so their keyword lists are merged
+        Vector<String> keywords = vertex.value().get().Keywords;
+        for (const String& keyword : fragment.value().get().Keywords)
+        {
+            if (std::find(keywords.begin(), keywords.end(), keyword) == keywords.end())
+            {
+                keywords.push_back(keyword);
+            }
+        }
+
+        if (keywords.size() > ShaderPreprocessor::MAX_KEYWORDS)
+        {
+            ZN_LOG_WARN(Resource, "[ResourceManager::LoadShaderVariants] Failed to load Shader variants. {} and {} declare more than {} keywords", vertPath, fragPath, ShaderPreprocessor::MAX_KEYWORDS);
+            return std::nullopt;
+        }
+
+        return s_shaderVariantsRegistry.EmplaceResource(vertex.value().get().Source, fragment.value().get().Source, std::move(keywords));
+    }
+
+    Opt<CRefWrapper<ShaderVariants>> ResourceManager::GetShaderVariants(Handle<ShaderVariants> handle)
+    {
+        if (Opt<CRefWrapper<ShaderVariants>> variants = s_shaderVariantsRegistry.GetResourceRef(handle))
+        {
+            return variants;
+        }
+
+        ZN_LOG_WARN_LIMITED(Resource, "[ResourceManager::GetShaderVariants] Failed to retrieve Shader variants. The provided handle (Id: {}, Gen: {}) is not valid", handle.GetIndex(), handle.GetGeneration());
+
+        return std::nullopt;
+    }
+
+    Opt<CRefWrapper<Shader>> ResourceManager::GetShaderVariant(Handle<ShaderVariants> handle, u32 keywordMask)
+    {
+        auto variants = GetShaderVariants(handle);
+        if (!variants)
+        {
+            return std::nullopt;
+        }
+
+        const ShaderVariants& shaderVariants = variants.value().get();
+        const ShaderVariantKey key = shaderVariants.GetKey(keywordMask);
+
+        if (auto it = s_shaderVariantCache.find(key); it != s_shaderVariantCache.end())
+        {
+            return s_shadersRegistry.GetResourceRef(it->second);
+        }
+
+        const Vector<String>& keywords = shaderVariants.GetKeywords();
+        const String vertexCode = ShaderPreprocessor::InjectKeywords(shaderVariants.GetVertexSource(), keywords, keywordMask);
+        const String fragmentCode = ShaderPreprocessor::InjectKeywords(shaderVariants.GetFragmentSource(), keywords, keywordMask);
+
+        auto shaderHandle = s_shadersRegistry.EmplaceResource(vertexCode.c_str(), fragmentCode.c_str());
+        if (!shaderHandle)
+        {
+            ZN_LOG_WARN(Resource, "[ResourceManager::GetShaderVariant] Failed to compile variant with keyword mask {:#x}", keywordMask);
+            return std::nullopt;
+        }
+
+        s_shaderVariantCache.emplace(key, shaderHandle.value());
+
+        return s_shadersRegistry.GetResourceRef(shaderHandle.value());
+    }
+
+    Opt<Handle<Material>> ResourceManager::CreateMaterial(Handle<ShaderVariants> shader, u32 keywordMask, const Vector<MaterialParameter>& parameters)
+    {
+        MemoryTagScope memoryTag(MemoryTag::Resource);
+
+        if (!s_shaderVariantsRegistry.GetResourceRef(shader))
+        {
+            ZN_LOG_WARN(Resource, "[ResourceManager::CreateMaterial] Failed to create Material. The provided Shader variants handle (Id: {}, Gen: {}) is not valid", shader.GetIndex(), shader.GetGeneration());
+            return std::nullopt;
+        }
+
+        return s_materialRegistry.EmplaceResource(shader, keywordMask, parameters);
+    }
+
+    Opt<CRefWrapper<Material>> ResourceManager::GetMaterial(Handle<Material> handle)
+    {
+        if (Opt<CRefWrapper<Material>> material = s_materialRegistry.GetResourceRef(handle))
+        {
+            return material;
+        }
+
+        ZN_LOG_WARN_LIMITED(Resource, "[ResourceManager::GetMaterial] Failed to retrieve Material. The provided Material handle (Id: {}, Gen: {}) is not valid", handle.GetIndex(), handle.GetGeneration());
+
+        return std::nullopt;
+    }
+
+    b8 ResourceManager::ModifyMaterial(Handle<Material> handle, const Func<void(Material&)>& modifyFunc)
+    {
+        return s_materialRegistry.ModifyResource(handle, modifyFunc);
+    }
+
+    bool ResourceManager::ReleaseMaterial(Handle<Material> handle)
+    {
+        return s_materialRegistry.ReleaseResource(handle);
+    }
+
+    Opt<Handle<Texture>> ResourceManager::LoadTexture(const String& path)
+    {
+        return LoadTextures({ path }).front();
+    }
+
+    Vector<Opt<Handle<Texture>>> ResourceManager::LoadTextures(const Vector<String>& paths)
+    {
+        MemoryTagScope memoryTag(MemoryTag::Resource);
+
+        struct DecodedImage
+        {
+            String FullPath;
+            stbi_uc* Data = nullptr;
+            int Width = 0;
+            int Height = 0;
+            int Channels = 0;
+        };
+
+        Vector<DecodedImage> images(paths.size());
+        for (uSize i = 0; i < paths.size(); ++i)
+        {
+            if (!FileSystem::Exists(paths[i]))
+            {
+                ZN_LOG_WARN(Resource, "[ResourceManager::LoadTextures] Failed to load Texture resource. File {} does not exist", paths[i]);
+                continue;
+            }
+
+            images[i].FullPath = FileSystem::GetFullPath(paths[i]).value().string();
+        }
 
         stbi_set_flip_vertically_on_load(1);
 
-        int width, height, channels;
+        // Decoding doesn't touch GL, only creating the textures has to happen on this thread
+        JobSystem::ParallelFor(static_cast<u32>(images.size()), 1, [&images](u32 begin, u32 end)
+        {
+            for (u32 i = begin; i < end; ++i)
+            {
+                DecodedImage& image = images[i];
+                if (!image.FullPath.empty())
+                {
+                    image.Data = stbi_load(image.FullPath.c_str(), &image.Width, &image.Height, &image.Channels, 0);
+                }
+            }
+        });
 
-        stbi_uc* data = stbi_load(fullPath.string().c_str(), &width, &height, &channels, 0);
-        if (data)
+        Vector<Opt<Handle<Texture>>> handles(paths.size());
+        for (uSize i = 0; i < images.size(); ++i)
         {
+            DecodedImage& image = images[i];
+            if (image.FullPath.empty())
+                continue;
+
+            if (!image.Data)
+            {
+                ZN_LOG_WARN(Resource, "[ResourceManager::LoadTextures] Failed to load Texture resource. Library (stbi) failed to load texture: {}", paths[i]);
+                continue;
+            }
+
             unsigned int dataFormat;
             unsigned int internalFormat;
             
-            if (channels == 4)
+            if (image.Channels == 4)
             {
                 internalFormat = GL_RGBA8;
                 dataFormat = GL_RGBA;
             }
-            else if (channels == 3)
+            else if (image.Channels == 3)
             {
                 internalFormat = GL_RGB8;
                 dataFormat = GL_RGB;
             }
             
-            auto handle = s_textureRegistry.EmplaceResource(data, width, height, channels, internalFormat, dataFormat);
+            handles[i] = s_textureRegistry.EmplaceResource(image.Data, image.Width, image.Height, image.Channels, internalFormat, dataFormat);
 
-            stbi_image_free(data);
-
-            return handle;
+            stbi_image_free(image.Data);
         }
-        
-        ZN_CORE_WARN("[ResourceManager::LoadTexture] Failed to load Texture resource. Library (stbi) failed to load texture: {}", path);
-        
-        return std::nullopt;
+
+        return handles;
     }
 
     Opt<CRefWrapper<Texture>> ResourceManager::GetTexture(Handle<Texture> handle)
@@ -118,7 +281,7 @@ namespace zn
             return texture;
         }
 
-        ZN_CORE_WARN("[ResourceManager::GetTexture] Failed to retrieve Texture. The provided Texture handle (Id: {}, Gen: {}) is not valid", handle.GetIndex(), handle.GetGeneration());
+        ZN_LOG_WARN_LIMITED(Resource, "[ResourceManager::GetTexture] Failed to retrieve Texture. The provided Texture handle (Id: {}, Gen: {}) is not valid", handle.GetIndex(), handle.GetGeneration());
         
         return std::nullopt;
     }
@@ -3,7 +3,9 @@
 #include "Core/Base.hpp"
 #include "Core/Log.hpp"
 #include "Resource/ResourceRegistry.hpp"
+#include "Renderer/Material.hpp"
 #include "Renderer/Shader.hpp"
+#include "Renderer/ShaderVariants.hpp"
 #include "Renderer/Texture.hpp"
 
 namespace zn
@@ -23,7 +25,20 @@ namespace zn
         [[nodiscard]] static Opt<CRefWrapper<Shader>> GetShader(Handle<Shader> handle);
         [[nodiscard]] static bool ReleaseShader(Handle<Shader> handle);
 
+        // Loads sources declaring '#pragma keywords'. Permutations are compiled lazily by GetShaderVariant
+        [[nodiscard]] static Opt<Handle<ShaderVariants>> LoadShaderVariants(const String& vertPath, const String& fragPath);
+        [[nodiscard]] static Opt<CRefWrapper<ShaderVariants>> GetShaderVariants(Handle<ShaderVariants> handle);
+        [[nodiscard]] static Opt<CRefWrapper<Shader>> GetShaderVariant(Handle<ShaderVariants> handle, u32 keywordMask);
+
+        [[nodiscard]] static Opt<Handle<Material>> CreateMaterial(Handle<ShaderVariants> shader, u32 keywordMask, const Vector<MaterialParameter>& parameters);
+        [[nodiscard]] static Opt<CRefWrapper<Material>> GetMaterial(Handle<Material> handle);
+        static b8 ModifyMaterial(Handle<Material> handle, const Func<void(Material&)>& modifyFunc);
+        [[nodiscard]] static bool ReleaseMaterial(Handle<Material> handle);
+
         [[nodiscard]] static Opt<Handle<Texture>> LoadTexture(const String& path);
+        // Decodes the files in parallel on the job system, then creates the textures on the calling thread.
+        // One entry per path, std::nullopt for the ones that failed
+        [[nodiscard]] static Vector<Opt<Handle<Texture>>> LoadTextures(const Vector<String>& paths);
         [[nodiscard]] static Opt<CRefWrapper<Texture>> GetTexture(Handle<Texture> handle);
         [[nodiscard]] static bool ReleaseTexture(Handle<Texture> handle);
 
@@ -33,6 +48,10 @@ namespace zn
         ResourceManager() = default;
 
         static ResourceRegistry<Shader> s_shadersRegistry;
+        static ResourceRegistry<ShaderVariants> s_shaderVariantsRegistry;
+        // Compiled permutations, shared by every ShaderVariants built from the same sources
+        static UMap<ShaderVariantKey, Handle<Shader>> s_shaderVariantCache;
+        static ResourceRegistry<Material> s_materialRegistry;
         static ResourceRegistry<Texture> s_textureRegistry;
     };
 }
@@ -0,0 +1,170 @@
+#include "Archetype.hpp"
+
+#include "Core/Assert.hpp"
+
+#include <algorithm>
+
+namespace zn
+{
+    namespace
+    {
+        u32 AlignUp(u32 value, u32 alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    Archetype::Archetype(ComponentMask mask)
+        : m_mask(mask)
+    {
+        for (ComponentId id = 0; id < MAX_COMPONENT_TYPES; ++id)
+        {
+            if (Has(id))
+            {
+                m_components.push_back(id);
+            }
+        }
+
+        // Widest alignment first, so columns need as little padding as possible
+        std::stable_sort(m_components.begin(), m_components.end(), [](ComponentId lhs, ComponentId rhs)
+        {
+            return ComponentRegistry::GetInfo(lhs).Alignment > ComponentRegistry::GetInfo(rhs).Alignment;
+        });
+
+        m_columnOffsets.fill(NO_COLUMN);
+        ComputeLayout();
+    }
+
+    Archetype::~Archetype()
+    {
+        for (u32 chunk = 0; chunk < m_chunks.size(); ++chunk)
+        {
+            for (ComponentId id : m_components)
+            {
+                const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+                Byte* column = static_cast<Byte*>(GetColumn(chunk, id));
+
+                for (u32 row = 0; row < m_chunks[chunk]->Count; ++row)
+                {
+                    info.Destroy(column + row * info.Size);
+                }
+            }
+        }
+    }
+
+    void Archetype::ComputeLayout()
+    {
+        u32 rowSize = sizeof(Entity);
+        for (ComponentId id : m_components)
+        {
+            const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+            ZN_ASSERT(info.Alignment <= CHUNK_ALIGNMENT, "Component alignment is larger than the chunk alignment");
+            rowSize += info.Size;
+        }
+
+        ZN_ASSERT(rowSize <= CHUNK_SIZE, "Components of an archetype don't fit in a chunk");
+
+        // Padding between columns can push the estimate over the chunk size, shrink until it fits
+        for (u32 capacity = CHUNK_SIZE / rowSize; capacity > 0; --capacity)
+        {
+            u32 offset = AlignUp(capacity * static_cast<u32>(sizeof(Entity)), CHUNK_ALIGNMENT);
+            b8 fits = true;
+
+            for (ComponentId id : m_components)
+            {
+                const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+                offset = AlignUp(offset, info.Alignment);
+                m_columnOffsets[id] = offset;
+                offset += capacity * info.Size;
+
+                if (offset > CHUNK_SIZE)
+                {
+                    fits = false;
+                    break;
+                }
+            }
+
+            if (fits)
+            {
+                m_chunkCapacity = capacity;
+                return;
+            }
+        }
+
+        ZN_ASSERT(false, "Components of an archetype don't fit in a chunk");
+    }
+
+    Archetype::Location Archetype::PushUninitialized(Entity entity)
+    {
+        if (m_chunks.empty() || m_chunks.back()->Count == m_chunkCapacity)
+        {
+            if (m_spareChunk)
+            {
+                m_chunks.push_back(std::move(m_spareChunk));
+            }
+            else
+            {
+                // Not CreateUnique, the chunk bytes don't need zeroing
+                m_chunks.push_back(UniquePtr<Chunk>(new Chunk));
+            }
+        }
+
+        const u32 chunk = static_cast<u32>(m_chunks.size() - 1);
+        const u32 row = m_chunks[chunk]->Count++;
+
+        GetEntities(chunk)[row] = entity;
+        ++m_entityCount;
+
+        return Location{ chunk, row };
+    }
+
+    Opt<Entity> Archetype::Remove(Location location)
+    {
+        ZN_ASSERT(location.Chunk < m_chunks.size() && location.Row < m_chunks[location.Chunk]->Count, "Invalid archetype location");
+
+        const u32 lastChunk = static_cast<u32>(m_chunks.size() - 1);
+        const u32 lastRow = m_chunks[lastChunk]->Count - 1;
+        const b8 isLast = location.Chunk == lastChunk && location.Row == lastRow;
+
+        for (ComponentId id : m_components)
+        {
+            const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+            void* removed = GetComponent(location, id);
+            info.Destroy(removed);
+
+            if (!isLast)
+            {
+                void* last = GetComponent(Location{ lastChunk, lastRow }, id);
+                info.MoveConstruct(removed, last);
+                info.Destroy(last);
+            }
+        }
+
+        Opt<Entity> moved;
+        if (!isLast)
+        {
+            moved = GetEntities(lastChunk)[lastRow];
+            GetEntities(location.Chunk)[location.Row] = moved.value();
+        }
+
+        --m_entityCount;
+
+        // Only the last chunk is ever partially filled. An emptied one is kept aside, so an entity bouncing
+        // across a chunk boundary doesn't allocate every time
+        if (--m_chunks[lastChunk]->Count == 0 && m_chunks.size() > 1)
+        {
+            m_spareChunk = std::move(m_chunks.back());
+            m_chunks.pop_back();
+        }
+
+        return moved;
+    }
+
+    void* Archetype::GetComponent(Location location, ComponentId id)
+    {
+        ZN_ASSERT(Has(id), "The archetype doesn't have the component");
+
+        const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+        return static_cast<Byte*>(GetColumn(location.Chunk, id)) + location.Row * info.Size;
+    }
+}
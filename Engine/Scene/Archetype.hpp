@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Scene/Component.hpp"
+
+namespace zn
+{
+    // All entities with exactly the same set of components. Rows are packed into fixed size chunks
+    // with one contiguous column per component, so iterating a component touches consecutive memory
+    // and never follows a pointer per entity. Removing a row moves the last row into the hole, which
+    // keeps the chunks dense but means rows don't have stable positions.
+    class Archetype
+    {
+    public:
+        static constexpr u32 CHUNK_SIZE = 16 * 1024;
+        static constexpr u32 CHUNK_ALIGNMENT = 64;
+
+        struct Location
+        {
+            u32 Chunk = 0;
+            u32 Row = 0;
+        };
+
+        explicit Archetype(ComponentMask mask);
+        ~Archetype();
+
+        Archetype(const Archetype& other) = delete;
+        Archetype(Archetype&& other) noexcept = delete;
+
+        Archetype& operator=(const Archetype& other) = delete;
+        Archetype& operator=(Archetype&& other) noexcept = delete;
+
+        // Appends a row for the entity. Its components are left unconstructed, the caller constructs
+        // every one of them (see World)
+        [[nodiscard]] Location PushUninitialized(Entity entity);
+
+        // Destroys the components of the row and moves the last row into it. Returns the entity that
+        // was moved, whose location is now the removed one
+        Opt<Entity> Remove(Location location);
+
+        [[nodiscard]] ComponentMask GetMask() const { return m_mask; }
+        [[nodiscard]] const Vector<ComponentId>& GetComponents() const { return m_components; }
+        [[nodiscard]] b8 Has(ComponentId id) const { return (m_mask & (ComponentMask{1} << id)) != 0; }
+
+        [[nodiscard]] u32 GetChunkCapacity() const { return m_chunkCapacity; }
+        [[nodiscard]] u32 GetChunkCount() const { return static_cast<u32>(m_chunks.size()); }
+        [[nodiscard]] u32 GetEntityCount() const { return m_entityCount; }
+        [[nodiscard]] u32 GetRowCount(u32 chunk) const { return m_chunks[chunk]->Count; }
+
+        [[nodiscard]] Entity* GetEntities(u32 chunk) { return reinterpret_cast<Entity*>(m_chunks[chunk]->Data); }
+        [[nodiscard]] void* GetColumn(u32 chunk, ComponentId id) { return m_chunks[chunk]->Data + m_columnOffsets[id]; }
+        [[nodiscard]] void* GetComponent(Location location, ComponentId id);
+
+        template<Component T>
+        [[nodiscard]] T* GetColumn(u32 chunk) { return static_cast<T*>(GetColumn(chunk, ComponentRegistry::GetId<T>())); }
+
+    private:
+        struct alignas(CHUNK_ALIGNMENT) Chunk
+        {
+            Byte Data[CHUNK_SIZE];
+            u32 Count = 0;
+        };
+
+        static constexpr u32 NO_COLUMN = 0xFFFFFFFF;
+
+        // Largest row count whose columns fit in a chunk, filling m_columnOffsets for it
+        void ComputeLayout();
+
+        ComponentMask m_mask = 0;
+        Vector<ComponentId> m_components;
+        Array<u32, MAX_COMPONENT_TYPES> m_columnOffsets{};
+        u32 m_chunkCapacity = 0;
+
+        Vector<UniquePtr<Chunk>> m_chunks;
+        UniquePtr<Chunk> m_spareChunk;
+        u32 m_entityCount = 0;
+    };
+}
@@ -0,0 +1,25 @@
+#include "CommandBuffer.hpp"
+
+namespace zn
+{
+    void CommandBuffer::DestroyEntity(Entity entity)
+    {
+        m_commands.push_back([entity](World& world)
+        {
+            if (world.IsAlive(entity))
+            {
+                world.DestroyEntity(entity);
+            }
+        });
+    }
+
+    void CommandBuffer::Playback()
+    {
+        for (const Func<void(World&)>& command : m_commands)
+        {
+            command(m_world);
+        }
+
+        m_commands.clear();
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Scene/World.hpp"
+
+namespace zn
+{
+    // Structural changes recorded while a View is being iterated and applied in order by Playback.
+    // Commands targeting an entity that is gone by then are skipped
+    class CommandBuffer
+    {
+    public:
+        explicit CommandBuffer(World& world) : m_world(world) {}
+        ~CommandBuffer() = default;
+
+        CommandBuffer(const CommandBuffer& other) = delete;
+        CommandBuffer(CommandBuffer&& other) noexcept = delete;
+
+        CommandBuffer& operator=(const CommandBuffer& other) = delete;
+        CommandBuffer& operator=(CommandBuffer&& other) noexcept = delete;
+
+        // Not deferred: an entity without components isn't a structural change, and the returned
+        // entity can be used by the commands recorded after it
+        [[nodiscard]] Entity CreateEntity() { return m_world.CreateEntity(); }
+
+        void DestroyEntity(Entity entity);
+
+        // The component is copied into the command, Func only holds copyable callables
+        template<Component T>
+        requires std::is_copy_constructible_v<T>
+        void AddComponent(Entity entity, const T& component)
+        {
+            m_commands.push_back([entity, component](World& world)
+            {
+                if (world.IsAlive(entity))
+                {
+                    world.AddComponent<T>(entity, component);
+                }
+            });
+        }
+
+        template<Component T>
+        void RemoveComponent(Entity entity)
+        {
+            m_commands.push_back([entity](World& world)
+            {
+                world.RemoveComponent<T>(entity);
+            });
+        }
+
+        // Applies and clears the recorded commands. Must not be called while iterating a view
+        void Playback();
+
+        [[nodiscard]] b8 IsEmpty() const { return m_commands.empty(); }
+        [[nodiscard]] u32 GetCommandCount() const { return static_cast<u32>(m_commands.size()); }
+
+    private:
+        World& m_world;
+        Vector<Func<void(World&)>> m_commands;
+    };
+}
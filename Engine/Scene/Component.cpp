@@ -0,0 +1,54 @@
+#include "Component.hpp"
+
+#include "Core/Assert.hpp"
+
+#include <atomic>
+#include <mutex>
+
+namespace zn
+{
+    namespace
+    {
+        // Fixed storage, so references returned by GetInfo stay valid while other types register.
+        // Types register lazily on first use, which can happen on worker threads
+        struct Registry
+        {
+            Array<ComponentInfo, MAX_COMPONENT_TYPES> Infos{};
+            std::atomic<u32> Count{0};
+            std::mutex RegisterMutex;
+        };
+
+        // Function local so components registered during static initialization are safe
+        Registry& GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+    }
+
+    const ComponentInfo& ComponentRegistry::GetInfo(ComponentId id)
+    {
+        const Registry& registry = GetRegistry();
+        ZN_ASSERT(id < registry.Count.load(std::memory_order_acquire), "Unknown component id");
+        return registry.Infos[id];
+    }
+
+    u32 ComponentRegistry::GetCount()
+    {
+        return GetRegistry().Count.load(std::memory_order_acquire);
+    }
+
+    ComponentId ComponentRegistry::Register(const ComponentInfo& info)
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.RegisterMutex);
+
+        const u32 id = registry.Count.load(std::memory_order_relaxed);
+        ZN_ASSERT(id < MAX_COMPONENT_TYPES, "Too many component types, ComponentMask has one bit per type");
+
+        registry.Infos[id] = info;
+        registry.Count.store(id + 1, std::memory_order_release);
+
+        return static_cast<ComponentId>(id);
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Resource/ResourceRegistry.hpp"
+
+#include <new>
+#include <type_traits>
+
+namespace zn
+{
+    class World;
+
+    // Same index/generation layout as every other handle. The generation changes when the entity is
+    // destroyed, so stale entities are detected instead of aliasing a new one
+    using Entity = Handle<World>;
+
+    using ComponentId = u32;
+    using ComponentMask = u64; // One bit per ComponentId
+
+    static constexpr u32 MAX_COMPONENT_TYPES = 64;
+
+    // Components are plain data stored by value in archetype chunks and moved around whenever an
+    // entity changes archetype, so they must be cheap to default construct and to move
+    template<typename T>
+    concept Component = std::is_same_v<T, std::remove_cvref_t<T>>
+        && std::is_default_constructible_v<T>
+        && std::is_nothrow_move_constructible_v<T>
+        && std::is_move_assignable_v<T>;
+
+    struct ComponentInfo
+    {
+        u32 Size = 0;
+        u32 Alignment = 0;
+        void (*DefaultConstruct)(void* destination) = nullptr;
+        void (*MoveConstruct)(void* destination, void* source) = nullptr;
+        void (*Destroy)(void* component) = nullptr;
+    };
+
+    // Hands out a ComponentId per component type the first time the type is used
+    class ComponentRegistry
+    {
+    public:
+        ComponentRegistry() = delete;
+
+        template<Component T>
+        [[nodiscard]] static ComponentId GetId()
+        {
+            static const ComponentId id = Register(ComponentInfo{
+                static_cast<u32>(sizeof(T)),
+                static_cast<u32>(alignof(T)),
+                [](void* destination) { new (destination) T(); },
+                [](void* destination, void* source) { new (destination) T(std::move(*static_cast<T*>(source))); },
+                [](void* component) { static_cast<T*>(component)->~T(); }
+            });
+
+            return id;
+        }
+
+        template<Component... Ts>
+        [[nodiscard]] static ComponentMask GetMask()
+        {
+            return (ComponentMask{0} | ... | (ComponentMask{1} << GetId<Ts>()));
+        }
+
+        [[nodiscard]] static const ComponentInfo& GetInfo(ComponentId id);
+        [[nodiscard]] static u32 GetCount();
+
+    private:
+        static ComponentId Register(const ComponentInfo& info);
+    };
+}
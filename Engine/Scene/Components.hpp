@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Math/Bounds.hpp"
+#include "Math/Math.hpp"
+#include "Scene/TransformHierarchy.hpp"
+
+namespace zn
+{
+    // Node of the entity in the TransformHierarchy, which owns the local transform
+    struct TransformComponent
+    {
+        TransformHandle Node{};
+    };
+
+    // The node's world matrix as of the last hierarchy update, copied next to the other per entity
+    // data so systems iterating entities don't look it up in the hierarchy
+    struct WorldTransformComponent
+    {
+        math::m4 World{1.0f};
+    };
+
+    // Local rotation = Base * rotation of DegreesPerSecond around Axis over time
+    struct SpinComponent
+    {
+        math::quat Base{1.0f, 0.0f, 0.0f, 0.0f};
+        math::v3 Axis{0.0f, 1.0f, 0.0f};
+        f32 DegreesPerSecond = 0.0f;
+    };
+
+    // Slot in the renderer's instance buffer
+    struct MeshInstanceComponent
+    {
+        u32 Instance = 0;
+    };
+
+    // Solid object: occluder and occlusion culling candidate
+    struct CullingComponent
+    {
+        math::AABB LocalBounds{};
+        u32 CandidateId = 0;
+    };
+}
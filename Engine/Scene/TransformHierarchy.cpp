@@ -0,0 +1,437 @@
+#include "TransformHierarchy.hpp"
+
+#include "Core/Assert.hpp"
+#include "Core/Log.hpp"
+#include "Core/Timer.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace zn
+{
+    namespace
+    {
+        const math::m4 IDENTITY(1.0f);
+
+        template<typename T>
+        void Permute(Vector<T>& values, const Vector<u32>& order)
+        {
+            Vector<T> sorted;
+            sorted.reserve(order.size());
+
+            for (u32 index : order)
+            {
+                sorted.push_back(values[index]);
+            }
+
+            values = std::move(sorted);
+        }
+    }
+
+    TransformHandle TransformHierarchy::Create(Opt<TransformHandle> parent, const math::v3& translation, const math::quat& rotation, const math::v3& scale)
+    {
+        u32 parentDense = INVALID_INDEX;
+        if (parent)
+        {
+            parentDense = GetDense(parent.value());
+            if (parentDense == INVALID_INDEX)
+            {
+                ZN_LOG_WARN(Scene, "[TransformHierarchy::Create] Invalid parent (Id: {}, Gen: {}), the node is created as a root", parent->GetIndex(), parent->GetGeneration());
+            }
+        }
+
+        u32 slotIndex;
+        if (!m_freeSlots.empty())
+        {
+            slotIndex = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else
+        {
+            slotIndex = static_cast<u32>(m_slots.size());
+            m_slots.emplace_back();
+        }
+
+        const u32 dense = static_cast<u32>(m_world.size());
+        const uSize newSize = m_world.size() + 1;
+
+        m_translations.Resize(newSize);
+        m_rotations.Resize(newSize);
+        m_scales.Resize(newSize);
+        m_translations.Set(dense, translation);
+        m_rotations.Set(dense, rotation);
+        m_scales.Set(dense, scale);
+
+        m_world.push_back(IDENTITY);
+        m_parents.push_back(parentDense);
+        m_slotOfDense.push_back(slotIndex);
+        m_localDirty.push_back(1);
+        m_worldChanged.push_back(0);
+        m_removed.push_back(0);
+
+        Slot& slot = m_slots[slotIndex];
+        slot.Dense = dense;
+        slot.Alive = true;
+
+        // Appending only keeps the depth order when the node belongs to the deepest level, which is
+        // rarely the case. Sorting is deferred to Update so building a tree costs a single sort
+        m_orderDirty = true;
+
+        return TransformHandle{ slotIndex, slot.Generation };
+    }
+
+    void TransformHierarchy::Destroy(TransformHandle handle)
+    {
+        const u32 dense = GetDense(handle);
+        if (dense == INVALID_INDEX)
+        {
+            ZN_LOG_WARN(Scene, "[TransformHierarchy::Destroy] Invalid handle (Id: {}, Gen: {})", handle.GetIndex(), handle.GetGeneration());
+            return;
+        }
+
+        m_removed[dense] = 1;
+
+        // The arrays may not be sorted yet, so descendants are found by walking up from every node
+        for (u32 i = 0; i < m_world.size(); ++i)
+        {
+            for (u32 ancestor = m_parents[i]; ancestor != INVALID_INDEX; ancestor = m_parents[ancestor])
+            {
+                if (ancestor == dense)
+                {
+                    m_removed[i] = 1;
+                    break;
+                }
+            }
+        }
+
+        for (u32 i = 0; i < m_world.size(); ++i)
+        {
+            if (!m_removed[i])
+                continue;
+
+            Slot& slot = m_slots[m_slotOfDense[i]];
+            if (!slot.Alive)
+                continue;
+
+            slot.Alive = false;
+            slot.Dense = INVALID_INDEX;
+            ++slot.Generation;
+            m_freeSlots.push_back(m_slotOfDense[i]);
+        }
+
+        m_orderDirty = true;
+    }
+
+    b8 TransformHierarchy::SetParent(TransformHandle handle, Opt<TransformHandle> parent)
+    {
+        const u32 dense = GetDense(handle);
+        if (dense == INVALID_INDEX)
+        {
+            ZN_LOG_WARN(Scene, "[TransformHierarchy::SetParent] Invalid handle (Id: {}, Gen: {})", handle.GetIndex(), handle.GetGeneration());
+            return false;
+        }
+
+        u32 parentDense = INVALID_INDEX;
+        if (parent)
+        {
+            parentDense = GetDense(parent.value());
+            if (parentDense == INVALID_INDEX)
+            {
+                ZN_LOG_WARN(Scene, "[TransformHierarchy::SetParent] Invalid parent (Id: {}, Gen: {})", parent->GetIndex(), parent->GetGeneration());
+                return false;
+            }
+
+            for (u32 ancestor = parentDense; ancestor != INVALID_INDEX; ancestor = m_parents[ancestor])
+            {
+                if (ancestor == dense)
+                {
+                    ZN_LOG_WARN(Scene, "[TransformHierarchy::SetParent] A node can't be parented to one of its descendants");
+                    return false;
+                }
+            }
+        }
+
+        m_parents[dense] = parentDense;
+        m_localDirty[dense] = 1;
+        m_orderDirty = true;
+
+        return true;
+    }
+
+    void TransformHierarchy::SetLocalTranslation(TransformHandle handle, const math::v3& translation)
+    {
+        const u32 dense = GetDense(handle);
+        ZN_ASSERT(dense != INVALID_INDEX, "Invalid transform handle");
+
+        m_translations.Set(dense, translation);
+        m_localDirty[dense] = 1;
+    }
+
+    void TransformHierarchy::SetLocalRotation(TransformHandle handle, const math::quat& rotation)
+    {
+        const u32 dense = GetDense(handle);
+        ZN_ASSERT(dense != INVALID_INDEX, "Invalid transform handle");
+
+        m_rotations.Set(dense, rotation);
+        m_localDirty[dense] = 1;
+    }
+
+    void TransformHierarchy::SetLocalScale(TransformHandle handle, const math::v3& scale)
+    {
+        const u32 dense = GetDense(handle);
+        ZN_ASSERT(dense != INVALID_INDEX, "Invalid transform handle");
+
+        m_scales.Set(dense, scale);
+        m_localDirty[dense] = 1;
+    }
+
+    void TransformHierarchy::SetLocalTransform(TransformHandle handle, const math::v3& translation, const math::quat& rotation, const math::v3& scale)
+    {
+        const u32 dense = GetDense(handle);
+        ZN_ASSERT(dense != INVALID_INDEX, "Invalid transform handle");
+
+        m_translations.Set(dense, translation);
+        m_rotations.Set(dense, rotation);
+        m_scales.Set(dense, scale);
+        m_localDirty[dense] = 1;
+    }
+
+    math::v3 TransformHierarchy::GetLocalTranslation(TransformHandle handle) const
+    {
+        const u32 dense = GetDense(handle);
+        ZN_ASSERT(dense != INVALID_INDEX, "Invalid transform handle");
+
+        return dense != INVALID_INDEX ? m_translations.Get(dense) : math::v3(0.0f);
+    }
+
+    math::quat TransformHierarchy::GetLocalRotation(TransformHandle handle) const
+    {
+        const u32 dense = GetDense(handle);
+        ZN_ASSERT(dense != INVALID_INDEX, "Invalid transform handle");
+
+        return dense != INVALID_INDEX ? m_rotations.Get(dense) : math::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    math::v3 TransformHierarchy::GetLocalScale(TransformHandle handle) const
+    {
+        const u32 dense = GetDense(handle);
+        ZN_ASSERT(dense != INVALID_INDEX, "Invalid transform handle");
+
+        return dense != INVALID_INDEX ? m_scales.Get(dense) : math::v3(1.0f);
+    }
+
+    const math::m4& TransformHierarchy::GetWorldMatrix(TransformHandle handle) const
+    {
+        const u32 dense = GetDense(handle);
+        ZN_ASSERT(dense != INVALID_INDEX, "Invalid transform handle");
+
+        return dense != INVALID_INDEX ? m_world[dense] : IDENTITY;
+    }
+
+    b8 TransformHierarchy::IsValid(TransformHandle handle) const
+    {
+        return GetDense(handle) != INVALID_INDEX;
+    }
+
+    void TransformHierarchy::Update(const ParallelForFn& parallelFor)
+    {
+        Time::Timer timer;
+        timer.Start();
+
+        m_stats = {};
+
+        if (m_orderDirty)
+        {
+            Reorder();
+            m_stats.Reordered = true;
+        }
+
+        m_changed.clear();
+        std::fill(m_worldChanged.begin(), m_worldChanged.end(), static_cast<u8>(0));
+
+        const u32 levelCount = m_levelOffsets.empty() ? 0 : static_cast<u32>(m_levelOffsets.size() - 1);
+
+        for (u32 level = 0; level < levelCount; ++level)
+        {
+            // A node is recomputed when it changed or its parent's world matrix did. Parents live in
+            // earlier levels, so their flags are final by now
+            m_levelDirty.clear();
+            for (u32 i = m_levelOffsets[level]; i < m_levelOffsets[level + 1]; ++i)
+            {
+                const u32 parent = m_parents[i];
+                if (m_localDirty[i] || (parent != INVALID_INDEX && m_worldChanged[parent]))
+                {
+                    m_worldChanged[i] = 1;
+                    m_localDirty[i] = 0;
+                    m_levelDirty.push_back(i);
+                }
+            }
+
+            if (m_levelDirty.empty())
+                continue;
+
+            const u32 dirtyCount = static_cast<u32>(m_levelDirty.size());
+            const u32 taskCount = (dirtyCount + BATCH_SIZE - 1) / BATCH_SIZE;
+
+            if (m_scratch.size() < taskCount)
+            {
+                m_scratch.resize(taskCount);
+            }
+
+            auto runBatch = [this, dirtyCount](u32 task)
+            {
+                const u32 begin = task * BATCH_SIZE;
+                UpdateBatch(m_levelDirty.data() + begin, std::min(BATCH_SIZE, dirtyCount - begin), m_scratch[task]);
+            };
+
+            if (parallelFor && taskCount > 1)
+            {
+                parallelFor(taskCount, runBatch);
+            }
+            else
+            {
+                for (u32 task = 0; task < taskCount; ++task)
+                {
+                    runBatch(task);
+                }
+            }
+
+            m_changed.insert(m_changed.end(), m_levelDirty.begin(), m_levelDirty.end());
+            m_stats.Batches += taskCount;
+        }
+
+        m_stats.Nodes = GetCount();
+        m_stats.Levels = levelCount;
+        m_stats.Recomputed = static_cast<u32>(m_changed.size());
+        m_stats.UpdateTimeMs = timer.GetElapsedTime() * 1000.0;
+    }
+
+    u32 TransformHierarchy::GetDense(TransformHandle handle) const
+    {
+        if (handle.GetIndex() >= m_slots.size())
+            return INVALID_INDEX;
+
+        const Slot& slot = m_slots[handle.GetIndex()];
+        if (!slot.Alive || slot.Generation != handle.GetGeneration())
+            return INVALID_INDEX;
+
+        return slot.Dense;
+    }
+
+    void TransformHierarchy::Reorder()
+    {
+        const u32 count = static_cast<u32>(m_world.size());
+
+        // Depths are resolved by walking up to the first ancestor with a known depth
+        Vector<u32> depths(count, INVALID_INDEX);
+        Vector<u32> chain;
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            u32 node = i;
+            while (node != INVALID_INDEX && depths[node] == INVALID_INDEX)
+            {
+                chain.push_back(node);
+                node = m_parents[node];
+            }
+
+            u32 depth = node == INVALID_INDEX ? 0 : depths[node] + 1;
+            for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+            {
+                depths[*it] = depth++;
+            }
+
+            chain.clear();
+        }
+
+        Vector<u32> order;
+        order.reserve(count);
+        for (u32 i = 0; i < count; ++i)
+        {
+            if (!m_removed[i])
+            {
+                order.push_back(i);
+            }
+        }
+
+        std::stable_sort(order.begin(), order.end(), [&depths](u32 lhs, u32 rhs) { return depths[lhs] < depths[rhs]; });
+
+        Vector<u32> newIndexOf(count, INVALID_INDEX);
+        for (u32 i = 0; i < order.size(); ++i)
+        {
+            newIndexOf[order[i]] = i;
+        }
+
+        Permute(m_translations.X, order);
+        Permute(m_translations.Y, order);
+        Permute(m_translations.Z, order);
+        Permute(m_rotations.X, order);
+        Permute(m_rotations.Y, order);
+        Permute(m_rotations.Z, order);
+        Permute(m_rotations.W, order);
+        Permute(m_scales.X, order);
+        Permute(m_scales.Y, order);
+        Permute(m_scales.Z, order);
+        Permute(m_world, order);
+        Permute(m_parents, order);
+        Permute(m_slotOfDense, order);
+        Permute(m_localDirty, order);
+        Permute(depths, order);
+
+        const uSize newCount = order.size();
+        m_worldChanged.assign(newCount, 0);
+        m_removed.assign(newCount, 0);
+
+        m_levelOffsets.clear();
+        for (u32 i = 0; i < newCount; ++i)
+        {
+            if (m_parents[i] != INVALID_INDEX)
+            {
+                m_parents[i] = newIndexOf[m_parents[i]];
+            }
+
+            m_slots[m_slotOfDense[i]].Dense = i;
+
+            while (m_levelOffsets.size() <= depths[i])
+            {
+                m_levelOffsets.push_back(i);
+            }
+        }
+
+        if (newCount > 0)
+        {
+            m_levelOffsets.push_back(static_cast<u32>(newCount));
+        }
+
+        m_orderDirty = false;
+    }
+
+    void TransformHierarchy::UpdateBatch(const u32* nodes, u32 count, BatchScratch& scratch)
+    {
+        scratch.Translations.Resize(count);
+        scratch.Rotations.Resize(count);
+        scratch.Scales.Resize(count);
+        scratch.Parents.resize(count);
+        scratch.Locals.resize(count);
+
+        // Gather into contiguous streams so the SIMD kernels run over the dirty nodes only
+        for (u32 k = 0; k < count; ++k)
+        {
+            const u32 node = nodes[k];
+            scratch.Translations.Set(k, m_translations.Get(node));
+            scratch.Rotations.Set(k, m_rotations.Get(node));
+            scratch.Scales.Set(k, m_scales.Get(node));
+
+            const u32 parent = m_parents[node];
+            scratch.Parents[k] = parent != INVALID_INDEX ? m_world[parent] : IDENTITY;
+        }
+
+        math::simd::ComposeTRS(scratch.Translations, scratch.Rotations, scratch.Scales, scratch.Locals.data());
+        math::simd::MultiplyMatrices(scratch.Parents.data(), scratch.Locals.data(), scratch.Locals.data(), count);
+
+        for (u32 k = 0; k < count; ++k)
+        {
+            m_world[nodes[k]] = scratch.Locals[k];
+        }
+    }
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Math/Math.hpp"
+#include "Math/SimdMath.hpp"
+#include "Resource/ResourceRegistry.hpp"
+
+namespace zn
+{
+    class TransformHierarchy;
+    using TransformHandle = Handle<TransformHierarchy>;
+
+    // Parent/child transforms stored as structure of arrays, sorted by depth so every parent comes
+    // before its children. Update walks the depth levels in order and only recomputes the nodes whose
+    // local transform changed, plus everything below them:
+    //
+    //   world = parentWorld * T * R * S
+    //
+    // Inside a level the dirty nodes are independent, so they are processed in batches that can run
+    // on several threads; levels are the only synchronization points. Handles stay valid while nodes
+    // move around in the arrays. Creating, destroying and reparenting nodes only flags the order, the
+    // arrays are re-sorted on the next Update.
+    class TransformHierarchy
+    {
+    public:
+        struct Stats
+        {
+            u32 Nodes = 0;
+            u32 Levels = 0;
+            u32 Recomputed = 0; // World matrices recomputed by the last Update
+            u32 Batches = 0;
+            b8 Reordered = false;
+            f64 UpdateTimeMs = 0.0;
+        };
+
+        // Calls body(task) for every task in [0, taskCount) and returns once all of them finished
+        using ParallelForFn = Func<void(u32 taskCount, const Func<void(u32 task)>& body)>;
+
+        // Dirty nodes recomputed per task
+        static constexpr u32 BATCH_SIZE = 256;
+
+        TransformHierarchy() = default;
+        ~TransformHierarchy() = default;
+
+        TransformHierarchy(const TransformHierarchy& other) = delete;
+        TransformHierarchy(TransformHierarchy&& other) noexcept = delete;
+
+        TransformHierarchy& operator=(const TransformHierarchy& other) = delete;
+        TransformHierarchy& operator=(TransformHierarchy&& other) noexcept = delete;
+
+        [[nodiscard]] TransformHandle Create(Opt<TransformHandle> parent = std::nullopt,
+            const math::v3& translation = math::v3(0.0f), const math::quat& rotation = math::quat(1.0f, 0.0f, 0.0f, 0.0f),
+            const math::v3& scale = math::v3(1.0f));
+
+        // Destroys the node and all its descendants
+        void Destroy(TransformHandle handle);
+
+        // Reparenting keeps the local transform, so the world transform changes
+        b8 SetParent(TransformHandle handle, Opt<TransformHandle> parent);
+
+        void SetLocalTranslation(TransformHandle handle, const math::v3& translation);
+        void SetLocalRotation(TransformHandle handle, const math::quat& rotation);
+        void SetLocalScale(TransformHandle handle, const math::v3& scale);
+        void SetLocalTransform(TransformHandle handle, const math::v3& translation, const math::quat& rotation, const math::v3& scale);
+
+        [[nodiscard]] math::v3 GetLocalTranslation(TransformHandle handle) const;
+        [[nodiscard]] math::quat GetLocalRotation(TransformHandle handle) const;
+        [[nodiscard]] math::v3 GetLocalScale(TransformHandle handle) const;
+
+        // Result of the last Update
+        [[nodiscard]] const math::m4& GetWorldMatrix(TransformHandle handle) const;
+
+        [[nodiscard]] b8 IsValid(TransformHandle handle) const;
+        [[nodiscard]] u32 GetCount() const { return static_cast<u32>(m_world.size()); }
+
+        // Recomputes the dirty subtrees. Without parallelFor the batches run on the calling thread
+        void Update(const ParallelForFn& parallelFor = {});
+
+        // Visits the nodes whose world matrix changed in the last Update, in depth order
+        template<typename F>
+        requires CallableWithArgs<F, TransformHandle, const math::m4&>
+        void ForEachChanged(F&& func) const
+        {
+            for (u32 dense : m_changed)
+            {
+                const u32 slot = m_slotOfDense[dense];
+                func(TransformHandle{ slot, m_slots[slot].Generation }, m_world[dense]);
+            }
+        }
+
+        [[nodiscard]] const Stats& GetStats() const { return m_stats; }
+
+    private:
+        static constexpr u32 INVALID_INDEX = 0xFFFFFFFF;
+
+        struct Slot
+        {
+            u32 Dense = INVALID_INDEX;
+            u32 Generation = 0;
+            b8 Alive = false;
+        };
+
+        // Per task buffers, so batches never share memory
+        struct BatchScratch
+        {
+            math::Vec3SoA Translations;
+            math::QuatSoA Rotations;
+            math::Vec3SoA Scales;
+            Vector<math::m4> Parents;
+            Vector<math::m4> Locals;
+        };
+
+        [[nodiscard]] u32 GetDense(TransformHandle handle) const;
+        void MarkDirty(TransformHandle handle);
+
+        // Drops destroyed nodes and stable sorts the rest by depth
+        void Reorder();
+        void UpdateBatch(const u32* nodes, u32 count, BatchScratch& scratch);
+
+        // Sparse handle table
+        Vector<Slot> m_slots;
+        Vector<u32> m_freeSlots;
+
+        // Dense, depth sorted arrays
+        math::Vec3SoA m_translations;
+        math::QuatSoA m_rotations;
+        math::Vec3SoA m_scales;
+        Vector<math::m4> m_world;
+        Vector<u32> m_parents;     // Dense index of the parent, INVALID_INDEX for roots
+        Vector<u32> m_slotOfDense;
+        Vector<u8> m_localDirty;
+        Vector<u8> m_worldChanged;
+        Vector<u8> m_removed;
+
+        Vector<u32> m_levelOffsets; // Start of every depth level, plus the end
+        b8 m_orderDirty = false;
+
+        Vector<u32> m_levelDirty;
+        Vector<u32> m_changed;
+        Vector<BatchScratch> m_scratch;
+
+        Stats m_stats;
+    };
+}
@@ -0,0 +1,148 @@
+#include "World.hpp"
+
+#include "Core/Log.hpp"
+
+#include <utility>
+
+namespace zn
+{
+    Entity World::CreateEntity()
+    {
+        u32 index;
+        if (!m_freeEntities.empty())
+        {
+            index = m_freeEntities.back();
+            m_freeEntities.pop_back();
+        }
+        else
+        {
+            index = static_cast<u32>(m_entities.size());
+            m_entities.emplace_back();
+        }
+
+        EntityRecord& record = m_entities[index];
+        record.Owner = nullptr;
+        record.Alive = true;
+        ++m_entityCount;
+
+        return Entity{ index, record.Generation };
+    }
+
+    void World::DestroyEntity(Entity entity)
+    {
+        EntityRecord* record = GetRecord(entity);
+        if (!record)
+        {
+            ZN_LOG_WARN(Scene, "[World::DestroyEntity] Invalid entity (Id: {}, Gen: {})", entity.GetIndex(), entity.GetGeneration());
+            return;
+        }
+
+        if (record->Owner)
+        {
+            RemoveRow(*record);
+        }
+
+        record->Owner = nullptr;
+        record->Alive = false;
+        ++record->Generation;
+        m_freeEntities.push_back(entity.GetIndex());
+        --m_entityCount;
+    }
+
+    b8 World::IsAlive(Entity entity) const
+    {
+        return GetRecord(entity) != nullptr;
+    }
+
+    World::EntityRecord* World::GetRecord(Entity entity)
+    {
+        return const_cast<EntityRecord*>(std::as_const(*this).GetRecord(entity));
+    }
+
+    const World::EntityRecord* World::GetRecord(Entity entity) const
+    {
+        if (entity.GetIndex() >= m_entities.size())
+            return nullptr;
+
+        const EntityRecord& record = m_entities[entity.GetIndex()];
+        if (!record.Alive || record.Generation != entity.GetGeneration())
+            return nullptr;
+
+        return &record;
+    }
+
+    void* World::GetComponent(Entity entity, ComponentId id)
+    {
+        EntityRecord* record = GetRecord(entity);
+        if (!record || !record->Owner || !record->Owner->Has(id))
+            return nullptr;
+
+        return record->Owner->GetComponent(record->Location, id);
+    }
+
+    Archetype& World::GetOrCreateArchetype(ComponentMask mask)
+    {
+        if (auto it = m_archetypeLookup.find(mask); it != m_archetypeLookup.end())
+        {
+            return *it->second;
+        }
+
+        Archetype& archetype = *m_archetypes.emplace_back(CreateUnique<Archetype>(mask));
+        m_archetypeLookup.emplace(mask, &archetype);
+
+        return archetype;
+    }
+
+    void World::ChangeArchetype(Entity entity, EntityRecord& record, ComponentMask mask, Opt<ComponentId> unconstructed)
+    {
+        ZN_ASSERT(m_iterationDepth == 0, "Structural change while iterating a view, record it in a CommandBuffer");
+
+        Archetype* source = record.Owner;
+        const Archetype::Location sourceLocation = record.Location;
+
+        if (mask == 0)
+        {
+            RemoveRow(record);
+            record.Owner = nullptr;
+            return;
+        }
+
+        Archetype& destination = GetOrCreateArchetype(mask);
+        const Archetype::Location location = destination.PushUninitialized(entity);
+
+        for (ComponentId id : destination.GetComponents())
+        {
+            if (unconstructed && id == unconstructed.value())
+                continue;
+
+            const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+            void* component = destination.GetComponent(location, id);
+
+            if (source && source->Has(id))
+            {
+                info.MoveConstruct(component, source->GetComponent(sourceLocation, id));
+            }
+            else
+            {
+                info.DefaultConstruct(component);
+            }
+        }
+
+        // The moved from components are destroyed with the old row
+        if (source)
+        {
+            RemoveRow(record);
+        }
+
+        record.Owner = &destination;
+        record.Location = location;
+    }
+
+    void World::RemoveRow(const EntityRecord& record)
+    {
+        if (Opt<Entity> moved = record.Owner->Remove(record.Location))
+        {
+            m_entities[moved->GetIndex()].Location = record.Location;
+        }
+    }
+}
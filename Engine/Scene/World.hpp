@@ -0,0 +1,231 @@
+#pragma once
+
+#include "Core/Assert.hpp"
+#include "Core/Base.hpp"
+#include "Scene/Archetype.hpp"
+#include "Scene/Component.hpp"
+
+#include <bit>
+
+namespace zn
+{
+    template<Component... Ts>
+    class View;
+
+    // Entities and their components, grouped into archetypes by component set. Adding or removing a
+    // component moves the entity to another archetype (a structural change); those are not allowed
+    // while a View is being iterated, record them in a CommandBuffer instead.
+    //
+    // Entities without components live outside every archetype. Creating one is not a structural
+    // change, so it is allowed anywhere.
+    class World
+    {
+    public:
+        World() = default;
+        ~World() = default;
+
+        World(const World& other) = delete;
+        World(World&& other) noexcept = delete;
+
+        World& operator=(const World& other) = delete;
+        World& operator=(World&& other) noexcept = delete;
+
+        [[nodiscard]] Entity CreateEntity();
+
+        template<Component... Ts>
+        requires (sizeof...(Ts) > 0)
+        Entity CreateEntity(Ts... components)
+        {
+            const ComponentMask mask = ComponentRegistry::GetMask<Ts...>();
+            ZN_ASSERT(std::popcount(mask) == sizeof...(Ts), "An entity can't have the same component twice");
+            ZN_ASSERT(m_iterationDepth == 0, "Structural change while iterating a view, record it in a CommandBuffer");
+
+            const Entity entity = CreateEntity();
+            EntityRecord& record = m_entities[entity.GetIndex()];
+
+            Archetype& archetype = GetOrCreateArchetype(mask);
+            record.Owner = &archetype;
+            record.Location = archetype.PushUninitialized(entity);
+
+            (new (archetype.GetComponent(record.Location, ComponentRegistry::GetId<Ts>())) Ts(std::move(components)), ...);
+
+            return entity;
+        }
+
+        void DestroyEntity(Entity entity);
+        [[nodiscard]] b8 IsAlive(Entity entity) const;
+
+        // Replaces the component if the entity already has it
+        template<Component T, typename... Args>
+        requires ConstructibleWithArgs<T, Args...>
+        T& AddComponent(Entity entity, Args&&... args)
+        {
+            ZN_ASSERT(IsAlive(entity), "AddComponent on a destroyed entity");
+
+            const ComponentId id = ComponentRegistry::GetId<T>();
+            EntityRecord& record = m_entities[entity.GetIndex()];
+
+            if (record.Owner && record.Owner->Has(id))
+            {
+                T& component = *static_cast<T*>(record.Owner->GetComponent(record.Location, id));
+                component = T(std::forward<Args>(args)...);
+                return component;
+            }
+
+            const ComponentMask mask = (record.Owner ? record.Owner->GetMask() : 0) | (ComponentMask{1} << id);
+            ChangeArchetype(entity, record, mask, id);
+
+            return *new (record.Owner->GetComponent(record.Location, id)) T(std::forward<Args>(args)...);
+        }
+
+        template<Component T>
+        void RemoveComponent(Entity entity)
+        {
+            const ComponentId id = ComponentRegistry::GetId<T>();
+
+            EntityRecord* record = GetRecord(entity);
+            if (!record || !record->Owner || !record->Owner->Has(id))
+                return;
+
+            ChangeArchetype(entity, *record, record->Owner->GetMask() & ~(ComponentMask{1} << id), std::nullopt);
+        }
+
+        template<Component T>
+        [[nodiscard]] b8 HasComponent(Entity entity) const
+        {
+            const EntityRecord* record = GetRecord(entity);
+            return record && record->Owner && record->Owner->Has(ComponentRegistry::GetId<T>());
+        }
+
+        // nullptr if the entity is destroyed or doesn't have the component. The pointer is invalidated
+        // by the next structural change
+        template<Component T>
+        [[nodiscard]] T* GetComponent(Entity entity)
+        {
+            return static_cast<T*>(GetComponent(entity, ComponentRegistry::GetId<T>()));
+        }
+
+        // Entities having at least all of Ts
+        template<Component... Ts>
+        [[nodiscard]] View<Ts...> Query() { return View<Ts...>(*this); }
+
+        [[nodiscard]] u32 GetEntityCount() const { return m_entityCount; }
+        [[nodiscard]] const Vector<UniquePtr<Archetype>>& GetArchetypes() const { return m_archetypes; }
+
+    private:
+        template<Component... Ts>
+        friend class View;
+
+        struct EntityRecord
+        {
+            Archetype* Owner = nullptr; // nullptr while the entity has no components
+            Archetype::Location Location{};
+            u32 Generation = 0;
+            b8 Alive = false;
+        };
+
+        [[nodiscard]] EntityRecord* GetRecord(Entity entity);
+        [[nodiscard]] const EntityRecord* GetRecord(Entity entity) const;
+        [[nodiscard]] void* GetComponent(Entity entity, ComponentId id);
+
+        [[nodiscard]] Archetype& GetOrCreateArchetype(ComponentMask mask);
+
+        // Moves the entity to the archetype of mask. Components both archetypes have are moved, the
+        // other new ones are default constructed, except unconstructed which the caller constructs
+        void ChangeArchetype(Entity entity, EntityRecord& record, ComponentMask mask, Opt<ComponentId> unconstructed);
+        // Removes the row of the record and fixes up the entity that was moved into it
+        void RemoveRow(const EntityRecord& record);
+
+        Vector<EntityRecord> m_entities;
+        Vector<u32> m_freeEntities;
+        u32 m_entityCount = 0;
+
+        Vector<UniquePtr<Archetype>> m_archetypes;
+        UMap<ComponentMask, Archetype*> m_archetypeLookup;
+
+        u32 m_iterationDepth = 0;
+    };
+
+    // Typed iteration over every entity having all of Ts (and none of the excluded components).
+    // Archetypes are matched by mask and walked chunk by chunk, so components are read straight from
+    // their columns
+    template<Component... Ts>
+    class View
+    {
+    public:
+        explicit View(World& world)
+            : m_world(world), m_include(ComponentRegistry::GetMask<Ts...>())
+        {
+        }
+
+        template<Component... Us>
+        View& Exclude()
+        {
+            m_exclude |= ComponentRegistry::GetMask<Us...>();
+            return *this;
+        }
+
+        // func(entity, components...) for every matching entity
+        template<typename F>
+        requires CallableWithArgs<F, Entity, Ts&...>
+        void Each(F&& func)
+        {
+            EachChunk([&func](u32 count, const Entity* entities, Ts*... columns)
+            {
+                for (u32 i = 0; i < count; ++i)
+                {
+                    func(entities[i], columns[i]...);
+                }
+            });
+        }
+
+        // func(count, entities, columns...) once per chunk, for loops that want the arrays themselves
+        template<typename F>
+        requires CallableWithArgs<F, u32, const Entity*, Ts*...>
+        void EachChunk(F&& func)
+        {
+            ++m_world.m_iterationDepth;
+
+            for (const UniquePtr<Archetype>& archetype : m_world.m_archetypes)
+            {
+                if (!Matches(*archetype))
+                    continue;
+
+                for (u32 chunk = 0; chunk < archetype->GetChunkCount(); ++chunk)
+                {
+                    const u32 count = archetype->GetRowCount(chunk);
+                    if (count == 0)
+                        continue;
+
+                    func(count, archetype->GetEntities(chunk), archetype->template GetColumn<Ts>(chunk)...);
+                }
+            }
+
+            --m_world.m_iterationDepth;
+        }
+
+        [[nodiscard]] u32 Count() const
+        {
+            u32 count = 0;
+            for (const UniquePtr<Archetype>& archetype : m_world.m_archetypes)
+            {
+                if (Matches(*archetype))
+                {
+                    count += archetype->GetEntityCount();
+                }
+            }
+
+            return count;
+        }
+
+    private:
+        [[nodiscard]] b8 Matches(const Archetype& archetype) const
+        {
+            return (archetype.GetMask() & m_include) == m_include && (archetype.GetMask() & m_exclude) == 0;
+        }
+
+        World& m_world;
+        ComponentMask m_include = 0;
+        ComponentMask m_exclude = 0;
+    };
+}
@@ -1,14 +1,44 @@
 #include "Core/Application.hpp"
 
+#include <cstdlib>
+#include <cstring>
+
 int main(int argc, char *argv[])
 {
     using namespace zn;
+
+	ApplicationConfig config;
+	config.Name = "Sandbox";
+	config.WindowWidth = 1980;
+	config.WindowHeight = 1080;
+
+	// --headless runs the simulation without a window, --ticks N stops it after N ticks,
+	// --throttle paces it at the fixed update rate and --stats-csv PATH streams the stats to a file
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--headless") == 0)
+		{
+			config.Headless = true;
+		}
+		else if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+		{
+			config.MaxTicks = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--throttle") == 0)
+		{
+			config.ThrottleToFixedRate = true;
+		}
+		else if (std::strcmp(argv[i], "--stats-csv") == 0 && i + 1 < argc)
+		{
+			config.StatsCsvPath = argv[++i];
+		}
+	}
     
 	SharedPtr<Application> app = CreateShared<Application>();
-	if (app->Init("Sandbox", 1980, 1080))
+	if (app->Init(config))
 	{
 		app->Run();
 	}
 
 	return 0;
-}
\ No newline at end of file
+}